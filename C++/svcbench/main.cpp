@@ -0,0 +1,552 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "svcsig.hpp"
+#include "svcsigann.hpp"
+#include "svcsigbatch.hpp"
+#include "svcsiglibrary.hpp"
+#include "svcsigquantile.hpp"
+#include "svcsigreflectance.hpp"
+#include "svcsigsavgol.hpp"
+#include "svcsigexpression.hpp"
+#include "svcsigshm.hpp"
+#include "svcsigsrf.hpp"
+
+void svcbench_usage( void )
+{
+  std::cout << "svcbench" << std::endl;
+  std::cout << "\tTimes the svcsig readers" << std::endl;
+  std::cout << std::endl;
+  std::cout << "Usage: svcbench shm [-p processes] [-n repeats] filename.sig ..." << std::endl;
+  std::cout << "       svcbench reflectance [-n repeats] filename.sig ..." << std::endl;
+  std::cout << "       svcbench srf [-n repeats] [-s table] filename.sig ..." << std::endl;
+  std::cout << "       svcbench search [-n repeats] [-l size] filename.sig ..." << std::endl;
+  std::cout << "       svcbench ann [-l size] filename.sig ..." << std::endl;
+  std::cout << "       svcbench quantile [-l size] filename.sig ..." << std::endl;
+  std::cout << "       svcbench savgol [-n repeats] filename.sig ..." << std::endl;
+  std::cout << "       svcbench indices [-n repeats] filename.sig ..." << std::endl;
+  std::cout << "\tshm:\tParsing each file against reading it from shared memory" << std::endl;
+  std::cout << "\treflectance:\tRecomputing reflectance, in GB/s" << std::endl;
+  std::cout << "\tsrf:\tSimulating OLI and MSI bands (Gaussian approximations, plus" << std::endl;
+  std::cout << "\t\tany response tables), in spectra/s" << std::endl;
+  std::cout << "\tsearch:\tExact top 10 search of a library of random mixtures of" << std::endl;
+  std::cout << "\t\tthe files, in queries/s" << std::endl;
+  std::cout << "\tann:\tRecall@10 and queries/s of the approximate index against" << std::endl;
+  std::cout << "\t\texact search of the same library" << std::endl;
+  std::cout << "\tquantile:\tRank error, time and memory of the quantile sketches" << std::endl;
+  std::cout << "\t\tagainst nth_element on the full matrix" << std::endl;
+  std::cout << "\tsavgol:\tSavitzky-Golay smoothing and derivatives, in spectra/s" << std::endl;
+  std::cout << "\tindices:\tthe standard spectral indices, in spectra/s" << std::endl;
+  std::cout << "\tp:\tThe number of reader processes (default 1)" << std::endl;
+  std::cout << "\tn:\tThe number of passes over the files (default 100)" << std::endl;
+  std::cout << "\ts:\tA response table to add to the band sets" << std::endl;
+  std::cout << "\tl:\tThe number of library spectra (default 20000)" << std::endl;
+  return;
+};
+
+double svcbench_seconds( const std::chrono::steady_clock::time_point &start )
+{
+  return std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+}
+
+// -- -- shm -- -- //
+int svcbench_shm( const std::vector<std::string> &filenames, const int &processes, const int &repeats )
+{
+  const std::string name( "/svcbench" );
+  svcsigshm::remove( name );
+  svcsigshm shm;
+  shm.open( name );
+
+  // parse every file (the baseline), publishing it
+  std::chrono::steady_clock::time_point start( std::chrono::steady_clock::now() );
+  double sum( 0.0 );
+  for ( size_t i = 0; i < filenames.size(); i++ ) {
+    svcsig sig;
+    sig.read( filenames[ i ] );
+    for ( size_t j = 0; j < sig.targetReflectance().size(); j++ ) {
+      sum += sig.targetReflectance()[ j ];
+    }
+    if ( !shm.publish( filenames[ i ], sig ) ) {
+      std::cerr << "could not publish '" << filenames[ i ] << "'" << std::endl;
+    }
+  }
+  double parse( svcbench_seconds( start ) / filenames.size() );
+  std::cout << "parse:  " << parse * 1e6 << " us/file" << std::endl;
+  std::cout << "shared: " << shm.size() << " files, " << shm.used() / 1048576.0 << " MB" << std::endl;
+
+  // read them back from the segment in other processes
+  std::vector<pid_t> children;
+  for ( int p = 0; p < processes; p++ ) {
+    pid_t child( fork() );
+    if ( child == 0 ) {
+      svcsigshm reader;
+      reader.attach( name );
+      double check( 0.0 );
+      size_t missing( 0 );
+      std::chrono::steady_clock::time_point start( std::chrono::steady_clock::now() );
+      for ( int r = 0; r < repeats; r++ ) {
+        for ( size_t i = 0; i < filenames.size(); i++ ) {
+          svcsigshmview view( reader.find( filenames[ i ] ) );
+          if ( !view.valid() ) {
+            missing++;
+            continue;
+          }
+          const float *reflectance( view.targetReflectance() );
+          for ( size_t j = 0; j < view.size(); j++ ) {
+            check += reflectance[ j ];
+          }
+        }
+      }
+      double find( svcbench_seconds( start ) / ( double( repeats ) * filenames.size() ) );
+      std::cout << "reader " << p << ": " << find * 1e6 << " us/file (" << parse / find << "x), " << missing << " missing" << ( check == sum * repeats ? "" : " (mismatch)" ) << std::endl;
+      _exit( 0 );
+    }
+    children.push_back( child );
+  }
+  for ( size_t p = 0; p < children.size(); p++ ) {
+    waitpid( children[ p ], NULL, 0 );
+  }
+
+  shm.close();
+  svcsigshm::remove( name );
+  return 0;
+}
+
+// -- -- reflectance -- -- //
+int svcbench_reflectance( const std::vector<std::string> &filenames, const int &repeats )
+{
+  std::vector<svcsig> sigs( svcSigReadBatch( filenames ) );
+  size_t bands( 0 );
+  for ( size_t i = 0; i < sigs.size(); i++ ) {
+    bands += sigs[ i ].size();
+  }
+  // two radiances are read and the reflectance written
+  double gb( 3.0 * sizeof( float ) * bands * repeats / 1e9 );
+
+  // the scalar loop through copied vectors
+  std::chrono::steady_clock::time_point start( std::chrono::steady_clock::now() );
+  double checksum( 0.0 ); // printed, so the loop is not optimised away
+  for ( int r = 0; r < repeats; r++ ) {
+    for ( size_t i = 0; i < sigs.size(); i++ ) {
+      std::vector<float> reference( sigs[ i ].referenceRadiance() );
+      std::vector<float> target( sigs[ i ].targetRadiance() );
+      std::vector<float> reflectance( reference.size() );
+      for ( size_t j = 0; j < reference.size(); j++ ) {
+        reflectance[ j ] = reference[ j ] == 0.0 ? 0.0 : 100.0 * sigs[ i ].factorsReflectance() * target[ j ] / reference[ j ];
+      }
+      checksum += reflectance[ 0 ];
+    }
+  }
+  double copied( svcbench_seconds( start ) );
+
+  // the kernel, in place
+  start = std::chrono::steady_clock::now();
+  for ( int r = 0; r < repeats; r++ ) {
+    for ( size_t i = 0; i < sigs.size(); i++ ) {
+      svcSigReflectance( sigs[ i ] );
+    }
+  }
+  double kernel( svcbench_seconds( start ) );
+
+  start = std::chrono::steady_clock::now();
+  for ( int r = 0; r < repeats; r++ ) {
+    svcSigReflectanceBatch( sigs );
+  }
+  double batch( svcbench_seconds( start ) );
+
+  std::cout << "copied: " << gb / copied << " GB/s (checksum " << checksum << ")" << std::endl;
+  std::cout << "kernel: " << gb / kernel << " GB/s (" << copied / kernel << "x)" << std::endl;
+  std::cout << "batch:  " << gb / batch << " GB/s on " << svcSigThreads( 0 ) << " threads" << std::endl;
+  return 0;
+}
+
+// -- -- srf -- -- //
+int svcbench_srf( const std::vector<std::string> &filenames, const std::vector<std::string> &tables, const int &repeats )
+{
+  // Gaussian approximations of the reflective bands of Landsat 8 OLI and
+  // Sentinel-2A MSI
+  const double oli[][ 2 ] = { { 443, 16 }, { 482, 60 }, { 561, 57 }, { 655, 38 }, { 865, 28 }, { 1609, 85 }, { 2201, 187 } };
+  const double msi[][ 2 ] = { { 443, 21 }, { 492, 66 }, { 560, 36 }, { 665, 31 }, { 704, 15 }, { 740, 15 }, { 783, 20 },
+    { 833, 106 }, { 865, 21 }, { 945, 20 }, { 1374, 31 }, { 1614, 91 }, { 2202, 175 } };
+  svcsigsrf srf;
+  svcsigbandset set( "OLI" );
+  for ( size_t b = 0; b < sizeof( oli ) / sizeof( oli[ 0 ] ); b++ ) {
+    set.gaussian( "B" + std::to_string( b + 1 ), oli[ b ][ 0 ], oli[ b ][ 1 ] );
+  }
+  srf.add( set );
+  set = svcsigbandset( "MSI" );
+  for ( size_t b = 0; b < sizeof( msi ) / sizeof( msi[ 0 ] ); b++ ) {
+    set.gaussian( "B" + std::to_string( b + 1 ), msi[ b ][ 0 ], msi[ b ][ 1 ] );
+  }
+  srf.add( set );
+  for ( size_t i = 0; i < tables.size(); i++ ) {
+    srf.add( svcsigbandset( tables[ i ] ).load( tables[ i ] ) );
+  }
+
+  std::vector<svcsig> sigs( svcSigReadBatch( filenames ) );
+  std::chrono::steady_clock::time_point start( std::chrono::steady_clock::now() );
+  srf.matrix( sigs[ 0 ].wavelength() );
+  std::cout << "weights: " << svcbench_seconds( start ) * 1e3 << " ms for " << srf.size() << " bands" << std::endl;
+
+  // a block of spectra on the first file's grid
+  const size_t count( 10000 );
+  size_t bands( sigs[ 0 ].size() );
+  std::vector<float> in( count * bands );
+  std::vector<float> out( count * srf.size() );
+  for ( size_t s = 0; s < count; s++ ) {
+    const svcsig &sig( sigs[ s % sigs.size() ] );
+    if ( sig.size() == bands ) {
+      std::copy( sig.targetReflectanceData(), sig.targetReflectanceData() + bands, in.begin() + s * bands );
+    }
+  }
+  start = std::chrono::steady_clock::now();
+  for ( int r = 0; r < repeats; r++ ) {
+    srf.apply( sigs[ 0 ].wavelength(), in.data(), out.data(), count );
+  }
+  std::cout << "matrix: " << count * repeats / svcbench_seconds( start ) << " spectra/s" << std::endl;
+
+  start = std::chrono::steady_clock::now();
+  for ( int r = 0; r < repeats; r++ ) {
+    srf.apply( sigs );
+  }
+  std::cout << "files:  " << sigs.size() * repeats / svcbench_seconds( start ) << " spectra/s" << std::endl;
+  return 0;
+}
+
+// -- -- search -- -- //
+std::vector<float> svcbench_library( const std::vector<svcsig> &sigs, const svcsiglibrary &files, const size_t &size )
+{
+  // each spectrum is a random mixture of the files, with a little noise
+  size_t bands( files.grid().size() );
+  std::vector<float> library( size * bands, 0.0f );
+  std::vector<float> abundance( sigs.size() );
+  srand( 1 );
+  for ( size_t s = 0; s < size; s++ ) {
+    float total( 0.0f );
+    for ( size_t f = 0; f < sigs.size(); f++ ) {
+      abundance[ f ] = -std::log( ( rand() + 1.0f ) / ( RAND_MAX + 1.0f ) );
+      total += abundance[ f ];
+    }
+    float *spectrum( &library[ s * bands ] );
+    for ( size_t f = 0; f < sigs.size(); f++ ) {
+      const float *row( files.row( f ) );
+      for ( size_t j = 0; j < bands; j++ ) {
+        spectrum[ j ] += abundance[ f ] / total * row[ j ];
+      }
+    }
+    for ( size_t j = 0; j < bands; j++ ) {
+      spectrum[ j ] += 0.1f * ( rand() / float( RAND_MAX ) - 0.5f );
+    }
+  }
+  return library;
+}
+
+int svcbench_search( const std::vector<std::string> &filenames, const size_t &size, const int &repeats )
+{
+  std::vector<svcsig> sigs( svcSigReadBatch( filenames ) );
+  svcsiglibrary files;
+  files.build( sigs, svcSigResampleGrid( 350, 2500, 1 ) );
+  std::vector<float> spectra( svcbench_library( sigs, files, size ) );
+  svcsiglibrary library;
+  std::chrono::steady_clock::time_point start( std::chrono::steady_clock::now() );
+  library.build( files.grid(), spectra.data(), size );
+  std::cout << "build:  " << svcbench_seconds( start ) * 1e3 << " ms for " << size << " spectra" << std::endl;
+
+  const char *names[] = { "angle", "euclidean", "pearson" };
+  double gb( double( sizeof( float ) ) * size * files.grid().size() / 1e9 );
+  for ( int metric = SVCSIG_LIBRARY_ANGLE; metric <= SVCSIG_LIBRARY_PEARSON; metric++ ) {
+    start = std::chrono::steady_clock::now();
+    for ( int r = 0; r < repeats; r++ ) {
+      library.search( sigs, 10, metric );
+    }
+    double seconds( svcbench_seconds( start ) / repeats );
+    std::cout << names[ metric ] << ": " << sigs.size() / seconds << " queries/s (" << gb / seconds << " GB/s of library)" << std::endl;
+  }
+  return 0;
+}
+
+// -- -- ann -- -- //
+int svcbench_ann( const std::vector<std::string> &filenames, const size_t &size )
+{
+  std::vector<svcsig> sigs( svcSigReadBatch( filenames ) );
+  svcsiglibrary files;
+  files.build( sigs, svcSigResampleGrid( 350, 2500, 1 ) );
+  // the library, then the queries
+  const size_t queries( 1000 );
+  const size_t k( 10 );
+  std::vector<float> spectra( svcbench_library( sigs, files, size + queries ) );
+  size_t bands( files.grid().size() );
+  svcsiglibrary library;
+  library.build( files.grid(), spectra.data(), size );
+  const float *query( spectra.data() + size * bands );
+
+  std::chrono::steady_clock::time_point start( std::chrono::steady_clock::now() );
+  std::vector< std::vector<svcsigmatch> > exact( library.search( query, queries, k ) );
+  std::cout << "exact:  " << queries / svcbench_seconds( start ) << " queries/s" << std::endl;
+
+  const std::string filename( "svcbench.ann" );
+  {
+    svcsigann built;
+    start = std::chrono::steady_clock::now();
+    built.build( library );
+    std::cout << "build:  " << svcbench_seconds( start ) << " s (" << built.dims() << " components, " << built.lists() << " lists)" << std::endl;
+    built.save( filename );
+  }
+  svcsigann ann;
+  start = std::chrono::steady_clock::now();
+  ann.load( filename );
+  std::cout << "load:   " << svcbench_seconds( start ) * 1e3 << " ms" << std::endl;
+
+  const size_t nprobes[] = { 1, 4, 16, 64 };
+  const size_t refines[] = { 0, 20, 100 };
+  for ( size_t p = 0; p < sizeof( nprobes ) / sizeof( nprobes[ 0 ] ); p++ ) {
+    for ( size_t r = 0; r < sizeof( refines ) / sizeof( refines[ 0 ] ); r++ ) {
+      start = std::chrono::steady_clock::now();
+      std::vector< std::vector<svcsigmatch> > found( ann.search( query, queries, k, nprobes[ p ], 0, refines[ r ] > 0 ? &library : NULL, refines[ r ] ) );
+      double seconds( svcbench_seconds( start ) );
+      size_t hits( 0 );
+      for ( size_t q = 0; q < queries; q++ ) {
+        for ( size_t i = 0; i < found[ q ].size(); i++ ) {
+          for ( size_t j = 0; j < exact[ q ].size(); j++ ) {
+            hits += found[ q ][ i ].id == exact[ q ][ j ].id ? 1 : 0;
+          }
+        }
+      }
+      std::cout << "nprobe " << nprobes[ p ] << ", refine " << refines[ r ] << ": recall@10 " << hits / double( queries * k ) << ", " << queries / seconds << " queries/s" << std::endl;
+    }
+  }
+  remove( filename.c_str() );
+  return 0;
+}
+
+// -- -- quantile -- -- //
+int svcbench_quantile( const std::vector<std::string> &filenames, const size_t &size )
+{
+  std::vector<svcsig> sigs( svcSigReadBatch( filenames ) );
+  svcsiglibrary files;
+  files.build( sigs, svcSigResampleGrid( 350, 2500, 1 ) );
+  std::vector<float> spectra( svcbench_library( sigs, files, size ) );
+  size_t bands( files.grid().size() );
+  const double q[] = { 0.05, 0.5, 0.95 };
+
+  // exact, from the matrix
+  std::chrono::steady_clock::time_point start( std::chrono::steady_clock::now() );
+  std::vector<float> exact( 3 * bands );
+  std::vector<float> column( size );
+  for ( size_t j = 0; j < bands; j++ ) {
+    for ( size_t s = 0; s < size; s++ ) {
+      column[ s ] = spectra[ s * bands + j ];
+    }
+    for ( size_t i = 0; i < 3; i++ ) {
+      std::vector<float>::iterator at( column.begin() + size_t( q[ i ] * ( size - 1 ) ) );
+      std::nth_element( column.begin(), at, column.end() );
+      exact[ i * bands + j ] = *at;
+    }
+  }
+  double seconds( svcbench_seconds( start ) );
+  std::cout << "exact:  " << size / seconds << " spectra/s, " << sizeof( float ) * size * bands / 1048576.0 << " MB" << std::endl;
+
+  // streamed through the sketches
+  start = std::chrono::steady_clock::now();
+  svcsigquantiles sketches( files.grid() );
+  for ( size_t s = 0; s < size; s++ ) {
+    sketches.add( &spectra[ s * bands ] );
+  }
+  std::vector<float> approximate[ 3 ];
+  for ( size_t i = 0; i < 3; i++ ) {
+    approximate[ i ] = sketches.quantile( q[ i ] );
+  }
+  seconds = svcbench_seconds( start );
+  size_t retained( 0 );
+  for ( size_t j = 0; j < bands; j++ ) {
+    retained += sketches.band( j ).retained();
+  }
+  std::cout << "sketch: " << size / seconds << " spectra/s, " << sizeof( float ) * retained / 1048576.0 << " MB" << std::endl;
+
+  // the rank errors of the sketch
+  for ( size_t i = 0; i < 3; i++ ) {
+    double worst( 0.0 ), mean( 0.0 );
+    for ( size_t j = 0; j < bands; j++ ) {
+      for ( size_t s = 0; s < size; s++ ) {
+        column[ s ] = spectra[ s * bands + j ];
+      }
+      std::sort( column.begin(), column.end() );
+      double below( std::lower_bound( column.begin(), column.end(), approximate[ i ][ j ] ) - column.begin() );
+      double through( std::upper_bound( column.begin(), column.end(), approximate[ i ][ j ] ) - column.begin() );
+      double target( q[ i ] * size );
+      double error( target < below ? below - target : ( target > through ? target - through : 0.0 ) );
+      worst = std::max( worst, error / size );
+      mean += error / size / bands;
+    }
+    std::cout << "q " << q[ i ] << ": rank error " << mean * 100 << "% mean, " << worst * 100 << "% worst (exact value error "
+      << std::fabs( approximate[ i ][ bands / 2 ] - exact[ i * bands + bands / 2 ] ) << " at band " << bands / 2 << ")" << std::endl;
+  }
+  return 0;
+}
+
+// -- -- savgol -- -- //
+int svcbench_savgol( const std::vector<std::string> &filenames, const int &repeats )
+{
+  std::vector<svcsig> sigs( svcSigReadBatch( filenames ) );
+  size_t total( 0 );
+  for ( size_t i = 0; i < sigs.size(); i++ ) {
+    total += sigs[ i ].size();
+  }
+  std::vector<float> out( total );
+  const size_t settings[][ 3 ] = { { 11, 2, 0 }, { 11, 2, 1 }, { 21, 3, 2 } };
+  for ( size_t k = 0; k < sizeof( settings ) / sizeof( settings[ 0 ] ); k++ ) {
+    const size_t window( settings[ k ][ 0 ] ), order( settings[ k ][ 1 ] ), derivative( settings[ k ][ 2 ] );
+
+    // the least a scalar filter does: a window sum per band, through copied
+    // vectors
+    std::chrono::steady_clock::time_point start( std::chrono::steady_clock::now() );
+    double checksum( 0.0 ); // printed, so the loop is not optimised away
+    for ( int r = 0; r < repeats; r++ ) {
+      for ( size_t i = 0; i < sigs.size(); i++ ) {
+        std::vector<float> reflectance( sigs[ i ].targetReflectance() );
+        std::vector<float> filtered( reflectance.size() );
+        for ( size_t j = 0; j < reflectance.size(); j++ ) {
+          float sum( 0.0f );
+          for ( size_t b = j >= window / 2 ? j - window / 2 : 0; b < std::min( reflectance.size(), j + window / 2 + 1 ); b++ ) {
+            sum += reflectance[ b ];
+          }
+          filtered[ j ] = sum;
+        }
+        checksum += filtered[ 0 ];
+      }
+    }
+    double copied( svcbench_seconds( start ) );
+
+    start = std::chrono::steady_clock::now();
+    for ( int r = 0; r < repeats; r++ ) {
+      svcSigSavgolBatch( sigs, out.data(), window, order, derivative, SVCSIG_SPECTRUM_TARGET_REFLECTANCE, 1 );
+    }
+    double kernel( svcbench_seconds( start ) );
+    std::cout << "window " << window << ", order " << order << ", derivative " << derivative << ": " << sigs.size() * repeats / kernel
+      << " spectra/s (" << copied / kernel << "x a copied scalar window sum, checksum " << checksum << ")" << std::endl;
+  }
+  return 0;
+}
+
+// -- -- indices -- -- //
+int svcbench_indices( const std::vector<std::string> &filenames, const int &repeats )
+{
+  std::vector<svcsig> sigs( svcSigReadBatch( filenames ) );
+  svcsigindices indices;
+  indices.standard();
+
+  // the usual script: a linear search of the wavelengths for the two bands
+  // of each index, then a normalised difference
+  std::chrono::steady_clock::time_point start( std::chrono::steady_clock::now() );
+  double checksum( 0.0 ); // printed, so the loop is not optimised away
+  for ( int r = 0; r < repeats; r++ ) {
+    for ( size_t i = 0; i < sigs.size(); i++ ) {
+      std::vector<float> wavelength( sigs[ i ].wavelength() );
+      std::vector<float> reflectance( sigs[ i ].targetReflectance() );
+      for ( size_t k = 0; k < indices.size(); k++ ) {
+        const double bands[ 2 ] = { 800.0, 670.0 };
+        float value[ 2 ];
+        for ( size_t b = 0; b < 2; b++ ) {
+          size_t best( 0 );
+          for ( size_t j = 1; j < wavelength.size(); j++ ) {
+            if ( std::fabs( wavelength[ j ] - bands[ b ] ) < std::fabs( wavelength[ best ] - bands[ b ] ) ) {
+              best = j;
+            }
+          }
+          value[ b ] = reflectance[ best ];
+        }
+        checksum += ( value[ 0 ] - value[ 1 ] ) / ( value[ 0 ] + value[ 1 ] );
+      }
+    }
+  }
+  double scalar( svcbench_seconds( start ) );
+
+  std::vector<float> out;
+  start = std::chrono::steady_clock::now();
+  for ( int r = 0; r < repeats; r++ ) {
+    out = indices.apply( sigs, SVCSIG_SPECTRUM_TARGET_REFLECTANCE, 1 );
+  }
+  double compiled( svcbench_seconds( start ) );
+  std::cout << indices.size() << " indices, " << indices.terms() << " terms: " << sigs.size() * repeats / compiled
+    << " spectra/s (" << scalar / compiled << "x linear searches, checksum " << checksum << ")" << std::endl;
+  return 0;
+}
+
+int main( int argc, char* argv[] )
+{
+  if ( argc < 3 ) {
+    svcbench_usage();
+    return argc == 1 ? 0 : 1;
+  }
+
+  std::string mode( argv[ 1 ] );
+  int processes( 1 );
+  int repeats( 100 );
+  int size( 20000 );
+  std::vector<std::string> filenames;
+  std::vector<std::string> tables;
+  for ( int i = 2; i < argc; i++ ) {
+    std::string arg( argv[ i ] );
+    if ( arg.compare( "-p" ) == 0 && i + 1 < argc ) {
+      processes = atoi( argv[ ++i ] );
+    }
+    else if ( arg.compare( "-n" ) == 0 && i + 1 < argc ) {
+      repeats = atoi( argv[ ++i ] );
+    }
+    else if ( arg.compare( "-l" ) == 0 && i + 1 < argc ) {
+      size = atoi( argv[ ++i ] );
+    }
+    else if ( arg.compare( "-s" ) == 0 && i + 1 < argc ) {
+      tables.push_back( argv[ ++i ] );
+    }
+    else {
+      filenames.push_back( arg );
+    }
+  }
+  if ( filenames.empty() || processes < 1 || repeats < 1 || size < 1 ) {
+    std::cerr << "invalid options" << std::endl;
+    std::cerr << std::endl;
+    svcbench_usage();
+    return 1;
+  }
+
+  try {
+    if ( mode.compare( "shm" ) == 0 ) {
+      return svcbench_shm( filenames, processes, repeats );
+    }
+    if ( mode.compare( "reflectance" ) == 0 ) {
+      return svcbench_reflectance( filenames, repeats );
+    }
+    if ( mode.compare( "srf" ) == 0 ) {
+      return svcbench_srf( filenames, tables, repeats );
+    }
+    if ( mode.compare( "search" ) == 0 ) {
+      return svcbench_search( filenames, size, repeats );
+    }
+    if ( mode.compare( "ann" ) == 0 ) {
+      return svcbench_ann( filenames, size );
+    }
+    if ( mode.compare( "quantile" ) == 0 ) {
+      return svcbench_quantile( filenames, size );
+    }
+    if ( mode.compare( "savgol" ) == 0 ) {
+      return svcbench_savgol( filenames, repeats );
+    }
+    if ( mode.compare( "indices" ) == 0 ) {
+      return svcbench_indices( filenames, repeats );
+    }
+  } catch ( const std::exception &e ) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+  std::cerr << "unknown benchmark '" << mode << "'" << std::endl;
+  svcbench_usage();
+  return 1;
+}
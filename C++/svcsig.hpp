@@ -6,6 +6,15 @@
  *
  * HISTORY:
  *    2013-08-04: Written by Paul Romanczyk (RIT)
+ *    2026-10-18: Added readers for streams and memory buffers
+ *    2026-10-18: Added transparent reading of gzip and zstd compressed files
+ *    2026-10-18: Added header only readers
+ *    2026-10-18: Added decoded acquisition times
+ *    2026-10-18: Added filtered reads that stop after a rejected header
+ *    2026-10-18: Added footprint()
+ *    2026-10-18: Added decoded positions and gps times
+ *    2026-10-18: Added in place access to the spectra
+ *    2026-10-18: Parse the data lines in place
  *
  * REFERENCES:
  *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
@@ -40,6 +49,8 @@
 #ifndef __svcsig_hpp_
 #define __svcsig_hpp_
 
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
@@ -48,9 +59,25 @@
 #include <vector>
 
 #include "svcsighelper.hpp"
+#include "svcsigcompress.hpp"
 #include "svcsigspectraheader.hpp"
 #include "svcsigcommonheader.hpp"
 
+class svcsig;
+
+/* Name: svcsigfilter
+ *
+ * Description: A test of the header of a sig file, used by the filtered
+ *    readers to skip the data of files that are not wanted
+ * Notes: accept() is called from the reading thread, so it must be thread
+ *    safe if files are read in parallel
+ */
+class svcsigfilter {
+public:
+  virtual ~svcsigfilter() {}
+  virtual bool accept( const svcsig &sig ) const = 0;
+};
+
 
 class svcsig {
 private:
@@ -187,6 +214,53 @@ private:
    * Notes:
    */
   void svcSigParseData( std::string &s, float &wl, float &refRad, float &tarRad, float &tarRef ) const;
+  
+  /* Name: bool svcSigReadFile( const std::string &filename, const bool &readData, const svcsigfilter *filter )
+   *
+   * Description:	Opens a (possibly compressed) sig file and parses it
+   * Arguments: const std::string &filename: the sig file
+   *            const bool &readData: false to stop after the header
+   *            const svcsigfilter *filter: the header test, or NULL
+   * Modifies: Everything
+   * Returns: bool, true if the header was read and accepted by filter
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Implimentation of read( filename ) and readHeader( filename )
+   */
+  bool svcSigReadFile( const std::string &filename, const bool &readData, const svcsigfilter *filter );
+  
+  /* Name: bool svcSigReadBuffer( const char *buffer, const size_t &size, const bool &readData, const svcsigfilter *filter )
+   *
+   * Description:	Parses a (possibly compressed) sig file that is in memory
+   * Arguments: const char *buffer: the start of the sig file
+   *            const size_t &size: the number of bytes in the sig file
+   *            const bool &readData: false to stop after the header
+   *            const svcsigfilter *filter: the header test, or NULL
+   * Modifies: Everything
+   * Returns: bool, true if the header was read and accepted by filter
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Implimentation of read( buffer, size ) and readHeader( buffer, size )
+   */
+  bool svcSigReadBuffer( const char *buffer, const size_t &size, const bool &readData, const svcsigfilter *filter );
+  
+  /* Name: bool svcSigReadStream( std::istream &input, const bool &readData, const svcsigfilter *filter )
+   *
+   * Description:	Parses a sig file from a stream
+   * Arguments: std::istream &input: the (uncompressed) sig file
+   *            const bool &readData: false to stop after the header
+   *            const svcsigfilter *filter: the header test, or NULL
+   * Modifies: Everything, std::istream &input
+   * Returns: bool, true if the header was read and accepted by filter
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Implimentation of all of the readers. If filter rejects the header
+   *    the data is not read.
+   */
+  bool svcSigReadStream( std::istream &input, const bool &readData, const svcsigfilter *filter );
 
 public:
   /* Name: svcsig::svcsig()
@@ -238,10 +312,117 @@ public:
    * Pre:
    * Post:
    * Exceptions: !!!! I need to fill this in !!!! 
-   * Notes: This is the "real" constructor
+   * Notes: This is the "real" constructor. gzip and zstd compressed files are
+   *    detected by their magic bytes and decompressed while they are parsed
+   *    (see svcsigcompress.hpp)
    */
   svcsig& read( const std::string &filename );
   
+  /* Name: svcsig& svcsig::read( std::istream &input )
+   *
+   * Description:	svcsig reader for an already open stream
+   * Arguments: std::istream &input: a stream positioned at the start of a SVC
+   *     sig file
+   * Modifies: Everything, std::istream &input
+   * Returns: *this
+   * Pre:
+   * Post: The data vectors only hold the data from input
+   * Exceptions:
+   * Notes: read( const std::string &filename ) is a wrapper around this
+   */
+  svcsig& read( std::istream &input );
+  
+  /* Name: svcsig& svcsig::read( const char *buffer, const size_t &size )
+   *
+   * Description:	svcsig reader for a sig file that is already in memory
+   * Arguments: const char *buffer: the start of the sig file
+   *            const size_t &size: the number of bytes in the sig file
+   * Modifies: Everything
+   * Returns: *this
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: The buffer is parsed in place (e.g. from a mmap'ed tar archive), it
+   *    is not copied. Compressed buffers are decompressed as they are parsed.
+   */
+  svcsig& read( const char *buffer, const size_t &size );
+  
+  /* Name: svcsig& svcsig::readHeader( const std::string &filename )
+   *
+   * Description:	svcsig header reader
+   * Arguments: const std::string &filename: the filename of the SVC sig file to
+   *     parse
+   * Modifies: Everything
+   * Returns: *this
+   * Pre:
+   * Post: The headers are set, the data vectors are empty
+   * Exceptions:
+   * Notes: Parsing stops at the "data=" line, so the data block is never read.
+   *    Use this when only the headers are needed (e.g. to catalogue or filter
+   *    files).
+   */
+  svcsig& readHeader( const std::string &filename );
+  
+  /* Name: svcsig& svcsig::readHeader( std::istream &input )
+   *
+   * Description:	svcsig header reader for an already open stream
+   * Arguments: std::istream &input: a stream positioned at the start of a SVC
+   *     sig file
+   * Modifies: Everything, std::istream &input
+   * Returns: *this
+   * Pre:
+   * Post: input is positioned at the start of the data block
+   * Exceptions:
+   * Notes:
+   */
+  svcsig& readHeader( std::istream &input );
+  
+  /* Name: svcsig& svcsig::readHeader( const char *buffer, const size_t &size )
+   *
+   * Description:	svcsig header reader for a sig file that is already in memory
+   * Arguments: const char *buffer: the start of the sig file
+   *            const size_t &size: the number of bytes in the sig file
+   * Modifies: Everything
+   * Returns: *this
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  svcsig& readHeader( const char *buffer, const size_t &size );
+  
+  /* Name: bool svcsig::read( const std::string &filename, const svcsigfilter &filter, const bool &readData )
+   *
+   * Description:	svcsig reader that only reads the data of wanted files
+   * Arguments: const std::string &filename: the (possibly compressed) file
+   *            const svcsigfilter &filter: the header test
+   *            const bool &readData: false to stop after the header anyway
+   * Modifies: Everything
+   * Returns: bool, true if the header was read and accepted by filter
+   * Pre:
+   * Post: If false is returned the data is empty
+   * Exceptions:
+   * Notes: The header is tested as soon as it is parsed, so rejected files are
+   *    never read past "data="
+   */
+  bool read( const std::string &filename, const svcsigfilter &filter, const bool &readData = true );
+  
+  /* Name: bool svcsig::read( const char *buffer, const size_t &size, const svcsigfilter &filter, const bool &readData )
+   *
+   * Description:	svcsig reader that only reads the data of wanted files
+   * Arguments: const char *buffer: the start of the sig file
+   *            const size_t &size: the number of bytes in the sig file
+   *            const svcsigfilter &filter: the header test
+   *            const bool &readData: false to stop after the header anyway
+   * Modifies: Everything
+   * Returns: bool, true if the header was read and accepted by filter
+   * Pre:
+   * Post: If false is returned the data is empty
+   * Exceptions:
+   * Notes:
+   */
+  bool read( const char *buffer, const size_t &size, const svcsigfilter &filter, const bool &readData = true );
+  
   /* Name: void svcsig::write( const std::string &filename ) const
    *
    * Description:	svcsig writer
@@ -349,6 +530,27 @@ public:
    */
   std::vector<float> targetReflectance() const;
   
+  /* Name: spectra in place
+   *
+   * Description: return the spectra stored in the svcsig (size() values each)
+   *    without copying them. The radiances and reflectance may be corrected
+   *    through the non-const versions.
+   * Arguments:
+   * Modifies:
+   * Returns: float *, NULL if there is no data
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: The pointers are invalidated by read()
+   */
+  const float * wavelengthData() const;
+  const float * referenceRadianceData() const;
+  float * referenceRadianceData();
+  const float * targetRadianceData() const;
+  float * targetRadianceData();
+  const float * targetReflectanceData() const;
+  float * targetReflectanceData();
+  
   // from the common header
   
   /* Name: std::string svcsig::name() const
@@ -1172,6 +1374,20 @@ public:
    */
   std::string referenceTime() const;
   
+  /* Name: int64_t svcsig::referenceEpochTime() const
+   *
+   * Description: Returns the time of the reference scan aquisition in seconds since
+   *    1970-01-01 00:00:00 (in the instrument's clock)
+   * Arguments:
+   * Modifies:
+   * Returns: int64_t, or SVCSIG_TIME_INVALID if the time could not be decoded
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: The time is decoded once, when the file is read
+   */
+  int64_t referenceEpochTime() const;
+  
   /* Name: std::string svcsig::referenceLongitude() const
    *
    * Description: Returns the longitude of the reference scan aquisition in
@@ -1256,6 +1472,24 @@ public:
    */
   float referenceDecimalGpstime() const;
   
+  /* Name: decoded position and gps time of the reference scan
+   *
+   * Description: referenceDecodedLongitude() and referenceDecodedLatitude() return
+   *    the position of the reference scan aquisition in degrees,
+   *    referenceDecodedGpstime() its gps time in hours
+   * Arguments:
+   * Modifies:
+   * Returns: double, NAN if the field is missing or invalid
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: The fields are decoded once, when the file is read. Unlike the
+   *    decimal versions, these do not throw.
+   */
+  double referenceDecodedLongitude() const;
+  double referenceDecodedLatitude() const;
+  double referenceDecodedGpstime() const;
+  
   /* Name: unsigned int svcsig::referenceMemorySlot() const
    *
    * Description: Returns the memory slot of the reference scan
@@ -1803,6 +2037,20 @@ public:
    */
   std::string targetTime() const;
   
+  /* Name: int64_t svcsig::targetEpochTime() const
+   *
+   * Description: Returns the time of the target scan aquisition in seconds since
+   *    1970-01-01 00:00:00 (in the instrument's clock)
+   * Arguments:
+   * Modifies:
+   * Returns: int64_t, or SVCSIG_TIME_INVALID if the time could not be decoded
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: The time is decoded once, when the file is read
+   */
+  int64_t targetEpochTime() const;
+  
   /* Name: std::string svcsig::targetLongitude() const
    *
    * Description: Returns the longitude of the target scan aquisition in
@@ -1887,6 +2135,24 @@ public:
    */
   float targetDecimalGpstime() const;
   
+  /* Name: decoded position and gps time of the target scan
+   *
+   * Description: targetDecodedLongitude() and targetDecodedLatitude() return
+   *    the position of the target scan aquisition in degrees,
+   *    targetDecodedGpstime() its gps time in hours
+   * Arguments:
+   * Modifies:
+   * Returns: double, NAN if the field is missing or invalid
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: The fields are decoded once, when the file is read. Unlike the
+   *    decimal versions, these do not throw.
+   */
+  double targetDecodedLongitude() const;
+  double targetDecodedLatitude() const;
+  double targetDecodedGpstime() const;
+  
   /* Name: unsigned int svcsig::targetMemorySlot() const
    *
    * Description: Returns the memory slot of the target scan
@@ -1990,6 +2256,22 @@ public:
    * Notes:
    */
   void displayData() const;
+  
+  /* Name: size_t svcsig::footprint() const
+   *
+   * Description: Returns the memory used by the object, including the
+   *    capacity of its vectors and strings
+   * Arguments:
+   * Modifies:
+   * Returns: size_t bytes
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Used to budget caches
+   */
+  size_t footprint() const;
+  
+  friend class svcsigquery;
 };
 
 
@@ -2126,14 +2408,22 @@ void svcsig::svcSigParseWhitespace( std::string &s, std::string &p ) const
 void svcsig::svcSigParseData( std::string &s, float &wl, float &refRad, float &tarRad, float &tarRef ) const
 {
   try {
-    std::string p;
-    svcSigParseWhitespace( s, p );
-    wl = atof( p.c_str() );
-    svcSigParseWhitespace( s, p );
-    refRad = atof( p.c_str() );
-    svcSigParseWhitespace( s, p );
-    tarRad = atof( p.c_str() );
-    tarRef = atof( s.c_str() );
+    // parse in place: the same fields as svcSigParseWhitespace gives, without
+    // copying the rest of the line for each one
+    float *values[ 3 ] = { &wl, &refRad, &tarRad };
+    const char *p( s.c_str() );
+    for ( int i = 0; i < 3; i++ ) {
+      const char *space( strpbrk( p, " \t" ) );
+      if ( space == NULL ) {
+        std::string message( "in svcSigParseData.\n" );
+        message += "\tNo space in string '" + std::string( p ) + "'";
+        throw invalidSVCsigHeader( message );
+      }
+      *values[ i ] = ( space == p ) ? 0 : svcSigParseDecimal( p );
+      p = space + 1;
+      p += strspn( p, " \t\n\r" );
+    }
+    tarRef = svcSigParseDecimal( p );
     s.clear();
   } catch ( invalidSVCsigHeader &e ) {
     std::cerr << "In svcsig::svcSigParseData" << std::endl;
@@ -2173,18 +2463,125 @@ svcsig::~svcsig()
 
 // -- -- IO -- -- //
 svcsig& svcsig::read( const std::string &filename )
+{
+  svcSigReadFile( filename, true, NULL );
+  return *this;
+}
+
+svcsig& svcsig::read( std::istream &input )
+{
+  svcSigReadStream( input, true, NULL );
+  return *this;
+}
+
+svcsig& svcsig::read( const char *buffer, const size_t &size )
+{
+  svcSigReadBuffer( buffer, size, true, NULL );
+  return *this;
+}
+
+svcsig& svcsig::readHeader( const std::string &filename )
+{
+  svcSigReadFile( filename, false, NULL );
+  return *this;
+}
+
+svcsig& svcsig::readHeader( std::istream &input )
+{
+  svcSigReadStream( input, false, NULL );
+  return *this;
+}
+
+svcsig& svcsig::readHeader( const char *buffer, const size_t &size )
+{
+  svcSigReadBuffer( buffer, size, false, NULL );
+  return *this;
+}
+
+bool svcsig::read( const std::string &filename, const svcsigfilter &filter, const bool &readData )
+{
+  return svcSigReadFile( filename, readData, &filter );
+}
+
+bool svcsig::read( const char *buffer, const size_t &size, const svcsigfilter &filter, const bool &readData )
+{
+  return svcSigReadBuffer( buffer, size, readData, &filter );
+}
+
+bool svcsig::svcSigReadFile( const std::string &filename, const bool &readData, const svcsigfilter *filter )
 {
   std::ifstream input;
-  input.open( filename.c_str() );
-  
-  std::string l;
+  input.open( filename.c_str(), std::ios::in | std::ios::binary );
   
+  std::streambuf *decompressed( NULL );
+  bool accepted;
   
   try {
     if ( !input.is_open() ) {
       throw notSvcSigFile( "File '" + filename + "' does not exist." );
     }
     
+    // check for compression, then go back to the start
+    char magic[ 4 ];
+    input.read( magic, 4 );
+    size_t n( input.gcount() );
+    input.clear();
+    input.seekg( 0 );
+    decompressed = svcSigDecompressBuf( input.rdbuf(), magic, n );
+  } catch ( notSvcSigFile &e ) {
+    std::cerr << e.what() << std::endl;
+    std::cerr << "Failed to complete read" << std::endl;
+    return false;
+  }
+  
+  if ( decompressed ) {
+    std::istream decompressedInput( decompressed );
+    accepted = svcSigReadStream( decompressedInput, readData, filter );
+    delete decompressed;
+  }
+  else {
+    accepted = svcSigReadStream( input, readData, filter );
+  }
+  input.close();
+  return accepted;
+}
+
+bool svcsig::svcSigReadBuffer( const char *buffer, const size_t &size, const bool &readData, const svcsigfilter *filter )
+{
+  svcsigmembuf buf( buffer, size );
+  
+  std::streambuf *decompressed( NULL );
+  bool accepted;
+  try {
+    decompressed = svcSigDecompressBuf( &buf, buffer, size );
+  } catch ( notSvcSigFile &e ) {
+    std::cerr << e.what() << std::endl;
+    std::cerr << "Failed to complete read" << std::endl;
+    return false;
+  }
+  
+  if ( decompressed ) {
+    std::istream input( decompressed );
+    accepted = svcSigReadStream( input, readData, filter );
+    delete decompressed;
+  }
+  else {
+    std::istream input( &buf );
+    accepted = svcSigReadStream( input, readData, filter );
+  }
+  return accepted;
+}
+
+bool svcsig::svcSigReadStream( std::istream &input, const bool &readData, const svcsigfilter *filter )
+{
+  std::string l;
+  
+  _wavelength.clear();
+  _referenceRadiance.clear();
+  _targetRadiance.clear();
+  _targetReflectance.clear();
+  
+  try {
     // I need i/o error checking & Exceptions here
     std::string line;
     std::string part;
@@ -2428,10 +2825,17 @@ svcsig& svcsig::read( const std::string &filename )
     
     
     
+    // test the header before reading the data
+    if ( filter != NULL && !filter->accept( *this ) ) {
+      return false;
+    }
+    
     // read the data
     float wl, refRad, tarRad, tarRef;
-    getline( input, line );
-    while ( input.good() ) {
+    if ( readData ) {
+      getline( input, line );
+    }
+    while ( readData && input.good() ) {
       svcSigParseData( line, wl, refRad, tarRad, tarRef );
       _wavelength.push_back( wl );
       _referenceRadiance.push_back( refRad );
@@ -2444,19 +2848,14 @@ svcsig& svcsig::read( const std::string &filename )
   } catch ( notSvcSigFile &e ) {
     std::cerr << e.what() << std::endl;
     std::cerr << "Failed to complete read" << std::endl;
-    std::cerr << e.what() << std::endl;
-    input.close();
-    return *this;
+    return false;
   } catch ( invalidSVCsigHeader &e ) {
     std::cerr << e.what() << std::endl;
     std::cerr << "Failed to complete read" << std::endl;
-    std::cerr << e.what() << std::endl;
-    input.close();
-    return *this;
+    return false;
   }
   
-  input.close();
-  return *this;
+  return true;
 }
 
 void svcsig::write( const std::string &filename ) const
@@ -2640,6 +3039,41 @@ std::vector<float> svcsig::targetReflectance() const
   return _targetReflectance;
 }
 
+const float * svcsig::wavelengthData() const
+{
+  return _wavelength.empty() ? NULL : _wavelength.data();
+}
+
+const float * svcsig::referenceRadianceData() const
+{
+  return _referenceRadiance.empty() ? NULL : _referenceRadiance.data();
+}
+
+float * svcsig::referenceRadianceData()
+{
+  return _referenceRadiance.empty() ? NULL : _referenceRadiance.data();
+}
+
+const float * svcsig::targetRadianceData() const
+{
+  return _targetRadiance.empty() ? NULL : _targetRadiance.data();
+}
+
+float * svcsig::targetRadianceData()
+{
+  return _targetRadiance.empty() ? NULL : _targetRadiance.data();
+}
+
+const float * svcsig::targetReflectanceData() const
+{
+  return _targetReflectance.empty() ? NULL : _targetReflectance.data();
+}
+
+float * svcsig::targetReflectanceData()
+{
+  return _targetReflectance.empty() ? NULL : _targetReflectance.data();
+}
+
 std::string svcsig::name() const
 {
   return _commonHeader.name();
@@ -2935,6 +3369,11 @@ std::string svcsig::referenceTime() const
   return _referenceHeader.time();
 }
 
+int64_t svcsig::referenceEpochTime() const
+{
+  return _referenceHeader.epochTime();
+}
+
 std::string svcsig::referenceLongitude() const
 {
   return _referenceHeader.longitude();
@@ -2973,6 +3412,21 @@ float svcsig::referenceDecimalGpstime() const
   return _referenceHeader.decimalGpstime();
 }
 
+double svcsig::referenceDecodedLongitude() const
+{
+  return _referenceHeader.decodedLongitude();
+}
+
+double svcsig::referenceDecodedLatitude() const
+{
+  return _referenceHeader.decodedLatitude();
+}
+
+double svcsig::referenceDecodedGpstime() const
+{
+  return _referenceHeader.decodedGpstime();
+}
+
 unsigned int svcsig::referenceMemorySlot() const
 {
   return _referenceHeader.memorySlot();
@@ -3168,6 +3622,11 @@ std::string svcsig::targetTime() const
   return _targetHeader.time();
 }
 
+int64_t svcsig::targetEpochTime() const
+{
+  return _targetHeader.epochTime();
+}
+
 std::string svcsig::targetLongitude() const
 {
   return _targetHeader.longitude();
@@ -3206,6 +3665,21 @@ float svcsig::targetDecimalGpstime() const
   return _targetHeader.decimalGpstime();
 }
 
+double svcsig::targetDecodedLongitude() const
+{
+  return _targetHeader.decodedLongitude();
+}
+
+double svcsig::targetDecodedLatitude() const
+{
+  return _targetHeader.decodedLatitude();
+}
+
+double svcsig::targetDecodedGpstime() const
+{
+  return _targetHeader.decodedGpstime();
+}
+
 unsigned int svcsig::targetMemorySlot() const
 {
   return _targetHeader.memorySlot();
@@ -3264,4 +3738,31 @@ void svcsig::displayData() const
   }
 }
 
+// -- -- Memory -- -- //
+size_t svcsig::footprint() const
+{
+  size_t bytes( sizeof( svcsig ) );
+  bytes += ( _wavelength.capacity() + _referenceRadiance.capacity() + _targetRadiance.capacity() + _targetReflectance.capacity() ) * sizeof( float );
+  
+  bytes += svcSigStringFootprint( _commonHeader._name );
+  bytes += svcSigStringFootprint( _commonHeader._instrumentModelNumber );
+  bytes += svcSigStringFootprint( _commonHeader._instrumentExtendedSerialNumber );
+  bytes += svcSigStringFootprint( _commonHeader._instrumentCommonName );
+  bytes += svcSigStringFootprint( _commonHeader._comm );
+  bytes += svcSigStringFootprint( _commonHeader._factorsComment );
+  
+  const svcsigspectraheader *spectra[ 2 ] = { &_referenceHeader, &_targetHeader };
+  for ( int i = 0; i < 2; i++ ) {
+    bytes += svcSigStringFootprint( spectra[ i ]->_scanMethod );
+    bytes += svcSigStringFootprint( spectra[ i ]->_scanSettings );
+    bytes += svcSigStringFootprint( spectra[ i ]->_optic );
+    bytes += svcSigStringFootprint( spectra[ i ]->_units );
+    bytes += svcSigStringFootprint( spectra[ i ]->_time );
+    bytes += svcSigStringFootprint( spectra[ i ]->_longitude );
+    bytes += svcSigStringFootprint( spectra[ i ]->_latitude );
+    bytes += svcSigStringFootprint( spectra[ i ]->_gpstime );
+  }
+  return bytes;
+}
+
 #endif //__svcsig_h_
\ No newline at end of file
@@ -0,0 +1,870 @@
+/*******************************************************************************
+ * svcsigann.hpp
+ *
+ * DESCRIPTION:
+ *    Provides header and implimentation for the svcsigann class, an
+ *    approximate nearest neighbour index over the spectra of a svcsiglibrary
+ *    for libraries of millions of spectra or thousands of queries per second.
+ *
+ *    Spectra are normalised for the metric (to unit length for the spectral
+ *    angle, and centered as well for Pearson correlation), so that Euclidean
+ *    distance ranks them, and reduced to a few principal components. The
+ *    reduced spectra are grouped into inverted lists around k-means
+ *    centroids (IVF). A query scans the lists of its nprobe closest
+ *    centroids, optionally re-ranking the best candidates exactly against the
+ *    library. Raising nprobe or the number re-ranked trades speed for recall.
+ *
+ *    An index is saved to one file, which is memory mapped when it is
+ *    loaded, so large indices open instantly and share pages between
+ *    processes.
+ *
+ *    Build with -pthread.
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *    2026-10-18: search() checks the library size; load() checks the metric
+ *    2026-10-18: Zero spectra are never matched (version 2); load() checks
+ *        the sizes and ids
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *   H. Jegou, M. Douze, C. Schmid, "Product Quantization for Nearest Neighbor
+ *     Search", IEEE TPAMI 33(1), 2011 (inverted file indices)
+ *   N. Halko, P. G. Martinsson, J. A. Tropp, "Finding Structure with
+ *     Randomness", SIAM Review 53(2), 2011 (randomized subspace iteration)
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsigann_hpp_
+#define __svcsigann_hpp_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <queue>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "svcsighelper.hpp"
+#include "svcsig.hpp"
+#include "svcsigbatch.hpp"
+#include "svcsiglibrary.hpp"
+
+#define SVCSIG_ANN_MAGIC "SVCSIGA"
+#define SVCSIG_ANN_VERSION 2
+
+// the default number of principal components
+#define SVCSIG_ANN_DIMS 32
+// the default number of lists scanned per query
+#define SVCSIG_ANN_NPROBE 8
+// the most spectra used to find the principal components
+#define SVCSIG_ANN_SAMPLE 8192
+// subspace iterations used to find the principal components
+#define SVCSIG_ANN_POWER 6
+// spectra per list used to train the centroids, and k-means iterations
+#define SVCSIG_ANN_TRAIN 64
+#define SVCSIG_ANN_ITERATIONS 10
+// the alignment (bytes) of each array in a saved index
+#define SVCSIG_ANN_ALIGN 64
+
+
+// the file header of an index, followed by the arrays listed in svcsigann
+struct svcsigannheader {
+  char magic[ 8 ];
+  uint32_t version;
+  uint32_t metric;
+  uint64_t count;
+  uint32_t bands;
+  uint32_t dims;
+  uint32_t lists;
+  uint32_t reserved;
+};
+
+
+class svcsigann {
+private:
+  // the arrays built by build()
+  std::vector<float> _gridData;
+  std::vector<float> _meanData;
+  std::vector<float> _componentsData;
+  std::vector<float> _centroidsData;
+  std::vector<uint64_t> _offsetsData;
+  std::vector<uint32_t> _idsData;
+  std::vector<float> _vectorsData;
+  std::vector<float> _normsData;
+  
+  // the current arrays, either the above, or a mapping of the file given to
+  // load()
+  const float *_grid; // bands wavelengths
+  const float *_mean; // bands, of the normalised spectra
+  const float *_components; // dims rows of bands
+  const float *_centroids; // lists rows of dims
+  const uint64_t *_offsets; // lists + 1, list l is [_offsets[ l ], _offsets[ l + 1 ])
+  const uint32_t *_ids; // count library rows, in list order
+  const float *_vectors; // count rows of dims, in list order
+  const float *_norms; // count squared norms of _vectors, NAN for a zero spectrum
+  size_t _count;
+  size_t _bands;
+  size_t _dims;
+  size_t _lists;
+  int _metric;
+  void *_map;
+  size_t _mapSize;
+  
+  // indices are not copyable (they may own a mapping)
+  svcsigann( const svcsigann &other );
+  svcsigann& operator=( const svcsigann &other );
+  
+  /* Name: void svcSigAnnUse()
+   *
+   * Description: Points the current arrays at the built arrays, releasing any
+   *    mapping
+   */
+  void svcSigAnnUse();
+  
+  /* Name: size_t svcSigAnnLayout( size_t offsets[ 9 ] ) const
+   *
+   * Description: The byte offsets of the arrays in a saved index, and its size
+   */
+  size_t svcSigAnnLayout( size_t offsets[ 9 ] ) const;
+  
+  /* Name: void svcSigAnnSizes( size_t sizes[ 8 ] ) const
+   *
+   * Description: The sizes (bytes) of the arrays in a saved index
+   */
+  void svcSigAnnSizes( size_t sizes[ 8 ] ) const;
+  
+  /* Name: void svcSigAnnNormalise( const float *spectrum, float *out ) const
+   *
+   * Description: Normalises a spectrum for the metric
+   */
+  void svcSigAnnNormalise( const float *spectrum, float *out ) const;
+  
+  /* Name: void svcSigAnnProject( const float *spectrum, float *out ) const
+   *
+   * Description: Reduces a spectrum on the grid to its principal components
+   */
+  void svcSigAnnProject( const float *spectrum, float *out ) const;
+  
+  /* Name: bool svcSigAnnZero( const float *spectrum ) const
+   *
+   * Description: true if the metric is undefined for a spectrum on the grid,
+   *    as svcsiglibrary has it: a zero spectrum, or a constant one for
+   *    Pearson correlation
+   */
+  bool svcSigAnnZero( const float *spectrum ) const;
+  
+  /* Name: double svcSigAnnMetric( const double &squared ) const
+   *
+   * Description: Converts a squared distance between normalised spectra to
+   *    the distance of the metric
+   */
+  double svcSigAnnMetric( const double &squared ) const;
+
+public:
+  /* Name: svcsigann()
+   *
+   * Description: Constructs an empty index
+   */
+  svcsigann();
+  
+  /* Name: ~svcsigann()
+   *
+   * Description: Releases any mapping
+   */
+  ~svcsigann();
+  
+  /* Name: svcsigann& build( const svcsiglibrary &library, const int &metric, const size_t &dims, const size_t &lists, const unsigned int &threads )
+   *
+   * Description: Builds an index over a library
+   * Arguments: const svcsiglibrary &library: the spectra; ids are its rows
+   *            const int &metric: SVCSIG_LIBRARY_ANGLE,
+   *                SVCSIG_LIBRARY_EUCLIDEAN or SVCSIG_LIBRARY_PEARSON
+   *            const size_t &dims: the number of principal components
+   *            const size_t &lists: the number of inverted lists, or 0 for
+   *                about 4 sqrt( library.size() )
+   *            const unsigned int &threads: the number of threads (0 for one
+   *                per core)
+   * Modifies: Everything
+   * Returns: *this
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigAnn if the metric is unknown or the library is
+   *    empty
+   * Notes: The components and centroids are trained on a sample of the
+   *    library, with a fixed seed, so builds are repeatable
+   */
+  svcsigann& build( const svcsiglibrary &library, const int &metric = SVCSIG_LIBRARY_ANGLE, const size_t &dims = SVCSIG_ANN_DIMS, const size_t &lists = 0, const unsigned int &threads = 0 );
+  
+  /* Name: svcsigann& load( const std::string &filename )
+   *
+   * Description: Maps an index saved by save()
+   * Arguments: const std::string &filename: the index file
+   * Modifies: Everything
+   * Returns: *this
+   * Pre:
+   * Post: The index is empty if it failed
+   * Exceptions: invalidSVCsigAnn if the file is not a valid index, including
+   *    one with an unknown metric, sizes that do not match the file, or list
+   *    offsets or ids out of range
+   * Notes: The file is mapped read only, and only the list offsets and ids
+   *    are read (to check them)
+   */
+  svcsigann& load( const std::string &filename );
+  
+  /* Name: void save( const std::string &filename ) const
+   *
+   * Description: Saves the index
+   * Arguments: const std::string &filename: the index file
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigAnn if the file could not be written
+   * Notes: Written to filename.tmp and renamed over filename
+   */
+  void save( const std::string &filename ) const;
+  
+  /* Name: getters
+   *
+   * Description: size() is the number of spectra, metric() the metric the
+   *    index was built for, grid() the wavelengths of the library, dims() the
+   *    number of principal components and lists() the number of inverted lists
+   */
+  size_t size() const;
+  int metric() const;
+  std::vector<float> grid() const;
+  size_t dims() const;
+  size_t lists() const;
+  
+  /* Name: std::vector< std::vector<svcsigmatch> > search( const float *queries, const size_t &count, const size_t &k, const size_t &nprobe, const unsigned int &threads, const svcsiglibrary *library, const size_t &refine ) const
+   *
+   * Description: Finds approximately the k closest library spectra to each
+   *    query
+   * Arguments: const float *queries: count rows of grid().size() values
+   *            const size_t &count: the number of queries
+   *            const size_t &k: the number of matches per query
+   *            const size_t &nprobe: the number of lists scanned
+   *            const unsigned int &threads: the number of threads (0 for one
+   *                per core)
+   *            const svcsiglibrary *library: the library the index was built
+   *                from, to re-rank exactly, or NULL
+   *            const size_t &refine: the number of candidates re-ranked
+   *                exactly (at least k) when library is given
+   * Modifies:
+   * Returns: the matches of each query, closest first
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigAnn if the library is on another grid or does
+   *    not have as many spectra as the index
+   * Notes: Without a library the distances are those of the reduced spectra.
+   *    Zero spectra (see svcsiglibrary) never match, and a zero query has no
+   *    matches.
+   */
+  std::vector< std::vector<svcsigmatch> > search( const float *queries, const size_t &count, const size_t &k, const size_t &nprobe = SVCSIG_ANN_NPROBE, const unsigned int &threads = 0, const svcsiglibrary *library = NULL, const size_t &refine = 0 ) const;
+  
+  /* Name: std::vector< std::vector<svcsigmatch> > search( const std::vector<svcsig> &queries, const size_t &k, const size_t &nprobe, const unsigned int &threads, const svcsiglibrary *library, const size_t &refine ) const
+   *
+   * Description: Finds approximately the k closest library spectra to the
+   *    target reflectance of each sig file, resampling them onto the library
+   *    grid if they are on another grid
+   */
+  std::vector< std::vector<svcsigmatch> > search( const std::vector<svcsig> &queries, const size_t &k, const size_t &nprobe = SVCSIG_ANN_NPROBE, const unsigned int &threads = 0, const svcsiglibrary *library = NULL, const size_t &refine = 0 ) const;
+};
+
+
+// --- --- Implimentation --- --- //
+
+// -- -- Constructors -- -- //
+svcsigann::svcsigann()
+{
+  _map = NULL;
+  _mapSize = 0;
+  _metric = SVCSIG_LIBRARY_ANGLE;
+  _count = 0;
+  _bands = 0;
+  _dims = 0;
+  _lists = 0;
+  _offsetsData.assign( 1, 0 );
+  svcSigAnnUse();
+}
+
+// -- -- Destructor -- -- //
+svcsigann::~svcsigann()
+{
+  if ( _map != NULL ) {
+    munmap( _map, _mapSize );
+  }
+}
+
+// -- -- Build -- -- //
+svcsigann& svcsigann::build( const svcsiglibrary &library, const int &metric, const size_t &dims, const size_t &lists, const unsigned int &threads )
+{
+  if ( metric != SVCSIG_LIBRARY_ANGLE && metric != SVCSIG_LIBRARY_EUCLIDEAN && metric != SVCSIG_LIBRARY_PEARSON ) {
+    throw invalidSVCsigAnn( "unknown metric" );
+  }
+  if ( library.size() == 0 ) {
+    throw invalidSVCsigAnn( "the library is empty" );
+  }
+  _metric = metric;
+  _count = library.size();
+  _bands = library.grid().size();
+  _dims = std::min( std::max( dims, size_t( 1 ) ), _bands );
+  _lists = lists > 0 ? lists : size_t( 4.0 * std::sqrt( double( _count ) ) );
+  _lists = std::max( size_t( 1 ), std::min( _lists, _count ) );
+  _gridData = library.grid();
+  unsigned int nThreads( svcSigThreads( threads ) );
+  std::mt19937 random( 1 );
+  
+  // a sample of the normalised spectra, centered
+  size_t samples( std::min( _count, size_t( SVCSIG_ANN_SAMPLE ) ) );
+  std::vector<float> sample( samples * _bands );
+  svcSigParallelFor( samples, nThreads, [&]( size_t s, unsigned int ) {
+    svcSigAnnNormalise( library.row( s * _count / samples ), &sample[ s * _bands ] );
+  } );
+  _meanData.assign( _bands, 0.0f );
+  std::vector<double> mean( _bands, 0.0 );
+  for ( size_t s = 0; s < samples; s++ ) {
+    for ( size_t j = 0; j < _bands; j++ ) {
+      mean[ j ] += sample[ s * _bands + j ];
+    }
+  }
+  for ( size_t j = 0; j < _bands; j++ ) {
+    _meanData[ j ] = mean[ j ] / samples;
+  }
+  std::vector<float> transposed( _bands * samples );
+  for ( size_t s = 0; s < samples; s++ ) {
+    for ( size_t j = 0; j < _bands; j++ ) {
+      sample[ s * _bands + j ] -= _meanData[ j ];
+      transposed[ j * samples + s ] = sample[ s * _bands + j ];
+    }
+  }
+  
+  // the principal components, by subspace iteration from a random start:
+  // Q = orth( ( X Q' )' X ), with both products as inner products of
+  // contiguous rows
+  std::normal_distribution<float> normal;
+  _componentsData.resize( _dims * _bands );
+  for ( size_t j = 0; j < _componentsData.size(); j++ ) {
+    _componentsData[ j ] = normal( random );
+  }
+  std::vector<float> scores( _dims * samples );
+  for ( int iteration = 0; iteration <= SVCSIG_ANN_POWER; iteration++ ) {
+    // orthonormalise the rows (modified Gram-Schmidt)
+    for ( size_t d = 0; d < _dims; d++ ) {
+      float *q( &_componentsData[ d * _bands ] );
+      for ( size_t e = 0; e < d; e++ ) {
+        const float *p( &_componentsData[ e * _bands ] );
+        float dot( svcSigDot( q, p, _bands ) );
+        for ( size_t j = 0; j < _bands; j++ ) {
+          q[ j ] -= dot * p[ j ];
+        }
+      }
+      float norm( std::sqrt( svcSigDot( q, q, _bands ) ) );
+      for ( size_t j = 0; j < _bands; j++ ) {
+        q[ j ] = norm > 0.0f ? q[ j ] / norm : 0.0f;
+      }
+    }
+    if ( iteration == SVCSIG_ANN_POWER ) {
+      break;
+    }
+    svcSigParallelFor( samples, nThreads, [&]( size_t s, unsigned int ) {
+      for ( size_t d = 0; d < _dims; d++ ) {
+        scores[ d * samples + s ] = svcSigDot( &sample[ s * _bands ], &_componentsData[ d * _bands ], _bands );
+      }
+    } );
+    svcSigParallelFor( _bands, nThreads, [&]( size_t j, unsigned int ) {
+      for ( size_t d = 0; d < _dims; d++ ) {
+        _componentsData[ d * _bands + j ] = svcSigDot( &scores[ d * samples ], &transposed[ j * samples ], samples );
+      }
+    } );
+  }
+  std::vector<float>().swap( sample );
+  std::vector<float>().swap( transposed );
+  
+  // reduce every spectrum
+  _grid = _gridData.data();
+  _mean = _meanData.data();
+  _components = _componentsData.data();
+  std::vector<float> reduced( _count * _dims );
+  std::vector<char> zero( _count );
+  svcSigParallelFor( _count, nThreads, [&]( size_t i, unsigned int ) {
+    svcSigAnnProject( library.row( i ), &reduced[ i * _dims ] );
+    zero[ i ] = svcSigAnnZero( library.row( i ) );
+  } );
+  
+  // k-means on a sample of the reduced spectra
+  std::vector<size_t> order( _count );
+  for ( size_t i = 0; i < _count; i++ ) {
+    order[ i ] = i;
+  }
+  std::shuffle( order.begin(), order.end(), random );
+  size_t trained( std::min( _count, _lists * SVCSIG_ANN_TRAIN ) );
+  _centroidsData.resize( _lists * _dims );
+  for ( size_t l = 0; l < _lists; l++ ) {
+    std::copy( &reduced[ order[ l ] * _dims ], &reduced[ order[ l ] * _dims ] + _dims, &_centroidsData[ l * _dims ] );
+  }
+  std::vector<float> centroidNorms( _lists );
+  std::vector<uint32_t> assigned( _count );
+  auto nearest = [&]( const float *v ) {
+    // |v - c|^2 less the constant |v|^2
+    uint32_t best( 0 );
+    float bestDistance( INFINITY );
+    for ( size_t l = 0; l < _lists; l++ ) {
+      float distance( centroidNorms[ l ] - 2.0f * svcSigDot( v, &_centroidsData[ l * _dims ], _dims ) );
+      if ( distance < bestDistance ) {
+        bestDistance = distance;
+        best = l;
+      }
+    }
+    return best;
+  };
+  for ( int iteration = 0; iteration <= SVCSIG_ANN_ITERATIONS; iteration++ ) {
+    for ( size_t l = 0; l < _lists; l++ ) {
+      centroidNorms[ l ] = svcSigDot( &_centroidsData[ l * _dims ], &_centroidsData[ l * _dims ], _dims );
+    }
+    if ( iteration == SVCSIG_ANN_ITERATIONS ) {
+      break;
+    }
+    svcSigParallelFor( trained, nThreads, [&]( size_t s, unsigned int ) {
+      assigned[ s ] = nearest( &reduced[ order[ s ] * _dims ] );
+    } );
+    std::vector<double> sum( _lists * _dims, 0.0 );
+    std::vector<size_t> members( _lists, 0 );
+    for ( size_t s = 0; s < trained; s++ ) {
+      const float *v( &reduced[ order[ s ] * _dims ] );
+      for ( size_t d = 0; d < _dims; d++ ) {
+        sum[ assigned[ s ] * _dims + d ] += v[ d ];
+      }
+      members[ assigned[ s ] ]++;
+    }
+    for ( size_t l = 0; l < _lists; l++ ) {
+      // an empty list restarts at a random spectrum
+      const float *v( &reduced[ order[ random() % trained ] * _dims ] );
+      for ( size_t d = 0; d < _dims; d++ ) {
+        _centroidsData[ l * _dims + d ] = members[ l ] > 0 ? sum[ l * _dims + d ] / members[ l ] : v[ d ];
+      }
+    }
+  }
+  
+  // the inverted lists
+  svcSigParallelFor( _count, nThreads, [&]( size_t i, unsigned int ) {
+    assigned[ i ] = nearest( &reduced[ i * _dims ] );
+  } );
+  _offsetsData.assign( _lists + 1, 0 );
+  for ( size_t i = 0; i < _count; i++ ) {
+    _offsetsData[ assigned[ i ] + 1 ]++;
+  }
+  for ( size_t l = 0; l < _lists; l++ ) {
+    _offsetsData[ l + 1 ] += _offsetsData[ l ];
+  }
+  std::vector<uint64_t> next( _offsetsData.begin(), _offsetsData.end() - 1 );
+  _idsData.resize( _count );
+  _vectorsData.resize( _count * _dims );
+  _normsData.resize( _count );
+  for ( size_t i = 0; i < _count; i++ ) {
+    uint64_t at( next[ assigned[ i ] ]++ );
+    const float *v( &reduced[ i * _dims ] );
+    _idsData[ at ] = i;
+    std::copy( v, v + _dims, &_vectorsData[ at * _dims ] );
+    _normsData[ at ] = zero[ i ] ? NAN : svcSigDot( v, v, _dims );
+  }
+  
+  svcSigAnnUse();
+  return *this;
+}
+
+// -- -- IO -- -- //
+svcsigann& svcsigann::load( const std::string &filename )
+{
+  _gridData.clear();
+  _meanData.clear();
+  _componentsData.clear();
+  _centroidsData.clear();
+  _offsetsData.assign( 1, 0 );
+  _idsData.clear();
+  _vectorsData.clear();
+  _normsData.clear();
+  _count = 0;
+  _bands = 0;
+  _dims = 0;
+  _lists = 0;
+  svcSigAnnUse();
+  
+  int fd( ::open( filename.c_str(), O_RDONLY ) );
+  if ( fd < 0 ) {
+    throw invalidSVCsigAnn( "could not open '" + filename + "'" );
+  }
+  struct stat st;
+  if ( fstat( fd, &st ) != 0 || size_t( st.st_size ) < sizeof( svcsigannheader ) ) {
+    ::close( fd );
+    throw invalidSVCsigAnn( "'" + filename + "' is not an index" );
+  }
+  void *map( mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 ) );
+  ::close( fd );
+  if ( map == MAP_FAILED ) {
+    throw invalidSVCsigAnn( "could not map '" + filename + "'" );
+  }
+  
+  const svcsigannheader *header( static_cast<const svcsigannheader *>( map ) );
+  std::string problem;
+  if ( memcmp( header->magic, SVCSIG_ANN_MAGIC, 8 ) != 0 ) {
+    problem = "is not an index";
+  }
+  else if ( header->version != SVCSIG_ANN_VERSION ) {
+    problem = "was written by an incompatible version";
+  }
+  else if ( header->lists == 0 || header->dims == 0 || header->dims > header->bands ) {
+    problem = "is corrupt";
+  }
+  else if ( header->metric != SVCSIG_LIBRARY_ANGLE && header->metric != SVCSIG_LIBRARY_EUCLIDEAN && header->metric != SVCSIG_LIBRARY_PEARSON ) {
+    problem = "is corrupt";
+  }
+  else {
+    // every array is at most the file, so the layout can not overflow
+    uint64_t words( st.st_size / sizeof( float ) );
+    if ( header->count > 0xffffffffu || header->count > words || header->bands > words || header->lists > words ) {
+      problem = "is corrupt";
+    }
+    else if ( header->dims > words / header->bands || header->dims > words / header->lists || ( header->count > 0 && header->dims > words / header->count ) ) {
+      problem = "is corrupt";
+    }
+  }
+  size_t offsets[ 9 ];
+  if ( problem.empty() ) {
+    _count = header->count;
+    _bands = header->bands;
+    _dims = header->dims;
+    _lists = header->lists;
+    if ( svcSigAnnLayout( offsets ) != size_t( st.st_size ) ) {
+      problem = "is truncated";
+    }
+  }
+  const char *base( static_cast<const char *>( map ) );
+  if ( problem.empty() ) {
+    const uint64_t *lists( reinterpret_cast<const uint64_t *>( base + offsets[ 4 ] ) );
+    for ( size_t l = 0; l < _lists && problem.empty(); l++ ) {
+      if ( lists[ l ] > lists[ l + 1 ] ) {
+        problem = "is corrupt";
+      }
+    }
+    if ( lists[ 0 ] != 0 || lists[ _lists ] != _count ) {
+      problem = "is corrupt";
+    }
+    const uint32_t *ids( reinterpret_cast<const uint32_t *>( base + offsets[ 5 ] ) );
+    for ( size_t i = 0; i < _count && problem.empty(); i++ ) {
+      if ( ids[ i ] >= _count ) {
+        problem = "is corrupt";
+      }
+    }
+  }
+  if ( problem.size() > 0 ) {
+    munmap( map, st.st_size );
+    _count = 0;
+    _bands = 0;
+    _dims = 0;
+    _lists = 0;
+    throw invalidSVCsigAnn( "'" + filename + "' " + problem );
+  }
+  
+  _map = map;
+  _mapSize = st.st_size;
+  _metric = header->metric;
+  _grid = reinterpret_cast<const float *>( base + offsets[ 0 ] );
+  _mean = reinterpret_cast<const float *>( base + offsets[ 1 ] );
+  _components = reinterpret_cast<const float *>( base + offsets[ 2 ] );
+  _centroids = reinterpret_cast<const float *>( base + offsets[ 3 ] );
+  _offsets = reinterpret_cast<const uint64_t *>( base + offsets[ 4 ] );
+  _ids = reinterpret_cast<const uint32_t *>( base + offsets[ 5 ] );
+  _vectors = reinterpret_cast<const float *>( base + offsets[ 6 ] );
+  _norms = reinterpret_cast<const float *>( base + offsets[ 7 ] );
+  return *this;
+}
+
+void svcsigann::save( const std::string &filename ) const
+{
+  std::string tmp( filename + ".tmp" );
+  FILE *output( fopen( tmp.c_str(), "wb" ) );
+  if ( output == NULL ) {
+    throw invalidSVCsigAnn( "could not write '" + tmp + "'" );
+  }
+  
+  svcsigannheader header;
+  memset( &header, 0, sizeof( header ) );
+  memcpy( header.magic, SVCSIG_ANN_MAGIC, 8 );
+  header.version = SVCSIG_ANN_VERSION;
+  header.metric = _metric;
+  header.count = _count;
+  header.bands = _bands;
+  header.dims = _dims;
+  header.lists = _lists;
+  
+  size_t offsets[ 9 ];
+  svcSigAnnLayout( offsets );
+  const void *arrays[ 8 ] = { _grid, _mean, _components, _centroids, _offsets, _ids, _vectors, _norms };
+  size_t sizes[ 8 ];
+  svcSigAnnSizes( sizes );
+  
+  bool good( fwrite( &header, sizeof( header ), 1, output ) == 1 );
+  size_t at( sizeof( header ) );
+  const char padding[ SVCSIG_ANN_ALIGN ] = { 0 };
+  for ( size_t a = 0; a < 8 && good; a++ ) {
+    good = fwrite( padding, 1, offsets[ a ] - at, output ) == offsets[ a ] - at;
+    if ( good && sizes[ a ] > 0 ) {
+      good = fwrite( arrays[ a ], 1, sizes[ a ], output ) == sizes[ a ];
+    }
+    at = offsets[ a ] + sizes[ a ];
+  }
+  good = ( fclose( output ) == 0 ) && good;
+  
+  if ( !good || rename( tmp.c_str(), filename.c_str() ) != 0 ) {
+    remove( tmp.c_str() );
+    throw invalidSVCsigAnn( "could not write '" + filename + "'" );
+  }
+}
+
+// -- -- Getters -- -- //
+size_t svcsigann::size() const
+{
+  return _count;
+}
+
+int svcsigann::metric() const
+{
+  return _metric;
+}
+
+std::vector<float> svcsigann::grid() const
+{
+  return std::vector<float>( _grid, _grid + _bands );
+}
+
+size_t svcsigann::dims() const
+{
+  return _dims;
+}
+
+size_t svcsigann::lists() const
+{
+  return _lists;
+}
+
+// -- -- Search -- -- //
+std::vector< std::vector<svcsigmatch> > svcsigann::search( const float *queries, const size_t &count, const size_t &k, const size_t &nprobe, const unsigned int &threads, const svcsiglibrary *library, const size_t &refine ) const
+{
+  if ( library != NULL && ( library->grid().size() != _bands || !std::equal( _grid, _grid + _bands, library->grid().begin() ) ) ) {
+    throw invalidSVCsigAnn( "the library is on another grid" );
+  }
+  if ( library != NULL && library->size() != _count ) {
+    throw invalidSVCsigAnn( "the library is not the one the index was built from" );
+  }
+  size_t probes( std::min( std::max( nprobe, size_t( 1 ) ), _lists ) );
+  size_t candidates( library != NULL ? std::max( k, refine ) : k );
+  
+  std::vector< std::vector<svcsigmatch> > matches( count );
+  svcSigParallelFor( count, threads, [&]( size_t q, unsigned int ) {
+    if ( _count == 0 || k == 0 || svcSigAnnZero( queries + q * _bands ) ) {
+      return;
+    }
+    std::vector<float> reduced( _dims );
+    svcSigAnnProject( queries + q * _bands, reduced.data() );
+    float norm( svcSigDot( reduced.data(), reduced.data(), _dims ) );
+    
+    // the closest lists
+    std::vector< std::pair<float, size_t> > closest( _lists );
+    for ( size_t l = 0; l < _lists; l++ ) {
+      const float *c( _centroids + l * _dims );
+      closest[ l ] = std::make_pair( svcSigDot( c, c, _dims ) - 2.0f * svcSigDot( reduced.data(), c, _dims ), l );
+    }
+    std::partial_sort( closest.begin(), closest.begin() + probes, closest.end() );
+    
+    // the best candidates in them (a max heap)
+    typedef std::pair<double, size_t> candidate;
+    std::priority_queue<candidate> best;
+    for ( size_t p = 0; p < probes; p++ ) {
+      size_t l( closest[ p ].second );
+      for ( uint64_t i = _offsets[ l ]; i < _offsets[ l + 1 ]; i++ ) {
+        if ( std::isnan( _norms[ i ] ) ) {
+          continue;
+        }
+        double distance( std::max( 0.0f, norm + _norms[ i ] - 2.0f * svcSigDot( reduced.data(), _vectors + i * _dims, _dims ) ) );
+        if ( best.size() < candidates ) {
+          best.push( candidate( distance, _ids[ i ] ) );
+        }
+        else if ( candidate( distance, _ids[ i ] ) < best.top() ) {
+          best.pop();
+          best.push( candidate( distance, _ids[ i ] ) );
+        }
+      }
+    }
+    
+    std::vector<size_t> ids;
+    std::vector<double> distances;
+    while ( !best.empty() ) {
+      ids.push_back( best.top().second );
+      distances.push_back( svcSigAnnMetric( best.top().first ) );
+      best.pop();
+    }
+    if ( library != NULL ) {
+      library->distances( queries + q * _bands, ids.data(), ids.size(), _metric, distances.data() );
+    }
+    std::vector<candidate> found;
+    for ( size_t i = 0; i < ids.size(); i++ ) {
+      if ( !std::isnan( distances[ i ] ) ) {
+        found.push_back( candidate( distances[ i ], ids[ i ] ) );
+      }
+    }
+    std::sort( found.begin(), found.end() );
+    for ( size_t i = 0; i < found.size() && i < k; i++ ) {
+      svcsigmatch match;
+      match.id = found[ i ].second;
+      match.distance = found[ i ].first;
+      matches[ q ].push_back( match );
+    }
+  } );
+  return matches;
+}
+
+std::vector< std::vector<svcsigmatch> > svcsigann::search( const std::vector<svcsig> &queries, const size_t &k, const size_t &nprobe, const unsigned int &threads, const svcsiglibrary *library, const size_t &refine ) const
+{
+  svcsiglibrary packed;
+  packed.build( queries, grid(), threads );
+  return search( packed.size() > 0 ? packed.row( 0 ) : NULL, packed.size(), k, nprobe, threads, library, refine );
+}
+
+// -- -- Helper Functions -- -- //
+void svcsigann::svcSigAnnUse()
+{
+  if ( _map != NULL ) {
+    munmap( _map, _mapSize );
+    _map = NULL;
+    _mapSize = 0;
+  }
+  _grid = _gridData.data();
+  _mean = _meanData.data();
+  _components = _componentsData.data();
+  _centroids = _centroidsData.data();
+  _offsets = _offsetsData.data();
+  _ids = _idsData.data();
+  _vectors = _vectorsData.data();
+  _norms = _normsData.data();
+}
+
+size_t svcsigann::svcSigAnnLayout( size_t offsets[ 9 ] ) const
+{
+  size_t sizes[ 8 ];
+  svcSigAnnSizes( sizes );
+  size_t at( sizeof( svcsigannheader ) );
+  for ( size_t a = 0; a < 8; a++ ) {
+    offsets[ a ] = ( at + SVCSIG_ANN_ALIGN - 1 ) / SVCSIG_ANN_ALIGN * SVCSIG_ANN_ALIGN;
+    at = offsets[ a ] + sizes[ a ];
+  }
+  offsets[ 8 ] = at;
+  return at;
+}
+
+void svcsigann::svcSigAnnSizes( size_t sizes[ 8 ] ) const
+{
+  sizes[ 0 ] = _bands * sizeof( float ); // grid
+  sizes[ 1 ] = _bands * sizeof( float ); // mean
+  sizes[ 2 ] = _dims * _bands * sizeof( float ); // components
+  sizes[ 3 ] = _lists * _dims * sizeof( float ); // centroids
+  sizes[ 4 ] = ( _lists + 1 ) * sizeof( uint64_t ); // offsets
+  sizes[ 5 ] = _count * sizeof( uint32_t ); // ids
+  sizes[ 6 ] = _count * _dims * sizeof( float ); // vectors
+  sizes[ 7 ] = _count * sizeof( float ); // norms
+}
+
+void svcsigann::svcSigAnnNormalise( const float *spectrum, float *out ) const
+{
+  double sum( 0.0 ), squares( 0.0 );
+  for ( size_t j = 0; j < _bands; j++ ) {
+    sum += spectrum[ j ];
+    squares += double( spectrum[ j ] ) * spectrum[ j ];
+  }
+  double offset( 0.0 ), scale( 1.0 );
+  if ( _metric == SVCSIG_LIBRARY_ANGLE ) {
+    scale = squares > 0.0 ? 1.0 / std::sqrt( squares ) : 0.0;
+  }
+  else if ( _metric == SVCSIG_LIBRARY_PEARSON ) {
+    offset = sum / _bands;
+    double centered( squares - sum * offset );
+    scale = centered > 0.0 ? 1.0 / std::sqrt( centered ) : 0.0;
+  }
+  for ( size_t j = 0; j < _bands; j++ ) {
+    out[ j ] = ( spectrum[ j ] - offset ) * scale;
+  }
+}
+
+void svcsigann::svcSigAnnProject( const float *spectrum, float *out ) const
+{
+  std::vector<float> normalised( _bands );
+  svcSigAnnNormalise( spectrum, normalised.data() );
+  for ( size_t j = 0; j < _bands; j++ ) {
+    normalised[ j ] -= _mean[ j ];
+  }
+  for ( size_t d = 0; d < _dims; d++ ) {
+    out[ d ] = svcSigDot( normalised.data(), _components + d * _bands, _bands );
+  }
+}
+
+bool svcsigann::svcSigAnnZero( const float *spectrum ) const
+{
+  double sum( 0.0 ), squares( 0.0 );
+  for ( size_t j = 0; j < _bands; j++ ) {
+    sum += spectrum[ j ];
+    squares += double( spectrum[ j ] ) * spectrum[ j ];
+  }
+  if ( squares == 0.0 ) {
+    return true;
+  }
+  return _metric == SVCSIG_LIBRARY_PEARSON && std::max( 0.0, squares - sum * sum / _bands ) == 0.0;
+}
+
+double svcsigann::svcSigAnnMetric( const double &squared ) const
+{
+  // unit (and centered) spectra a and b have |a - b|^2 = 2 ( 1 - a.b )
+  if ( _metric == SVCSIG_LIBRARY_ANGLE ) {
+    return std::acos( std::max( -1.0, std::min( 1.0, 1.0 - squared / 2.0 ) ) );
+  }
+  if ( _metric == SVCSIG_LIBRARY_PEARSON ) {
+    return squared / 2.0;
+  }
+  return std::sqrt( squared );
+}
+
+#endif // __svcsigann_hpp_
@@ -0,0 +1,431 @@
+/*******************************************************************************
+ * svcsigbatch.hpp
+ *
+ * DESCRIPTION:
+ *    Provides multi-threaded loading of many SVC sig files, and the parallel
+ *    loop that it (and the other collection tools) is built on. Also decodes
+ *    the positions and gps times of whole collections into arrays, and
+ *    groups collections by wavelength grid.
+ *
+ *    Build with -pthread.
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *    2026-10-18: Added batch position and gps time decoding
+ *    2026-10-18: Added svcSigGroupByGrid()
+ *    2026-10-18: The batch decoders convert the digits with SSSE3
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsigbatch_hpp_
+#define __svcsigbatch_hpp_
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <stdint.h>
+
+#if defined( __SSSE3__ )
+#include <immintrin.h>
+#endif
+
+#include "svcsig.hpp"
+
+// the number of strings decoded per parallel item
+#define SVCSIG_BATCH_CHUNK 4096
+
+
+/* Name: unsigned int svcSigThreads( const unsigned int &threads )
+ *
+ * Description: Resolves a requested number of worker threads
+ * Arguments: const unsigned int &threads: the requested number, 0 for one per
+ *     core
+ * Modifies:
+ * Returns: unsigned int (at least 1)
+ * Pre:
+ * Post:
+ * Exceptions:
+ * Notes:
+ */
+unsigned int svcSigThreads( const unsigned int &threads )
+{
+  if ( threads > 0 ) {
+    return threads;
+  }
+  unsigned int cores( std::thread::hardware_concurrency() );
+  return cores > 0 ? cores : 1;
+}
+
+/* Name: void svcSigParallelFor( const size_t &n, const unsigned int &threads, Function f )
+ *
+ * Description: Calls f( i, thread ) for every i in [0, n) across worker threads
+ * Arguments: const size_t &n: the number of items
+ *            const unsigned int &threads: the number of threads (0 for one per
+ *                core)
+ *            Function f: called as f( size_t i, unsigned int thread ), where
+ *                thread is in [0, svcSigThreads( threads ) ) and can index per
+ *                thread state
+ * Modifies:
+ * Returns:
+ * Pre:
+ * Post: f has been called once for every i
+ * Exceptions: The first exception thrown by f is rethrown after all threads
+ *     have stopped
+ * Notes: Items are handed out one at a time from a shared counter, so uneven
+ *    items (e.g. files of different sizes) balance across the threads
+ */
+template <typename Function>
+void svcSigParallelFor( const size_t &n, const unsigned int &threads, Function f )
+{
+  unsigned int nThreads( svcSigThreads( threads ) );
+  if ( nThreads > n ) {
+    nThreads = n > 0 ? n : 1;
+  }
+
+  std::atomic<size_t> next( 0 );
+  std::exception_ptr error;
+  std::mutex errorMutex;
+
+  auto worker = [&]( unsigned int thread ) {
+    try {
+      for ( size_t i = next++; i < n; i = next++ ) {
+        f( i, thread );
+      }
+    } catch ( ... ) {
+      std::lock_guard<std::mutex> lock( errorMutex );
+      if ( !error ) {
+        error = std::current_exception();
+      }
+      next = n; // stop the other threads
+    }
+  };
+
+  if ( nThreads == 1 ) {
+    worker( 0 );
+  }
+  else {
+    std::vector<std::thread> pool;
+    for ( unsigned int t = 0; t < nThreads; t++ ) {
+      pool.push_back( std::thread( worker, t ) );
+    }
+    for ( unsigned int t = 0; t < nThreads; t++ ) {
+      pool[ t ].join();
+    }
+  }
+
+  if ( error ) {
+    std::rethrow_exception( error );
+  }
+}
+
+/* Name: std::vector<svcsig> svcSigReadBatch( const std::vector<std::string> &filenames, const unsigned int &threads )
+ *
+ * Description: Reads many sig files across worker threads
+ * Arguments: const std::vector<std::string> &filenames: the sig files (plain,
+ *                gzip or zstd compressed)
+ *            const unsigned int &threads: the number of threads (0 for one per
+ *                core)
+ * Modifies:
+ * Returns: std::vector<svcsig>, in the same order as filenames
+ * Pre:
+ * Post:
+ * Exceptions:
+ * Notes: Decompression happens in the worker threads, so compressed libraries
+ *    load at the combined speed of all of the cores
+ */
+std::vector<svcsig> svcSigReadBatch( const std::vector<std::string> &filenames, const unsigned int &threads = 0 )
+{
+  std::vector<svcsig> sigs( filenames.size() );
+  svcSigParallelFor( filenames.size(), threads, [&]( size_t i, unsigned int ) {
+    sigs[ i ].read( filenames[ i ] );
+  } );
+  return sigs;
+}
+
+/* Name: void svcSigPositionBatch( const std::vector<svcsig> &sigs, std::vector<double> &latitude, std::vector<double> &longitude, std::vector<double> &gpstime, const bool &reference )
+ *
+ * Description: Gathers the decoded positions and gps times of many sig files
+ *    into arrays
+ * Arguments: const std::vector<svcsig> &sigs: the sig files
+ *            std::vector<double> &latitude: the latitudes (degrees)
+ *            std::vector<double> &longitude: the longitudes (degrees)
+ *            std::vector<double> &gpstime: the gps times (hours)
+ *            const bool &reference: use the reference scans, rather than the
+ *                target scans
+ * Modifies: latitude, longitude, gpstime (resized to sigs.size())
+ * Returns:
+ * Pre:
+ * Post:
+ * Exceptions:
+ * Notes: Values are NAN where a field is missing or invalid. Nothing is
+ *    parsed, the fields were decoded when the files were read.
+ */
+void svcSigPositionBatch( const std::vector<svcsig> &sigs, std::vector<double> &latitude, std::vector<double> &longitude, std::vector<double> &gpstime, const bool &reference = false )
+{
+  latitude.resize( sigs.size() );
+  longitude.resize( sigs.size() );
+  gpstime.resize( sigs.size() );
+  for ( size_t i = 0; i < sigs.size(); i++ ) {
+    latitude[ i ] = reference ? sigs[ i ].referenceDecodedLatitude() : sigs[ i ].targetDecodedLatitude();
+    longitude[ i ] = reference ? sigs[ i ].referenceDecodedLongitude() : sigs[ i ].targetDecodedLongitude();
+    gpstime[ i ] = reference ? sigs[ i ].referenceDecodedGpstime() : sigs[ i ].targetDecodedGpstime();
+  }
+}
+
+/* Name: bool svcSigDecodeDigits( const char *s, const size_t &n, uint64_t &value, size_t &digits, size_t &dot )
+ *
+ * Description: Reads a field of digits with at most one '.' as an integer,
+ *    all of its digits at once with SSSE3
+ * Arguments: const char *s, const size_t &n: the field (at most 16 bytes)
+ *            uint64_t &value: the digits as an integer, the dot removed
+ *            size_t &digits: the number of digits
+ *            size_t &dot: the index of the dot, n if there is none
+ * Modifies: value, digits, dot
+ * Returns: bool, false if the field has any other character, more than 15
+ *    digits (so value might not be exact as a double) or none
+ * Pre:
+ * Post:
+ * Exceptions:
+ * Notes: Fields of 8 to 16 bytes are loaded as two overlapping halves, the
+ *    digits right aligned in a register with one byte shuffle, which also
+ *    drops the dot, then combined in pairs, fours and eights with
+ *    multiply-adds. Shorter fields, or without SSSE3, it is a loop.
+ */
+bool svcSigDecodeDigits( const char *s, const size_t &n, uint64_t &value, size_t &digits, size_t &dot )
+{
+  if ( n == 0 || n > 16 ) {
+    return false;
+  }
+#if defined( __SSSE3__ )
+  if ( n >= 8 ) {
+    // the first and the last eight bytes, overlapping, so nothing past the
+    // field is read; the shuffle puts the last ones back in place and zeroes
+    // the bytes past n
+    __m128i j( _mm_setr_epi8( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 ) );
+    __m128i halves( _mm_unpacklo_epi64( _mm_loadl_epi64( reinterpret_cast<const __m128i *>( s ) ), _mm_loadl_epi64( reinterpret_cast<const __m128i *>( s + n - 8 ) ) ) );
+    __m128i placed( _mm_add_epi8( j, _mm_and_si128( _mm_cmpgt_epi8( j, _mm_set1_epi8( 7 ) ), _mm_set1_epi8( char( 16 - n ) ) ) ) );
+    __m128i chars( _mm_shuffle_epi8( halves, _mm_or_si128( placed, _mm_cmpgt_epi8( j, _mm_set1_epi8( char( n - 1 ) ) ) ) ) );
+    __m128i d( _mm_sub_epi8( chars, _mm_set1_epi8( '0' ) ) );
+    int used( ( 1 << n ) - 1 );
+    int dots( _mm_movemask_epi8( _mm_cmpeq_epi8( chars, _mm_set1_epi8( '.' ) ) ) & used );
+    int other( _mm_movemask_epi8( _mm_or_si128( _mm_cmplt_epi8( d, _mm_setzero_si128() ), _mm_cmpgt_epi8( d, _mm_set1_epi8( 9 ) ) ) ) & used & ~dots );
+    if ( other != 0 || ( dots & ( dots - 1 ) ) != 0 ) {
+      return false;
+    }
+    dot = dots != 0 ? __builtin_ctz( dots ) : n;
+    digits = n - ( dots != 0 ? 1 : 0 );
+    if ( digits > 15 ) {
+      return false;
+    }
+
+    // byte j takes digit k = j - ( 16 - digits ), which is at k, or k + 1 past
+    // the dot; negative k have the top bit set, so the shuffle zeroes them
+    __m128i k( _mm_sub_epi8( j, _mm_set1_epi8( char( 16 - digits ) ) ) );
+    __m128i source( _mm_sub_epi8( k, _mm_cmpgt_epi8( k, _mm_set1_epi8( char( dot ) - 1 ) ) ) );
+    __m128i aligned( _mm_shuffle_epi8( d, source ) );
+    __m128i pairs( _mm_maddubs_epi16( aligned, _mm_set1_epi16( 0x010a ) ) ); // 10 a + b
+    __m128i fours( _mm_madd_epi16( pairs, _mm_set1_epi32( 0x00010064 ) ) ); // 100 a + b
+    __m128i packed( _mm_packs_epi32( fours, fours ) );
+    __m128i eights( _mm_madd_epi16( packed, _mm_set1_epi32( 0x00012710 ) ) ); // 10000 a + b
+    value = uint64_t( uint32_t( _mm_cvtsi128_si32( eights ) ) ) * 100000000u + uint32_t( _mm_cvtsi128_si32( _mm_srli_si128( eights, 4 ) ) );
+    return true;
+  }
+#endif
+  value = 0;
+  digits = 0;
+  dot = n;
+  for ( size_t i = 0; i < n; i++ ) {
+    if ( s[ i ] == '.' && dot == n ) {
+      dot = i;
+    }
+    else if ( s[ i ] >= '0' && s[ i ] <= '9' ) {
+      value = value * 10 + ( s[ i ] - '0' );
+      digits++;
+    }
+    else {
+      return false;
+    }
+  }
+  return digits > 0 && digits <= 15;
+}
+
+/* Name: double svcSigDecodePower( const size_t &e )
+ *
+ * Description: 10^e, exactly (e <= 17)
+ */
+double svcSigDecodePower( const size_t &e )
+{
+  static const double powers[ 18 ] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17 };
+  return powers[ e ];
+}
+
+/* Name: double svcSigDecodeLatLonFast( const std::string &latlon, const svcsigspectraheader &decoder )
+ *
+ * Description: svcsigspectraheader::svcSigDecodeLatLon() (the same result,
+ *    to the bit) with svcSigDecodeDigits() for the common dddmm.mmmmQ form,
+ *    and decoder for anything else
+ * Notes: The minutes are value % 10^( f + 2 ) / 10^f for f decimals, one
+ *    division of two exact doubles, so they round as strtod() does
+ */
+double svcSigDecodeLatLonFast( const std::string &latlon, const svcsigspectraheader &decoder )
+{
+  size_t n( latlon.size() );
+  if ( n >= 2 ) {
+    char quadrant( latlon[ n - 1 ] );
+    double sign( quadrant == 'N' || quadrant == 'E' ? 1.0 : ( quadrant == 'S' || quadrant == 'W' ? -1.0 : 0.0 ) );
+    uint64_t value;
+    size_t digits, dot;
+    if ( sign != 0.0 && svcSigDecodeDigits( latlon.data(), n - 1, value, digits, dot ) && dot >= 2 && dot < n - 1 ) {
+      size_t fraction( n - 2 - dot );
+      uint64_t scale( uint64_t( svcSigDecodePower( fraction + 2 ) ) );
+      return sign * ( double( value / scale ) + double( value % scale ) / svcSigDecodePower( fraction ) / 60.0 );
+    }
+  }
+  return decoder.svcSigDecodeLatLon( latlon );
+}
+
+/* Name: double svcSigDecodeGpsTimeFast( const std::string &gpstime, const svcsigspectraheader &decoder )
+ *
+ * Description: svcsigspectraheader::svcSigDecodeGpsTime() (the same result,
+ *    to the bit) with svcSigDecodeDigits() for the common hhmmss.sss form,
+ *    and decoder for anything else
+ */
+double svcSigDecodeGpsTimeFast( const std::string &gpstime, const svcsigspectraheader &decoder )
+{
+  uint64_t value;
+  size_t digits, dot;
+  if ( svcSigDecodeDigits( gpstime.data(), gpstime.size(), value, digits, dot ) && dot >= 4 && digits > 4 ) {
+    size_t fraction( dot < gpstime.size() ? gpstime.size() - 1 - dot : 0 );
+    uint64_t seconds( uint64_t( svcSigDecodePower( digits - 4 ) ) );
+    double hours( double( value / ( seconds * 100 ) ) );
+    double minutes( double( value / seconds % 100 ) );
+    return hours + minutes / 60.0 + double( value % seconds ) / svcSigDecodePower( fraction ) / 3600.0;
+  }
+  return decoder.svcSigDecodeGpsTime( gpstime );
+}
+
+/* Name: std::vector<double> svcSigDecodeLatLonBatch( const std::vector<std::string> &latlon, const unsigned int &threads )
+ *
+ * Description: Decodes many positions (dddmm.mmmmQ) to degrees across worker
+ *    threads
+ * Arguments: const std::vector<std::string> &latlon: the positions
+ *            const unsigned int &threads: the number of threads (0 for one per
+ *                core)
+ * Modifies:
+ * Returns: std::vector<double>, NAN where a position can not be decoded
+ * Pre:
+ * Post:
+ * Exceptions:
+ * Notes: See svcsigspectraheader::svcSigDecodeLatLon()
+ */
+std::vector<double> svcSigDecodeLatLonBatch( const std::vector<std::string> &latlon, const unsigned int &threads = 0 )
+{
+  std::vector<double> degrees( latlon.size() );
+  svcsigspectraheader decoder;
+  size_t chunks( ( latlon.size() + SVCSIG_BATCH_CHUNK - 1 ) / SVCSIG_BATCH_CHUNK );
+  svcSigParallelFor( chunks, threads, [&]( size_t chunk, unsigned int ) {
+    size_t end( std::min( latlon.size(), ( chunk + 1 ) * SVCSIG_BATCH_CHUNK ) );
+    for ( size_t i = chunk * SVCSIG_BATCH_CHUNK; i < end; i++ ) {
+      degrees[ i ] = svcSigDecodeLatLonFast( latlon[ i ], decoder );
+    }
+  } );
+  return degrees;
+}
+
+/* Name: std::vector<double> svcSigDecodeGpsTimeBatch( const std::vector<std::string> &gpstime, const unsigned int &threads )
+ *
+ * Description: Decodes many gps times (hhmmss.sss) to hours across worker
+ *    threads
+ * Arguments: const std::vector<std::string> &gpstime: the gps times
+ *            const unsigned int &threads: the number of threads (0 for one per
+ *                core)
+ * Modifies:
+ * Returns: std::vector<double>, NAN where a time can not be decoded
+ * Pre:
+ * Post:
+ * Exceptions:
+ * Notes: See svcsigspectraheader::svcSigDecodeGpsTime()
+ */
+std::vector<double> svcSigDecodeGpsTimeBatch( const std::vector<std::string> &gpstime, const unsigned int &threads = 0 )
+{
+  std::vector<double> hours( gpstime.size() );
+  svcsigspectraheader decoder;
+  size_t chunks( ( gpstime.size() + SVCSIG_BATCH_CHUNK - 1 ) / SVCSIG_BATCH_CHUNK );
+  svcSigParallelFor( chunks, threads, [&]( size_t chunk, unsigned int ) {
+    size_t end( std::min( gpstime.size(), ( chunk + 1 ) * SVCSIG_BATCH_CHUNK ) );
+    for ( size_t i = chunk * SVCSIG_BATCH_CHUNK; i < end; i++ ) {
+      hours[ i ] = svcSigDecodeGpsTimeFast( gpstime[ i ], decoder );
+    }
+  } );
+  return hours;
+}
+
+/* Name: std::map< std::vector<float>, std::vector<size_t> > svcSigGroupByGrid( const std::vector<svcsig> &sigs )
+ *
+ * Description: Groups sig files by wavelength grid, so that the per grid
+ *    work (resamplers, splices, filters) is looked up once per group
+ * Arguments: const std::vector<svcsig> &sigs: the sig files
+ * Modifies:
+ * Returns: std::map< std::vector<float>, std::vector<size_t> >, the indices
+ *     into sigs of the files on each grid, in order. Empty files are left out.
+ * Pre:
+ * Post:
+ * Exceptions:
+ * Notes: Each file is first compared (memcmp) with the grid of the file
+ *    before it, so a run of files on one grid costs no map lookups
+ */
+std::map< std::vector<float>, std::vector<size_t> > svcSigGroupByGrid( const std::vector<svcsig> &sigs )
+{
+  typedef std::map< std::vector<float>, std::vector<size_t> > groups;
+  groups grouped;
+  groups::iterator last( grouped.end() );
+  for ( size_t i = 0; i < sigs.size(); i++ ) {
+    size_t n( sigs[ i ].size() );
+    if ( n == 0 ) {
+      continue;
+    }
+    const float *wavelength( sigs[ i ].wavelengthData() );
+    if ( last == grouped.end() || last->first.size() != n || memcmp( last->first.data(), wavelength, n * sizeof( float ) ) != 0 ) {
+      last = grouped.insert( std::make_pair( std::vector<float>( wavelength, wavelength + n ), std::vector<size_t>() ) ).first;
+    }
+    last->second.push_back( i );
+  }
+  return grouped;
+}
+
+#endif // __svcsigbatch_hpp_
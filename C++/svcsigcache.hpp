@@ -0,0 +1,338 @@
+/*******************************************************************************
+ * svcsigcache.hpp
+ *
+ * DESCRIPTION:
+ *    Provides header and implimentation for the svcsigcache class, a thread
+ *    safe least recently used cache of parsed sig files with a memory budget.
+ *    Files are shared as immutable svcsig objects, and every lookup checks the
+ *    file (mtime, size, inode) so a changed file is parsed again.
+ *
+ *    Build with -pthread.
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *    2026-10-18: Files that do not parse are not cached
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsigcache_hpp_
+#define __svcsigcache_hpp_
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <stdint.h>
+#include <sys/stat.h>
+
+#include "svcsig.hpp"
+
+// the default memory budget, in bytes
+#define SVCSIG_CACHE_BUDGET ( size_t( 256 ) << 20 )
+
+
+class svcsigcache {
+private:
+  // one cached file; the key is the path and the stat results it was read
+  // with
+  struct entry {
+    std::string path;
+    int64_t mtime; // ns since the epoch
+    int64_t size;
+    uint64_t device;
+    uint64_t inode;
+    size_t bytes; // footprint of sig and of this entry
+    std::shared_ptr<const svcsig> sig;
+  };
+  typedef std::list<entry> svcSigCacheList;
+  
+  mutable std::mutex _mutex;
+  svcSigCacheList _entries; // most recently used first
+  std::unordered_map<std::string, svcSigCacheList::iterator> _index;
+  size_t _budget;
+  size_t _bytes;
+  
+  // counters
+  size_t _hits;
+  size_t _misses;
+  size_t _evictions;
+  
+  svcsigcache( const svcsigcache &other );
+  svcsigcache& operator=( const svcsigcache &other );
+  
+  /* Name: void svcSigCacheErase( svcSigCacheList::iterator it )
+   *
+   * Description: Removes an entry
+   * Arguments: svcSigCacheList::iterator it: the entry
+   * Modifies: _entries, _index, _bytes
+   * Returns:
+   * Pre: _mutex is held
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  void svcSigCacheErase( svcSigCacheList::iterator it );
+  
+  /* Name: void svcSigCacheTrim()
+   *
+   * Description: Evicts the least recently used entries until the cache fits
+   *    its budget
+   * Arguments:
+   * Modifies: _entries, _index, _bytes, _evictions
+   * Returns:
+   * Pre: _mutex is held
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  void svcSigCacheTrim();
+
+public:
+  /* Name: svcsigcache( const size_t &budget )
+   *
+   * Description: Creates an empty cache
+   * Arguments: const size_t &budget: the most memory (bytes) to hold
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  svcsigcache( const size_t &budget = SVCSIG_CACHE_BUDGET );
+  
+  /* Name: std::shared_ptr<const svcsig> read( const std::string &filename )
+   *
+   * Description: Returns a parsed sig file, from the cache if it has not
+   *    changed since it was cached
+   * Arguments: const std::string &filename: the (possibly compressed) file
+   * Modifies: the cache
+   * Returns: std::shared_ptr<const svcsig>, empty if the file does not exist
+   *     or is not a sig file with data (such files are not cached, so every
+   *     read of one is a miss)
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Thread safe. Files are parsed without holding the lock, so
+   *    threads missing on different files parse in parallel. The returned
+   *    object stays valid after it is evicted.
+   */
+  std::shared_ptr<const svcsig> read( const std::string &filename );
+  
+  /* Name: void erase( const std::string &filename )
+   *
+   * Description: Removes a file from the cache
+   * Arguments: const std::string &filename: the file, as given to read()
+   * Modifies: the cache
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  void erase( const std::string &filename );
+  
+  /* Name: void clear()
+   *
+   * Description: Empties the cache (the counters are kept)
+   */
+  void clear();
+  
+  /* Name: void budget( const size_t &budget )
+   *
+   * Description: Changes the memory budget, evicting entries if needed
+   * Arguments: const size_t &budget: the most memory (bytes) to hold
+   */
+  void budget( const size_t &budget );
+  
+  /* Name: getters
+   *
+   * Description: budget() is the memory budget, bytes() the memory held and
+   *    size() the number of files held (all bytes are footprints, see
+   *    svcsig::footprint()). hits(), misses() and evictions() count the
+   *    lookups served from the cache, the lookups that parsed the file
+   *    (including changed files) and the entries evicted for space.
+   */
+  size_t budget() const;
+  size_t bytes() const;
+  size_t size() const;
+  size_t hits() const;
+  size_t misses() const;
+  size_t evictions() const;
+};
+
+
+// --- --- Implimentation --- --- //
+
+// -- -- Constructors -- -- //
+svcsigcache::svcsigcache( const size_t &budget )
+: _budget( budget ), _bytes( 0 ), _hits( 0 ), _misses( 0 ), _evictions( 0 )
+{
+}
+
+// -- -- Lookup -- -- //
+std::shared_ptr<const svcsig> svcsigcache::read( const std::string &filename )
+{
+  struct stat st;
+  if ( stat( filename.c_str(), &st ) != 0 ) {
+    erase( filename );
+    return std::shared_ptr<const svcsig>();
+  }
+  entry key;
+  key.path = filename;
+  key.mtime = int64_t( st.st_mtim.tv_sec ) * 1000000000 + st.st_mtim.tv_nsec;
+  key.size = st.st_size;
+  key.device = st.st_dev;
+  key.inode = st.st_ino;
+  
+  {
+    std::lock_guard<std::mutex> lock( _mutex );
+    std::unordered_map<std::string, svcSigCacheList::iterator>::iterator found( _index.find( filename ) );
+    if ( found != _index.end() ) {
+      svcSigCacheList::iterator it( found->second );
+      if ( it->mtime == key.mtime && it->size == key.size && it->device == key.device && it->inode == key.inode ) {
+        _hits++;
+        _entries.splice( _entries.begin(), _entries, it );
+        return it->sig;
+      }
+      // changed on disk
+      svcSigCacheErase( it );
+    }
+    _misses++;
+  }
+  
+  std::shared_ptr<svcsig> sig( new svcsig() );
+  sig->read( filename );
+  if ( sig->size() == 0 ) {
+    return std::shared_ptr<const svcsig>();
+  }
+  key.sig = sig;
+  // the path is held twice, by the entry and as the key of _index
+  key.bytes = sig->footprint() + sizeof( entry ) + sizeof( std::string ) + 2 * svcSigStringFootprint( filename );
+  
+  std::lock_guard<std::mutex> lock( _mutex );
+  std::unordered_map<std::string, svcSigCacheList::iterator>::iterator found( _index.find( filename ) );
+  if ( found != _index.end() ) {
+    // another thread read it first; keep the newer file
+    if ( found->second->mtime >= key.mtime ) {
+      return key.sig;
+    }
+    svcSigCacheErase( found->second );
+  }
+  if ( key.bytes <= _budget ) {
+    _entries.push_front( key );
+    _index[ filename ] = _entries.begin();
+    _bytes += key.bytes;
+    svcSigCacheTrim();
+  }
+  return key.sig;
+}
+
+void svcsigcache::erase( const std::string &filename )
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  std::unordered_map<std::string, svcSigCacheList::iterator>::iterator found( _index.find( filename ) );
+  if ( found != _index.end() ) {
+    svcSigCacheErase( found->second );
+  }
+}
+
+void svcsigcache::clear()
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  _entries.clear();
+  _index.clear();
+  _bytes = 0;
+}
+
+void svcsigcache::budget( const size_t &budget )
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  _budget = budget;
+  svcSigCacheTrim();
+}
+
+// -- -- Getters -- -- //
+size_t svcsigcache::budget() const
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  return _budget;
+}
+
+size_t svcsigcache::bytes() const
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  return _bytes;
+}
+
+size_t svcsigcache::size() const
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  return _entries.size();
+}
+
+size_t svcsigcache::hits() const
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  return _hits;
+}
+
+size_t svcsigcache::misses() const
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  return _misses;
+}
+
+size_t svcsigcache::evictions() const
+{
+  std::lock_guard<std::mutex> lock( _mutex );
+  return _evictions;
+}
+
+// -- -- Helper Functions -- -- //
+void svcsigcache::svcSigCacheErase( svcSigCacheList::iterator it )
+{
+  _bytes -= it->bytes;
+  _index.erase( it->path );
+  _entries.erase( it );
+}
+
+void svcsigcache::svcSigCacheTrim()
+{
+  while ( _bytes > _budget && !_entries.empty() ) {
+    svcSigCacheErase( --_entries.end() );
+    _evictions++;
+  }
+}
+
+#endif // __svcsigcache_hpp_
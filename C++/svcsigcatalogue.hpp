@@ -0,0 +1,899 @@
+/*******************************************************************************
+ * svcsigcatalogue.hpp
+ *
+ * DESCRIPTION:
+ *    Provides header and implimentation for the svcsigcatalogue class, a
+ *    persistent index of the headers of every sig file in a directory tree.
+ *    Files are keyed by path, size and modification time, so a refresh only
+ *    parses the files that changed.
+ *
+ *    Build with -pthread.
+ *
+ * FILE FORMAT:
+ *    svcsigcatalogueheader (magic, version, record size, counts)
+ *    svcsigcatalogueentry[ count ] (fixed size records)
+ *    char[ poolSize ] (null terminated strings, entries hold offsets into it)
+ *
+ *    Loading maps the file, there is no parsing (the string offsets are only
+ *    checked against the pool). The format is native endian.
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *    2026-10-18: Version 2 records store the decoded acquisition times
+ *    2026-10-18: svcsigshm stores its headers as catalogue entries
+ *    2026-10-18: Version 3 records store the decoded positions and gps times
+ *    2026-10-18: Files whose header can not be parsed are left out
+ *    2026-10-18: load() checks the string offsets against the pool
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsigcatalogue_hpp_
+#define __svcsigcatalogue_hpp_
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <stdint.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "svcsighelper.hpp"
+#include "svcsig.hpp"
+#include "svcsigbatch.hpp"
+
+#define SVCSIG_CATALOGUE_MAGIC "SVCSIGC"
+#define SVCSIG_CATALOGUE_VERSION 3
+
+// the number of changed files parsed per parallel pass during a refresh
+#define SVCSIG_CATALOGUE_CHUNK 4096
+
+
+// the filter of the header reads of a refresh: every valid sig file
+class svcsigcatalogueall : public svcsigfilter {
+public:
+  bool accept( const svcsig & ) const { return true; }
+};
+
+
+// the file header of a catalogue
+struct svcsigcatalogueheader {
+  char magic[ 8 ];
+  uint32_t version;
+  uint32_t recordSize;
+  uint64_t count;
+  uint64_t poolSize;
+};
+
+// the svcsigspectraheader fields of one spectrum. Strings are offsets into the
+// string pool.
+struct svcsigcataloguespectra {
+  int64_t epoch; // the decoded time, see svcsigspectraheader::epochTime()
+  double decodedLongitude; // see svcsigspectraheader::decodedLongitude()
+  double decodedLatitude;
+  double decodedGpstime;
+  float integration[ 3 ];
+  float scanCoadds[ 3 ];
+  float scanTime;
+  float temp[ 3 ];
+  float battery;
+  uint32_t error;
+  uint32_t memorySlot;
+  short externalDataSet1[ 8 ];
+  short externalDataSet2[ 8 ];
+  uint32_t scanMethod;
+  uint32_t scanSettings;
+  uint32_t optic;
+  uint32_t units;
+  uint32_t time;
+  uint32_t longitude;
+  uint32_t latitude;
+  uint32_t gpstime;
+};
+
+// one file of the catalogue: its key (path, size, mtime) and its
+// svcsigcommonheader fields, plus a svcsigcataloguespectra per spectrum
+struct svcsigcatalogueentry {
+  int64_t size; // bytes
+  int64_t mtime; // ns since the epoch
+  uint32_t path;
+  uint32_t name;
+  uint32_t instrumentModelNumber;
+  uint32_t instrumentExtendedSerialNumber;
+  uint32_t instrumentCommonName;
+  uint32_t comm;
+  uint32_t factorsComment;
+  float factors[ 3 ];
+  short externalDataDark[ 8 ];
+  char externalDataMask;
+  svcsigcataloguespectra reference;
+  svcsigcataloguespectra target;
+};
+
+
+class svcsigcatalogue {
+private:
+  // the shared memory cache stores its headers as entries
+  friend class svcsigshm;
+  friend class svcsigshmview;
+
+  // the entries and string pool built by refresh()
+  std::vector<svcsigcatalogueentry> _entries;
+  std::vector<char> _pool; // starts with "", so offset 0 is the empty string
+  
+  // the current entries and string pool, either _entries and _pool, or a
+  // mapping of the file given to load()
+  const svcsigcatalogueentry *_records;
+  size_t _count;
+  const char *_strings;
+  void *_map;
+  size_t _mapSize;
+
+  // catalogues are not copyable (they may own a mapping)
+  svcsigcatalogue( const svcsigcatalogue &other );
+  svcsigcatalogue& operator=( const svcsigcatalogue &other );
+
+  /* Name: void svcSigCatalogueUse( std::vector<svcsigcatalogueentry> &entries, std::vector<char> &pool )
+   *
+   * Description: Replaces the contents of the catalogue
+   * Arguments: std::vector<svcsigcatalogueentry> &entries: the new entries
+   *            std::vector<char> &pool: the new string pool
+   * Modifies: Everything, entries, pool (they are swapped in)
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Releases any mapping
+   */
+  void svcSigCatalogueUse( std::vector<svcsigcatalogueentry> &entries, std::vector<char> &pool );
+
+  // a string pool under construction
+  typedef std::unordered_map<std::string, uint32_t> svcSigCatalogueIndex;
+
+  /* Name: uint32_t svcSigCatalogueIntern( const std::string &s, std::vector<char> &pool, svcSigCatalogueIndex &index ) const
+   *
+   * Description: Adds a string to a string pool (once)
+   * Arguments: const std::string &s: the string
+   *            std::vector<char> &pool: the pool
+   *            svcSigCatalogueIndex &index: the strings already in pool
+   * Modifies: pool, index
+   * Returns: the offset of s in pool
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigCatalogue if the pool grows past 4 GB
+   * Notes:
+   */
+  uint32_t svcSigCatalogueIntern( const std::string &s, std::vector<char> &pool, svcSigCatalogueIndex &index ) const;
+
+  /* Name: void svcSigCatalogueFill( const svcsig &sig, svcsigcatalogueentry &entry, std::vector<char> &pool, svcSigCatalogueIndex &index ) const
+   *
+   * Description: Copies the headers of sig into entry
+   * Arguments: const svcsig &sig: the (header only) sig file
+   *            svcsigcatalogueentry &entry: the output
+   *            std::vector<char> &pool: the string pool
+   *            svcSigCatalogueIndex &index: the strings already in pool
+   * Modifies: entry, pool, index
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: The key fields of entry are not touched
+   */
+  void svcSigCatalogueFill( const svcsig &sig, svcsigcatalogueentry &entry, std::vector<char> &pool, svcSigCatalogueIndex &index ) const;
+  void svcSigCatalogueFill( const svcsigspectraheader &header, svcsigcataloguespectra &spectra, std::vector<char> &pool, svcSigCatalogueIndex &index ) const;
+
+  /* Name: void svcSigCatalogueMove( svcsigcatalogueentry &entry, std::vector<char> &pool, svcSigCatalogueIndex &index ) const
+   *
+   * Description: Moves the strings of an entry from this catalogue's pool to
+   *    a new pool
+   * Arguments: svcsigcatalogueentry &entry: the entry
+   *            std::vector<char> &pool: the new string pool
+   *            svcSigCatalogueIndex &index: the strings already in pool
+   * Modifies: entry, pool, index
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  void svcSigCatalogueMove( svcsigcatalogueentry &entry, std::vector<char> &pool, svcSigCatalogueIndex &index ) const;
+  void svcSigCatalogueMove( svcsigcataloguespectra &spectra, std::vector<char> &pool, svcSigCatalogueIndex &index ) const;
+
+  /* Name: bool svcSigCatalogueValid( const svcsigcatalogueentry &entry, const uint64_t &poolSize ) const
+   *
+   * Description: Checks that the strings of an entry are in a pool
+   * Arguments: const svcsigcatalogueentry &entry: the entry
+   *            const uint64_t &poolSize: the size of the pool
+   * Modifies:
+   * Returns: bool, false if an offset is past the end of the pool
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: The pool ends with a null, so a string in it ends in it
+   */
+  bool svcSigCatalogueValid( const svcsigcatalogueentry &entry, const uint64_t &poolSize ) const;
+  bool svcSigCatalogueValid( const svcsigcataloguespectra &spectra, const uint64_t &poolSize ) const;
+
+  /* Name: void svcSigCatalogueScan( const std::string &directory, std::vector<std::string> &filenames ) const
+   *
+   * Description: Recursively finds sig files (.sig, .sig.gz, .sig.zst)
+   * Arguments: const std::string &directory: the directory
+   *            std::vector<std::string> &filenames: the output
+   * Modifies: filenames
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Unreadable directories are skipped
+   */
+  void svcSigCatalogueScan( const std::string &directory, std::vector<std::string> &filenames ) const;
+
+  svcsigspectraheader svcSigCatalogueSpectraHeader( const svcsigcataloguespectra &spectra ) const;
+
+public:
+  /* Name: svcsigcatalogue()
+   *
+   * Description: Constructs an empty catalogue
+   * Arguments:
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  svcsigcatalogue();
+
+  /* Name: ~svcsigcatalogue()
+   *
+   * Description: Destructor for svcsigcatalogue
+   * Arguments:
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Unmaps the catalogue file if it was loaded
+   */
+  ~svcsigcatalogue();
+
+  /* Name: svcsigcatalogue& load( const std::string &filename )
+   *
+   * Description: Loads a catalogue saved with save()
+   * Arguments: const std::string &filename: the catalogue file
+   * Modifies: Everything
+   * Returns: *this
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigCatalogue if the file cannot be read, was
+   *     written by an incompatible version, or is corrupt (e.g. a string
+   *     offset past the end of the pool)
+   * Notes: A missing file loads as an empty catalogue, so that the first
+   *    refresh() builds it. The file is memory mapped and used in place;
+   *    only the string offsets of the entries are checked.
+   */
+  svcsigcatalogue& load( const std::string &filename );
+
+  /* Name: void save( const std::string &filename ) const
+   *
+   * Description: Saves the catalogue
+   * Arguments: const std::string &filename: the catalogue file
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigCatalogue if the file cannot be written
+   * Notes: The catalogue is written to filename.tmp and renamed, so readers
+   *    never see a partial file
+   */
+  void save( const std::string &filename ) const;
+
+  /* Name: size_t refresh( const std::string &directory, const unsigned int &threads )
+   *
+   * Description: Brings the catalogue up to date with a directory tree
+   * Arguments: const std::string &directory: the root of the tree
+   *            const unsigned int &threads: the number of threads (0 for one
+   *                per core)
+   * Modifies: Everything
+   * Returns: The number of files that were parsed
+   * Pre:
+   * Post: The catalogue holds exactly the sig files in the tree, sorted by
+   *     path
+   * Exceptions:
+   * Notes: Files whose header can not be parsed are left out, as in
+   *    refresh( filenames )
+   */
+  size_t refresh( const std::string &directory, const unsigned int &threads = 0 );
+
+  /* Name: size_t refresh( const std::vector<std::string> &filenames, const unsigned int &threads )
+   *
+   * Description: Brings the catalogue up to date with a list of files
+   * Arguments: const std::vector<std::string> &filenames: the sig files
+   *            const unsigned int &threads: the number of threads (0 for one
+   *                per core)
+   * Modifies: Everything
+   * Returns: The number of files that were parsed
+   * Pre:
+   * Post: The catalogue holds exactly the files that exist and have a valid
+   *     header, in the order given
+   * Exceptions:
+   * Notes: Files whose size and modification time match their entry are kept
+   *    without being opened. Only the headers of changed files are parsed.
+   *    Files whose header can not be parsed get no entry, so they are parsed
+   *    again (and counted) at every refresh until they are fixed.
+   */
+  size_t refresh( const std::vector<std::string> &filenames, const unsigned int &threads = 0 );
+
+  /* Name: size_t size() const
+   *
+   * Description: Returns the number of files in the catalogue
+   * Arguments:
+   * Modifies:
+   * Returns: size_t
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  size_t size() const;
+
+  /* Name: const svcsigcatalogueentry & entry( const size_t &i ) const
+   *
+   * Description: Returns the raw record of a file
+   * Arguments: const size_t &i: the file
+   * Modifies:
+   * Returns: const svcsigcatalogueentry &
+   * Pre: i < size()
+   * Post:
+   * Exceptions:
+   * Notes: This is the fast way to scan the catalogue. Use string() to look up
+   *    the string fields.
+   */
+  const svcsigcatalogueentry & entry( const size_t &i ) const;
+
+  /* Name: const char * string( const uint32_t &offset ) const
+   *
+   * Description: Looks up a string field of an entry
+   * Arguments: const uint32_t &offset: the field
+   * Modifies:
+   * Returns: const char * (null terminated)
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  const char * string( const uint32_t &offset ) const;
+
+  /* Name: std::string path( const size_t &i ) const
+   *
+   * Description: Returns the path of a file
+   * Arguments: const size_t &i: the file
+   * Modifies:
+   * Returns: std::string
+   * Pre: i < size()
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  std::string path( const size_t &i ) const;
+
+  /* Name: svcsigcommonheader commonHeader( const size_t &i ) const
+   *
+   * Description: Rebuilds the common header of a file
+   * Arguments: const size_t &i: the file
+   * Modifies:
+   * Returns: svcsigcommonheader
+   * Pre: i < size()
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  svcsigcommonheader commonHeader( const size_t &i ) const;
+
+  /* Name: svcsigspectraheader referenceHeader( const size_t &i ) const
+   *
+   * Description: Rebuilds the reference spectra header of a file
+   * Arguments: const size_t &i: the file
+   * Modifies:
+   * Returns: svcsigspectraheader
+   * Pre: i < size()
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  svcsigspectraheader referenceHeader( const size_t &i ) const;
+
+  /* Name: svcsigspectraheader targetHeader( const size_t &i ) const
+   *
+   * Description: Rebuilds the target spectra header of a file
+   * Arguments: const size_t &i: the file
+   * Modifies:
+   * Returns: svcsigspectraheader
+   * Pre: i < size()
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  svcsigspectraheader targetHeader( const size_t &i ) const;
+};
+
+
+// --- --- Implimentation --- --- //
+
+// -- -- Constructors -- -- //
+svcsigcatalogue::svcsigcatalogue()
+{
+  _map = NULL;
+  _mapSize = 0;
+  std::vector<svcsigcatalogueentry> entries;
+  std::vector<char> pool( 1, '\0' );
+  svcSigCatalogueUse( entries, pool );
+}
+
+// -- -- Destructor -- -- //
+svcsigcatalogue::~svcsigcatalogue()
+{
+  if ( _map != NULL ) {
+    munmap( _map, _mapSize );
+  }
+}
+
+// -- -- IO -- -- //
+svcsigcatalogue& svcsigcatalogue::load( const std::string &filename )
+{
+  std::vector<svcsigcatalogueentry> entries;
+  std::vector<char> pool( 1, '\0' );
+  svcSigCatalogueUse( entries, pool );
+
+  int fd( ::open( filename.c_str(), O_RDONLY ) );
+  if ( fd < 0 ) {
+    return *this;
+  }
+
+  struct stat st;
+  if ( fstat( fd, &st ) != 0 || size_t( st.st_size ) < sizeof( svcsigcatalogueheader ) ) {
+    ::close( fd );
+    throw invalidSVCsigCatalogue( "'" + filename + "' is not a catalogue" );
+  }
+  void *map( mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 ) );
+  ::close( fd );
+  if ( map == MAP_FAILED ) {
+    throw invalidSVCsigCatalogue( "could not map '" + filename + "'" );
+  }
+
+  const svcsigcatalogueheader *header( static_cast<const svcsigcatalogueheader *>( map ) );
+  std::string problem;
+  if ( memcmp( header->magic, SVCSIG_CATALOGUE_MAGIC, 8 ) != 0 ) {
+    problem = "is not a catalogue";
+  }
+  else if ( header->version != SVCSIG_CATALOGUE_VERSION || header->recordSize != sizeof( svcsigcatalogueentry ) ) {
+    problem = "was written by an incompatible version";
+  }
+  else if ( header->count > size_t( st.st_size ) / sizeof( svcsigcatalogueentry ) || header->poolSize == 0 || size_t( st.st_size ) != sizeof( svcsigcatalogueheader ) + header->count * sizeof( svcsigcatalogueentry ) + header->poolSize ) {
+    problem = "is truncated";
+  }
+  if ( problem.size() > 0 ) {
+    munmap( map, st.st_size );
+    throw invalidSVCsigCatalogue( "'" + filename + "' " + problem );
+  }
+
+  const char *base( static_cast<const char *>( map ) );
+  _map = map;
+  _mapSize = st.st_size;
+  _records = reinterpret_cast<const svcsigcatalogueentry *>( base + sizeof( svcsigcatalogueheader ) );
+  _count = header->count;
+  _strings = base + sizeof( svcsigcatalogueheader ) + _count * sizeof( svcsigcatalogueentry );
+  bool valid( _strings[ header->poolSize - 1 ] == '\0' );
+  for ( size_t i = 0; i < _count && valid; i++ ) {
+    valid = svcSigCatalogueValid( _records[ i ], header->poolSize );
+  }
+  if ( !valid ) {
+    std::vector<svcsigcatalogueentry> none;
+    std::vector<char> empty( 1, '\0' );
+    svcSigCatalogueUse( none, empty );
+    throw invalidSVCsigCatalogue( "'" + filename + "' is corrupt" );
+  }
+  return *this;
+}
+
+void svcsigcatalogue::save( const std::string &filename ) const
+{
+  std::string tmp( filename + ".tmp" );
+  FILE *output( fopen( tmp.c_str(), "wb" ) );
+  if ( output == NULL ) {
+    throw invalidSVCsigCatalogue( "could not write '" + tmp + "'" );
+  }
+
+  // the pool ends with the last null terminator
+  size_t poolSize( 1 );
+  if ( _map != NULL ) {
+    poolSize = _mapSize - sizeof( svcsigcatalogueheader ) - _count * sizeof( svcsigcatalogueentry );
+  }
+  else {
+    poolSize = _pool.size();
+  }
+
+  svcsigcatalogueheader header;
+  memset( &header, 0, sizeof( header ) );
+  memcpy( header.magic, SVCSIG_CATALOGUE_MAGIC, 8 );
+  header.version = SVCSIG_CATALOGUE_VERSION;
+  header.recordSize = sizeof( svcsigcatalogueentry );
+  header.count = _count;
+  header.poolSize = poolSize;
+
+  bool good( fwrite( &header, sizeof( header ), 1, output ) == 1 );
+  if ( good && _count > 0 ) {
+    good = fwrite( _records, sizeof( svcsigcatalogueentry ), _count, output ) == _count;
+  }
+  if ( good ) {
+    good = fwrite( _strings, 1, poolSize, output ) == poolSize;
+  }
+  good = ( fclose( output ) == 0 ) && good;
+
+  if ( !good || rename( tmp.c_str(), filename.c_str() ) != 0 ) {
+    remove( tmp.c_str() );
+    throw invalidSVCsigCatalogue( "could not write '" + filename + "'" );
+  }
+}
+
+// -- -- Refresh -- -- //
+size_t svcsigcatalogue::refresh( const std::string &directory, const unsigned int &threads )
+{
+  std::vector<std::string> filenames;
+  svcSigCatalogueScan( directory, filenames );
+  std::sort( filenames.begin(), filenames.end() );
+  return refresh( filenames, threads );
+}
+
+size_t svcsigcatalogue::refresh( const std::vector<std::string> &filenames, const unsigned int &threads )
+{
+  size_t i, j;
+  size_t n( filenames.size() );
+
+  // the current entries by path
+  std::unordered_map<std::string, size_t> current;
+  current.reserve( _count );
+  for ( i = 0; i < _count; i++ ) {
+    current[ string( _records[ i ].path ) ] = i;
+  }
+
+  // stat everything (this is most of the work of a refresh with no changes)
+  std::vector<svcsigcatalogueentry> entries( n );
+  std::vector<char> exists( n, 0 );
+  svcSigParallelFor( n, threads, [&]( size_t k, unsigned int ) {
+    struct stat st;
+    if ( stat( filenames[ k ].c_str(), &st ) == 0 && S_ISREG( st.st_mode ) ) {
+      memset( &entries[ k ], 0, sizeof( svcsigcatalogueentry ) );
+      entries[ k ].size = st.st_size;
+      entries[ k ].mtime = int64_t( st.st_mtim.tv_sec ) * 1000000000 + st.st_mtim.tv_nsec;
+      exists[ k ] = 1;
+    }
+  } );
+
+  std::vector<char> pool( 1, '\0' );
+  svcSigCatalogueIndex index;
+  index[ "" ] = 0;
+
+  // keep unchanged entries, collect changed ones
+  std::vector<size_t> changed;
+  for ( i = 0; i < n; i++ ) {
+    if ( !exists[ i ] ) {
+      continue;
+    }
+    std::unordered_map<std::string, size_t>::const_iterator it( current.find( filenames[ i ] ) );
+    if ( it != current.end() && _records[ it->second ].size == entries[ i ].size && _records[ it->second ].mtime == entries[ i ].mtime ) {
+      entries[ i ] = _records[ it->second ];
+      svcSigCatalogueMove( entries[ i ], pool, index );
+    }
+    else {
+      changed.push_back( i );
+      entries[ i ].path = svcSigCatalogueIntern( filenames[ i ], pool, index );
+    }
+  }
+
+  // parse the headers of the changed files, a chunk at a time; files that
+  // do not parse are dropped like missing ones
+  static const svcsigcatalogueall all;
+  std::vector<svcsig> sigs;
+  std::vector<char> parsed;
+  for ( i = 0; i < changed.size(); i += SVCSIG_CATALOGUE_CHUNK ) {
+    size_t chunk( std::min( changed.size() - i, size_t( SVCSIG_CATALOGUE_CHUNK ) ) );
+    sigs.assign( chunk, svcsig() );
+    parsed.assign( chunk, 0 );
+    svcSigParallelFor( chunk, threads, [&]( size_t k, unsigned int ) {
+      parsed[ k ] = sigs[ k ].read( filenames[ changed[ i + k ] ], all, false );
+    } );
+    for ( j = 0; j < chunk; j++ ) {
+      if ( parsed[ j ] ) {
+        svcSigCatalogueFill( sigs[ j ], entries[ changed[ i + j ] ], pool, index );
+      }
+      else {
+        exists[ changed[ i + j ] ] = 0;
+      }
+    }
+  }
+
+  // drop the files that no longer exist (or did not parse)
+  j = 0;
+  for ( i = 0; i < n; i++ ) {
+    if ( exists[ i ] ) {
+      entries[ j++ ] = entries[ i ];
+    }
+  }
+  entries.resize( j );
+
+  svcSigCatalogueUse( entries, pool );
+  return changed.size();
+}
+
+// -- -- Getters -- -- //
+size_t svcsigcatalogue::size() const
+{
+  return _count;
+}
+
+const svcsigcatalogueentry & svcsigcatalogue::entry( const size_t &i ) const
+{
+  return _records[ i ];
+}
+
+const char * svcsigcatalogue::string( const uint32_t &offset ) const
+{
+  return _strings + offset;
+}
+
+std::string svcsigcatalogue::path( const size_t &i ) const
+{
+  return string( _records[ i ].path );
+}
+
+svcsigcommonheader svcsigcatalogue::commonHeader( const size_t &i ) const
+{
+  const svcsigcatalogueentry &e( _records[ i ] );
+  svcsigcommonheader header;
+  header._name = string( e.name );
+  header._instrumentModelNumber = string( e.instrumentModelNumber );
+  header._instrumentExtendedSerialNumber = string( e.instrumentExtendedSerialNumber );
+  header._instrumentCommonName = string( e.instrumentCommonName );
+  memcpy( header._externalDataDark, e.externalDataDark, sizeof( e.externalDataDark ) );
+  header._externalDataMask = e.externalDataMask;
+  header._comm = string( e.comm );
+  memcpy( header._factors, e.factors, sizeof( e.factors ) );
+  header._factorsComment = string( e.factorsComment );
+  return header;
+}
+
+svcsigspectraheader svcsigcatalogue::referenceHeader( const size_t &i ) const
+{
+  return svcSigCatalogueSpectraHeader( _records[ i ].reference );
+}
+
+svcsigspectraheader svcsigcatalogue::targetHeader( const size_t &i ) const
+{
+  return svcSigCatalogueSpectraHeader( _records[ i ].target );
+}
+
+// -- -- Helper Functions -- -- //
+void svcsigcatalogue::svcSigCatalogueUse( std::vector<svcsigcatalogueentry> &entries, std::vector<char> &pool )
+{
+  if ( _map != NULL ) {
+    munmap( _map, _mapSize );
+    _map = NULL;
+    _mapSize = 0;
+  }
+  _entries.swap( entries );
+  _pool.swap( pool );
+  _records = _entries.size() > 0 ? &_entries[ 0 ] : NULL;
+  _count = _entries.size();
+  _strings = &_pool[ 0 ];
+}
+
+uint32_t svcsigcatalogue::svcSigCatalogueIntern( const std::string &s, std::vector<char> &pool, svcSigCatalogueIndex &index ) const
+{
+  svcSigCatalogueIndex::const_iterator it( index.find( s ) );
+  if ( it != index.end() ) {
+    return it->second;
+  }
+  if ( pool.size() + s.size() + 1 > 0xffffffffu ) {
+    throw invalidSVCsigCatalogue( "string pool is full" );
+  }
+  uint32_t offset( pool.size() );
+  pool.insert( pool.end(), s.begin(), s.end() );
+  pool.push_back( '\0' );
+  index[ s ] = offset;
+  return offset;
+}
+
+void svcsigcatalogue::svcSigCatalogueFill( const svcsig &sig, svcsigcatalogueentry &entry, std::vector<char> &pool, svcSigCatalogueIndex &index ) const
+{
+  svcsigcommonheader c( sig.commonHeader() );
+  entry.name = svcSigCatalogueIntern( c._name, pool, index );
+  entry.instrumentModelNumber = svcSigCatalogueIntern( c._instrumentModelNumber, pool, index );
+  entry.instrumentExtendedSerialNumber = svcSigCatalogueIntern( c._instrumentExtendedSerialNumber, pool, index );
+  entry.instrumentCommonName = svcSigCatalogueIntern( c._instrumentCommonName, pool, index );
+  entry.comm = svcSigCatalogueIntern( c._comm, pool, index );
+  entry.factorsComment = svcSigCatalogueIntern( c._factorsComment, pool, index );
+  memcpy( entry.factors, c._factors, sizeof( entry.factors ) );
+  memcpy( entry.externalDataDark, c._externalDataDark, sizeof( entry.externalDataDark ) );
+  entry.externalDataMask = c._externalDataMask;
+  svcSigCatalogueFill( sig.referenceHeader(), entry.reference, pool, index );
+  svcSigCatalogueFill( sig.targetHeader(), entry.target, pool, index );
+}
+
+void svcsigcatalogue::svcSigCatalogueFill( const svcsigspectraheader &header, svcsigcataloguespectra &spectra, std::vector<char> &pool, svcSigCatalogueIndex &index ) const
+{
+  memcpy( spectra.integration, header._integration, sizeof( spectra.integration ) );
+  memcpy( spectra.scanCoadds, header._scanCoadds, sizeof( spectra.scanCoadds ) );
+  spectra.scanTime = header._scanTime;
+  memcpy( spectra.temp, header._temp, sizeof( spectra.temp ) );
+  spectra.battery = header._battery;
+  spectra.error = header._error;
+  spectra.memorySlot = header._memorySlot;
+  memcpy( spectra.externalDataSet1, header._externalDataSet1, sizeof( spectra.externalDataSet1 ) );
+  memcpy( spectra.externalDataSet2, header._externalDataSet2, sizeof( spectra.externalDataSet2 ) );
+  spectra.scanMethod = svcSigCatalogueIntern( header._scanMethod, pool, index );
+  spectra.scanSettings = svcSigCatalogueIntern( header._scanSettings, pool, index );
+  spectra.optic = svcSigCatalogueIntern( header._optic, pool, index );
+  spectra.units = svcSigCatalogueIntern( header._units, pool, index );
+  spectra.time = svcSigCatalogueIntern( header._time, pool, index );
+  spectra.epoch = header._epoch;
+  spectra.longitude = svcSigCatalogueIntern( header._longitude, pool, index );
+  spectra.latitude = svcSigCatalogueIntern( header._latitude, pool, index );
+  spectra.gpstime = svcSigCatalogueIntern( header._gpstime, pool, index );
+  spectra.decodedLongitude = header._decodedLongitude;
+  spectra.decodedLatitude = header._decodedLatitude;
+  spectra.decodedGpstime = header._decodedGpstime;
+}
+
+void svcsigcatalogue::svcSigCatalogueMove( svcsigcatalogueentry &entry, std::vector<char> &pool, svcSigCatalogueIndex &index ) const
+{
+  entry.path = svcSigCatalogueIntern( string( entry.path ), pool, index );
+  entry.name = svcSigCatalogueIntern( string( entry.name ), pool, index );
+  entry.instrumentModelNumber = svcSigCatalogueIntern( string( entry.instrumentModelNumber ), pool, index );
+  entry.instrumentExtendedSerialNumber = svcSigCatalogueIntern( string( entry.instrumentExtendedSerialNumber ), pool, index );
+  entry.instrumentCommonName = svcSigCatalogueIntern( string( entry.instrumentCommonName ), pool, index );
+  entry.comm = svcSigCatalogueIntern( string( entry.comm ), pool, index );
+  entry.factorsComment = svcSigCatalogueIntern( string( entry.factorsComment ), pool, index );
+  svcSigCatalogueMove( entry.reference, pool, index );
+  svcSigCatalogueMove( entry.target, pool, index );
+}
+
+void svcsigcatalogue::svcSigCatalogueMove( svcsigcataloguespectra &spectra, std::vector<char> &pool, svcSigCatalogueIndex &index ) const
+{
+  spectra.scanMethod = svcSigCatalogueIntern( string( spectra.scanMethod ), pool, index );
+  spectra.scanSettings = svcSigCatalogueIntern( string( spectra.scanSettings ), pool, index );
+  spectra.optic = svcSigCatalogueIntern( string( spectra.optic ), pool, index );
+  spectra.units = svcSigCatalogueIntern( string( spectra.units ), pool, index );
+  spectra.time = svcSigCatalogueIntern( string( spectra.time ), pool, index );
+  spectra.longitude = svcSigCatalogueIntern( string( spectra.longitude ), pool, index );
+  spectra.latitude = svcSigCatalogueIntern( string( spectra.latitude ), pool, index );
+  spectra.gpstime = svcSigCatalogueIntern( string( spectra.gpstime ), pool, index );
+}
+
+bool svcsigcatalogue::svcSigCatalogueValid( const svcsigcatalogueentry &entry, const uint64_t &poolSize ) const
+{
+  const uint32_t offsets[ 7 ] = { entry.path, entry.name, entry.instrumentModelNumber, entry.instrumentExtendedSerialNumber,
+    entry.instrumentCommonName, entry.comm, entry.factorsComment };
+  for ( size_t i = 0; i < 7; i++ ) {
+    if ( offsets[ i ] >= poolSize ) {
+      return false;
+    }
+  }
+  return svcSigCatalogueValid( entry.reference, poolSize ) && svcSigCatalogueValid( entry.target, poolSize );
+}
+
+bool svcsigcatalogue::svcSigCatalogueValid( const svcsigcataloguespectra &spectra, const uint64_t &poolSize ) const
+{
+  const uint32_t offsets[ 8 ] = { spectra.scanMethod, spectra.scanSettings, spectra.optic, spectra.units,
+    spectra.time, spectra.longitude, spectra.latitude, spectra.gpstime };
+  for ( size_t i = 0; i < 8; i++ ) {
+    if ( offsets[ i ] >= poolSize ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+svcsigspectraheader svcsigcatalogue::svcSigCatalogueSpectraHeader( const svcsigcataloguespectra &spectra ) const
+{
+  svcsigspectraheader header;
+  memcpy( header._integration, spectra.integration, sizeof( spectra.integration ) );
+  memcpy( header._scanCoadds, spectra.scanCoadds, sizeof( spectra.scanCoadds ) );
+  header._scanTime = spectra.scanTime;
+  memcpy( header._temp, spectra.temp, sizeof( spectra.temp ) );
+  header._battery = spectra.battery;
+  header._error = spectra.error;
+  header._memorySlot = spectra.memorySlot;
+  memcpy( header._externalDataSet1, spectra.externalDataSet1, sizeof( spectra.externalDataSet1 ) );
+  memcpy( header._externalDataSet2, spectra.externalDataSet2, sizeof( spectra.externalDataSet2 ) );
+  header._scanMethod = string( spectra.scanMethod );
+  header._scanSettings = string( spectra.scanSettings );
+  header._optic = string( spectra.optic );
+  header._units = string( spectra.units );
+  header._time = string( spectra.time );
+  header._epoch = spectra.epoch;
+  header._longitude = string( spectra.longitude );
+  header._latitude = string( spectra.latitude );
+  header._gpstime = string( spectra.gpstime );
+  header._decodedLongitude = spectra.decodedLongitude;
+  header._decodedLatitude = spectra.decodedLatitude;
+  header._decodedGpstime = spectra.decodedGpstime;
+  return header;
+}
+
+void svcsigcatalogue::svcSigCatalogueScan( const std::string &directory, std::vector<std::string> &filenames ) const
+{
+  DIR *dir( opendir( directory.c_str() ) );
+  if ( dir == NULL ) {
+    return;
+  }
+
+  struct dirent *item;
+  while ( ( item = readdir( dir ) ) != NULL ) {
+    std::string name( item->d_name );
+    if ( name.compare( "." ) == 0 || name.compare( ".." ) == 0 ) {
+      continue;
+    }
+    std::string path( directory + "/" + name );
+
+    bool isDirectory( item->d_type == DT_DIR );
+    bool isFile( item->d_type == DT_REG );
+    if ( item->d_type == DT_UNKNOWN || item->d_type == DT_LNK ) {
+      struct stat st;
+      if ( stat( path.c_str(), &st ) == 0 ) {
+        isDirectory = S_ISDIR( st.st_mode ) && item->d_type != DT_LNK;
+        isFile = S_ISREG( st.st_mode );
+      }
+    }
+
+    if ( isDirectory ) {
+      svcSigCatalogueScan( path, filenames );
+    }
+    else if ( isFile ) {
+      size_t loc( name.rfind( ".sig" ) );
+      if ( loc != std::string::npos ) {
+        std::string extension( name.substr( loc ) );
+        if ( extension.compare( ".sig" ) == 0 || extension.compare( ".sig.gz" ) == 0 || extension.compare( ".sig.zst" ) == 0 ) {
+          filenames.push_back( path );
+        }
+      }
+    }
+  }
+  closedir( dir );
+}
+
+#endif // __svcsigcatalogue_hpp_
@@ -6,6 +6,7 @@
  *
  * HISTORY:
  *    2013-08-04: Written by Paul Romanczyk (RIT)
+ *    2026-10-18: svcsigcatalogue may rebuild headers
  *
  * REFERENCES:
  *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
@@ -111,6 +112,7 @@ public:
   std::string factorsComment() const;
   
   friend class svcsig;
+  friend class svcsigcatalogue;
 };
 
 
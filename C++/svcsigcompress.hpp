@@ -0,0 +1,300 @@
+/*******************************************************************************
+ * svcsigcompress.hpp
+ *
+ * DESCRIPTION:
+ *    Provides streaming decompression of gzip and zstd compressed SVC sig files
+ *    so that they can be parsed without a temporary file
+ *
+ *    Support is optional and chosen at build time:
+ *      -DSVCSIG_USE_ZLIB (link with -lz) for .sig.gz
+ *      -DSVCSIG_USE_ZSTD (link with -lzstd) for .sig.zst
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *   RFC 1952 (gzip), RFC 8878 (zstd)
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsigcompress_hpp_
+#define __svcsigcompress_hpp_
+
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#ifdef SVCSIG_USE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef SVCSIG_USE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "svcsighelper.hpp"
+
+#define SVCSIG_COMPRESS_NONE 0
+#define SVCSIG_COMPRESS_GZIP 1
+#define SVCSIG_COMPRESS_ZSTD 2
+
+// the size of the compressed and decompressed chunks
+#define SVCSIG_COMPRESS_CHUNK 65536
+
+
+/* Name: int svcSigDetectCompression( const char *magic, const size_t &size )
+ *
+ * Description: Detects the compression of a file from its first bytes
+ * Arguments: const char *magic: the first bytes of the file
+ *            const size_t &size: the number of bytes in magic (4 is enough)
+ * Modifies:
+ * Returns: SVCSIG_COMPRESS_NONE, SVCSIG_COMPRESS_GZIP or SVCSIG_COMPRESS_ZSTD
+ * Pre:
+ * Post:
+ * Exceptions:
+ * Notes: This works whether or not support for the compression is compiled in
+ */
+int svcSigDetectCompression( const char *magic, const size_t &size )
+{
+  const unsigned char *m( reinterpret_cast<const unsigned char *>( magic ) );
+  if ( size >= 2 && m[ 0 ] == 0x1f && m[ 1 ] == 0x8b ) {
+    return SVCSIG_COMPRESS_GZIP;
+  }
+  if ( size >= 4 && m[ 0 ] == 0x28 && m[ 1 ] == 0xb5 && m[ 2 ] == 0x2f && m[ 3 ] == 0xfd ) {
+    return SVCSIG_COMPRESS_ZSTD;
+  }
+  return SVCSIG_COMPRESS_NONE;
+}
+
+
+#ifdef SVCSIG_USE_ZLIB
+/* Name: svcsiggzbuf
+ *
+ * Description: A read only std::streambuf that inflates a gzip stream read from
+ *    another std::streambuf, one chunk at a time
+ * Notes: Concatenated gzip members are decoded as one stream. Errors are
+ *    reported to std::cerr and end the stream, as with the other read errors.
+ */
+class svcsiggzbuf : public std::streambuf {
+private:
+  std::streambuf *_source;
+  z_stream _z;
+  std::vector<char> _in;
+  std::vector<char> _out;
+  bool _done;
+
+  svcsiggzbuf( const svcsiggzbuf &other );
+  svcsiggzbuf& operator=( const svcsiggzbuf &other );
+protected:
+  int_type underflow();
+public:
+  svcsiggzbuf( std::streambuf *source );
+  ~svcsiggzbuf();
+};
+
+svcsiggzbuf::svcsiggzbuf( std::streambuf *source )
+: _source( source ), _in( SVCSIG_COMPRESS_CHUNK ), _out( SVCSIG_COMPRESS_CHUNK ), _done( false )
+{
+  _z.zalloc = Z_NULL;
+  _z.zfree = Z_NULL;
+  _z.opaque = Z_NULL;
+  _z.next_in = Z_NULL;
+  _z.avail_in = 0;
+  // 15 + 16: 32 KB window, gzip wrapper only
+  if ( inflateInit2( &_z, 15 + 16 ) != Z_OK ) {
+    std::cerr << "svcsiggzbuf: inflateInit2 failed" << std::endl;
+    _done = true;
+  }
+  setg( &_out[ 0 ], &_out[ 0 ], &_out[ 0 ] );
+}
+
+svcsiggzbuf::~svcsiggzbuf()
+{
+  inflateEnd( &_z );
+}
+
+svcsiggzbuf::int_type svcsiggzbuf::underflow()
+{
+  if ( gptr() < egptr() ) {
+    return traits_type::to_int_type( *gptr() );
+  }
+
+  while ( !_done ) {
+    if ( _z.avail_in == 0 ) {
+      std::streamsize n( _source->sgetn( &_in[ 0 ], _in.size() ) );
+      if ( n <= 0 ) {
+        _done = true;
+        break;
+      }
+      _z.next_in = reinterpret_cast<Bytef *>( &_in[ 0 ] );
+      _z.avail_in = n;
+    }
+
+    _z.next_out = reinterpret_cast<Bytef *>( &_out[ 0 ] );
+    _z.avail_out = _out.size();
+    int status( inflate( &_z, Z_NO_FLUSH ) );
+    if ( status == Z_STREAM_END ) {
+      // there may be another gzip member
+      inflateReset( &_z );
+    }
+    else if ( status != Z_OK && status != Z_BUF_ERROR ) {
+      std::cerr << "svcsiggzbuf: corrupt gzip data" << std::endl;
+      _done = true;
+    }
+
+    size_t have( _out.size() - _z.avail_out );
+    if ( have > 0 ) {
+      setg( &_out[ 0 ], &_out[ 0 ], &_out[ 0 ] + have );
+      return traits_type::to_int_type( *gptr() );
+    }
+  }
+  return traits_type::eof();
+}
+#endif // SVCSIG_USE_ZLIB
+
+
+#ifdef SVCSIG_USE_ZSTD
+/* Name: svcsigzstdbuf
+ *
+ * Description: A read only std::streambuf that decompresses a zstd stream read
+ *    from another std::streambuf, one chunk at a time
+ * Notes: Errors are reported to std::cerr and end the stream
+ */
+class svcsigzstdbuf : public std::streambuf {
+private:
+  std::streambuf *_source;
+  ZSTD_DStream *_z;
+  ZSTD_inBuffer _zin;
+  std::vector<char> _in;
+  std::vector<char> _out;
+  bool _done;
+
+  svcsigzstdbuf( const svcsigzstdbuf &other );
+  svcsigzstdbuf& operator=( const svcsigzstdbuf &other );
+protected:
+  int_type underflow();
+public:
+  svcsigzstdbuf( std::streambuf *source );
+  ~svcsigzstdbuf();
+};
+
+svcsigzstdbuf::svcsigzstdbuf( std::streambuf *source )
+: _source( source ), _in( ZSTD_DStreamInSize() ), _out( ZSTD_DStreamOutSize() ), _done( false )
+{
+  _z = ZSTD_createDStream();
+  if ( _z == NULL || ZSTD_isError( ZSTD_initDStream( _z ) ) ) {
+    std::cerr << "svcsigzstdbuf: ZSTD_initDStream failed" << std::endl;
+    _done = true;
+  }
+  _zin.src = &_in[ 0 ];
+  _zin.size = 0;
+  _zin.pos = 0;
+  setg( &_out[ 0 ], &_out[ 0 ], &_out[ 0 ] );
+}
+
+svcsigzstdbuf::~svcsigzstdbuf()
+{
+  ZSTD_freeDStream( _z );
+}
+
+svcsigzstdbuf::int_type svcsigzstdbuf::underflow()
+{
+  if ( gptr() < egptr() ) {
+    return traits_type::to_int_type( *gptr() );
+  }
+
+  while ( !_done ) {
+    if ( _zin.pos == _zin.size ) {
+      std::streamsize n( _source->sgetn( &_in[ 0 ], _in.size() ) );
+      if ( n <= 0 ) {
+        _done = true;
+        break;
+      }
+      _zin.size = n;
+      _zin.pos = 0;
+    }
+
+    ZSTD_outBuffer zout = { &_out[ 0 ], _out.size(), 0 };
+    size_t status( ZSTD_decompressStream( _z, &zout, &_zin ) );
+    if ( ZSTD_isError( status ) ) {
+      std::cerr << "svcsigzstdbuf: " << ZSTD_getErrorName( status ) << std::endl;
+      _done = true;
+    }
+
+    if ( zout.pos > 0 ) {
+      setg( &_out[ 0 ], &_out[ 0 ], &_out[ 0 ] + zout.pos );
+      return traits_type::to_int_type( *gptr() );
+    }
+  }
+  return traits_type::eof();
+}
+#endif // SVCSIG_USE_ZSTD
+
+
+/* Name: std::streambuf * svcSigDecompressBuf( std::streambuf *source, const char *magic, const size_t &size )
+ *
+ * Description: Wraps source in a decompressing std::streambuf if its magic
+ *    bytes show it is compressed
+ * Arguments: std::streambuf *source: the (possibly) compressed data
+ *            const char *magic: the first bytes of source
+ *            const size_t &size: the number of bytes in magic
+ * Modifies:
+ * Returns: A new std::streambuf (it is up to the user to delete it), or NULL if
+ *    source is not compressed
+ * Pre: source is positioned at its start
+ * Post:
+ * Exceptions: notSvcSigFile if source is compressed, but support for that
+ *    compression was not compiled in
+ * Notes:
+ */
+std::streambuf * svcSigDecompressBuf( std::streambuf *source, const char *magic, const size_t &size )
+{
+#if !defined( SVCSIG_USE_ZLIB ) && !defined( SVCSIG_USE_ZSTD )
+  ( void ) source;
+#endif
+  switch ( svcSigDetectCompression( magic, size ) ) {
+    case SVCSIG_COMPRESS_GZIP:
+#ifdef SVCSIG_USE_ZLIB
+      return new svcsiggzbuf( source );
+#else
+      throw notSvcSigFile( "gzip input needs a build with -DSVCSIG_USE_ZLIB" );
+#endif
+    case SVCSIG_COMPRESS_ZSTD:
+#ifdef SVCSIG_USE_ZSTD
+      return new svcsigzstdbuf( source );
+#else
+      throw notSvcSigFile( "zstd input needs a build with -DSVCSIG_USE_ZSTD" );
+#endif
+    default:
+      return NULL;
+  }
+}
+
+#endif // __svcsigcompress_hpp_
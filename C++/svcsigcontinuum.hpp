@@ -0,0 +1,417 @@
+/*******************************************************************************
+ * svcsigcontinuum.hpp
+ *
+ * DESCRIPTION:
+ *    Provides header and implimentation for continuum removal, and for the
+ *    svcsigcontinuum class, which measures absorption features (e.g. the
+ *    water bands at 1450 and 1940 nm and the Al-OH band at 2200 nm) of sig
+ *    file reflectance: their band depth, position, width and area.
+ *
+ *    The continuum is the upper convex hull of the spectrum, found in linear
+ *    time with a monotone chain because the wavelengths are already in
+ *    order. Sig files are spliced first (see svcsigsplice.hpp), so their
+ *    overlapping detector segments give one ascending spectrum. Each feature
+ *    has its own continuum, the hull of the bands in its window.
+ *
+ *    Build with -pthread.
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *    2026-10-18: apply( sigs ) looks up one splicer per grid
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *   R. N. Clark, T. L. Roush, "Reflectance Spectroscopy: Quantitative
+ *     Analysis Techniques for Remote Sensing Applications", JGR 89(B7), 1984
+ *   A. M. Andrew, "Another Efficient Algorithm for Convex Hulls in Two
+ *     Dimensions", Information Processing Letters 9(5), 1979
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsigcontinuum_hpp_
+#define __svcsigcontinuum_hpp_
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "svcsighelper.hpp"
+#include "svcsig.hpp"
+#include "svcsigbatch.hpp"
+#include "svcsigsplice.hpp"
+
+
+// an absorption feature: the bands from left to right (nm)
+struct svcsigfeaturewindow {
+  std::string name;
+  double left;
+  double right;
+};
+
+// the measures of an absorption feature, NAN if it could not be measured
+struct svcsigfeaturevalues {
+  float depth; // 1 - the smallest continuum removed value
+  float position; // the wavelength of the smallest value (nm)
+  float width; // the full width at half depth (nm)
+  float area; // the integral of 1 - the continuum removed values (nm)
+};
+
+
+/* Name: void svcSigContinuum( const float *wavelength, const float *spectrum, const size_t &size, float *continuum )
+ *
+ * Description: The continuum (upper convex hull) of a spectrum
+ * Arguments: const float *wavelength: size ascending wavelengths
+ *            const float *spectrum: size values
+ *            const size_t &size: the number of bands
+ *            float *continuum: size values
+ * Modifies: continuum
+ * Returns:
+ * Pre: wavelength is strictly ascending
+ * Post: continuum >= spectrum, and touches it at the hull's vertices
+ * Exceptions:
+ * Notes: Linear time. NAN bands are left out of the hull, and are NAN.
+ */
+void svcSigContinuum( const float *wavelength, const float *spectrum, const size_t &size, float *continuum );
+
+/* Name: void svcSigContinuumRemoved( const float *wavelength, const float *spectrum, const size_t &size, float *removed )
+ *
+ * Description: A spectrum divided by its continuum
+ * Arguments: See svcSigContinuum()
+ *            float *removed: size values, in [0, 1] for positive spectra
+ * Modifies: removed
+ * Notes: Bands with a continuum that is not positive are NAN
+ */
+void svcSigContinuumRemoved( const float *wavelength, const float *spectrum, const size_t &size, float *removed );
+
+
+class svcsigcontinuum {
+private:
+  std::vector<svcsigfeaturewindow> _windows;
+  svcsigspliceoptions _options;
+
+public:
+  /* Name: svcsigcontinuum( const svcsigspliceoptions &options )
+   *
+   * Description: Constructs an engine with the 1450, 1940 and 2200 nm
+   *    features
+   * Arguments: const svcsigspliceoptions &options: how sig files are spliced
+   */
+  svcsigcontinuum( const svcsigspliceoptions &options = svcsigspliceoptions() );
+  
+  /* Name: svcsigcontinuum& clear()
+   *
+   * Description: Removes the features
+   */
+  svcsigcontinuum& clear();
+  
+  /* Name: svcsigcontinuum& add( const std::string &name, const double &left, const double &right )
+   *
+   * Description: Adds a feature
+   * Arguments: const std::string &name: the name of the feature
+   *            const double &left, &right: its window (nm)
+   * Modifies: The features
+   * Returns: *this
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigContinuum if left is not below right
+   * Notes:
+   */
+  svcsigcontinuum& add( const std::string &name, const double &left, const double &right );
+  
+  /* Name: getters
+   *
+   * Description: size() is the number of features and window( i ) feature i
+   */
+  size_t size() const;
+  const svcsigfeaturewindow & window( const size_t &i ) const;
+  
+  /* Name: void apply( const float *wavelength, const float *spectrum, const size_t &bands, svcsigfeaturevalues *out ) const
+   *
+   * Description: Measures the features of a spectrum
+   * Arguments: const float *wavelength: bands ascending wavelengths
+   *            const float *spectrum: bands values
+   *            const size_t &bands: the number of bands
+   *            svcsigfeaturevalues *out: size() measures
+   * Modifies: out
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Features with fewer than 3 bands in their window are NAN. The
+   *    position is refined with a parabola through the smallest value and
+   *    its neighbours.
+   */
+  void apply( const float *wavelength, const float *spectrum, const size_t &bands, svcsigfeaturevalues *out ) const;
+  
+  /* Name: std::vector<svcsigfeaturevalues> apply( const svcsig &sig ) const
+   *
+   * Description: Measures the features of the spliced target reflectance of
+   *    a sig file
+   * Returns: std::vector<svcsigfeaturevalues>, size() measures
+   */
+  std::vector<svcsigfeaturevalues> apply( const svcsig &sig ) const;
+  
+  /* Name: std::vector<svcsigfeaturevalues> apply( const std::vector<svcsig> &sigs, const unsigned int &threads ) const
+   *
+   * Description: Measures the features of many sig files
+   * Arguments: const std::vector<svcsig> &sigs: the sig files
+   *            const unsigned int &threads: the number of threads (0 for one
+   *                per core)
+   * Modifies:
+   * Returns: std::vector<svcsigfeaturevalues>, sigs.size() rows of size()
+   *    measures
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Files are grouped by grid (svcSigGroupByGrid()) and the splicer
+   *    of each grid is looked up once. Empty files give NAN measures.
+   */
+  std::vector<svcsigfeaturevalues> apply( const std::vector<svcsig> &sigs, const unsigned int &threads = 0 ) const;
+  
+  /* Name: std::vector<float> removed( const svcsig &sig, std::vector<float> &wavelength ) const
+   *
+   * Description: The continuum removed spliced target reflectance of a sig
+   *    file, over its whole range
+   * Arguments: const svcsig &sig: the sig file
+   *            std::vector<float> &wavelength: the spliced wavelengths
+   * Modifies: wavelength
+   * Returns: std::vector<float>
+   */
+  std::vector<float> removed( const svcsig &sig, std::vector<float> &wavelength ) const;
+};
+
+
+// --- --- Implimentation --- --- //
+
+// -- -- Continuum -- -- //
+void svcSigContinuum( const float *wavelength, const float *spectrum, const size_t &size, float *continuum )
+{
+  // the upper hull, left to right: drop the last vertex while it is on or
+  // below the line from the one before it to the new point
+  std::vector<size_t> hull;
+  for ( size_t i = 0; i < size; i++ ) {
+    if ( std::isnan( spectrum[ i ] ) ) {
+      continue;
+    }
+    while ( hull.size() >= 2 ) {
+      size_t a( hull[ hull.size() - 2 ] ), b( hull.back() );
+      double cross( ( double( wavelength[ b ] ) - wavelength[ a ] ) * ( double( spectrum[ i ] ) - spectrum[ a ] ) -
+        ( double( spectrum[ b ] ) - spectrum[ a ] ) * ( double( wavelength[ i ] ) - wavelength[ a ] ) );
+      if ( cross < 0.0 ) {
+        break;
+      }
+      hull.pop_back();
+    }
+    hull.push_back( i );
+  }
+  
+  // the hull at every band
+  size_t k( 0 );
+  for ( size_t i = 0; i < size; i++ ) {
+    if ( std::isnan( spectrum[ i ] ) || hull.empty() ) {
+      continuum[ i ] = NAN;
+      continue;
+    }
+    while ( k + 1 < hull.size() && hull[ k + 1 ] <= i ) {
+      k++;
+    }
+    if ( hull[ k ] == i || k + 1 == hull.size() ) {
+      continuum[ i ] = spectrum[ hull[ k ] ];
+      continue;
+    }
+    size_t a( hull[ k ] ), b( hull[ k + 1 ] );
+    double s( ( double( wavelength[ i ] ) - wavelength[ a ] ) / ( double( wavelength[ b ] ) - wavelength[ a ] ) );
+    continuum[ i ] = ( 1.0 - s ) * spectrum[ a ] + s * spectrum[ b ];
+  }
+}
+
+void svcSigContinuumRemoved( const float *wavelength, const float *spectrum, const size_t &size, float *removed )
+{
+  svcSigContinuum( wavelength, spectrum, size, removed );
+  for ( size_t i = 0; i < size; i++ ) {
+    removed[ i ] = removed[ i ] > 0.0f ? spectrum[ i ] / removed[ i ] : NAN;
+  }
+}
+
+// -- -- Constructors -- -- //
+svcsigcontinuum::svcsigcontinuum( const svcsigspliceoptions &options )
+: _options( options )
+{
+  add( "1450", 1350.0, 1550.0 );
+  add( "1940", 1820.0, 2080.0 );
+  add( "2200", 2120.0, 2280.0 );
+}
+
+// -- -- Features -- -- //
+svcsigcontinuum& svcsigcontinuum::clear()
+{
+  _windows.clear();
+  return *this;
+}
+
+svcsigcontinuum& svcsigcontinuum::add( const std::string &name, const double &left, const double &right )
+{
+  if ( !( left < right ) ) {
+    throw invalidSVCsigContinuum( "the window of feature '" + name + "' is empty" );
+  }
+  svcsigfeaturewindow window;
+  window.name = name;
+  window.left = left;
+  window.right = right;
+  _windows.push_back( window );
+  return *this;
+}
+
+// -- -- Getters -- -- //
+size_t svcsigcontinuum::size() const
+{
+  return _windows.size();
+}
+
+const svcsigfeaturewindow & svcsigcontinuum::window( const size_t &i ) const
+{
+  return _windows[ i ];
+}
+
+// -- -- Measurement -- -- //
+void svcsigcontinuum::apply( const float *wavelength, const float *spectrum, const size_t &bands, svcsigfeaturevalues *out ) const
+{
+  std::vector<float> removed;
+  for ( size_t f = 0; f < _windows.size(); f++ ) {
+    svcsigfeaturevalues &values( out[ f ] );
+    values.depth = values.position = values.width = values.area = NAN;
+    
+    const float *first( std::lower_bound( wavelength, wavelength + bands, float( _windows[ f ].left ) ) );
+    const float *last( std::upper_bound( wavelength, wavelength + bands, float( _windows[ f ].right ) ) );
+    size_t begin( first - wavelength ), n( last - first );
+    if ( last - first < 3 ) {
+      continue;
+    }
+    const float *x( wavelength + begin );
+    removed.resize( n );
+    svcSigContinuumRemoved( x, spectrum + begin, n, removed.data() );
+    
+    // the deepest point
+    size_t deepest( n );
+    for ( size_t i = 0; i < n; i++ ) {
+      if ( !std::isnan( removed[ i ] ) && ( deepest == n || removed[ i ] < removed[ deepest ] ) ) {
+        deepest = i;
+      }
+    }
+    if ( deepest == n ) {
+      continue;
+    }
+    values.depth = 1.0f - removed[ deepest ];
+    values.position = x[ deepest ];
+    if ( deepest > 0 && deepest + 1 < n && !std::isnan( removed[ deepest - 1 ] ) && !std::isnan( removed[ deepest + 1 ] ) ) {
+      // the vertex of the parabola through the three points
+      double x0( x[ deepest - 1 ] ), x1( x[ deepest ] ), x2( x[ deepest + 1 ] );
+      double y0( removed[ deepest - 1 ] ), y1( removed[ deepest ] ), y2( removed[ deepest + 1 ] );
+      double denominator( ( x1 - x0 ) * ( y1 - y2 ) - ( x1 - x2 ) * ( y1 - y0 ) );
+      if ( denominator != 0.0 ) {
+        double vertex( x1 - 0.5 * ( ( x1 - x0 ) * ( x1 - x0 ) * ( y1 - y2 ) - ( x1 - x2 ) * ( x1 - x2 ) * ( y1 - y0 ) ) / denominator );
+        if ( vertex > x0 && vertex < x2 ) {
+          values.position = vertex;
+        }
+      }
+    }
+    
+    // the width at half depth, interpolated on each side of the deepest point
+    float half( 1.0f - 0.5f * values.depth );
+    double leftEdge( x[ 0 ] ), rightEdge( x[ n - 1 ] );
+    for ( size_t i = deepest; i-- > 0; ) {
+      if ( removed[ i ] >= half ) {
+        leftEdge = x[ i ] + ( x[ i + 1 ] - x[ i ] ) * ( removed[ i ] - half ) / ( removed[ i ] - removed[ i + 1 ] );
+        break;
+      }
+    }
+    for ( size_t i = deepest + 1; i < n; i++ ) {
+      if ( removed[ i ] >= half ) {
+        rightEdge = x[ i - 1 ] + ( x[ i ] - x[ i - 1 ] ) * ( half - removed[ i - 1 ] ) / ( removed[ i ] - removed[ i - 1 ] );
+        break;
+      }
+    }
+    values.width = values.depth > 0.0f ? rightEdge - leftEdge : 0.0;
+    
+    // the area, by the trapezoid rule
+    double area( 0.0 );
+    for ( size_t i = 1; i < n; i++ ) {
+      if ( !std::isnan( removed[ i - 1 ] ) && !std::isnan( removed[ i ] ) ) {
+        area += 0.5 * ( 2.0 - removed[ i - 1 ] - removed[ i ] ) * ( x[ i ] - x[ i - 1 ] );
+      }
+    }
+    values.area = area;
+  }
+}
+
+std::vector<svcsigfeaturevalues> svcsigcontinuum::apply( const svcsig &sig ) const
+{
+  std::vector<svcsigfeaturevalues> out( _windows.size() );
+  std::shared_ptr<const svcsigsplicer> splicer( svcSigSplicer( sig.wavelength(), _options ) );
+  std::vector<float> spliced( splicer->apply( sig ) );
+  apply( splicer->wavelength().data(), spliced.data(), spliced.size(), out.data() );
+  return out;
+}
+
+std::vector<svcsigfeaturevalues> svcsigcontinuum::apply( const std::vector<svcsig> &sigs, const unsigned int &threads ) const
+{
+  std::vector<svcsigfeaturevalues> out( sigs.size() * _windows.size() );
+  std::vector< std::shared_ptr<const svcsigsplicer> > splicers( sigs.size() );
+  std::map< std::vector<float>, std::vector<size_t> > groups( svcSigGroupByGrid( sigs ) );
+  for ( std::map< std::vector<float>, std::vector<size_t> >::const_iterator g = groups.begin(); g != groups.end(); ++g ) {
+    std::shared_ptr<const svcsigsplicer> splicer( svcSigSplicer( g->first, _options ) );
+    for ( size_t i = 0; i < g->second.size(); i++ ) {
+      splicers[ g->second[ i ] ] = splicer;
+    }
+  }
+  svcSigParallelFor( sigs.size(), threads, [&]( size_t i, unsigned int ) {
+    const svcsigsplicer *splicer( splicers[ i ].get() );
+    if ( splicer == NULL ) {
+      apply( NULL, NULL, 0, out.data() + i * _windows.size() );
+      return;
+    }
+    std::vector<float> spliced( splicer->apply( sigs[ i ] ) );
+    apply( splicer->wavelength().data(), spliced.data(), spliced.size(), out.data() + i * _windows.size() );
+  } );
+  return out;
+}
+
+std::vector<float> svcsigcontinuum::removed( const svcsig &sig, std::vector<float> &wavelength ) const
+{
+  std::shared_ptr<const svcsigsplicer> splicer( svcSigSplicer( sig.wavelength(), _options ) );
+  std::vector<float> spliced( splicer->apply( sig ) );
+  wavelength = splicer->wavelength();
+  std::vector<float> out( spliced.size() );
+  svcSigContinuumRemoved( wavelength.data(), spliced.data(), spliced.size(), out.data() );
+  return out;
+}
+
+#endif // __svcsigcontinuum_hpp_
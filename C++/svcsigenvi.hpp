@@ -0,0 +1,515 @@
+/*******************************************************************************
+ * svcsigenvi.hpp
+ *
+ * DESCRIPTION:
+ *    Provides header and implimentation for the svcsigenvi class, which
+ *    writes collections of sig files as an ENVI spectral library: a binary
+ *    .sli file of float32 spectra, one after another (band sequential, one
+ *    line per spectrum), and a .hdr text header with the spectra names and
+ *    wavelength lists.
+ *
+ *    A library has one wavelength grid. By default it is the spliced grid of
+ *    the first file (see svcsigsplice.hpp), so the overlaps of the detectors
+ *    are removed; files on other grids are spliced and then resampled onto
+ *    it (see svcsigresample.hpp).
+ *
+ *    Spectra are written as they are added, and the names are spooled to a
+ *    file, so memory does not grow with the size of the library. Everything
+ *    is written to .tmp files that are renamed into place by close(), so a
+ *    library is never seen half written.
+ *
+ *    Build with -pthread.
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *    2026-10-18: add( sigs ) looks up one splicer and resampler per grid
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *   "ENVI Header Format", ENVI documentation, L3Harris Geospatial
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsigenvi_hpp_
+#define __svcsigenvi_hpp_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "svcsighelper.hpp"
+#include "svcsig.hpp"
+#include "svcsigbatch.hpp"
+#include "svcsigresample.hpp"
+#include "svcsigsplice.hpp"
+
+// the number of spectra converted together by the collection writers
+#define SVCSIG_ENVI_CHUNK 1024
+
+
+class svcsigenvi {
+private:
+  std::string _filename; // the .sli file
+  std::string _header; // the .hdr file
+  std::vector<float> _grid;
+  int _spectrum;
+  int _mode;
+  FILE *_data;
+  FILE *_names;
+  size_t _count;
+  
+  svcsigenvi( const svcsigenvi &other );
+  svcsigenvi& operator=( const svcsigenvi &other );
+  
+  /* Name: void svcSigEnviStages( const std::vector<float> &wavelength, std::shared_ptr<const svcsigsplicer> &splicer, std::shared_ptr<const svcsigresampler> &resampler ) const
+   *
+   * Description: The splicer of a grid, and the resampler from the spliced
+   *    grid onto the library grid (NULL if it is the library grid)
+   */
+  void svcSigEnviStages( const std::vector<float> &wavelength, std::shared_ptr<const svcsigsplicer> &splicer, std::shared_ptr<const svcsigresampler> &resampler ) const;
+  
+  /* Name: void svcSigEnviRow( const svcsig &sig, const svcsigsplicer *splicer, const svcsigresampler *resampler, float *out ) const
+   *
+   * Description: Splices a spectrum of a sig file, and resamples it onto the
+   *    grid if it is on another
+   * Arguments: const svcsig &sig: the sig file
+   *            const svcsigsplicer *splicer,
+   *            const svcsigresampler *resampler: from svcSigEnviStages()
+   *            float *out: grid().size() values, NAN for an empty file
+   * Modifies: out
+   */
+  void svcSigEnviRow( const svcsig &sig, const svcsigsplicer *splicer, const svcsigresampler *resampler, float *out ) const;
+  
+  /* Name: void svcSigEnviWrite( const float *spectra, const std::vector<std::string> &names )
+   *
+   * Description: Writes names.size() spectra on the grid, and their names
+   * Exceptions: invalidSVCsigEnvi if they can not be written (the library is
+   *     abandoned)
+   */
+  void svcSigEnviWrite( const float *spectra, const std::vector<std::string> &names );
+  
+  /* Name: void svcSigEnviAbandon()
+   *
+   * Description: Closes and removes the .tmp files
+   */
+  void svcSigEnviAbandon();
+
+public:
+  /* Name: svcsigenvi( const std::string &filename, const std::vector<float> &grid, const int &spectrum, const int &mode )
+   *
+   * Description: Starts a spectral library
+   * Arguments: const std::string &filename: the .sli file; the header is the
+   *                same name with .hdr in place of .sli (or added)
+   *            const std::vector<float> &grid: the wavelengths of the library
+   *                (ascending), empty for the spliced grid of the first file
+   *                added
+   *            const int &spectrum: SVCSIG_SPECTRUM_REFERENCE_RADIANCE,
+   *                SVCSIG_SPECTRUM_TARGET_RADIANCE or
+   *                SVCSIG_SPECTRUM_TARGET_REFLECTANCE
+   *            const int &mode: how files on other grids are resampled,
+   *                SVCSIG_RESAMPLE_LINEAR, SVCSIG_RESAMPLE_CUBIC or
+   *                SVCSIG_RESAMPLE_PCHIP
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post: filename.tmp is open
+   * Exceptions: invalidSVCsigEnvi for an unknown spectrum or mode, or if the
+   *     files can not be created
+   * Notes:
+   */
+  svcsigenvi( const std::string &filename, const std::vector<float> &grid = std::vector<float>(), const int &spectrum = SVCSIG_SPECTRUM_TARGET_REFLECTANCE, const int &mode = SVCSIG_RESAMPLE_LINEAR );
+  
+  /* Name: ~svcsigenvi()
+   *
+   * Description: Removes the .tmp files of a library that was not closed
+   * Notes: Call close() to keep the library; an exception part way through
+   *    an export then leaves no partial library behind
+   */
+  ~svcsigenvi();
+  
+  /* Name: getters
+   *
+   * Description: filename() and header() are the .sli and .hdr files, grid()
+   *    the wavelengths (empty until the first file if none were given) and
+   *    size() the number of spectra written so far
+   */
+  std::string filename() const;
+  std::string header() const;
+  const std::vector<float> & grid() const;
+  size_t size() const;
+  
+  /* Name: svcsigenvi& add( const svcsig &sig, const std::string &name )
+   *
+   * Description: Writes the spectrum of a sig file
+   * Arguments: const svcsig &sig: the sig file
+   *            const std::string &name: its name in the library, empty for
+   *                svcsig::name()
+   * Modifies: the library
+   * Returns: *this
+   * Exceptions: invalidSVCsigEnvi if the library is closed or can not be
+   *     written
+   */
+  svcsigenvi& add( const svcsig &sig, const std::string &name = "" );
+  
+  /* Name: svcsigenvi& add( const std::vector<svcsig> &sigs, const unsigned int &threads, const std::vector<std::string> &names )
+   *
+   * Description: Writes the spectra of many sig files, splicing and
+   *    resampling them across worker threads
+   * Arguments: const std::vector<svcsig> &sigs: the sig files, on any grids
+   *            const unsigned int &threads: the number of threads (0 for one
+   *                per core)
+   *            const std::vector<std::string> &names: their names in the
+   *                library, empty for svcsig::name()
+   * Returns: *this
+   * Exceptions: invalidSVCsigEnvi if there are names, but not one per file
+   * Notes: Spectra are converted SVCSIG_ENVI_CHUNK at a time. Files are
+   *    grouped by grid (svcSigGroupByGrid()), and the splicer and resampler
+   *    of each grid are looked up once.
+   */
+  svcsigenvi& add( const std::vector<svcsig> &sigs, const unsigned int &threads = 0, const std::vector<std::string> &names = std::vector<std::string>() );
+  
+  /* Name: svcsigenvi& add( const std::string &name, const float *spectrum )
+   *
+   * Description: Writes a spectrum that is already on the grid
+   * Arguments: const std::string &name: its name in the library
+   *            const float *spectrum: grid().size() values
+   * Exceptions: invalidSVCsigEnvi if there is no grid yet
+   */
+  svcsigenvi& add( const std::string &name, const float *spectrum );
+  
+  /* Name: void close()
+   *
+   * Description: Writes the header, and renames the library into place
+   * Modifies: the library
+   * Returns:
+   * Pre:
+   * Post: the library is closed; further adds throw
+   * Exceptions: invalidSVCsigEnvi if there is no grid (nothing was added to a
+   *     library without one), or the files can not be written
+   * Notes: Names have any commas and braces, which delimit the ENVI lists,
+   *    replaced by underscores
+   */
+  void close();
+};
+
+/* Name: size_t svcSigEnviWrite( const std::string &filename, const std::vector<std::string> &filenames, const std::vector<float> &grid, const int &spectrum, const int &mode, const unsigned int &threads )
+ *
+ * Description: Writes sig files as an ENVI spectral library, streaming them
+ *    through memory SVCSIG_ENVI_CHUNK at a time
+ * Arguments: const std::string &filename: the .sli file
+ *            const std::vector<std::string> &filenames: the sig files (plain,
+ *                gzip or zstd compressed)
+ *            others: see svcsigenvi()
+ *            const unsigned int &threads: the number of threads (0 for one per
+ *                core)
+ * Modifies:
+ * Returns: size_t, the number of spectra written
+ * Pre:
+ * Post:
+ * Exceptions: invalidSVCsigEnvi (see svcsigenvi), and the exceptions of
+ *     svcsig::read(); no library is written if one is thrown
+ * Notes: The names are the file names, without their directories
+ */
+size_t svcSigEnviWrite( const std::string &filename, const std::vector<std::string> &filenames, const std::vector<float> &grid = std::vector<float>(), const int &spectrum = SVCSIG_SPECTRUM_TARGET_REFLECTANCE, const int &mode = SVCSIG_RESAMPLE_LINEAR, const unsigned int &threads = 0 );
+
+
+// --- --- Implimentation --- --- //
+
+// -- -- Constructors -- -- //
+svcsigenvi::svcsigenvi( const std::string &filename, const std::vector<float> &grid, const int &spectrum, const int &mode )
+: _filename( filename ), _grid( grid ), _spectrum( spectrum ), _mode( mode ), _data( NULL ), _names( NULL ), _count( 0 )
+{
+  if ( spectrum != SVCSIG_SPECTRUM_REFERENCE_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_REFLECTANCE ) {
+    throw invalidSVCsigEnvi( "unknown spectrum" );
+  }
+  if ( mode != SVCSIG_RESAMPLE_LINEAR && mode != SVCSIG_RESAMPLE_CUBIC && mode != SVCSIG_RESAMPLE_PCHIP ) {
+    throw invalidSVCsigEnvi( "unknown resampling mode" );
+  }
+  size_t dot( filename.size() >= 4 ? filename.size() - 4 : 0 );
+  _header = filename.compare( dot, std::string::npos, ".sli" ) == 0 ? filename.substr( 0, dot ) + ".hdr" : filename + ".hdr";
+  
+  _data = fopen( ( _filename + ".tmp" ).c_str(), "wb" );
+  _names = fopen( ( _header + ".names.tmp" ).c_str(), "w+b" );
+  if ( _data == NULL || _names == NULL ) {
+    svcSigEnviAbandon();
+    throw invalidSVCsigEnvi( "could not create '" + _filename + "'" );
+  }
+}
+
+svcsigenvi::~svcsigenvi()
+{
+  svcSigEnviAbandon();
+}
+
+// -- -- Getters -- -- //
+std::string svcsigenvi::filename() const
+{
+  return _filename;
+}
+
+std::string svcsigenvi::header() const
+{
+  return _header;
+}
+
+const std::vector<float> & svcsigenvi::grid() const
+{
+  return _grid;
+}
+
+size_t svcsigenvi::size() const
+{
+  return _count;
+}
+
+// -- -- Writing -- -- //
+svcsigenvi& svcsigenvi::add( const svcsig &sig, const std::string &name )
+{
+  if ( _data == NULL ) {
+    throw invalidSVCsigEnvi( "the library is closed" );
+  }
+  if ( _grid.empty() && sig.size() > 0 ) {
+    _grid = svcSigSplicer( sig.wavelength() )->wavelength();
+  }
+  if ( _grid.empty() ) {
+    throw invalidSVCsigEnvi( "the library has no grid" );
+  }
+  std::vector<float> row( _grid.size() );
+  std::shared_ptr<const svcsigsplicer> splicer;
+  std::shared_ptr<const svcsigresampler> resampler;
+  if ( sig.size() > 0 ) {
+    svcSigEnviStages( sig.wavelength(), splicer, resampler );
+  }
+  svcSigEnviRow( sig, splicer.get(), resampler.get(), row.data() );
+  svcSigEnviWrite( row.data(), std::vector<std::string>( 1, name.empty() ? sig.name() : name ) );
+  return *this;
+}
+
+svcsigenvi& svcsigenvi::add( const std::vector<svcsig> &sigs, const unsigned int &threads, const std::vector<std::string> &names )
+{
+  if ( _data == NULL ) {
+    throw invalidSVCsigEnvi( "the library is closed" );
+  }
+  if ( !names.empty() && names.size() != sigs.size() ) {
+    throw invalidSVCsigEnvi( "there must be a name for each file" );
+  }
+  for ( size_t i = 0; i < sigs.size() && _grid.empty(); i++ ) {
+    if ( sigs[ i ].size() > 0 ) {
+      _grid = svcSigSplicer( sigs[ i ].wavelength() )->wavelength();
+    }
+  }
+  if ( _grid.empty() && !sigs.empty() ) {
+    throw invalidSVCsigEnvi( "the library has no grid" );
+  }
+  std::vector< std::shared_ptr<const svcsigsplicer> > splicers( sigs.size() );
+  std::vector< std::shared_ptr<const svcsigresampler> > resamplers( sigs.size() );
+  std::map< std::vector<float>, std::vector<size_t> > groups( svcSigGroupByGrid( sigs ) );
+  for ( std::map< std::vector<float>, std::vector<size_t> >::const_iterator g = groups.begin(); g != groups.end(); ++g ) {
+    std::shared_ptr<const svcsigsplicer> splicer;
+    std::shared_ptr<const svcsigresampler> resampler;
+    svcSigEnviStages( g->first, splicer, resampler );
+    for ( size_t i = 0; i < g->second.size(); i++ ) {
+      splicers[ g->second[ i ] ] = splicer;
+      resamplers[ g->second[ i ] ] = resampler;
+    }
+  }
+  std::vector<float> rows;
+  std::vector<std::string> chunk;
+  for ( size_t first = 0; first < sigs.size(); first += SVCSIG_ENVI_CHUNK ) {
+    size_t n( std::min( sigs.size() - first, size_t( SVCSIG_ENVI_CHUNK ) ) );
+    rows.resize( n * _grid.size() );
+    chunk.resize( n );
+    svcSigParallelFor( n, threads, [&]( size_t i, unsigned int ) {
+      svcSigEnviRow( sigs[ first + i ], splicers[ first + i ].get(), resamplers[ first + i ].get(), rows.data() + i * _grid.size() );
+      chunk[ i ] = names.empty() ? sigs[ first + i ].name() : names[ first + i ];
+    } );
+    svcSigEnviWrite( rows.data(), chunk );
+  }
+  return *this;
+}
+
+svcsigenvi& svcsigenvi::add( const std::string &name, const float *spectrum )
+{
+  if ( _data == NULL ) {
+    throw invalidSVCsigEnvi( "the library is closed" );
+  }
+  if ( _grid.empty() ) {
+    throw invalidSVCsigEnvi( "the library has no grid" );
+  }
+  svcSigEnviWrite( spectrum, std::vector<std::string>( 1, name ) );
+  return *this;
+}
+
+void svcsigenvi::close()
+{
+  if ( _data == NULL ) {
+    throw invalidSVCsigEnvi( "the library is closed" );
+  }
+  if ( _grid.empty() ) {
+    svcSigEnviAbandon();
+    throw invalidSVCsigEnvi( "the library has no grid" );
+  }
+  
+  // the header: the fields, the spooled names, then the wavelengths
+  std::string tmp( _header + ".tmp" );
+  FILE *output( fopen( tmp.c_str(), "wb" ) );
+  if ( output == NULL ) {
+    svcSigEnviAbandon();
+    throw invalidSVCsigEnvi( "could not write '" + _header + "'" );
+  }
+  const uint16_t one( 1 );
+  std::ostringstream fields;
+  fields << "ENVI" << std::endl;
+  fields << "description = {SVC sig spectral library}" << std::endl;
+  fields << "samples = " << _grid.size() << std::endl;
+  fields << "lines = " << _count << std::endl;
+  fields << "bands = 1" << std::endl;
+  fields << "header offset = 0" << std::endl;
+  fields << "file type = ENVI Spectral Library" << std::endl;
+  fields << "data type = 4" << std::endl;
+  fields << "interleave = bsq" << std::endl;
+  fields << "byte order = " << ( *reinterpret_cast<const char *>( &one ) == 1 ? 0 : 1 ) << std::endl;
+  fields << "wavelength units = Nanometers" << std::endl;
+  if ( _spectrum == SVCSIG_SPECTRUM_TARGET_REFLECTANCE ) {
+    fields << "reflectance scale factor = 100" << std::endl; // sig files are in percent
+  }
+  fields << "spectra names = {";
+  std::string text( fields.str() );
+  bool good( fwrite( text.data(), 1, text.size(), output ) == text.size() );
+  
+  good = fflush( _names ) == 0 && fseek( _names, 0, SEEK_SET ) == 0 && good;
+  char buffer[ 65536 ];
+  for ( size_t n = fread( buffer, 1, sizeof( buffer ), _names ); n > 0 && good; n = fread( buffer, 1, sizeof( buffer ), _names ) ) {
+    good = fwrite( buffer, 1, n, output ) == n;
+  }
+  good = !ferror( _names ) && good;
+  
+  std::ostringstream wavelengths;
+  wavelengths << "}" << std::endl << "wavelength = {" << std::endl << "  " << std::setprecision( 7 );
+  for ( size_t j = 0; j < _grid.size(); j++ ) {
+    wavelengths << _grid[ j ] << ( j + 1 < _grid.size() ? ( j % 8 == 7 ? ",\n  " : ", " ) : "}\n" );
+  }
+  text = wavelengths.str();
+  good = fwrite( text.data(), 1, text.size(), output ) == text.size() && good;
+  good = fclose( output ) == 0 && good;
+  good = fclose( _data ) == 0 && good;
+  _data = NULL;
+  
+  if ( !good || rename( ( _filename + ".tmp" ).c_str(), _filename.c_str() ) != 0 || rename( tmp.c_str(), _header.c_str() ) != 0 ) {
+    remove( tmp.c_str() );
+    svcSigEnviAbandon();
+    throw invalidSVCsigEnvi( "could not write '" + _filename + "'" );
+  }
+  svcSigEnviAbandon();
+}
+
+// -- -- Helpers -- -- //
+void svcsigenvi::svcSigEnviStages( const std::vector<float> &wavelength, std::shared_ptr<const svcsigsplicer> &splicer, std::shared_ptr<const svcsigresampler> &resampler ) const
+{
+  splicer = svcSigSplicer( wavelength );
+  resampler.reset();
+  if ( splicer->wavelength() != _grid ) {
+    resampler = svcSigResampler( splicer->wavelength(), _grid, _mode );
+  }
+}
+
+void svcsigenvi::svcSigEnviRow( const svcsig &sig, const svcsigsplicer *splicer, const svcsigresampler *resampler, float *out ) const
+{
+  if ( sig.size() == 0 || splicer == NULL ) {
+    std::fill( out, out + _grid.size(), NAN );
+    return;
+  }
+  std::vector<float> spliced( splicer->apply( sig, _spectrum ) );
+  if ( resampler == NULL ) {
+    std::copy( spliced.begin(), spliced.end(), out );
+  }
+  else {
+    resampler->apply( spliced.data(), out );
+  }
+}
+
+void svcsigenvi::svcSigEnviWrite( const float *spectra, const std::vector<std::string> &names )
+{
+  bool good( fwrite( spectra, sizeof( float ), names.size() * _grid.size(), _data ) == names.size() * _grid.size() );
+  for ( size_t i = 0; i < names.size() && good; i++ ) {
+    std::string name( names[ i ] );
+    for ( size_t c = 0; c < name.size(); c++ ) {
+      if ( name[ c ] == ',' || name[ c ] == '{' || name[ c ] == '}' || name[ c ] == '\n' || name[ c ] == '\r' ) {
+        name[ c ] = '_';
+      }
+    }
+    name = ( _count + i > 0 ? ",\n  " : "\n  " ) + name;
+    good = fwrite( name.data(), 1, name.size(), _names ) == name.size();
+  }
+  if ( !good ) {
+    svcSigEnviAbandon();
+    throw invalidSVCsigEnvi( "could not write '" + _filename + "'" );
+  }
+  _count += names.size();
+}
+
+void svcsigenvi::svcSigEnviAbandon()
+{
+  if ( _data != NULL ) {
+    fclose( _data );
+    remove( ( _filename + ".tmp" ).c_str() );
+    _data = NULL;
+  }
+  if ( _names != NULL ) {
+    fclose( _names );
+    remove( ( _header + ".names.tmp" ).c_str() );
+    _names = NULL;
+  }
+}
+
+// -- -- Collections -- -- //
+size_t svcSigEnviWrite( const std::string &filename, const std::vector<std::string> &filenames, const std::vector<float> &grid, const int &spectrum, const int &mode, const unsigned int &threads )
+{
+  svcsigenvi library( filename, grid, spectrum, mode );
+  std::vector<svcsig> sigs;
+  for ( size_t first = 0; first < filenames.size(); first += SVCSIG_ENVI_CHUNK ) {
+    std::vector<std::string> chunk( filenames.begin() + first, filenames.begin() + std::min( filenames.size(), first + SVCSIG_ENVI_CHUNK ) );
+    std::vector<std::string> names( chunk.size() );
+    for ( size_t i = 0; i < chunk.size(); i++ ) {
+      names[ i ] = chunk[ i ].substr( chunk[ i ].find_last_of( "/\\" ) + 1 );
+    }
+    sigs = svcSigReadBatch( chunk, threads );
+    library.add( sigs, threads, names );
+  }
+  library.close();
+  return library.size();
+}
+
+#endif // __svcsigenvi_hpp_
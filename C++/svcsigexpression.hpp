@@ -0,0 +1,933 @@
+/*******************************************************************************
+ * svcsigexpression.hpp
+ *
+ * DESCRIPTION:
+ *    Provides header and implimentation for the svcsigindices class, which
+ *    computes spectral indices (e.g. NDVI, PRI, red edge NDVI) written as
+ *    expressions over the reflectance of sig files, such as
+ *    "(R800-R670)/(R800+R670)".
+ *
+ *    An expression is parsed once, when it is added, into a small stack
+ *    program. Its band terms are bound once per wavelength grid to the
+ *    bands (and interpolation weights) that they read, and the binding is
+ *    cached, so no wavelengths are searched per spectrum. Spectra are
+ *    evaluated SVCSIG_EXPRESSION_BLOCK at a time: the bands read by any
+ *    index are gathered once, then every instruction runs over contiguous
+ *    arrays of one value per spectrum.
+ *
+ *    The grammar is
+ *      sum     = product { ( "+" | "-" ) product }
+ *      product = unary { ( "*" | "/" ) unary }
+ *      unary   = ( "-" | "+" ) unary | power
+ *      power   = primary [ "^" unary ]
+ *      primary = number | "(" sum ")" | band | function "(" sum [ "," sum ] ")"
+ *      band    = "R" number | "R[" number ":" number "]"
+ *    where R800 is the reflectance at 800 nm (interpolated between the
+ *    nearest bands), R[841:876] is the mean of the bands from 841 to 876
+ *    nm, and the functions are abs, sqrt, log, exp, min and max.
+ *
+ *    Build with -pthread.
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *   J. W. Rouse, R. H. Haas, J. A. Schell, D. W. Deering, "Monitoring
+ *     Vegetation Systems in the Great Plains with ERTS", NASA SP-351, 1974
+ *   J. A. Gamon, J. Penuelas, C. B. Field, "A Narrow-Waveband Spectral Index
+ *     That Tracks Diurnal Changes in Photosynthetic Efficiency", Remote
+ *     Sensing of Environment 41(1), 1992
+ *   A. Huete, K. Didan, T. Miura, E. P. Rodriguez, X. Gao, L. G. Ferreira,
+ *     "Overview of the Radiometric and Biophysical Performance of the MODIS
+ *     Vegetation Indices", Remote Sensing of Environment 83(1-2), 2002
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsigexpression_hpp_
+#define __svcsigexpression_hpp_
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "svcsighelper.hpp"
+#include "svcsig.hpp"
+#include "svcsigbatch.hpp"
+#include "svcsigresample.hpp"
+#include "svcsigsplice.hpp"
+
+// the number of spectra evaluated together
+#define SVCSIG_EXPRESSION_BLOCK 64
+
+// the instructions of a compiled expression
+#define SVCSIG_EXPRESSION_NUMBER 0
+#define SVCSIG_EXPRESSION_TERM 1
+#define SVCSIG_EXPRESSION_ADD 2
+#define SVCSIG_EXPRESSION_SUBTRACT 3
+#define SVCSIG_EXPRESSION_MULTIPLY 4
+#define SVCSIG_EXPRESSION_DIVIDE 5
+#define SVCSIG_EXPRESSION_POWER 6
+#define SVCSIG_EXPRESSION_MIN 7
+#define SVCSIG_EXPRESSION_MAX 8
+#define SVCSIG_EXPRESSION_NEGATE 9
+#define SVCSIG_EXPRESSION_ABS 10
+#define SVCSIG_EXPRESSION_SQRT 11
+#define SVCSIG_EXPRESSION_LOG 12
+#define SVCSIG_EXPRESSION_EXP 13
+
+
+// one instruction: push a number or a band term, or replace the top one (or
+// two) values of the stack with the result of an operation
+struct svcsigexpressionop {
+  int code;
+  float value; // of SVCSIG_EXPRESSION_NUMBER
+  uint32_t term; // of SVCSIG_EXPRESSION_TERM
+};
+
+// a band term: the reflectance at a wavelength (left == right), or the mean
+// of the bands from left to right (nm)
+struct svcsigexpressionterm {
+  double left;
+  double right;
+};
+
+// the band terms of a svcsigindices for one wavelength grid. columns are the
+// bands read by any term, ascending. Each term is a sparse row over the
+// columns: rows holds the start of each row in index and weight, plus the
+// end. Empty rows are terms outside the grid.
+struct svcsigexpressionbinding {
+  size_t sourceSize;
+  std::vector<uint32_t> columns;
+  std::vector<uint32_t> rows;
+  std::vector<uint32_t> index;
+  std::vector<float> weight;
+};
+
+
+class svcsigindices {
+private:
+  std::vector<std::string> _names;
+  std::vector<std::string> _expressions;
+  std::vector< std::vector<svcsigexpressionop> > _programs;
+  std::vector<svcsigexpressionterm> _terms; // shared by all of the programs
+  size_t _depth; // the deepest stack of any program
+  svcsigspliceoptions _options;
+  
+  mutable std::mutex _lock;
+  mutable std::map< std::vector<float>, std::shared_ptr<const svcsigexpressionbinding> > _bindings;
+  
+  svcsigindices( const svcsigindices &other );
+  svcsigindices& operator=( const svcsigindices &other );
+  
+  /* Name: parsing
+   *
+   * Description: A recursive descent parser, one function per rule of the
+   *    grammar (see the top of this file). Each appends the instructions of
+   *    its rule, starting at text[ pos ], to program, and the band terms that
+   *    they read to terms.
+   * Modifies: pos (moved past the rule), program, terms
+   * Exceptions: invalidSVCsigExpression on a syntax error
+   */
+  void svcSigExpressionSum( const std::string &text, size_t &pos, std::vector<svcsigexpressionop> &program, std::vector<svcsigexpressionterm> &terms ) const;
+  void svcSigExpressionProduct( const std::string &text, size_t &pos, std::vector<svcsigexpressionop> &program, std::vector<svcsigexpressionterm> &terms ) const;
+  void svcSigExpressionUnary( const std::string &text, size_t &pos, std::vector<svcsigexpressionop> &program, std::vector<svcsigexpressionterm> &terms ) const;
+  void svcSigExpressionPower( const std::string &text, size_t &pos, std::vector<svcsigexpressionop> &program, std::vector<svcsigexpressionterm> &terms ) const;
+  void svcSigExpressionPrimary( const std::string &text, size_t &pos, std::vector<svcsigexpressionop> &program, std::vector<svcsigexpressionterm> &terms ) const;
+  double svcSigExpressionNumber( const std::string &text, size_t &pos ) const;
+  void svcSigExpressionExpect( const std::string &text, size_t &pos, const char &c ) const;
+  void svcSigExpressionError( const std::string &text, const size_t &pos, const std::string &message ) const;
+  
+  /* Name: std::shared_ptr<const svcsigexpressionbinding> svcSigExpressionBind( const std::vector<float> &grid ) const
+   *
+   * Description: Finds the bands and weights of every term for a grid
+   */
+  std::shared_ptr<const svcsigexpressionbinding> svcSigExpressionBind( const std::vector<float> &grid ) const;
+  
+  /* Name: void svcSigExpressionBlock( const svcsigexpressionbinding &binding, const float * const *in, const size_t &count, float *out, float *tile ) const
+   *
+   * Description: Computes the indices of up to SVCSIG_EXPRESSION_BLOCK
+   *    spectra
+   * Arguments: const svcsigexpressionbinding &binding: the terms
+   *            const float * const *in: the spectra
+   *            const size_t &count: the number of spectra
+   *            float *out: count rows of size() values
+   *            float *tile: scratch for ( columns + terms + depth ) *
+   *                SVCSIG_EXPRESSION_BLOCK values
+   * Modifies: out, tile
+   * Notes: The bands read are transposed into tile, so the terms and every
+   *    instruction work on contiguous runs of SVCSIG_EXPRESSION_BLOCK values
+   */
+  void svcSigExpressionBlock( const svcsigexpressionbinding &binding, const float * const *in, const size_t &count, float *out, float *tile ) const;
+
+public:
+  /* Name: svcsigindices( const svcsigspliceoptions &options )
+   *
+   * Description: Constructs an engine with no indices
+   * Arguments: const svcsigspliceoptions &options: how the detector overlaps
+   *     of a grid are resolved; each term reads the bands that splicing
+   *     keeps (see svcsigsplice.hpp)
+   */
+  svcsigindices( const svcsigspliceoptions &options = svcsigspliceoptions() );
+  
+  /* Name: svcsigindices& add( const std::string &name, const std::string &expression )
+   *
+   * Description: Compiles and adds an index
+   * Arguments: const std::string &name: the name of the index
+   *            const std::string &expression: its expression, e.g.
+   *                "(R800-R670)/(R800+R670)"
+   * Modifies: the indices, and clears the cached bindings
+   * Returns: *this
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigExpression if the expression can not be parsed;
+   *     the indices are unchanged
+   * Notes: Terms are shared between indices, so R800 is computed once per
+   *    spectrum however many indices read it
+   */
+  svcsigindices& add( const std::string &name, const std::string &expression );
+  
+  /* Name: svcsigindices& standard()
+   *
+   * Description: Adds the common vegetation and water indices: NDVI, SR,
+   *    NDRE (red edge NDVI), PRI, MCARI, EVI, NDWI and WBI
+   */
+  svcsigindices& standard();
+  
+  /* Name: svcsigindices& clear()
+   *
+   * Description: Removes the indices
+   */
+  svcsigindices& clear();
+  
+  /* Name: getters
+   *
+   * Description: size() is the number of indices, name( i ) and
+   *    expression( i ) describe index i, and terms() is the number of
+   *    distinct band terms that they read
+   */
+  size_t size() const;
+  std::string name( const size_t &i ) const;
+  std::string expression( const size_t &i ) const;
+  size_t terms() const;
+  
+  /* Name: std::shared_ptr<const svcsigexpressionbinding> binding( const std::vector<float> &grid ) const
+   *
+   * Description: Returns the terms bound to a wavelength grid, binding them
+   *    the first time the grid is seen
+   * Arguments: const std::vector<float> &grid: the wavelengths (e.g.
+   *     svcsig::wavelength())
+   * Modifies: the cache
+   * Returns: std::shared_ptr<const svcsigexpressionbinding>
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Thread safe
+   */
+  std::shared_ptr<const svcsigexpressionbinding> binding( const std::vector<float> &grid ) const;
+  
+  /* Name: void apply( const std::vector<float> &grid, const float *in, float *out, const size_t &count, const unsigned int &threads ) const
+   *
+   * Description: Computes the indices of many spectra on one grid
+   * Arguments: const std::vector<float> &grid: the wavelengths of the spectra
+   *            const float *in: count spectra of grid.size() values, one after
+   *                another
+   *            float *out: count rows of size() values
+   *            const size_t &count: the number of spectra
+   *            const unsigned int &threads: the number of threads (0 for one
+   *                per core)
+   * Modifies: out
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Indices that read a band outside the grid are NAN
+   */
+  void apply( const std::vector<float> &grid, const float *in, float *out, const size_t &count, const unsigned int &threads = 0 ) const;
+  
+  /* Name: std::vector<float> apply( const svcsig &sig, const int &spectrum ) const
+   *
+   * Description: Computes the indices of one sig file
+   * Arguments: const svcsig &sig: the sig file
+   *            const int &spectrum: SVCSIG_SPECTRUM_REFERENCE_RADIANCE,
+   *                SVCSIG_SPECTRUM_TARGET_RADIANCE or
+   *                SVCSIG_SPECTRUM_TARGET_REFLECTANCE
+   * Returns: std::vector<float> of size() values
+   * Exceptions: invalidSVCsigExpression for an unknown spectrum
+   */
+  std::vector<float> apply( const svcsig &sig, const int &spectrum = SVCSIG_SPECTRUM_TARGET_REFLECTANCE ) const;
+  
+  /* Name: std::vector<float> apply( const std::vector<svcsig> &sigs, const int &spectrum, const unsigned int &threads ) const
+   *
+   * Description: Computes the indices of many sig files across worker threads
+   * Arguments: const std::vector<svcsig> &sigs: the sig files, on any grids
+   *            const int &spectrum: see above
+   *            const unsigned int &threads: the number of threads (0 for one
+   *                per core)
+   * Modifies:
+   * Returns: std::vector<float> of sigs.size() rows of size() values
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigExpression for an unknown spectrum
+   * Notes: Files are grouped by grid (svcSigGroupByGrid()), so each grid is
+   *    bound once. Empty sig files give rows of NAN.
+   */
+  std::vector<float> apply( const std::vector<svcsig> &sigs, const int &spectrum = SVCSIG_SPECTRUM_TARGET_REFLECTANCE, const unsigned int &threads = 0 ) const;
+};
+
+// --- --- Implimentation --- --- //
+
+// -- -- Block operations -- -- //
+// Each works on SVCSIG_EXPRESSION_BLOCK values. The operands are copied to
+// local arrays so the compiler knows that they do not overlap, and the loops
+// vectorize.
+
+/* Name: void svcSigExpressionBinaryBlock( const int &code, float *a, const float *b )
+ *
+ * Description: a = a op b
+ */
+void svcSigExpressionBinaryBlock( const int &code, float *a, const float *b )
+{
+  const size_t B( SVCSIG_EXPRESSION_BLOCK );
+  float x[ SVCSIG_EXPRESSION_BLOCK ];
+  float y[ SVCSIG_EXPRESSION_BLOCK ];
+  for ( size_t s = 0; s < B; s++ ) {
+    x[ s ] = a[ s ];
+    y[ s ] = b[ s ];
+  }
+  switch ( code ) {
+  case SVCSIG_EXPRESSION_ADD:
+    for ( size_t s = 0; s < B; s++ ) {
+      x[ s ] += y[ s ];
+    }
+    break;
+  case SVCSIG_EXPRESSION_SUBTRACT:
+    for ( size_t s = 0; s < B; s++ ) {
+      x[ s ] -= y[ s ];
+    }
+    break;
+  case SVCSIG_EXPRESSION_MULTIPLY:
+    for ( size_t s = 0; s < B; s++ ) {
+      x[ s ] *= y[ s ];
+    }
+    break;
+  case SVCSIG_EXPRESSION_DIVIDE:
+    for ( size_t s = 0; s < B; s++ ) {
+      x[ s ] /= y[ s ];
+    }
+    break;
+  case SVCSIG_EXPRESSION_POWER:
+    for ( size_t s = 0; s < B; s++ ) {
+      x[ s ] = std::pow( x[ s ], y[ s ] );
+    }
+    break;
+  case SVCSIG_EXPRESSION_MIN:
+    for ( size_t s = 0; s < B; s++ ) {
+      x[ s ] = y[ s ] < x[ s ] ? y[ s ] : x[ s ];
+    }
+    break;
+  case SVCSIG_EXPRESSION_MAX:
+    for ( size_t s = 0; s < B; s++ ) {
+      x[ s ] = y[ s ] > x[ s ] ? y[ s ] : x[ s ];
+    }
+    break;
+  }
+  for ( size_t s = 0; s < B; s++ ) {
+    a[ s ] = x[ s ];
+  }
+}
+
+/* Name: void svcSigExpressionUnaryBlock( const int &code, float *a )
+ *
+ * Description: a = op( a )
+ */
+void svcSigExpressionUnaryBlock( const int &code, float *a )
+{
+  const size_t B( SVCSIG_EXPRESSION_BLOCK );
+  float x[ SVCSIG_EXPRESSION_BLOCK ];
+  for ( size_t s = 0; s < B; s++ ) {
+    x[ s ] = a[ s ];
+  }
+  switch ( code ) {
+  case SVCSIG_EXPRESSION_NEGATE:
+    for ( size_t s = 0; s < B; s++ ) {
+      x[ s ] = -x[ s ];
+    }
+    break;
+  case SVCSIG_EXPRESSION_ABS:
+    for ( size_t s = 0; s < B; s++ ) {
+      x[ s ] = std::fabs( x[ s ] );
+    }
+    break;
+  case SVCSIG_EXPRESSION_SQRT:
+    for ( size_t s = 0; s < B; s++ ) {
+      x[ s ] = std::sqrt( x[ s ] );
+    }
+    break;
+  case SVCSIG_EXPRESSION_LOG:
+    for ( size_t s = 0; s < B; s++ ) {
+      x[ s ] = std::log( x[ s ] );
+    }
+    break;
+  case SVCSIG_EXPRESSION_EXP:
+    for ( size_t s = 0; s < B; s++ ) {
+      x[ s ] = std::exp( x[ s ] );
+    }
+    break;
+  }
+  for ( size_t s = 0; s < B; s++ ) {
+    a[ s ] = x[ s ];
+  }
+}
+
+// -- -- Public -- -- //
+
+svcsigindices::svcsigindices( const svcsigspliceoptions &options )
+: _depth( 0 ), _options( options )
+{}
+
+svcsigindices& svcsigindices::add( const std::string &name, const std::string &expression )
+{
+  // parse into local copies, so a syntax error leaves the indices unchanged
+  std::vector<svcsigexpressionop> program;
+  std::vector<svcsigexpressionterm> terms;
+  size_t pos( 0 );
+  svcSigExpressionSum( expression, pos, program, terms );
+  while ( pos < expression.size() && std::isspace( static_cast<unsigned char>( expression[ pos ] ) ) ) {
+    pos++;
+  }
+  if ( pos < expression.size() ) {
+    svcSigExpressionError( expression, pos, "expected an operator" );
+  }
+  
+  // share the terms with the other indices, and find the stack depth
+  size_t depth( 0 );
+  size_t deepest( 0 );
+  for ( size_t i = 0; i < program.size(); i++ ) {
+    if ( program[ i ].code == SVCSIG_EXPRESSION_TERM ) {
+      const svcsigexpressionterm &term( terms[ program[ i ].term ] );
+      size_t t( 0 );
+      while ( t < _terms.size() && ( _terms[ t ].left != term.left || _terms[ t ].right != term.right ) ) {
+        t++;
+      }
+      if ( t == _terms.size() ) {
+        _terms.push_back( term );
+      }
+      program[ i ].term = t;
+    }
+    if ( program[ i ].code == SVCSIG_EXPRESSION_NUMBER || program[ i ].code == SVCSIG_EXPRESSION_TERM ) {
+      depth++;
+    }
+    else if ( program[ i ].code < SVCSIG_EXPRESSION_NEGATE ) {
+      depth--;
+    }
+    deepest = std::max( deepest, depth );
+  }
+  
+  _names.push_back( name );
+  _expressions.push_back( expression );
+  _programs.push_back( program );
+  _depth = std::max( _depth, deepest );
+  std::lock_guard<std::mutex> guard( _lock );
+  _bindings.clear();
+  return *this;
+}
+
+svcsigindices& svcsigindices::standard()
+{
+  add( "NDVI", "(R800-R670)/(R800+R670)" );
+  add( "SR", "R800/R670" );
+  add( "NDRE", "(R790-R720)/(R790+R720)" );
+  add( "PRI", "(R531-R570)/(R531+R570)" );
+  add( "MCARI", "((R700-R670)-0.2*(R700-R550))*(R700/R670)" );
+  add( "EVI", "2.5*(R[841:876]-R[620:670])/(R[841:876]+6*R[620:670]-7.5*R[459:479]+1)" );
+  add( "NDWI", "(R860-R1240)/(R860+R1240)" );
+  add( "WBI", "R900/R970" );
+  return *this;
+}
+
+svcsigindices& svcsigindices::clear()
+{
+  _names.clear();
+  _expressions.clear();
+  _programs.clear();
+  _terms.clear();
+  _depth = 0;
+  std::lock_guard<std::mutex> guard( _lock );
+  _bindings.clear();
+  return *this;
+}
+
+size_t svcsigindices::size() const
+{
+  return _names.size();
+}
+
+std::string svcsigindices::name( const size_t &i ) const
+{
+  return _names.at( i );
+}
+
+std::string svcsigindices::expression( const size_t &i ) const
+{
+  return _expressions.at( i );
+}
+
+size_t svcsigindices::terms() const
+{
+  return _terms.size();
+}
+
+std::shared_ptr<const svcsigexpressionbinding> svcsigindices::binding( const std::vector<float> &grid ) const
+{
+  {
+    std::lock_guard<std::mutex> guard( _lock );
+    std::map< std::vector<float>, std::shared_ptr<const svcsigexpressionbinding> >::const_iterator found( _bindings.find( grid ) );
+    if ( found != _bindings.end() ) {
+      return found->second;
+    }
+  }
+  // bind outside of the lock; if another thread got there first, use its
+  std::shared_ptr<const svcsigexpressionbinding> built( svcSigExpressionBind( grid ) );
+  std::lock_guard<std::mutex> guard( _lock );
+  return _bindings.insert( std::make_pair( grid, built ) ).first->second;
+}
+
+void svcsigindices::apply( const std::vector<float> &grid, const float *in, float *out, const size_t &count, const unsigned int &threads ) const
+{
+  std::shared_ptr<const svcsigexpressionbinding> terms( binding( grid ) );
+  size_t blocks( ( count + SVCSIG_EXPRESSION_BLOCK - 1 ) / SVCSIG_EXPRESSION_BLOCK );
+  size_t tileSize( ( terms->columns.size() + _terms.size() + _depth ) * SVCSIG_EXPRESSION_BLOCK );
+  std::vector< std::vector<float> > tiles( svcSigThreads( threads ) );
+  svcSigParallelFor( blocks, threads, [&]( size_t block, unsigned int thread ) {
+    const float *spectra[ SVCSIG_EXPRESSION_BLOCK ];
+    size_t first( block * SVCSIG_EXPRESSION_BLOCK );
+    size_t n( std::min( count - first, size_t( SVCSIG_EXPRESSION_BLOCK ) ) );
+    for ( size_t s = 0; s < n; s++ ) {
+      spectra[ s ] = in + ( first + s ) * grid.size();
+    }
+    tiles[ thread ].resize( tileSize );
+    svcSigExpressionBlock( *terms, spectra, n, out + first * _names.size(), tiles[ thread ].data() );
+  } );
+}
+
+std::vector<float> svcsigindices::apply( const svcsig &sig, const int &spectrum ) const
+{
+  return apply( std::vector<svcsig>( 1, sig ), spectrum, 1 );
+}
+
+std::vector<float> svcsigindices::apply( const std::vector<svcsig> &sigs, const int &spectrum, const unsigned int &threads ) const
+{
+  if ( spectrum != SVCSIG_SPECTRUM_REFERENCE_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_REFLECTANCE ) {
+    throw invalidSVCsigExpression( "unknown spectrum" );
+  }
+  std::vector<float> out( sigs.size() * _names.size(), NAN );
+  
+  // group the files by grid, then cut each group into blocks
+  std::map< std::vector<float>, std::vector<size_t> > groups( svcSigGroupByGrid( sigs ) );
+  std::vector< std::shared_ptr<const svcsigexpressionbinding> > bindings;
+  std::vector< std::pair<size_t, size_t> > blocks; // ( group, first member )
+  std::vector< const std::vector<size_t> * > members;
+  size_t tileSize( 0 );
+  for ( std::map< std::vector<float>, std::vector<size_t> >::const_iterator g = groups.begin(); g != groups.end(); ++g ) {
+    bindings.push_back( binding( g->first ) );
+    members.push_back( &g->second );
+    tileSize = std::max( tileSize, ( bindings.back()->columns.size() + _terms.size() + _depth ) * SVCSIG_EXPRESSION_BLOCK );
+    for ( size_t first = 0; first < g->second.size(); first += SVCSIG_EXPRESSION_BLOCK ) {
+      blocks.push_back( std::make_pair( members.size() - 1, first ) );
+    }
+  }
+  
+  std::vector< std::vector<float> > tiles( svcSigThreads( threads ) );
+  std::vector< std::vector<float> > results( svcSigThreads( threads ) );
+  svcSigParallelFor( blocks.size(), threads, [&]( size_t b, unsigned int thread ) {
+    const svcsigexpressionbinding &terms( *bindings[ blocks[ b ].first ] );
+    const std::vector<size_t> &group( *members[ blocks[ b ].first ] );
+    size_t first( blocks[ b ].second );
+    size_t n( std::min( group.size() - first, size_t( SVCSIG_EXPRESSION_BLOCK ) ) );
+    const float *spectra[ SVCSIG_EXPRESSION_BLOCK ];
+    for ( size_t s = 0; s < n; s++ ) {
+      const svcsig &sig( sigs[ group[ first + s ] ] );
+      spectra[ s ] = spectrum == SVCSIG_SPECTRUM_REFERENCE_RADIANCE ? sig.referenceRadianceData() :
+        ( spectrum == SVCSIG_SPECTRUM_TARGET_RADIANCE ? sig.targetRadianceData() : sig.targetReflectanceData() );
+    }
+    tiles[ thread ].resize( tileSize );
+    results[ thread ].resize( _names.size() * SVCSIG_EXPRESSION_BLOCK );
+    svcSigExpressionBlock( terms, spectra, n, results[ thread ].data(), tiles[ thread ].data() );
+    for ( size_t s = 0; s < n; s++ ) {
+      std::copy( results[ thread ].begin() + s * _names.size(), results[ thread ].begin() + ( s + 1 ) * _names.size(), out.begin() + group[ first + s ] * _names.size() );
+    }
+  } );
+  return out;
+}
+
+// -- -- Parsing -- -- //
+
+void svcsigindices::svcSigExpressionSum( const std::string &text, size_t &pos, std::vector<svcsigexpressionop> &program, std::vector<svcsigexpressionterm> &terms ) const
+{
+  svcSigExpressionProduct( text, pos, program, terms );
+  while ( true ) {
+    while ( pos < text.size() && std::isspace( static_cast<unsigned char>( text[ pos ] ) ) ) {
+      pos++;
+    }
+    if ( pos >= text.size() || ( text[ pos ] != '+' && text[ pos ] != '-' ) ) {
+      return;
+    }
+    svcsigexpressionop op = { text[ pos ] == '+' ? SVCSIG_EXPRESSION_ADD : SVCSIG_EXPRESSION_SUBTRACT, 0.0f, 0 };
+    pos++;
+    svcSigExpressionProduct( text, pos, program, terms );
+    program.push_back( op );
+  }
+}
+
+void svcsigindices::svcSigExpressionProduct( const std::string &text, size_t &pos, std::vector<svcsigexpressionop> &program, std::vector<svcsigexpressionterm> &terms ) const
+{
+  svcSigExpressionUnary( text, pos, program, terms );
+  while ( true ) {
+    while ( pos < text.size() && std::isspace( static_cast<unsigned char>( text[ pos ] ) ) ) {
+      pos++;
+    }
+    if ( pos >= text.size() || ( text[ pos ] != '*' && text[ pos ] != '/' ) ) {
+      return;
+    }
+    svcsigexpressionop op = { text[ pos ] == '*' ? SVCSIG_EXPRESSION_MULTIPLY : SVCSIG_EXPRESSION_DIVIDE, 0.0f, 0 };
+    pos++;
+    svcSigExpressionUnary( text, pos, program, terms );
+    program.push_back( op );
+  }
+}
+
+void svcsigindices::svcSigExpressionUnary( const std::string &text, size_t &pos, std::vector<svcsigexpressionop> &program, std::vector<svcsigexpressionterm> &terms ) const
+{
+  while ( pos < text.size() && std::isspace( static_cast<unsigned char>( text[ pos ] ) ) ) {
+    pos++;
+  }
+  if ( pos < text.size() && ( text[ pos ] == '-' || text[ pos ] == '+' ) ) {
+    bool negate( text[ pos ] == '-' );
+    pos++;
+    svcSigExpressionUnary( text, pos, program, terms );
+    if ( negate ) {
+      svcsigexpressionop op = { SVCSIG_EXPRESSION_NEGATE, 0.0f, 0 };
+      program.push_back( op );
+    }
+    return;
+  }
+  svcSigExpressionPower( text, pos, program, terms );
+}
+
+void svcsigindices::svcSigExpressionPower( const std::string &text, size_t &pos, std::vector<svcsigexpressionop> &program, std::vector<svcsigexpressionterm> &terms ) const
+{
+  svcSigExpressionPrimary( text, pos, program, terms );
+  while ( pos < text.size() && std::isspace( static_cast<unsigned char>( text[ pos ] ) ) ) {
+    pos++;
+  }
+  if ( pos < text.size() && text[ pos ] == '^' ) {
+    pos++;
+    // right associative, and binds tighter than a unary minus on its left
+    svcSigExpressionUnary( text, pos, program, terms );
+    svcsigexpressionop op = { SVCSIG_EXPRESSION_POWER, 0.0f, 0 };
+    program.push_back( op );
+  }
+}
+
+void svcsigindices::svcSigExpressionPrimary( const std::string &text, size_t &pos, std::vector<svcsigexpressionop> &program, std::vector<svcsigexpressionterm> &terms ) const
+{
+  while ( pos < text.size() && std::isspace( static_cast<unsigned char>( text[ pos ] ) ) ) {
+    pos++;
+  }
+  if ( pos >= text.size() ) {
+    svcSigExpressionError( text, pos, "unexpected end" );
+  }
+  
+  // ( sum )
+  if ( text[ pos ] == '(' ) {
+    pos++;
+    svcSigExpressionSum( text, pos, program, terms );
+    svcSigExpressionExpect( text, pos, ')' );
+    return;
+  }
+  
+  // number
+  if ( std::isdigit( static_cast<unsigned char>( text[ pos ] ) ) || text[ pos ] == '.' ) {
+    svcsigexpressionop op = { SVCSIG_EXPRESSION_NUMBER, float( svcSigExpressionNumber( text, pos ) ), 0 };
+    program.push_back( op );
+    return;
+  }
+  
+  if ( !std::isalpha( static_cast<unsigned char>( text[ pos ] ) ) ) {
+    svcSigExpressionError( text, pos, "expected a number, band or function" );
+  }
+  size_t start( pos );
+  while ( pos < text.size() && std::isalpha( static_cast<unsigned char>( text[ pos ] ) ) ) {
+    pos++;
+  }
+  std::string name( text.substr( start, pos - start ) );
+  
+  // band
+  if ( name == "R" ) {
+    svcsigexpressionterm term;
+    if ( pos < text.size() && text[ pos ] == '[' ) {
+      pos++;
+      term.left = svcSigExpressionNumber( text, pos );
+      svcSigExpressionExpect( text, pos, ':' );
+      term.right = svcSigExpressionNumber( text, pos );
+      svcSigExpressionExpect( text, pos, ']' );
+      if ( term.right < term.left ) {
+        svcSigExpressionError( text, start, "the band range is reversed" );
+      }
+    }
+    else {
+      term.left = svcSigExpressionNumber( text, pos );
+      term.right = term.left;
+    }
+    svcsigexpressionop op = { SVCSIG_EXPRESSION_TERM, 0.0f, uint32_t( terms.size() ) };
+    terms.push_back( term );
+    program.push_back( op );
+    return;
+  }
+  
+  // function ( sum [, sum] )
+  svcsigexpressionop op = { 0, 0.0f, 0 };
+  if ( name == "abs" ) {
+    op.code = SVCSIG_EXPRESSION_ABS;
+  }
+  else if ( name == "sqrt" ) {
+    op.code = SVCSIG_EXPRESSION_SQRT;
+  }
+  else if ( name == "log" ) {
+    op.code = SVCSIG_EXPRESSION_LOG;
+  }
+  else if ( name == "exp" ) {
+    op.code = SVCSIG_EXPRESSION_EXP;
+  }
+  else if ( name == "min" ) {
+    op.code = SVCSIG_EXPRESSION_MIN;
+  }
+  else if ( name == "max" ) {
+    op.code = SVCSIG_EXPRESSION_MAX;
+  }
+  else {
+    svcSigExpressionError( text, start, "unknown function '" + name + "'" );
+  }
+  svcSigExpressionExpect( text, pos, '(' );
+  svcSigExpressionSum( text, pos, program, terms );
+  if ( op.code == SVCSIG_EXPRESSION_MIN || op.code == SVCSIG_EXPRESSION_MAX ) {
+    svcSigExpressionExpect( text, pos, ',' );
+    svcSigExpressionSum( text, pos, program, terms );
+  }
+  svcSigExpressionExpect( text, pos, ')' );
+  program.push_back( op );
+}
+
+double svcsigindices::svcSigExpressionNumber( const std::string &text, size_t &pos ) const
+{
+  while ( pos < text.size() && std::isspace( static_cast<unsigned char>( text[ pos ] ) ) ) {
+    pos++;
+  }
+  // strtod would also take a sign, inf or nan, which are not numbers here
+  if ( pos >= text.size() || !( std::isdigit( static_cast<unsigned char>( text[ pos ] ) ) || text[ pos ] == '.' ) ) {
+    svcSigExpressionError( text, pos, "expected a number" );
+  }
+  const char *begin( text.c_str() + pos );
+  char *end( NULL );
+  double value( std::strtod( begin, &end ) );
+  if ( end == begin ) {
+    svcSigExpressionError( text, pos, "expected a number" );
+  }
+  pos += end - begin;
+  return value;
+}
+
+void svcsigindices::svcSigExpressionExpect( const std::string &text, size_t &pos, const char &c ) const
+{
+  while ( pos < text.size() && std::isspace( static_cast<unsigned char>( text[ pos ] ) ) ) {
+    pos++;
+  }
+  if ( pos >= text.size() || text[ pos ] != c ) {
+    svcSigExpressionError( text, pos, std::string( "expected '" ) + c + "'" );
+  }
+  pos++;
+}
+
+void svcsigindices::svcSigExpressionError( const std::string &text, const size_t &pos, const std::string &message ) const
+{
+  std::ostringstream error;
+  error << "\"" << text << "\" at character " << pos + 1 << ": " << message;
+  throw invalidSVCsigExpression( error.str() );
+}
+
+// -- -- Binding and evaluation -- -- //
+
+std::shared_ptr<const svcsigexpressionbinding> svcsigindices::svcSigExpressionBind( const std::vector<float> &grid ) const
+{
+  // the bands that splicing keeps, ascending
+  std::shared_ptr<const svcsigsplicer> splicer( svcSigSplicer( grid, _options ) );
+  std::vector< std::pair<double, uint32_t> > order;
+  for ( size_t g = 0; g < splicer->segments().size(); g++ ) {
+    const svcsigsegment &segment( splicer->segments()[ g ] );
+    for ( size_t i = segment.first; i < segment.last; i++ ) {
+      if ( !std::isnan( grid[ i ] ) ) {
+        order.push_back( std::make_pair( double( grid[ i ] ), uint32_t( i ) ) );
+      }
+    }
+  }
+  std::stable_sort( order.begin(), order.end() );
+  std::vector<double> x( order.size() );
+  for ( size_t i = 0; i < order.size(); i++ ) {
+    x[ i ] = order[ i ].first;
+  }
+  
+  // the weight of each band in each term
+  std::vector< std::vector< std::pair<uint32_t, double> > > rows( _terms.size() );
+  std::vector<int> used( grid.size(), 0 );
+  for ( size_t t = 0; t < _terms.size(); t++ ) {
+    const svcsigexpressionterm &term( _terms[ t ] );
+    size_t lo( std::lower_bound( x.begin(), x.end(), term.left ) - x.begin() );
+    size_t hi( std::upper_bound( x.begin(), x.end(), term.right ) - x.begin() );
+    if ( term.left < term.right && hi > lo ) {
+      // the mean of the bands in the range
+      for ( size_t i = lo; i < hi; i++ ) {
+        rows[ t ].push_back( std::make_pair( order[ i ].second, 1.0 / ( hi - lo ) ) );
+      }
+    }
+    else {
+      // interpolate at the wavelength, or at the middle of a range too
+      // narrow to hold a band
+      double wavelength( 0.5 * ( term.left + term.right ) );
+      size_t k( std::upper_bound( x.begin(), x.end(), wavelength ) - x.begin() );
+      if ( k > 0 && x[ k - 1 ] == wavelength ) {
+        rows[ t ].push_back( std::make_pair( order[ k - 1 ].second, 1.0 ) );
+      }
+      else if ( k > 0 && k < x.size() ) {
+        double s( ( wavelength - x[ k - 1 ] ) / ( x[ k ] - x[ k - 1 ] ) );
+        rows[ t ].push_back( std::make_pair( order[ k - 1 ].second, 1.0 - s ) );
+        rows[ t ].push_back( std::make_pair( order[ k ].second, s ) );
+      }
+    }
+    for ( size_t i = 0; i < rows[ t ].size(); i++ ) {
+      used[ rows[ t ][ i ].first ] = 1;
+    }
+  }
+  
+  std::shared_ptr<svcsigexpressionbinding> binding( new svcsigexpressionbinding );
+  binding->sourceSize = grid.size();
+  std::vector<uint32_t> column( grid.size(), 0 );
+  for ( size_t i = 0; i < grid.size(); i++ ) {
+    if ( used[ i ] ) {
+      column[ i ] = binding->columns.size();
+      binding->columns.push_back( i );
+    }
+  }
+  binding->rows.push_back( 0 );
+  for ( size_t t = 0; t < rows.size(); t++ ) {
+    for ( size_t i = 0; i < rows[ t ].size(); i++ ) {
+      binding->index.push_back( column[ rows[ t ][ i ].first ] );
+      binding->weight.push_back( rows[ t ][ i ].second );
+    }
+    binding->rows.push_back( binding->index.size() );
+  }
+  return binding;
+}
+
+void svcsigindices::svcSigExpressionBlock( const svcsigexpressionbinding &binding, const float * const *in, const size_t &count, float *out, float *tile ) const
+{
+  const size_t B( SVCSIG_EXPRESSION_BLOCK );
+  
+  // gather the bands read into columns of B values
+  float *columns( tile );
+  for ( size_t c = 0; c < binding.columns.size(); c++ ) {
+    uint32_t band( binding.columns[ c ] );
+    for ( size_t s = 0; s < B; s++ ) {
+      columns[ c * B + s ] = s < count ? in[ s ][ band ] : 0.0f;
+    }
+  }
+  
+  // the terms
+  float *values( columns + binding.columns.size() * B );
+  for ( size_t t = 0; t + 1 < binding.rows.size(); t++ ) {
+    float sum[ SVCSIG_EXPRESSION_BLOCK ];
+    bool empty( binding.rows[ t ] == binding.rows[ t + 1 ] );
+    for ( size_t s = 0; s < B; s++ ) {
+      sum[ s ] = empty ? NAN : 0.0f;
+    }
+    for ( uint32_t k = binding.rows[ t ]; k < binding.rows[ t + 1 ]; k++ ) {
+      const float w( binding.weight[ k ] );
+      const float *column( columns + binding.index[ k ] * B );
+      for ( size_t s = 0; s < B; s++ ) {
+        sum[ s ] += w * column[ s ];
+      }
+    }
+    std::copy( sum, sum + B, values + t * B );
+  }
+  
+  // run every program over the block
+  float *stack( values + _terms.size() * B );
+  for ( size_t p = 0; p < _programs.size(); p++ ) {
+    const std::vector<svcsigexpressionop> &program( _programs[ p ] );
+    size_t top( 0 );
+    for ( size_t i = 0; i < program.size(); i++ ) {
+      const svcsigexpressionop &op( program[ i ] );
+      switch ( op.code ) {
+      case SVCSIG_EXPRESSION_NUMBER:
+        std::fill( stack + top * B, stack + ( top + 1 ) * B, op.value );
+        top++;
+        break;
+      case SVCSIG_EXPRESSION_TERM:
+        std::copy( values + op.term * B, values + ( op.term + 1 ) * B, stack + top * B );
+        top++;
+        break;
+      case SVCSIG_EXPRESSION_ADD:
+      case SVCSIG_EXPRESSION_SUBTRACT:
+      case SVCSIG_EXPRESSION_MULTIPLY:
+      case SVCSIG_EXPRESSION_DIVIDE:
+      case SVCSIG_EXPRESSION_POWER:
+      case SVCSIG_EXPRESSION_MIN:
+      case SVCSIG_EXPRESSION_MAX:
+        top--;
+        svcSigExpressionBinaryBlock( op.code, stack + ( top - 1 ) * B, stack + top * B );
+        break;
+      default:
+        svcSigExpressionUnaryBlock( op.code, stack + ( top - 1 ) * B );
+        break;
+      }
+    }
+    for ( size_t s = 0; s < count; s++ ) {
+      out[ s * _programs.size() + p ] = stack[ s ];
+    }
+  }
+}
+
+#endif // __svcsigexpression_hpp_
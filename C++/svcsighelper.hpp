@@ -8,6 +8,26 @@
  * HISTORY:
  *    2013-08-04: Written by Paul Romanczyk (RIT)
  *    2014-01-28: Updated documentation
+ *    2026-10-18: Added svcsigmembuf and invalidSVCsigTar
+ *    2026-10-18: Added invalidSVCsigCatalogue
+ *    2026-10-18: Added invalidSVCsigIndex
+ *    2026-10-18: Added invalidSVCsigQuery
+ *    2026-10-18: Added invalidSVCsigResample
+ *    2026-10-18: Added invalidSVCsigSrf
+ *    2026-10-18: Added invalidSVCsigSplice
+ *    2026-10-18: Added invalidSVCsigLibrary
+ *    2026-10-18: Added invalidSVCsigAnn
+ *    2026-10-18: Added invalidSVCsigStats
+ *    2026-10-18: Added invalidSVCsigQuantile
+ *    2026-10-18: Added invalidSVCsigSavgol
+ *    2026-10-18: Added invalidSVCsigContinuum
+ *    2026-10-18: Added invalidSVCsigExpression
+ *    2026-10-18: Added invalidSVCsigLookup
+ *    2026-10-18: Added invalidSVCsigEnvi
+ *    2026-10-18: Added invalidSVCsigNumpy
+ *    2026-10-18: Added svcSigStringFootprint()
+ *    2026-10-18: Added svcSigParseDecimal()
+ *    2026-10-18: Added invalidSVCsigShm
  *
  * REFERENCES:
  *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
@@ -43,8 +63,10 @@
 #ifndef __svcsighelper_h_
 #define __svcsighelper_h_
 
+#include <cstdlib>
 #include <string>
 #include <stdexcept>
+#include <streambuf>
 
 class notSvcSigFile : public std::runtime_error {
 public:
@@ -76,5 +98,263 @@ public:
   {}
 };
 
+class invalidSVCsigTar : public std::runtime_error {
+public:
+  invalidSVCsigTar()
+  : std::runtime_error( "Invalid tar archive" )
+  {}
+  invalidSVCsigTar( const std::string &message )
+  : std::runtime_error( "Invalid tar archive: " + message )
+  {}
+};
+
+class invalidSVCsigCatalogue : public std::runtime_error {
+public:
+  invalidSVCsigCatalogue()
+  : std::runtime_error( "Invalid SVC sig catalogue" )
+  {}
+  invalidSVCsigCatalogue( const std::string &message )
+  : std::runtime_error( "Invalid SVC sig catalogue: " + message )
+  {}
+};
+
+class invalidSVCsigIndex : public std::runtime_error {
+public:
+  invalidSVCsigIndex()
+  : std::runtime_error( "Invalid SVC sig index" )
+  {}
+  invalidSVCsigIndex( const std::string &message )
+  : std::runtime_error( "Invalid SVC sig index: " + message )
+  {}
+};
+
+class invalidSVCsigQuery : public std::runtime_error {
+public:
+  invalidSVCsigQuery()
+  : std::runtime_error( "Invalid SVC sig query" )
+  {}
+  invalidSVCsigQuery( const std::string &message )
+  : std::runtime_error( "Invalid SVC sig query: " + message )
+  {}
+};
+
+class invalidSVCsigResample : public std::runtime_error {
+public:
+  invalidSVCsigResample()
+  : std::runtime_error( "Invalid SVC sig resampling" )
+  {}
+  invalidSVCsigResample( const std::string &message )
+  : std::runtime_error( "Invalid SVC sig resampling: " + message )
+  {}
+};
+
+class invalidSVCsigSrf : public std::runtime_error {
+public:
+  invalidSVCsigSrf()
+  : std::runtime_error( "Invalid SVC sig spectral response" )
+  {}
+  invalidSVCsigSrf( const std::string &message )
+  : std::runtime_error( "Invalid SVC sig spectral response: " + message )
+  {}
+};
+
+class invalidSVCsigSplice : public std::runtime_error {
+public:
+  invalidSVCsigSplice()
+  : std::runtime_error( "Invalid SVC sig splice" )
+  {}
+  invalidSVCsigSplice( const std::string &message )
+  : std::runtime_error( "Invalid SVC sig splice: " + message )
+  {}
+};
+
+class invalidSVCsigLibrary : public std::runtime_error {
+public:
+  invalidSVCsigLibrary()
+  : std::runtime_error( "Invalid SVC sig library" )
+  {}
+  invalidSVCsigLibrary( const std::string &message )
+  : std::runtime_error( "Invalid SVC sig library: " + message )
+  {}
+};
+
+class invalidSVCsigAnn : public std::runtime_error {
+public:
+  invalidSVCsigAnn()
+  : std::runtime_error( "Invalid SVC sig ann" )
+  {}
+  invalidSVCsigAnn( const std::string &message )
+  : std::runtime_error( "Invalid SVC sig ann: " + message )
+  {}
+};
+
+class invalidSVCsigStats : public std::runtime_error {
+public:
+  invalidSVCsigStats()
+  : std::runtime_error( "Invalid SVC sig stats" )
+  {}
+  invalidSVCsigStats( const std::string &message )
+  : std::runtime_error( "Invalid SVC sig stats: " + message )
+  {}
+};
+
+class invalidSVCsigQuantile : public std::runtime_error {
+public:
+  invalidSVCsigQuantile()
+  : std::runtime_error( "Invalid SVC sig quantile" )
+  {}
+  invalidSVCsigQuantile( const std::string &message )
+  : std::runtime_error( "Invalid SVC sig quantile: " + message )
+  {}
+};
+
+class invalidSVCsigSavgol : public std::runtime_error {
+public:
+  invalidSVCsigSavgol()
+  : std::runtime_error( "Invalid SVC sig savgol" )
+  {}
+  invalidSVCsigSavgol( const std::string &message )
+  : std::runtime_error( "Invalid SVC sig savgol: " + message )
+  {}
+};
+
+class invalidSVCsigContinuum : public std::runtime_error {
+public:
+  invalidSVCsigContinuum()
+  : std::runtime_error( "Invalid SVC sig continuum" )
+  {}
+  invalidSVCsigContinuum( const std::string &message )
+  : std::runtime_error( "Invalid SVC sig continuum: " + message )
+  {}
+};
+
+class invalidSVCsigExpression : public std::runtime_error {
+public:
+  invalidSVCsigExpression()
+  : std::runtime_error( "Invalid SVC sig expression" )
+  {}
+  invalidSVCsigExpression( const std::string &message )
+  : std::runtime_error( "Invalid SVC sig expression: " + message )
+  {}
+};
+
+class invalidSVCsigLookup : public std::runtime_error {
+public:
+  invalidSVCsigLookup()
+  : std::runtime_error( "Invalid SVC sig lookup" )
+  {}
+  invalidSVCsigLookup( const std::string &message )
+  : std::runtime_error( "Invalid SVC sig lookup: " + message )
+  {}
+};
+
+class invalidSVCsigEnvi : public std::runtime_error {
+public:
+  invalidSVCsigEnvi()
+  : std::runtime_error( "Invalid SVC sig ENVI library" )
+  {}
+  invalidSVCsigEnvi( const std::string &message )
+  : std::runtime_error( "Invalid SVC sig ENVI library: " + message )
+  {}
+};
+
+class invalidSVCsigNumpy : public std::runtime_error {
+public:
+  invalidSVCsigNumpy()
+  : std::runtime_error( "Invalid SVC sig NumPy library" )
+  {}
+  invalidSVCsigNumpy( const std::string &message )
+  : std::runtime_error( "Invalid SVC sig NumPy library: " + message )
+  {}
+};
+
+class invalidSVCsigShm : public std::runtime_error {
+public:
+  invalidSVCsigShm()
+  : std::runtime_error( "Invalid SVC sig shared memory cache" )
+  {}
+  invalidSVCsigShm( const std::string &message )
+  : std::runtime_error( "Invalid SVC sig shared memory cache: " + message )
+  {}
+};
+
+/* Name: svcsigmembuf
+ *
+ * Description: A read only std::streambuf over a block of memory, so that a
+ *    sig file can be parsed with a std::istream without copying it
+ * Notes: The memory must outlive the streambuf
+ */
+class svcsigmembuf : public std::streambuf {
+public:
+  svcsigmembuf( const char *buffer, const size_t &size )
+  {
+    char *begin( const_cast<char *>( buffer ) );
+    setg( begin, begin, begin + size );
+  }
+};
+
+/* Name: size_t svcSigStringFootprint( const std::string &s )
+ *
+ * Description: Returns the heap memory used by a string
+ * Arguments: const std::string &s: the string
+ * Modifies:
+ * Returns: size_t bytes, 0 if the string is stored inside the object
+ * Pre:
+ * Post:
+ * Exceptions:
+ * Notes: The object itself (sizeof( std::string )) is not counted
+ */
+size_t svcSigStringFootprint( const std::string &s )
+{
+  const char *data( s.data() );
+  const char *object( reinterpret_cast<const char *>( &s ) );
+  if ( data >= object && data < object + sizeof( std::string ) ) {
+    return 0;
+  }
+  return s.capacity() + 1;
+}
+
+/* Name: double svcSigParseDecimal( const char *s )
+ *
+ * Description: atof() for the plain decimals of sig data lines
+ * Arguments: const char *s: the number, leading whitespace allowed
+ * Modifies:
+ * Returns: double, exactly what atof( s ) returns
+ * Pre:
+ * Post:
+ * Exceptions:
+ * Notes: Numbers of at most 15 digits, with no exponent, are converted as
+ *    digits / 10^decimals. Both are exact doubles, so the division is
+ *    correctly rounded (Clinger's fast path). Anything else goes to atof().
+ */
+double svcSigParseDecimal( const char *s )
+{
+  static const double powers[ 16 ] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+    1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+  const char *p( s );
+  while ( *p == ' ' || *p == '\t' || *p == '\n' || *p == '\r' || *p == '\v' || *p == '\f' ) {
+    p++;
+  }
+  bool negative( *p == '-' );
+  if ( *p == '-' || *p == '+' ) {
+    p++;
+  }
+  unsigned long long digits( 0 );
+  int count( 0 );
+  int decimals( 0 );
+  for ( ; *p >= '0' && *p <= '9'; p++, count++ ) {
+    digits = digits * 10 + ( *p - '0' );
+  }
+  if ( *p == '.' ) {
+    for ( p++; *p >= '0' && *p <= '9'; p++, count++, decimals++ ) {
+      digits = digits * 10 + ( *p - '0' );
+    }
+  }
+  if ( count == 0 || count > 15 || *p == 'e' || *p == 'E' || *p == 'x' || *p == 'X' ) {
+    return atof( s );
+  }
+  double value( double( digits ) / powers[ decimals ] );
+  return negative ? -value : value;
+}
 
 #endif // __svcsighelper_h_
\ No newline at end of file
@@ -0,0 +1,512 @@
+/*******************************************************************************
+ * svcsiglibrary.hpp
+ *
+ * DESCRIPTION:
+ *    Provides header and implimentation for the svcsiglibrary class, a
+ *    spectral library packed into one reflectance matrix for exact similarity
+ *    search: the k library spectra closest to each query by spectral angle,
+ *    Euclidean distance or Pearson correlation.
+ *
+ *    The norms, sums and centered norms of the library spectra are computed
+ *    when it is built, so every metric comes from one inner product per pair,
+ *    which uses AVX-512, AVX or SSE when the compiler targets them (e.g.
+ *    -march=native). The library is searched in tiles of rows on all cores,
+ *    and each tile is compared with every query while it is in cache.
+ *
+ *    Spectra are resampled onto the library grid when they are on another
+ *    one (see svcsigresample.hpp). Bands outside a spectrum's range are 0.
+ *
+ *    Build with -pthread.
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *    2026-10-18: Zero (empty or unreadable) spectra are never matched; files
+ *        are resampled once per grid
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *   F. A. Kruse et al., "The Spectral Image Processing System (SIPS)",
+ *     Remote Sensing of Environment 44, 1993 (spectral angle)
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsiglibrary_hpp_
+#define __svcsiglibrary_hpp_
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#if defined( __SSE2__ ) || defined( __AVX__ ) || defined( __AVX512F__ )
+#include <immintrin.h>
+#endif
+
+#include "svcsighelper.hpp"
+#include "svcsig.hpp"
+#include "svcsigbatch.hpp"
+#include "svcsigresample.hpp"
+
+#define SVCSIG_LIBRARY_ANGLE 0 // spectral angle (radians)
+#define SVCSIG_LIBRARY_EUCLIDEAN 1
+#define SVCSIG_LIBRARY_PEARSON 2 // 1 - Pearson correlation
+
+// library rows per parallel tile
+#define SVCSIG_LIBRARY_TILE 64
+
+
+// a search result: a library row and its distance from the query
+struct svcsigmatch {
+  size_t id;
+  double distance;
+};
+
+
+/* Name: float svcSigDot( const float *a, const float *b, const size_t &n )
+ *
+ * Description: The inner product of two vectors
+ * Arguments: const float *a, *b: the vectors
+ *            const size_t &n: their length
+ * Modifies:
+ * Returns: float
+ * Pre:
+ * Post:
+ * Exceptions:
+ * Notes: Uses AVX-512, AVX (with FMA if available) or SSE when the compiler
+ *    targets them
+ */
+float svcSigDot( const float *a, const float *b, const size_t &n )
+{
+  size_t i( 0 );
+  float sum( 0.0f );
+#if defined( __AVX512F__ )
+  __m512 acc16a( _mm512_setzero_ps() ), acc16b( _mm512_setzero_ps() );
+  for ( ; i + 32 <= n; i += 32 ) {
+    acc16a = _mm512_fmadd_ps( _mm512_loadu_ps( a + i ), _mm512_loadu_ps( b + i ), acc16a );
+    acc16b = _mm512_fmadd_ps( _mm512_loadu_ps( a + i + 16 ), _mm512_loadu_ps( b + i + 16 ), acc16b );
+  }
+  sum += _mm512_reduce_add_ps( _mm512_add_ps( acc16a, acc16b ) );
+#endif
+#if defined( __AVX__ )
+  __m256 acc8( _mm256_setzero_ps() );
+  for ( ; i + 8 <= n; i += 8 ) {
+#if defined( __FMA__ )
+    acc8 = _mm256_fmadd_ps( _mm256_loadu_ps( a + i ), _mm256_loadu_ps( b + i ), acc8 );
+#else
+    acc8 = _mm256_add_ps( acc8, _mm256_mul_ps( _mm256_loadu_ps( a + i ), _mm256_loadu_ps( b + i ) ) );
+#endif
+  }
+  __m128 half( _mm_add_ps( _mm256_castps256_ps128( acc8 ), _mm256_extractf128_ps( acc8, 1 ) ) );
+  half = _mm_add_ps( half, _mm_movehl_ps( half, half ) );
+  half = _mm_add_ss( half, _mm_shuffle_ps( half, half, 1 ) );
+  sum += _mm_cvtss_f32( half );
+#elif defined( __SSE2__ )
+  __m128 acc4( _mm_setzero_ps() );
+  for ( ; i + 4 <= n; i += 4 ) {
+    acc4 = _mm_add_ps( acc4, _mm_mul_ps( _mm_loadu_ps( a + i ), _mm_loadu_ps( b + i ) ) );
+  }
+  acc4 = _mm_add_ps( acc4, _mm_movehl_ps( acc4, acc4 ) );
+  acc4 = _mm_add_ss( acc4, _mm_shuffle_ps( acc4, acc4, 1 ) );
+  sum += _mm_cvtss_f32( acc4 );
+#endif
+  for ( ; i < n; i++ ) {
+    sum += a[ i ] * b[ i ];
+  }
+  return sum;
+}
+
+
+class svcsiglibrary {
+private:
+  std::vector<float> _grid;
+  size_t _size;
+  std::vector<float> _data; // _size rows of _grid.size() values
+  std::vector<double> _norm; // of each row
+  std::vector<double> _sum;
+  std::vector<double> _centered; // the norm of each row less its mean
+  
+  /* Name: std::vector< std::shared_ptr<const svcsigresampler> > svcSigLibraryResamplers( const std::vector<svcsig> &sigs ) const
+   *
+   * Description: The resampler onto the library grid of each sig file, looked
+   *    up once per grid; NULL for files on the library grid and empty files
+   */
+  std::vector< std::shared_ptr<const svcsigresampler> > svcSigLibraryResamplers( const std::vector<svcsig> &sigs ) const;
+  
+  /* Name: void svcSigLibraryRow( const svcsig &sig, const svcsigresampler *resampler, float *row ) const
+   *
+   * Description: Puts the reflectance of a sig file on the library grid,
+   *    with its resampler from svcSigLibraryResamplers()
+   */
+  void svcSigLibraryRow( const svcsig &sig, const svcsigresampler *resampler, float *row ) const;
+  
+  /* Name: void svcSigLibraryStats( const float *row, double &norm, double &sum, double &centered ) const
+   *
+   * Description: The norm, sum and centered norm of a spectrum
+   */
+  void svcSigLibraryStats( const float *row, double &norm, double &sum, double &centered ) const;
+  
+  /* Name: double svcSigLibraryMetric( const double &dot, const double &norm, const double &sum, const double &centered, const size_t &i, const int &metric ) const
+   *
+   * Description: The distance from a query to row i given their inner
+   *    product and the norm, sum and centered norm of the query
+   * Notes: NAN if either spectrum is zero (or constant, for
+   *    SVCSIG_LIBRARY_PEARSON), so such rows can never be matched
+   */
+  double svcSigLibraryMetric( const double &dot, const double &norm, const double &sum, const double &centered, const size_t &i, const int &metric ) const;
+
+public:
+  /* Name: svcsiglibrary()
+   *
+   * Description: Constructs an empty library
+   */
+  svcsiglibrary();
+  
+  /* Name: svcsiglibrary& build( const std::vector<svcsig> &sigs, const std::vector<float> &grid, const unsigned int &threads )
+   *
+   * Description: Packs the target reflectance of many sig files
+   * Arguments: const std::vector<svcsig> &sigs: the sig files; row i is
+   *                sigs[ i ]
+   *            const std::vector<float> &grid: the library grid, e.g.
+   *                svcSigResampleGrid( 350, 2500, 1 ), or empty for the grid
+   *                of the first file
+   *            const unsigned int &threads: the number of threads (0 for one
+   *                per core)
+   * Modifies: Everything
+   * Returns: *this
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Files on another grid are resampled (linearly)
+   */
+  svcsiglibrary& build( const std::vector<svcsig> &sigs, const std::vector<float> &grid = std::vector<float>(), const unsigned int &threads = 0 );
+  
+  /* Name: svcsiglibrary& build( const std::vector<float> &grid, const float *spectra, const size_t &count )
+   *
+   * Description: Packs spectra that are already on one grid
+   * Arguments: const std::vector<float> &grid: the grid
+   *            const float *spectra: count rows of grid.size() values
+   *            const size_t &count: the number of spectra
+   */
+  svcsiglibrary& build( const std::vector<float> &grid, const float *spectra, const size_t &count );
+  
+  /* Name: getters
+   *
+   * Description: size() is the number of spectra, grid() their wavelengths
+   *    and row( i ) the values of spectrum i
+   */
+  size_t size() const;
+  const std::vector<float> & grid() const;
+  const float * row( const size_t &i ) const;
+  
+  /* Name: double distance( const float *query, const size_t &i, const int &metric ) const
+   *
+   * Description: The distance from a query on the library grid to row i
+   * Arguments: const float *query: grid().size() values
+   *            const size_t &i: the row
+   *            const int &metric: SVCSIG_LIBRARY_ANGLE,
+   *                SVCSIG_LIBRARY_EUCLIDEAN or SVCSIG_LIBRARY_PEARSON
+   * Returns: double, NAN if the metric is undefined: a zero query or row (as
+   *     empty and unreadable files give), or a constant one for
+   *     SVCSIG_LIBRARY_PEARSON
+   */
+  double distance( const float *query, const size_t &i, const int &metric ) const;
+  
+  /* Name: void distances( const float *query, const size_t *ids, const size_t &count, const int &metric, double *out ) const
+   *
+   * Description: The distances from a query on the library grid to many rows
+   *    (e.g. to re-rank candidates)
+   * Arguments: const float *query: grid().size() values
+   *            const size_t *ids: the rows
+   *            const size_t &count: the number of rows
+   *            const int &metric: SVCSIG_LIBRARY_ANGLE,
+   *                SVCSIG_LIBRARY_EUCLIDEAN or SVCSIG_LIBRARY_PEARSON
+   *            double *out: count distances
+   * Modifies: out
+   * Exceptions: invalidSVCsigLibrary if the metric is unknown
+   */
+  void distances( const float *query, const size_t *ids, const size_t &count, const int &metric, double *out ) const;
+  
+  /* Name: std::vector< std::vector<svcsigmatch> > search( const float *queries, const size_t &count, const size_t &k, const int &metric, const unsigned int &threads ) const
+   *
+   * Description: Finds the k closest library spectra to each query
+   * Arguments: const float *queries: count rows of grid().size() values
+   *            const size_t &count: the number of queries
+   *            const size_t &k: the number of matches per query
+   *            const int &metric: SVCSIG_LIBRARY_ANGLE,
+   *                SVCSIG_LIBRARY_EUCLIDEAN or SVCSIG_LIBRARY_PEARSON
+   *            const unsigned int &threads: the number of threads (0 for one
+   *                per core)
+   * Modifies:
+   * Returns: the matches of each query, closest first (ties by row)
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigLibrary if the metric is unknown
+   * Notes: Rows at an undefined (NAN) distance are never matched. Distances
+   *    come from single precision inner products, so near identical spectra
+   *    are not exactly 0 apart.
+   */
+  std::vector< std::vector<svcsigmatch> > search( const float *queries, const size_t &count, const size_t &k, const int &metric = SVCSIG_LIBRARY_ANGLE, const unsigned int &threads = 0 ) const;
+  
+  /* Name: std::vector< std::vector<svcsigmatch> > search( const std::vector<svcsig> &queries, const size_t &k, const int &metric, const unsigned int &threads ) const
+   *
+   * Description: Finds the k closest library spectra to the target
+   *    reflectance of each sig file, resampling them onto the library grid
+   *    if they are on another grid
+   */
+  std::vector< std::vector<svcsigmatch> > search( const std::vector<svcsig> &queries, const size_t &k, const int &metric = SVCSIG_LIBRARY_ANGLE, const unsigned int &threads = 0 ) const;
+};
+
+
+// --- --- Implimentation --- --- //
+
+// -- -- Constructors -- -- //
+svcsiglibrary::svcsiglibrary()
+: _size( 0 )
+{
+}
+
+// -- -- Build -- -- //
+svcsiglibrary& svcsiglibrary::build( const std::vector<svcsig> &sigs, const std::vector<float> &grid, const unsigned int &threads )
+{
+  _grid = grid;
+  if ( _grid.empty() && !sigs.empty() ) {
+    _grid = sigs[ 0 ].wavelength();
+  }
+  _size = sigs.size();
+  size_t n( _grid.size() );
+  _data.assign( _size * n, 0.0f );
+  _norm.resize( _size );
+  _sum.resize( _size );
+  _centered.resize( _size );
+  std::vector< std::shared_ptr<const svcsigresampler> > resamplers( svcSigLibraryResamplers( sigs ) );
+  svcSigParallelFor( _size, threads, [&]( size_t i, unsigned int ) {
+    svcSigLibraryRow( sigs[ i ], resamplers[ i ].get(), &_data[ i * n ] );
+    svcSigLibraryStats( &_data[ i * n ], _norm[ i ], _sum[ i ], _centered[ i ] );
+  } );
+  return *this;
+}
+
+svcsiglibrary& svcsiglibrary::build( const std::vector<float> &grid, const float *spectra, const size_t &count )
+{
+  _grid = grid;
+  _size = count;
+  size_t n( _grid.size() );
+  _data.assign( spectra, spectra + count * n );
+  _norm.resize( _size );
+  _sum.resize( _size );
+  _centered.resize( _size );
+  for ( size_t i = 0; i < _size; i++ ) {
+    float *row( &_data[ i * n ] );
+    for ( size_t j = 0; j < n; j++ ) {
+      row[ j ] = std::isnan( row[ j ] ) ? 0.0f : row[ j ];
+    }
+    svcSigLibraryStats( row, _norm[ i ], _sum[ i ], _centered[ i ] );
+  }
+  return *this;
+}
+
+// -- -- Getters -- -- //
+size_t svcsiglibrary::size() const
+{
+  return _size;
+}
+
+const std::vector<float> & svcsiglibrary::grid() const
+{
+  return _grid;
+}
+
+const float * svcsiglibrary::row( const size_t &i ) const
+{
+  return &_data[ i * _grid.size() ];
+}
+
+// -- -- Search -- -- //
+double svcsiglibrary::distance( const float *query, const size_t &i, const int &metric ) const
+{
+  double d;
+  distances( query, &i, 1, metric, &d );
+  return d;
+}
+
+void svcsiglibrary::distances( const float *query, const size_t *ids, const size_t &count, const int &metric, double *out ) const
+{
+  if ( metric != SVCSIG_LIBRARY_ANGLE && metric != SVCSIG_LIBRARY_EUCLIDEAN && metric != SVCSIG_LIBRARY_PEARSON ) {
+    throw invalidSVCsigLibrary( "unknown metric" );
+  }
+  double norm, sum, centered;
+  svcSigLibraryStats( query, norm, sum, centered );
+  for ( size_t c = 0; c < count; c++ ) {
+    out[ c ] = svcSigLibraryMetric( svcSigDot( query, row( ids[ c ] ), _grid.size() ), norm, sum, centered, ids[ c ], metric );
+  }
+}
+
+std::vector< std::vector<svcsigmatch> > svcsiglibrary::search( const float *queries, const size_t &count, const size_t &k, const int &metric, const unsigned int &threads ) const
+{
+  if ( metric != SVCSIG_LIBRARY_ANGLE && metric != SVCSIG_LIBRARY_EUCLIDEAN && metric != SVCSIG_LIBRARY_PEARSON ) {
+    throw invalidSVCsigLibrary( "unknown metric" );
+  }
+  size_t n( _grid.size() );
+  std::vector<double> norm( count ), sum( count ), centered( count );
+  for ( size_t q = 0; q < count; q++ ) {
+    svcSigLibraryStats( queries + q * n, norm[ q ], sum[ q ], centered[ q ] );
+  }
+  
+  // a max heap of the best k so far, per thread and query
+  typedef std::pair<double, size_t> candidate;
+  typedef std::priority_queue<candidate> heap;
+  unsigned int nThreads( svcSigThreads( threads ) );
+  std::vector< std::vector<heap> > best( nThreads, std::vector<heap>( count ) );
+  
+  size_t tiles( ( _size + SVCSIG_LIBRARY_TILE - 1 ) / SVCSIG_LIBRARY_TILE );
+  svcSigParallelFor( tiles, nThreads, [&]( size_t tile, unsigned int thread ) {
+    size_t first( tile * SVCSIG_LIBRARY_TILE );
+    size_t last( std::min( _size, first + SVCSIG_LIBRARY_TILE ) );
+    for ( size_t q = 0; q < count; q++ ) {
+      const float *query( queries + q * n );
+      heap &h( best[ thread ][ q ] );
+      for ( size_t i = first; i < last; i++ ) {
+        double d( svcSigLibraryMetric( svcSigDot( query, &_data[ i * n ], n ), norm[ q ], sum[ q ], centered[ q ], i, metric ) );
+        if ( std::isnan( d ) || k == 0 ) {
+          continue;
+        }
+        if ( h.size() < k ) {
+          h.push( candidate( d, i ) );
+        }
+        else if ( candidate( d, i ) < h.top() ) {
+          h.pop();
+          h.push( candidate( d, i ) );
+        }
+      }
+    }
+  } );
+  
+  // merge the threads
+  std::vector< std::vector<svcsigmatch> > matches( count );
+  for ( size_t q = 0; q < count; q++ ) {
+    std::vector<candidate> all;
+    for ( unsigned int t = 0; t < nThreads; t++ ) {
+      heap &h( best[ t ][ q ] );
+      while ( !h.empty() ) {
+        all.push_back( h.top() );
+        h.pop();
+      }
+    }
+    std::sort( all.begin(), all.end() );
+    for ( size_t i = 0; i < all.size() && i < k; i++ ) {
+      svcsigmatch match;
+      match.id = all[ i ].second;
+      match.distance = all[ i ].first;
+      matches[ q ].push_back( match );
+    }
+  }
+  return matches;
+}
+
+std::vector< std::vector<svcsigmatch> > svcsiglibrary::search( const std::vector<svcsig> &queries, const size_t &k, const int &metric, const unsigned int &threads ) const
+{
+  size_t n( _grid.size() );
+  std::vector<float> packed( queries.size() * n, 0.0f );
+  std::vector< std::shared_ptr<const svcsigresampler> > resamplers( svcSigLibraryResamplers( queries ) );
+  for ( size_t q = 0; q < queries.size(); q++ ) {
+    svcSigLibraryRow( queries[ q ], resamplers[ q ].get(), &packed[ q * n ] );
+  }
+  return search( packed.data(), queries.size(), k, metric, threads );
+}
+
+// -- -- Helper Functions -- -- //
+std::vector< std::shared_ptr<const svcsigresampler> > svcsiglibrary::svcSigLibraryResamplers( const std::vector<svcsig> &sigs ) const
+{
+  std::vector< std::shared_ptr<const svcsigresampler> > resamplers( sigs.size() );
+  std::map< std::vector<float>, std::vector<size_t> > groups( svcSigGroupByGrid( sigs ) );
+  for ( std::map< std::vector<float>, std::vector<size_t> >::const_iterator g = groups.begin(); g != groups.end(); ++g ) {
+    if ( g->first == _grid ) {
+      continue;
+    }
+    std::shared_ptr<const svcsigresampler> resampler( svcSigResampler( g->first, _grid, SVCSIG_RESAMPLE_LINEAR ) );
+    for ( size_t i = 0; i < g->second.size(); i++ ) {
+      resamplers[ g->second[ i ] ] = resampler;
+    }
+  }
+  return resamplers;
+}
+
+void svcsiglibrary::svcSigLibraryRow( const svcsig &sig, const svcsigresampler *resampler, float *row ) const
+{
+  size_t n( _grid.size() );
+  if ( sig.size() == 0 ) {
+    std::fill( row, row + n, 0.0f );
+    return;
+  }
+  if ( resampler == NULL ) {
+    std::copy( sig.targetReflectanceData(), sig.targetReflectanceData() + n, row );
+  }
+  else {
+    resampler->apply( sig.targetReflectanceData(), row );
+  }
+  for ( size_t j = 0; j < n; j++ ) {
+    row[ j ] = std::isnan( row[ j ] ) ? 0.0f : row[ j ];
+  }
+}
+
+void svcsiglibrary::svcSigLibraryStats( const float *row, double &norm, double &sum, double &centered ) const
+{
+  size_t n( _grid.size() );
+  double squares( 0.0 );
+  sum = 0.0;
+  for ( size_t j = 0; j < n; j++ ) {
+    sum += row[ j ];
+    squares += double( row[ j ] ) * row[ j ];
+  }
+  norm = std::sqrt( squares );
+  centered = n > 0 ? std::sqrt( std::max( 0.0, squares - sum * sum / n ) ) : 0.0;
+}
+
+double svcsiglibrary::svcSigLibraryMetric( const double &dot, const double &norm, const double &sum, const double &centered, const size_t &i, const int &metric ) const
+{
+  // a zero spectrum (an empty or unreadable file, or one with no overlap
+  // with the grid) has no direction, and must not rank as a match
+  if ( norm == 0.0 || _norm[ i ] == 0.0 ) {
+    return NAN;
+  }
+  if ( metric == SVCSIG_LIBRARY_ANGLE ) {
+    return std::acos( std::max( -1.0, std::min( 1.0, dot / ( norm * _norm[ i ] ) ) ) );
+  }
+  if ( metric == SVCSIG_LIBRARY_EUCLIDEAN ) {
+    return std::sqrt( std::max( 0.0, norm * norm + _norm[ i ] * _norm[ i ] - 2.0 * dot ) );
+  }
+  if ( centered == 0.0 || _centered[ i ] == 0.0 ) {
+    return NAN;
+  }
+  return 1.0 - ( dot - sum * _sum[ i ] / _grid.size() ) / ( centered * _centered[ i ] );
+}
+
+#endif // __svcsiglibrary_hpp_
@@ -0,0 +1,454 @@
+/*******************************************************************************
+ * svcsiglookup.hpp
+ *
+ * DESCRIPTION:
+ *    Provides header and implimentation for the svcsiglookup class, which
+ *    maps wavelengths to the bands (rows) of a wavelength grid: the nearest
+ *    band, the pair of bands either side with interpolation weights, and the
+ *    bands in a range, per detector segment or over the whole grid.
+ *
+ *    A lookup is built once per grid and shared by every spectrum on it (see
+ *    svcSigLookup()). Each detector segment has a table of buckets, one per
+ *    band, of equal width in wavelength; a wavelength's bucket is found by
+ *    arithmetic, and only the bands in that bucket are searched. Near
+ *    uniform segments (all of the SVC detectors) have at most a couple of
+ *    bands per bucket, so a lookup takes constant time; uneven segments
+ *    fall back to a binary search of the bucket, no worse than O(log n).
+ *
+ *    Where detector segments overlap, whole grid queries use the segment
+ *    that splicing keeps (the lower segment up to the middle of the overlap,
+ *    see svcsigsplice.hpp).
+ *
+ *    Build with -pthread.
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsiglookup_hpp_
+#define __svcsiglookup_hpp_
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "svcsighelper.hpp"
+#include "svcsig.hpp"
+#include "svcsigsplice.hpp"
+
+// no band or segment
+#define SVCSIG_LOOKUP_NONE ( ~size_t( 0 ) )
+
+
+// the bands either side of a wavelength: its value is
+// ( 1 - weight ) * spectrum[ lower ] + weight * spectrum[ upper ]. lower ==
+// upper (weight 0) on a band, and both are SVCSIG_LOOKUP_NONE outside the grid.
+struct svcsigbracket {
+  size_t lower;
+  size_t upper;
+  double weight;
+};
+
+
+class svcsiglookup {
+private:
+  std::vector<float> _grid;
+  std::vector<svcsigsegment> _segments;
+  std::vector<double> _cuts; // one per join; segment k keeps ( cut k - 1, cut k ]
+  std::vector<double> _scale; // buckets per nm of each segment
+  std::vector< std::vector<uint32_t> > _buckets; // the first band of each bucket, and the end
+  
+  /* Name: size_t svcSigLookupLower( const size_t &k, const double &wavelength ) const
+   *
+   * Description: The first band of segment k at or above a wavelength
+   * Returns: size_t in [begin, end] of the segment
+   */
+  size_t svcSigLookupLower( const size_t &k, const double &wavelength ) const;
+  
+  /* Name: size_t svcSigLookupUpper( const size_t &k, const double &wavelength ) const
+   *
+   * Description: The first band of segment k above a wavelength
+   * Returns: size_t in [begin, end] of the segment
+   */
+  size_t svcSigLookupUpper( const size_t &k, const double &wavelength ) const;
+  
+  /* Name: size_t svcSigLookupSegment( const double &wavelength ) const
+   *
+   * Description: The segment that keeps a wavelength by the cuts alone: the
+   *    first segment outside the grid below, the last above
+   * Notes: A scan; there are only a few cuts
+   */
+  size_t svcSigLookupSegment( const double &wavelength ) const;
+  
+  /* Name: void svcSigLookupCheck( const size_t &k ) const
+   *
+   * Description: Throws invalidSVCsigLookup if there is no segment k
+   */
+  void svcSigLookupCheck( const size_t &k ) const;
+
+public:
+  /* Name: svcsiglookup( const std::vector<float> &grid )
+   *
+   * Description: Builds the lookup of a wavelength grid
+   * Arguments: const std::vector<float> &grid: the wavelengths of a sig file
+   *     (svcsig::wavelength())
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Linear time. The segments are those of svcsigsplicer.
+   */
+  svcsiglookup( const std::vector<float> &grid );
+  
+  /* Name: getters
+   *
+   * Description: size() is the number of bands of the grid, wavelength() the
+   *    grid, segments() the detector segments and cuts() where the whole
+   *    grid queries change segment (nm)
+   */
+  size_t size() const;
+  const std::vector<float> & wavelength() const;
+  const std::vector<svcsigsegment> & segments() const;
+  const std::vector<double> & cuts() const;
+  
+  /* Name: size_t segment( const double &wavelength ) const
+   *
+   * Description: The segment that splicing keeps at a wavelength
+   * Returns: size_t, SVCSIG_LOOKUP_NONE if the wavelength is outside the
+   *     grid (or NAN)
+   */
+  size_t segment( const double &wavelength ) const;
+  
+  /* Name: size_t nearest( const double &wavelength, const size_t &k ) const
+   *
+   * Description: The band of segment k nearest a wavelength
+   * Arguments: const double &wavelength: the wavelength (nm)
+   *            const size_t &k: the segment
+   * Modifies:
+   * Returns: size_t, the band (row) of the grid; the first or last band of
+   *     the segment outside it, SVCSIG_LOOKUP_NONE for NAN
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigLookup if there is no segment k
+   * Notes: Ties go to the lower band
+   */
+  size_t nearest( const double &wavelength, const size_t &k ) const;
+  
+  /* Name: size_t nearest( const double &wavelength ) const
+   *
+   * Description: The nearest band of the segment that splicing keeps at a
+   *    wavelength (the first or last segment outside the grid)
+   */
+  size_t nearest( const double &wavelength ) const;
+  
+  /* Name: svcsigbracket bracket( const double &wavelength, const size_t &k ) const
+   *
+   * Description: The bands of segment k either side of a wavelength, and the
+   *    weights that interpolate between them
+   * Arguments: const double &wavelength: the wavelength (nm)
+   *            const size_t &k: the segment
+   * Modifies:
+   * Returns: svcsigbracket, SVCSIG_LOOKUP_NONE outside the segment
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigLookup if there is no segment k
+   * Notes:
+   */
+  svcsigbracket bracket( const double &wavelength, const size_t &k ) const;
+  
+  /* Name: svcsigbracket bracket( const double &wavelength ) const
+   *
+   * Description: The bracket in the segment that splicing keeps at a
+   *    wavelength
+   * Notes: Near a cut, one side may be past the cut (but never past the end
+   *    of the segment)
+   */
+  svcsigbracket bracket( const double &wavelength ) const;
+  
+  /* Name: void range( const double &left, const double &right, const size_t &k, size_t &begin, size_t &end ) const
+   *
+   * Description: The bands of segment k from left to right (nm), inclusive
+   * Arguments: const double &left, &right: the range (nm)
+   *            const size_t &k: the segment
+   *            size_t &begin, &end: the bands [begin, end) of the grid;
+   *                begin == end if there are none
+   * Modifies: begin, end
+   * Exceptions: invalidSVCsigLookup if there is no segment k
+   */
+  void range( const double &left, const double &right, const size_t &k, size_t &begin, size_t &end ) const;
+  
+  /* Name: std::vector<size_t> range( const double &left, const double &right ) const
+   *
+   * Description: The bands from left to right (nm), inclusive, that splicing
+   *    keeps
+   * Returns: std::vector<size_t>, ascending in wavelength
+   */
+  std::vector<size_t> range( const double &left, const double &right ) const;
+};
+
+/* Name: std::shared_ptr<const svcsiglookup> svcSigLookup( const std::vector<float> &grid )
+ *
+ * Description: Returns the lookup of a wavelength grid, building it the first
+ *    time the grid is seen
+ * Arguments: const std::vector<float> &grid: the wavelengths (e.g.
+ *     svcsig::wavelength())
+ * Modifies: the process wide cache
+ * Returns: std::shared_ptr<const svcsiglookup>
+ * Pre:
+ * Post:
+ * Exceptions:
+ * Notes: Thread safe. Finding the grid costs a comparison of it, so keep the
+ *    returned lookup to look up many wavelengths or spectra.
+ */
+std::shared_ptr<const svcsiglookup> svcSigLookup( const std::vector<float> &grid );
+
+
+// --- --- Implimentation --- --- //
+
+// -- -- Constructors -- -- //
+svcsiglookup::svcsiglookup( const std::vector<float> &grid )
+: _grid( grid )
+{
+  std::shared_ptr<const svcsigsplicer> splicer( svcSigSplicer( grid ) );
+  _segments = splicer->segments();
+  _cuts = splicer->cuts();
+  
+  // the buckets of each segment: bucket b starts b / scale nm above its first
+  // band. A band's bucket is found with the same arithmetic as a query's, so
+  // rounding can not put a band in the wrong one.
+  for ( size_t k = 0; k < _segments.size(); k++ ) {
+    const svcsigsegment &segment( _segments[ k ] );
+    size_t n( segment.end - segment.begin );
+    double low( grid[ segment.begin ] );
+    double high( grid[ segment.end - 1 ] );
+    double scale( n > 1 && high > low ? ( n - 1 ) / ( high - low ) : 0.0 );
+    std::vector<uint32_t> buckets( n + 1 );
+    size_t b( 0 );
+    for ( size_t i = 0; i < n; i++ ) {
+      size_t bucket( std::min( size_t( ( grid[ segment.begin + i ] - low ) * scale ), n - 1 ) );
+      while ( b <= bucket ) {
+        buckets[ b++ ] = i;
+      }
+    }
+    while ( b <= n ) {
+      buckets[ b++ ] = n;
+    }
+    _scale.push_back( scale );
+    _buckets.push_back( buckets );
+  }
+}
+
+// -- -- Getters -- -- //
+size_t svcsiglookup::size() const
+{
+  return _grid.size();
+}
+
+const std::vector<float> & svcsiglookup::wavelength() const
+{
+  return _grid;
+}
+
+const std::vector<svcsigsegment> & svcsiglookup::segments() const
+{
+  return _segments;
+}
+
+const std::vector<double> & svcsiglookup::cuts() const
+{
+  return _cuts;
+}
+
+// -- -- Queries -- -- //
+size_t svcsiglookup::segment( const double &wavelength ) const
+{
+  if ( _segments.empty() || std::isnan( wavelength ) ) {
+    return SVCSIG_LOOKUP_NONE;
+  }
+  size_t k( svcSigLookupSegment( wavelength ) );
+  const svcsigsegment &found( _segments[ k ] );
+  if ( !( wavelength >= _grid[ found.begin ] && wavelength <= _grid[ found.end - 1 ] ) ) {
+    return SVCSIG_LOOKUP_NONE;
+  }
+  return k;
+}
+
+size_t svcsiglookup::nearest( const double &wavelength, const size_t &k ) const
+{
+  svcSigLookupCheck( k );
+  if ( std::isnan( wavelength ) ) {
+    return SVCSIG_LOOKUP_NONE;
+  }
+  const svcsigsegment &found( _segments[ k ] );
+  size_t i( svcSigLookupLower( k, wavelength ) );
+  if ( i == found.end ) {
+    return i - 1;
+  }
+  if ( i > found.begin && wavelength - _grid[ i - 1 ] <= _grid[ i ] - wavelength ) {
+    return i - 1;
+  }
+  return i;
+}
+
+size_t svcsiglookup::nearest( const double &wavelength ) const
+{
+  if ( _segments.empty() || std::isnan( wavelength ) ) {
+    return SVCSIG_LOOKUP_NONE;
+  }
+  size_t k( svcSigLookupSegment( wavelength ) );
+  return nearest( wavelength, k );
+}
+
+svcsigbracket svcsiglookup::bracket( const double &wavelength, const size_t &k ) const
+{
+  svcSigLookupCheck( k );
+  svcsigbracket found = { SVCSIG_LOOKUP_NONE, SVCSIG_LOOKUP_NONE, 0.0 };
+  const svcsigsegment &segment( _segments[ k ] );
+  if ( !( wavelength >= _grid[ segment.begin ] && wavelength <= _grid[ segment.end - 1 ] ) ) {
+    return found;
+  }
+  size_t i( svcSigLookupLower( k, wavelength ) );
+  if ( _grid[ i ] == wavelength ) {
+    found.lower = i;
+    found.upper = i;
+  }
+  else {
+    found.lower = i - 1;
+    found.upper = i;
+    found.weight = ( wavelength - _grid[ i - 1 ] ) / ( _grid[ i ] - _grid[ i - 1 ] );
+  }
+  return found;
+}
+
+svcsigbracket svcsiglookup::bracket( const double &wavelength ) const
+{
+  size_t k( segment( wavelength ) );
+  if ( k == SVCSIG_LOOKUP_NONE ) {
+    svcsigbracket found = { SVCSIG_LOOKUP_NONE, SVCSIG_LOOKUP_NONE, 0.0 };
+    return found;
+  }
+  return bracket( wavelength, k );
+}
+
+void svcsiglookup::range( const double &left, const double &right, const size_t &k, size_t &begin, size_t &end ) const
+{
+  svcSigLookupCheck( k );
+  begin = svcSigLookupLower( k, left );
+  end = std::max( begin, svcSigLookupUpper( k, right ) );
+}
+
+std::vector<size_t> svcsiglookup::range( const double &left, const double &right ) const
+{
+  std::vector<size_t> bands;
+  for ( size_t k = 0; k < _segments.size(); k++ ) {
+    // segment k keeps ( cut k - 1, cut k ]
+    size_t begin( k > 0 && !( left > _cuts[ k - 1 ] ) ? svcSigLookupUpper( k, _cuts[ k - 1 ] ) : svcSigLookupLower( k, left ) );
+    size_t end( k < _cuts.size() && right > _cuts[ k ] ? svcSigLookupUpper( k, _cuts[ k ] ) : svcSigLookupUpper( k, right ) );
+    for ( size_t i = begin; i < end; i++ ) {
+      bands.push_back( i );
+    }
+  }
+  return bands;
+}
+
+// -- -- Helpers -- -- //
+size_t svcsiglookup::svcSigLookupLower( const size_t &k, const double &wavelength ) const
+{
+  const svcsigsegment &segment( _segments[ k ] );
+  double low( _grid[ segment.begin ] );
+  if ( !( wavelength > low ) ) {
+    return segment.begin;
+  }
+  if ( wavelength > _grid[ segment.end - 1 ] ) {
+    return segment.end;
+  }
+  const std::vector<uint32_t> &buckets( _buckets[ k ] );
+  size_t n( segment.end - segment.begin );
+  size_t bucket( std::min( size_t( ( wavelength - low ) * _scale[ k ] ), n - 1 ) );
+  const float *first( _grid.data() + segment.begin );
+  return std::lower_bound( first + buckets[ bucket ], first + buckets[ bucket + 1 ], wavelength ) - _grid.data();
+}
+
+size_t svcsiglookup::svcSigLookupUpper( const size_t &k, const double &wavelength ) const
+{
+  // the wavelengths of a segment increase, so at most one band equals it
+  size_t i( svcSigLookupLower( k, wavelength ) );
+  return i < _segments[ k ].end && _grid[ i ] == wavelength ? i + 1 : i;
+}
+
+size_t svcsiglookup::svcSigLookupSegment( const double &wavelength ) const
+{
+  size_t k( 0 );
+  while ( k < _cuts.size() && wavelength > _cuts[ k ] ) {
+    k++;
+  }
+  return k;
+}
+
+void svcsiglookup::svcSigLookupCheck( const size_t &k ) const
+{
+  if ( k >= _segments.size() ) {
+    throw invalidSVCsigLookup( "there is no segment " + std::to_string( k ) );
+  }
+}
+
+// -- -- Cache -- -- //
+std::shared_ptr<const svcsiglookup> svcSigLookup( const std::vector<float> &grid )
+{
+  static std::mutex lock;
+  static std::map< std::string, std::shared_ptr<const svcsiglookup> > cache;
+  
+  // the key is the grid, byte for byte
+  std::string key;
+  if ( !grid.empty() ) {
+    key.assign( reinterpret_cast<const char *>( grid.data() ), grid.size() * sizeof( float ) );
+  }
+  
+  {
+    std::lock_guard<std::mutex> guard( lock );
+    std::map< std::string, std::shared_ptr<const svcsiglookup> >::const_iterator found( cache.find( key ) );
+    if ( found != cache.end() ) {
+      return found->second;
+    }
+  }
+  std::shared_ptr<const svcsiglookup> lookup( new svcsiglookup( grid ) );
+  std::lock_guard<std::mutex> guard( lock );
+  return cache.insert( std::make_pair( key, lookup ) ).first->second;
+}
+
+#endif // __svcsiglookup_hpp_
@@ -0,0 +1,759 @@
+/*******************************************************************************
+ * svcsignumpy.hpp
+ *
+ * DESCRIPTION:
+ *    Provides header and implimentation for the svcsignumpy class, which
+ *    writes collections of sig files as NumPy arrays: the wavelength grid,
+ *    the reference radiance, target radiance and reflectance matrices (one
+ *    float32 row per file), and a structured array of header fields (names,
+ *    times, positions, integration times, coadds, temperatures, ...).
+ *
+ *    A library is written either to a directory of .npy files, which
+ *    numpy.load( filename, mmap_mode='r' ) opens instantly with nothing
+ *    parsed, or to a single uncompressed .npz file (numpy reads the members
+ *    of an .npz into memory; it can not memory map them).
+ *
+ *    A library has one wavelength grid, by default that of the first file.
+ *    Files on the grid are copied as they are (overlapping detector bands
+ *    included, as readSVCsig() returns them); files on other grids are
+ *    resampled onto it (see svcsigresample.hpp).
+ *
+ *    Rows are written as they are added, so memory does not grow with the
+ *    size of the library; the .npy headers leave room for the final shape,
+ *    which close() fills in. Everything is written to .tmp files that are
+ *    renamed into place by close().
+ *
+ *    Build with -pthread.
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *    2026-10-18: The CRC-32 tables are built by a thread safe static
+ *    2026-10-18: add( sigs ) looks up one resampler per grid
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *   "A Simple File Format for NumPy Arrays", NumPy Enhancement Proposal 1
+ *   "APPNOTE.TXT - .ZIP File Format Specification" v6.3, PKWARE, 2012
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsignumpy_hpp_
+#define __svcsignumpy_hpp_
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "svcsighelper.hpp"
+#include "svcsig.hpp"
+#include "svcsigbatch.hpp"
+#include "svcsigresample.hpp"
+
+// the number of files converted together by the collection writers
+#define SVCSIG_NUMPY_CHUNK 1024
+
+// the members of a library: the matrices and header array are streamed, the
+// wavelengths are written by close()
+#define SVCSIG_NUMPY_REFERENCE 0
+#define SVCSIG_NUMPY_TARGET 1
+#define SVCSIG_NUMPY_REFLECTANCE 2
+#define SVCSIG_NUMPY_HEADER 3
+#define SVCSIG_NUMPY_WAVELENGTH 4
+#define SVCSIG_NUMPY_MEMBERS 5
+
+// the header array: the size of its string fields, and of a record
+#define SVCSIG_NUMPY_NAME 64
+#define SVCSIG_NUMPY_TIME 32
+#define SVCSIG_NUMPY_RECORD 336
+
+
+class svcsignumpy {
+private:
+  std::string _path;
+  bool _npz;
+  std::vector<float> _grid;
+  int _mode;
+  FILE *_files[ SVCSIG_NUMPY_HEADER + 1 ];
+  size_t _count;
+  
+  svcsignumpy( const svcsignumpy &other );
+  svcsignumpy& operator=( const svcsignumpy &other );
+  
+  /* Name: std::string svcSigNumpyFile( const size_t &member, const bool &tmp ) const
+   *
+   * Description: The file of a member, or its .tmp file
+   */
+  std::string svcSigNumpyFile( const size_t &member, const bool &tmp ) const;
+  
+  /* Name: void svcSigNumpyRow( const svcsig &sig, const svcsigresampler *resampler, float *reference, float *target, float *reflectance, char *header ) const
+   *
+   * Description: Converts a sig file to a row of each matrix (resampled onto
+   *    the grid with resampler, or copied if it is NULL) and a header record
+   * Modifies: reference, target, reflectance (grid().size() values each, NAN
+   *     for an empty file), header (SVCSIG_NUMPY_RECORD bytes)
+   */
+  void svcSigNumpyRow( const svcsig &sig, const svcsigresampler *resampler, float *reference, float *target, float *reflectance, char *header ) const;
+  
+  /* Name: void svcSigNumpyWrite( const std::vector<float> *rows, const std::vector<char> &headers, const size_t &count )
+   *
+   * Description: Appends count rows to the matrices and header array
+   * Exceptions: invalidSVCsigNumpy if they can not be written (the library is
+   *     abandoned)
+   */
+  void svcSigNumpyWrite( const std::vector<float> *rows, const std::vector<char> &headers, const size_t &count );
+  
+  /* Name: bool svcSigNumpyZip( const std::string &filename ) const
+   *
+   * Description: Stores the finished .tmp members in an (uncompressed, zip64)
+   *    .npz file
+   * Returns: bool, false if it could not be written
+   */
+  bool svcSigNumpyZip( const std::string &filename ) const;
+  
+  /* Name: void svcSigNumpyAbandon()
+   *
+   * Description: Closes and removes the .tmp files
+   */
+  void svcSigNumpyAbandon();
+
+public:
+  /* Name: svcsignumpy( const std::string &path, const std::vector<float> &grid, const int &mode )
+   *
+   * Description: Starts a library
+   * Arguments: const std::string &path: a .npz file, or otherwise a directory
+   *                (created if needed) for wavelength.npy, reference.npy,
+   *                target.npy, reflectance.npy and header.npy
+   *            const std::vector<float> &grid: the wavelengths of the library,
+   *                empty for those of the first file added
+   *            const int &mode: how files on other grids are resampled,
+   *                SVCSIG_RESAMPLE_LINEAR, SVCSIG_RESAMPLE_CUBIC or
+   *                SVCSIG_RESAMPLE_PCHIP
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post: the .tmp files are open
+   * Exceptions: invalidSVCsigNumpy for an unknown mode, or if the files can
+   *     not be created
+   * Notes:
+   */
+  svcsignumpy( const std::string &path, const std::vector<float> &grid = std::vector<float>(), const int &mode = SVCSIG_RESAMPLE_LINEAR );
+  
+  /* Name: ~svcsignumpy()
+   *
+   * Description: Removes the .tmp files of a library that was not closed
+   * Notes: Call close() to keep the library
+   */
+  ~svcsignumpy();
+  
+  /* Name: getters
+   *
+   * Description: path() is the .npz file or directory, grid() the
+   *    wavelengths (empty until the first file if none were given) and size()
+   *    the number of files written so far
+   */
+  std::string path() const;
+  const std::vector<float> & grid() const;
+  size_t size() const;
+  
+  /* Name: svcsignumpy& add( const svcsig &sig )
+   *
+   * Description: Writes a sig file
+   * Modifies: the library
+   * Returns: *this
+   * Exceptions: invalidSVCsigNumpy if the library is closed, has no grid (the
+   *     first file is empty) or can not be written
+   */
+  svcsignumpy& add( const svcsig &sig );
+  
+  /* Name: svcsignumpy& add( const std::vector<svcsig> &sigs, const unsigned int &threads )
+   *
+   * Description: Writes many sig files, converting them across worker
+   *    threads SVCSIG_NUMPY_CHUNK at a time
+   * Arguments: const std::vector<svcsig> &sigs: the sig files, on any grids
+   *            const unsigned int &threads: the number of threads (0 for one
+   *                per core)
+   * Returns: *this
+   * Notes: Files are grouped by grid (svcSigGroupByGrid()) and the resampler
+   *    of each grid is looked up once
+   */
+  svcsignumpy& add( const std::vector<svcsig> &sigs, const unsigned int &threads = 0 );
+  
+  /* Name: void close()
+   *
+   * Description: Writes the shapes and the wavelengths, and renames the
+   *    library into place
+   * Modifies: the library
+   * Returns:
+   * Pre:
+   * Post: the library is closed; further adds throw
+   * Exceptions: invalidSVCsigNumpy if the files can not be written
+   * Notes: A library with no files has matrices of shape ( 0, bands )
+   */
+  void close();
+};
+
+/* Name: std::string svcSigNumpyHeader( const std::string &descr, const std::string &shape, const size_t &length )
+ *
+ * Description: The header of a .npy (version 1.0) file
+ * Arguments: const std::string &descr: the dtype, e.g. "'<f4'"
+ *            const std::string &shape: the shape, e.g. "(10, 1024)"
+ *            const size_t &length: the length to pad the header to, 0 for
+ *                the shortest that has room for any shape of as many
+ *                dimensions
+ * Returns: std::string, a multiple of 64 bytes long
+ */
+std::string svcSigNumpyHeader( const std::string &descr, const std::string &shape, const size_t &length = 0 );
+
+/* Name: uint32_t svcSigCrc32( uint32_t crc, const char *data, const size_t &size )
+ *
+ * Description: Updates the CRC-32 (as used by zip and gzip) of a stream
+ * Arguments: uint32_t crc: the CRC of the data so far, 0 to start
+ *            const char *data, const size_t &size: the next bytes
+ * Returns: uint32_t
+ * Notes: Slicing by 8, about 1 byte per cycle
+ */
+uint32_t svcSigCrc32( uint32_t crc, const char *data, const size_t &size );
+
+/* Name: size_t svcSigNumpyWrite( const std::string &path, const std::vector<std::string> &filenames, const std::vector<float> &grid, const int &mode, const unsigned int &threads )
+ *
+ * Description: Writes sig files as a NumPy library, streaming them through
+ *    memory SVCSIG_NUMPY_CHUNK at a time
+ * Arguments: const std::string &path: the .npz file or directory
+ *            const std::vector<std::string> &filenames: the sig files (plain,
+ *                gzip or zstd compressed)
+ *            others: see svcsignumpy()
+ *            const unsigned int &threads: the number of threads (0 for one per
+ *                core)
+ * Modifies:
+ * Returns: size_t, the number of files written
+ * Pre:
+ * Post:
+ * Exceptions: invalidSVCsigNumpy (see svcsignumpy), and the exceptions of
+ *     svcsig::read(); no library is written if one is thrown
+ * Notes:
+ */
+size_t svcSigNumpyWrite( const std::string &path, const std::vector<std::string> &filenames, const std::vector<float> &grid = std::vector<float>(), const int &mode = SVCSIG_RESAMPLE_LINEAR, const unsigned int &threads = 0 );
+
+
+// --- --- Implimentation --- --- //
+
+// -- -- Helper Functions -- -- //
+
+/* Name: const char * svcSigNumpyOrder()
+ *
+ * Description: The byte order character of the machine, for the dtypes
+ */
+const char * svcSigNumpyOrder()
+{
+  const uint16_t one( 1 );
+  return *reinterpret_cast<const char *>( &one ) == 1 ? "<" : ">";
+}
+
+/* Name: std::string svcSigNumpyRecordDescr()
+ *
+ * Description: The dtype of a header record, SVCSIG_NUMPY_RECORD bytes
+ *    packed; see svcsignumpy::svcSigNumpyRow() for its fields
+ */
+std::string svcSigNumpyRecordDescr()
+{
+  std::string o( svcSigNumpyOrder() );
+  std::ostringstream descr;
+  descr << "[('name', '|S" << SVCSIG_NUMPY_NAME << "'), ('instrument', '|S" << SVCSIG_NUMPY_NAME << "'), "
+    << "('reference_time', '|S" << SVCSIG_NUMPY_TIME << "'), ('target_time', '|S" << SVCSIG_NUMPY_TIME << "'), ";
+  const char *doubles[] = { "latitude", "longitude", "gpstime" };
+  const char *triples[] = { "integration", "coadds", "temperature" };
+  const char *scalars[] = { "battery", "error", "memory_slot" };
+  const char *sides[] = { "reference", "target" };
+  for ( size_t s = 0; s < 2; s++ ) {
+    for ( size_t f = 0; f < 3; f++ ) {
+      descr << "('" << sides[ s ] << "_" << doubles[ f ] << "', '" << o << "f8'), ";
+    }
+  }
+  for ( size_t s = 0; s < 2; s++ ) {
+    for ( size_t f = 0; f < 3; f++ ) {
+      descr << "('" << sides[ s ] << "_" << triples[ f ] << "', '" << o << "f4', (3,)), ";
+    }
+  }
+  for ( size_t s = 0; s < 2; s++ ) {
+    for ( size_t f = 0; f < 3; f++ ) {
+      descr << "('" << sides[ s ] << "_" << scalars[ f ] << "', '" << o << ( f == 0 ? "f4" : "u4" ) << "')" << ( s == 1 && f == 2 ? "]" : ", " );
+    }
+  }
+  return descr.str();
+}
+
+std::string svcSigNumpyHeader( const std::string &descr, const std::string &shape, const size_t &length )
+{
+  std::string dict( "{'descr': " + descr + ", 'fortran_order': False, 'shape': " + shape + ", }" );
+  size_t size( length );
+  if ( size == 0 ) {
+    // room for every dimension to grow to 20 digits
+    size_t dimensions( std::count( shape.begin(), shape.end(), ',' ) + ( shape.find_first_of( "0123456789" ) != std::string::npos ? 1 : 0 ) );
+    size = ( 10 + dict.size() + 20 * dimensions + 1 + 63 ) / 64 * 64;
+  }
+  std::string header( "\x93NUMPY\x01\x00", 8 );
+  uint16_t dictLength( uint16_t( size - 10 ) );
+  header += char( dictLength & 0xff );
+  header += char( dictLength >> 8 );
+  header += dict;
+  header.append( size - 1 - header.size(), ' ' );
+  header += '\n';
+  return header;
+}
+
+/* Name: svcsigcrc32tables
+ *
+ * Description: The slicing by 8 tables of svcSigCrc32(), built by the
+ *    constructor
+ */
+struct svcsigcrc32tables {
+  uint32_t table[ 8 ][ 256 ];
+  
+  svcsigcrc32tables()
+  {
+    for ( uint32_t i = 0; i < 256; i++ ) {
+      uint32_t c( i );
+      for ( int k = 0; k < 8; k++ ) {
+        c = c & 1 ? 0xedb88320u ^ ( c >> 1 ) : c >> 1;
+      }
+      table[ 0 ][ i ] = c;
+    }
+    for ( uint32_t i = 0; i < 256; i++ ) {
+      for ( int t = 1; t < 8; t++ ) {
+        table[ t ][ i ] = ( table[ t - 1 ][ i ] >> 8 ) ^ table[ 0 ][ table[ t - 1 ][ i ] & 0xff ];
+      }
+    }
+  }
+};
+
+uint32_t svcSigCrc32( uint32_t crc, const char *data, const size_t &size )
+{
+  // C++11 initializes a function static once, even with racing threads
+  static const svcsigcrc32tables tables;
+  const uint32_t ( *table )[ 256 ]( tables.table );
+  
+  const unsigned char *p( reinterpret_cast<const unsigned char *>( data ) );
+  size_t n( size );
+  crc = ~crc;
+  for ( ; n >= 8; n -= 8, p += 8 ) {
+    uint32_t lo( crc ^ ( uint32_t( p[ 0 ] ) | uint32_t( p[ 1 ] ) << 8 | uint32_t( p[ 2 ] ) << 16 | uint32_t( p[ 3 ] ) << 24 ) );
+    uint32_t hi( uint32_t( p[ 4 ] ) | uint32_t( p[ 5 ] ) << 8 | uint32_t( p[ 6 ] ) << 16 | uint32_t( p[ 7 ] ) << 24 );
+    crc = table[ 7 ][ lo & 0xff ] ^ table[ 6 ][ ( lo >> 8 ) & 0xff ] ^ table[ 5 ][ ( lo >> 16 ) & 0xff ] ^ table[ 4 ][ lo >> 24 ]
+      ^ table[ 3 ][ hi & 0xff ] ^ table[ 2 ][ ( hi >> 8 ) & 0xff ] ^ table[ 1 ][ ( hi >> 16 ) & 0xff ] ^ table[ 0 ][ hi >> 24 ];
+  }
+  for ( ; n > 0; n--, p++ ) {
+    crc = table[ 0 ][ ( crc ^ *p ) & 0xff ] ^ ( crc >> 8 );
+  }
+  return ~crc;
+}
+
+/* Name: void svcSigNumpyPut( std::string &out, const uint64_t &value, const size_t &bytes )
+ *
+ * Description: Appends the low bytes of an integer, little endian (as zip
+ *    files are)
+ */
+void svcSigNumpyPut( std::string &out, const uint64_t &value, const size_t &bytes )
+{
+  for ( size_t b = 0; b < bytes; b++ ) {
+    out += char( ( value >> ( 8 * b ) ) & 0xff );
+  }
+}
+
+// -- -- Constructors -- -- //
+svcsignumpy::svcsignumpy( const std::string &path, const std::vector<float> &grid, const int &mode )
+: _path( path ), _grid( grid ), _mode( mode ), _count( 0 )
+{
+  for ( size_t k = 0; k <= SVCSIG_NUMPY_HEADER; k++ ) {
+    _files[ k ] = NULL;
+  }
+  if ( mode != SVCSIG_RESAMPLE_LINEAR && mode != SVCSIG_RESAMPLE_CUBIC && mode != SVCSIG_RESAMPLE_PCHIP ) {
+    throw invalidSVCsigNumpy( "unknown resampling mode" );
+  }
+  _npz = path.size() >= 4 && path.compare( path.size() - 4, 4, ".npz" ) == 0;
+  if ( !_npz && mkdir( path.c_str(), 0777 ) != 0 && errno != EEXIST ) {
+    throw invalidSVCsigNumpy( "could not create '" + path + "'" );
+  }
+  
+  // the streamed members start with room for their final headers
+  std::string record( svcSigNumpyRecordDescr() );
+  for ( size_t k = 0; k <= SVCSIG_NUMPY_HEADER; k++ ) {
+    _files[ k ] = fopen( svcSigNumpyFile( k, true ).c_str(), "w+b" );
+    std::string header( k == SVCSIG_NUMPY_HEADER ? svcSigNumpyHeader( record, "(0,)" ) : svcSigNumpyHeader( std::string( "'" ) + svcSigNumpyOrder() + "f4'", "(0, 0)" ) );
+    if ( _files[ k ] == NULL || fwrite( header.data(), 1, header.size(), _files[ k ] ) != header.size() ) {
+      svcSigNumpyAbandon();
+      throw invalidSVCsigNumpy( "could not create '" + path + "'" );
+    }
+  }
+}
+
+svcsignumpy::~svcsignumpy()
+{
+  svcSigNumpyAbandon();
+}
+
+// -- -- Getters -- -- //
+std::string svcsignumpy::path() const
+{
+  return _path;
+}
+
+const std::vector<float> & svcsignumpy::grid() const
+{
+  return _grid;
+}
+
+size_t svcsignumpy::size() const
+{
+  return _count;
+}
+
+// -- -- Writing -- -- //
+svcsignumpy& svcsignumpy::add( const svcsig &sig )
+{
+  return add( std::vector<svcsig>( 1, sig ), 1 );
+}
+
+svcsignumpy& svcsignumpy::add( const std::vector<svcsig> &sigs, const unsigned int &threads )
+{
+  if ( _files[ 0 ] == NULL ) {
+    throw invalidSVCsigNumpy( "the library is closed" );
+  }
+  for ( size_t i = 0; i < sigs.size() && _grid.empty(); i++ ) {
+    if ( sigs[ i ].size() > 0 ) {
+      _grid = sigs[ i ].wavelength();
+    }
+  }
+  if ( _grid.empty() && !sigs.empty() ) {
+    throw invalidSVCsigNumpy( "the library has no grid" );
+  }
+  std::vector< std::shared_ptr<const svcsigresampler> > resamplers( sigs.size() );
+  std::map< std::vector<float>, std::vector<size_t> > groups( svcSigGroupByGrid( sigs ) );
+  for ( std::map< std::vector<float>, std::vector<size_t> >::const_iterator g = groups.begin(); g != groups.end(); ++g ) {
+    if ( g->first == _grid ) {
+      continue;
+    }
+    std::shared_ptr<const svcsigresampler> resampler( svcSigResampler( g->first, _grid, _mode ) );
+    for ( size_t i = 0; i < g->second.size(); i++ ) {
+      resamplers[ g->second[ i ] ] = resampler;
+    }
+  }
+  std::vector<float> rows[ 3 ];
+  std::vector<char> headers;
+  for ( size_t first = 0; first < sigs.size(); first += SVCSIG_NUMPY_CHUNK ) {
+    size_t n( std::min( sigs.size() - first, size_t( SVCSIG_NUMPY_CHUNK ) ) );
+    for ( size_t k = 0; k < 3; k++ ) {
+      rows[ k ].resize( n * _grid.size() );
+    }
+    headers.assign( n * SVCSIG_NUMPY_RECORD, 0 );
+    svcSigParallelFor( n, threads, [&]( size_t i, unsigned int ) {
+      size_t at( i * _grid.size() );
+      svcSigNumpyRow( sigs[ first + i ], resamplers[ first + i ].get(), rows[ 0 ].data() + at, rows[ 1 ].data() + at, rows[ 2 ].data() + at, headers.data() + i * SVCSIG_NUMPY_RECORD );
+    } );
+    svcSigNumpyWrite( rows, headers, n );
+  }
+  return *this;
+}
+
+void svcsignumpy::close()
+{
+  if ( _files[ 0 ] == NULL ) {
+    throw invalidSVCsigNumpy( "the library is closed" );
+  }
+  
+  // fill in the shapes, in the room left for them
+  bool good( true );
+  std::string record( svcSigNumpyRecordDescr() );
+  std::string f4( std::string( "'" ) + svcSigNumpyOrder() + "f4'" );
+  for ( size_t k = 0; k <= SVCSIG_NUMPY_HEADER; k++ ) {
+    std::ostringstream shape;
+    std::string header;
+    if ( k == SVCSIG_NUMPY_HEADER ) {
+      shape << "(" << _count << ",)";
+      header = svcSigNumpyHeader( record, shape.str(), svcSigNumpyHeader( record, "(0,)" ).size() );
+    }
+    else {
+      shape << "(" << _count << ", " << _grid.size() << ")";
+      header = svcSigNumpyHeader( f4, shape.str(), svcSigNumpyHeader( f4, "(0, 0)" ).size() );
+    }
+    good = good && fseek( _files[ k ], 0, SEEK_SET ) == 0 && fwrite( header.data(), 1, header.size(), _files[ k ] ) == header.size();
+    good = fclose( _files[ k ] ) == 0 && good;
+    _files[ k ] = NULL;
+  }
+  
+  std::ostringstream shape;
+  shape << "(" << _grid.size() << ",)";
+  std::string header( svcSigNumpyHeader( f4, shape.str() ) );
+  FILE *wavelength( fopen( svcSigNumpyFile( SVCSIG_NUMPY_WAVELENGTH, true ).c_str(), "wb" ) );
+  good = good && wavelength != NULL;
+  if ( wavelength != NULL ) {
+    good = good && fwrite( header.data(), 1, header.size(), wavelength ) == header.size();
+    good = good && fwrite( _grid.data(), sizeof( float ), _grid.size(), wavelength ) == _grid.size();
+    good = fclose( wavelength ) == 0 && good;
+  }
+  
+  if ( _npz ) {
+    good = good && svcSigNumpyZip( _path + ".tmp" ) && rename( ( _path + ".tmp" ).c_str(), _path.c_str() ) == 0;
+    if ( !good ) {
+      remove( ( _path + ".tmp" ).c_str() );
+    }
+  }
+  else {
+    for ( size_t k = 0; k < SVCSIG_NUMPY_MEMBERS && good; k++ ) {
+      good = rename( svcSigNumpyFile( k, true ).c_str(), svcSigNumpyFile( k, false ).c_str() ) == 0;
+    }
+  }
+  for ( size_t k = 0; k < SVCSIG_NUMPY_MEMBERS; k++ ) {
+    remove( svcSigNumpyFile( k, true ).c_str() );
+  }
+  if ( !good ) {
+    throw invalidSVCsigNumpy( "could not write '" + _path + "'" );
+  }
+}
+
+// -- -- Helpers -- -- //
+std::string svcsignumpy::svcSigNumpyFile( const size_t &member, const bool &tmp ) const
+{
+  const char *names[] = { "reference.npy", "target.npy", "reflectance.npy", "header.npy", "wavelength.npy" };
+  if ( _npz ) {
+    return _path + "." + names[ member ] + ".tmp";
+  }
+  return _path + "/" + names[ member ] + ( tmp ? ".tmp" : "" );
+}
+
+void svcsignumpy::svcSigNumpyRow( const svcsig &sig, const svcsigresampler *resampler, float *reference, float *target, float *reflectance, char *header ) const
+{
+  size_t n( _grid.size() );
+  const float *spectra[ 3 ] = { sig.referenceRadianceData(), sig.targetRadianceData(), sig.targetReflectanceData() };
+  float *out[ 3 ] = { reference, target, reflectance };
+  if ( sig.size() == 0 ) {
+    for ( size_t k = 0; k < 3; k++ ) {
+      std::fill( out[ k ], out[ k ] + n, NAN );
+    }
+  }
+  else if ( resampler == NULL ) {
+    for ( size_t k = 0; k < 3; k++ ) {
+      std::copy( spectra[ k ], spectra[ k ] + n, out[ k ] );
+    }
+  }
+  else {
+    for ( size_t k = 0; k < 3; k++ ) {
+      resampler->apply( spectra[ k ], out[ k ] );
+    }
+  }
+  
+  // the record, field by field (see svcSigNumpyRecordDescr())
+  char *at( header );
+  std::string strings[ 4 ] = { sig.name(), sig.instrument(), sig.referenceTime(), sig.targetTime() };
+  for ( size_t s = 0; s < 4; s++ ) {
+    size_t width( s < 2 ? SVCSIG_NUMPY_NAME : SVCSIG_NUMPY_TIME );
+    memcpy( at, strings[ s ].data(), std::min( strings[ s ].size(), width ) );
+    at += width;
+  }
+  const double doubles[ 6 ] = { sig.referenceDecodedLatitude(), sig.referenceDecodedLongitude(), sig.referenceDecodedGpstime(),
+    sig.targetDecodedLatitude(), sig.targetDecodedLongitude(), sig.targetDecodedGpstime() };
+  memcpy( at, doubles, sizeof( doubles ) );
+  at += sizeof( doubles );
+  const float triples[ 18 ] = {
+    sig.referenceIntegrationSi(), sig.referenceIntegrationInGaAs1(), sig.referenceIntegrationInGaAs2(),
+    sig.referenceScanCoaddsSi(), sig.referenceScanCoaddsInGaAs1(), sig.referenceScanCoaddsInGaAs2(),
+    sig.referenceTempSi(), sig.referenceTempInGaAs1(), sig.referenceTempInGaAs2(),
+    sig.targetIntegrationSi(), sig.targetIntegrationInGaAs1(), sig.targetIntegrationInGaAs2(),
+    sig.targetScanCoaddsSi(), sig.targetScanCoaddsInGaAs1(), sig.targetScanCoaddsInGaAs2(),
+    sig.targetTempSi(), sig.targetTempInGaAs1(), sig.targetTempInGaAs2() };
+  memcpy( at, triples, sizeof( triples ) );
+  at += sizeof( triples );
+  const float referenceBattery( sig.referenceBattery() );
+  const uint32_t reference32[ 2 ] = { sig.referenceError(), sig.referenceMemorySlot() };
+  const float targetBattery( sig.targetBattery() );
+  const uint32_t target32[ 2 ] = { sig.targetError(), sig.targetMemorySlot() };
+  memcpy( at, &referenceBattery, 4 );
+  memcpy( at + 4, reference32, 8 );
+  memcpy( at + 12, &targetBattery, 4 );
+  memcpy( at + 16, target32, 8 );
+}
+
+void svcsignumpy::svcSigNumpyWrite( const std::vector<float> *rows, const std::vector<char> &headers, const size_t &count )
+{
+  bool good( true );
+  for ( size_t k = 0; k < 3 && good; k++ ) {
+    good = fwrite( rows[ k ].data(), sizeof( float ), count * _grid.size(), _files[ k ] ) == count * _grid.size();
+  }
+  good = good && fwrite( headers.data(), 1, count * SVCSIG_NUMPY_RECORD, _files[ SVCSIG_NUMPY_HEADER ] ) == count * SVCSIG_NUMPY_RECORD;
+  if ( !good ) {
+    svcSigNumpyAbandon();
+    throw invalidSVCsigNumpy( "could not write '" + _path + "'" );
+  }
+  _count += count;
+}
+
+bool svcsignumpy::svcSigNumpyZip( const std::string &filename ) const
+{
+  FILE *output( fopen( filename.c_str(), "wb" ) );
+  if ( output == NULL ) {
+    return false;
+  }
+  // every entry is stored with zip64 sizes and offsets, so members may be
+  // larger than 4 GB
+  const char *names[] = { "wavelength.npy", "reference.npy", "target.npy", "reflectance.npy", "header.npy" };
+  const size_t members[] = { SVCSIG_NUMPY_WAVELENGTH, SVCSIG_NUMPY_REFERENCE, SVCSIG_NUMPY_TARGET, SVCSIG_NUMPY_REFLECTANCE, SVCSIG_NUMPY_HEADER };
+  std::string directory;
+  std::vector<char> buffer( 1 << 20 );
+  bool good( true );
+  uint64_t offset( 0 );
+  for ( size_t m = 0; m < SVCSIG_NUMPY_MEMBERS && good; m++ ) {
+    FILE *input( fopen( svcSigNumpyFile( members[ m ], true ).c_str(), "rb" ) );
+    good = input != NULL && fseek( input, 0, SEEK_END ) == 0;
+    if ( !good ) {
+      break;
+    }
+    uint64_t size( ftell( input ) );
+    rewind( input );
+    std::string name( names[ m ] );
+    
+    std::string local;
+    svcSigNumpyPut( local, 0x04034b50, 4 );
+    svcSigNumpyPut( local, 45, 2 ); // version needed: zip64
+    svcSigNumpyPut( local, 0, 2 ); // flags
+    svcSigNumpyPut( local, 0, 2 ); // stored
+    svcSigNumpyPut( local, 0, 2 ); // time
+    svcSigNumpyPut( local, 0x21, 2 ); // date: 1980-01-01
+    svcSigNumpyPut( local, 0, 4 ); // crc, filled in below
+    svcSigNumpyPut( local, 0xffffffff, 4 );
+    svcSigNumpyPut( local, 0xffffffff, 4 );
+    svcSigNumpyPut( local, name.size(), 2 );
+    svcSigNumpyPut( local, 20, 2 );
+    local += name;
+    svcSigNumpyPut( local, 0x0001, 2 );
+    svcSigNumpyPut( local, 16, 2 );
+    svcSigNumpyPut( local, size, 8 );
+    svcSigNumpyPut( local, size, 8 );
+    good = fwrite( local.data(), 1, local.size(), output ) == local.size();
+    
+    uint32_t crc( 0 );
+    uint64_t copied( 0 );
+    for ( size_t n = fread( buffer.data(), 1, buffer.size(), input ); n > 0 && good; n = fread( buffer.data(), 1, buffer.size(), input ) ) {
+      crc = svcSigCrc32( crc, buffer.data(), n );
+      good = fwrite( buffer.data(), 1, n, output ) == n;
+      copied += n;
+    }
+    good = good && !ferror( input ) && copied == size;
+    fclose( input );
+    std::string value;
+    svcSigNumpyPut( value, crc, 4 );
+    good = good && fseek( output, offset + 14, SEEK_SET ) == 0 && fwrite( value.data(), 1, 4, output ) == 4 && fseek( output, 0, SEEK_END ) == 0;
+    
+    svcSigNumpyPut( directory, 0x02014b50, 4 );
+    svcSigNumpyPut( directory, 45, 2 ); // version made by
+    svcSigNumpyPut( directory, 45, 2 ); // version needed
+    svcSigNumpyPut( directory, 0, 2 );
+    svcSigNumpyPut( directory, 0, 2 );
+    svcSigNumpyPut( directory, 0, 2 );
+    svcSigNumpyPut( directory, 0x21, 2 );
+    svcSigNumpyPut( directory, crc, 4 );
+    svcSigNumpyPut( directory, 0xffffffff, 4 );
+    svcSigNumpyPut( directory, 0xffffffff, 4 );
+    svcSigNumpyPut( directory, name.size(), 2 );
+    svcSigNumpyPut( directory, 28, 2 );
+    svcSigNumpyPut( directory, 0, 2 ); // comment
+    svcSigNumpyPut( directory, 0, 2 ); // disk
+    svcSigNumpyPut( directory, 0, 2 ); // internal attributes
+    svcSigNumpyPut( directory, 0, 4 ); // external attributes
+    svcSigNumpyPut( directory, 0xffffffff, 4 );
+    directory += name;
+    svcSigNumpyPut( directory, 0x0001, 2 );
+    svcSigNumpyPut( directory, 24, 2 );
+    svcSigNumpyPut( directory, size, 8 );
+    svcSigNumpyPut( directory, size, 8 );
+    svcSigNumpyPut( directory, offset, 8 );
+    offset += local.size() + size;
+  }
+  
+  // the central directory, then the zip64 end records
+  std::string end( directory );
+  svcSigNumpyPut( end, 0x06064b50, 4 );
+  svcSigNumpyPut( end, 44, 8 );
+  svcSigNumpyPut( end, 45, 2 );
+  svcSigNumpyPut( end, 45, 2 );
+  svcSigNumpyPut( end, 0, 4 );
+  svcSigNumpyPut( end, 0, 4 );
+  svcSigNumpyPut( end, SVCSIG_NUMPY_MEMBERS, 8 );
+  svcSigNumpyPut( end, SVCSIG_NUMPY_MEMBERS, 8 );
+  svcSigNumpyPut( end, directory.size(), 8 );
+  svcSigNumpyPut( end, offset, 8 );
+  svcSigNumpyPut( end, 0x07064b50, 4 );
+  svcSigNumpyPut( end, 0, 4 );
+  svcSigNumpyPut( end, offset + directory.size(), 8 );
+  svcSigNumpyPut( end, 1, 4 );
+  svcSigNumpyPut( end, 0x06054b50, 4 );
+  svcSigNumpyPut( end, 0, 2 );
+  svcSigNumpyPut( end, 0, 2 );
+  svcSigNumpyPut( end, SVCSIG_NUMPY_MEMBERS, 2 );
+  svcSigNumpyPut( end, SVCSIG_NUMPY_MEMBERS, 2 );
+  svcSigNumpyPut( end, 0xffffffff, 4 );
+  svcSigNumpyPut( end, 0xffffffff, 4 );
+  svcSigNumpyPut( end, 0, 2 );
+  good = good && fwrite( end.data(), 1, end.size(), output ) == end.size();
+  good = fclose( output ) == 0 && good;
+  return good;
+}
+
+void svcsignumpy::svcSigNumpyAbandon()
+{
+  for ( size_t k = 0; k <= SVCSIG_NUMPY_HEADER; k++ ) {
+    if ( _files[ k ] != NULL ) {
+      fclose( _files[ k ] );
+      remove( svcSigNumpyFile( k, true ).c_str() );
+      _files[ k ] = NULL;
+    }
+  }
+}
+
+// -- -- Collections -- -- //
+size_t svcSigNumpyWrite( const std::string &path, const std::vector<std::string> &filenames, const std::vector<float> &grid, const int &mode, const unsigned int &threads )
+{
+  svcsignumpy library( path, grid, mode );
+  for ( size_t first = 0; first < filenames.size(); first += SVCSIG_NUMPY_CHUNK ) {
+    std::vector<std::string> chunk( filenames.begin() + first, filenames.begin() + std::min( filenames.size(), first + SVCSIG_NUMPY_CHUNK ) );
+    library.add( svcSigReadBatch( chunk, threads ), threads );
+  }
+  library.close();
+  return library.size();
+}
+
+#endif // __svcsignumpy_hpp_
@@ -0,0 +1,593 @@
+/*******************************************************************************
+ * svcsigquantile.hpp
+ *
+ * DESCRIPTION:
+ *    Provides header and implimentation for the svcsigsketch class, a KLL
+ *    quantile sketch of a stream of values, and the svcsigquantiles class, a
+ *    sketch per band of a stream of spectra, for approximate median and
+ *    percentile spectra (e.g. 5th/95th envelopes) of collections too large to
+ *    hold as a matrix.
+ *
+ *    A sketch keeps a stack of compactors. Level h holds values of weight
+ *    2^h, and when a level is full it is sorted and every other value (from
+ *    a random start) is promoted to the level above. Memory is bounded by
+ *    about 3k values whatever the length of the stream, and sketches of
+ *    separate streams (threads, files) merge into a sketch of both.
+ *
+ *    Error: a quantile q is returned as a value whose rank is within eps n of
+ *    q n, where eps is O(1/k) with high probability (Karnin, Lang and Liberty
+ *    prove eps = O( sqrt( log( 1 / delta ) ) / k ) at confidence 1 - delta).
+ *    With the default k = 200, svcbench quantile measures a worst rank error
+ *    over 2151 bands of about 1%, and a typical error of about 0.3%.
+ *
+ *    Build with -pthread.
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *    2026-10-18: The resampler is looked up once per grid, not per spectrum
+ *    2026-10-18: Each band and thread seeds its sketch differently
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *   Z. Karnin, K. Lang, E. Liberty, "Optimal Quantile Approximation in
+ *     Streams", FOCS 2016
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsigquantile_hpp_
+#define __svcsigquantile_hpp_
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
+
+#include "svcsighelper.hpp"
+#include "svcsig.hpp"
+#include "svcsigbatch.hpp"
+#include "svcsigresample.hpp"
+
+// the default sketch size (larger is more accurate)
+#define SVCSIG_SKETCH_K 200
+// the smallest compactor
+#define SVCSIG_SKETCH_MIN 8
+
+
+class svcsigsketch {
+private:
+  uint32_t _k;
+  uint64_t _n;
+  uint64_t _random; // xorshift state for the compaction offsets
+  std::vector< std::vector<float> > _levels; // level h has weight 2^h
+  std::vector<size_t> _capacity; // of each level
+  
+  /* Name: void svcSigSketchCapacities()
+   *
+   * Description: Sets the number of values each level holds before it is
+   *    compacted: k at the top, shrinking by 2/3 per level below, and at
+   *    least SVCSIG_SKETCH_MIN
+   */
+  void svcSigSketchCapacities();
+  
+  /* Name: void svcSigSketchCompress()
+   *
+   * Description: Compacts every full level into the level above
+   */
+  void svcSigSketchCompress();
+  
+  /* Name: uint64_t svcSigSketchSeed( const uint64_t &seed ) const
+   *
+   * Description: Mixes a seed (splitmix64) into a nonzero xorshift state, so
+   *    that close seeds give unrelated compactions
+   */
+  uint64_t svcSigSketchSeed( const uint64_t &seed ) const;
+
+public:
+  /* Name: svcsigsketch( const uint32_t &k, const uint64_t &seed )
+   *
+   * Description: Constructs an empty sketch
+   * Arguments: const uint32_t &k: the size of the top compactor (at least 8)
+   *            const uint64_t &seed: seeds the compaction offsets
+   * Notes: Sketches that are merged, or whose errors are compared (e.g. the
+   *    bands of a spectrum), should have different seeds, or their errors
+   *    are correlated
+   */
+  svcsigsketch( const uint32_t &k = SVCSIG_SKETCH_K, const uint64_t &seed = 0 );
+  
+  /* Name: void add( const float &value )
+   *
+   * Description: Adds a value to the stream
+   * Arguments: const float &value: the value (NAN is skipped)
+   * Modifies: The sketch
+   */
+  void add( const float &value );
+  
+  /* Name: void merge( const svcsigsketch &other )
+   *
+   * Description: Adds the stream of another sketch
+   * Arguments: const svcsigsketch &other: the sketch
+   * Modifies: The sketch
+   * Returns:
+   * Pre:
+   * Post: A sketch of both streams, with the error bound of the larger k
+   * Exceptions:
+   * Notes:
+   */
+  void merge( const svcsigsketch &other );
+  
+  /* Name: getters
+   *
+   * Description: count() is the number of values added, and retained() the
+   *    number the sketch is holding
+   */
+  uint64_t count() const;
+  size_t retained() const;
+  
+  /* Name: std::vector<float> quantiles( const std::vector<double> &q ) const
+   *
+   * Description: Approximate quantiles of the stream
+   * Arguments: const std::vector<double> &q: the quantiles, in [0, 1] (0.5
+   *                is the median)
+   * Modifies:
+   * Returns: std::vector<float>, NAN if the stream is empty
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Each value returned was in the stream
+   */
+  std::vector<float> quantiles( const std::vector<double> &q ) const;
+  
+  /* Name: float quantile( const double &q ) const
+   *
+   * Description: An approximate quantile of the stream, see quantiles()
+   */
+  float quantile( const double &q ) const;
+};
+
+
+class svcsigquantiles {
+private:
+  std::vector<float> _grid;
+  uint32_t _k;
+  uint64_t _seed;
+  std::vector<svcsigsketch> _bands;
+  std::vector<float> _source; // the grid of the last file resampled
+  std::shared_ptr<const svcsigresampler> _resampler; // from _source onto _grid
+  std::vector<float> _resampled;
+
+public:
+  /* Name: svcsigquantiles( const std::vector<float> &grid, const uint32_t &k, const uint64_t &seed )
+   *
+   * Description: Constructs empty sketches
+   * Arguments: const std::vector<float> &grid: the wavelengths, or empty to
+   *                take those of the first sig file added
+   *            const uint32_t &k: the sketch size, see svcsigsketch
+   *            const uint64_t &seed: seeds the sketches, band j with
+   *                seed * 2^32 + j
+   * Notes: Sketches that will be merged should have different seeds
+   */
+  svcsigquantiles( const std::vector<float> &grid = std::vector<float>(), const uint32_t &k = SVCSIG_SKETCH_K, const uint64_t &seed = 0 );
+  
+  /* Name: void add( const float *spectrum )
+   *
+   * Description: Adds a spectrum on the grid
+   * Arguments: const float *spectrum: grid().size() values
+   * Modifies: The sketches
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: NAN values are skipped
+   */
+  void add( const float *spectrum );
+  
+  /* Name: void add( const svcsig &sig, const int &spectrum )
+   *
+   * Description: Adds a spectrum of a sig file, in place if it is on the
+   *    grid, and resampled (linearly) onto it if not
+   * Arguments: const svcsig &sig: the sig file
+   *            const int &spectrum: SVCSIG_SPECTRUM_REFERENCE_RADIANCE,
+   *                SVCSIG_SPECTRUM_TARGET_RADIANCE or
+   *                SVCSIG_SPECTRUM_TARGET_REFLECTANCE
+   * Modifies: The sketches (and the grid if it was empty)
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigQuantile if the spectrum is unknown
+   * Notes: Bands outside the file's range are skipped. The resampler is kept
+   *    until a file on another grid is added, so a run of files on one grid
+   *    looks it up once.
+   */
+  void add( const svcsig &sig, const int &spectrum = SVCSIG_SPECTRUM_TARGET_REFLECTANCE );
+  
+  /* Name: void merge( const svcsigquantiles &other )
+   *
+   * Description: Adds the spectra of other sketches
+   * Arguments: const svcsigquantiles &other: sketches on the same grid
+   * Modifies: The sketches
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigQuantile if the grids differ
+   * Notes: Sketches with an empty grid merge with any
+   */
+  void merge( const svcsigquantiles &other );
+  
+  /* Name: getters
+   *
+   * Description: grid() is the wavelengths, size() the number of bands, and
+   *    band( j ) the sketch of band j
+   */
+  const std::vector<float> & grid() const;
+  size_t size() const;
+  const svcsigsketch & band( const size_t &j ) const;
+  
+  /* Name: std::vector<float> quantile( const double &q ) const
+   *
+   * Description: The approximate quantile spectrum, e.g. 0.5 for the median
+   *    or 0.05 and 0.95 for an envelope
+   * Arguments: const double &q: the quantile, in [0, 1]
+   * Modifies:
+   * Returns: std::vector<float>, a value per band (NAN if it has none)
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: See svcsigsketch for the error
+   */
+  std::vector<float> quantile( const double &q ) const;
+  
+  /* Name: std::vector<float> median() const
+   *
+   * Description: The approximate median spectrum
+   */
+  std::vector<float> median() const;
+};
+
+
+/* Name: svcsigquantiles svcSigQuantilesBatch( const std::vector<std::string> &filenames, const std::vector<float> &grid, const int &spectrum, const unsigned int &threads, const uint32_t &k )
+ *
+ * Description: Sketches a spectrum of many sig files without keeping them
+ * Arguments: const std::vector<std::string> &filenames: the sig files
+ *            const std::vector<float> &grid: the wavelengths, or empty for
+ *                those of the first file
+ *            const int &spectrum: SVCSIG_SPECTRUM_REFERENCE_RADIANCE,
+ *                SVCSIG_SPECTRUM_TARGET_RADIANCE or
+ *                SVCSIG_SPECTRUM_TARGET_REFLECTANCE
+ *            const unsigned int &threads: the number of threads (0 for one per
+ *                core)
+ *            const uint32_t &k: the sketch size, see svcsigsketch
+ * Modifies:
+ * Returns: svcsigquantiles
+ * Pre:
+ * Post:
+ * Exceptions: invalidSVCsigQuantile if the spectrum is unknown
+ * Notes: Each thread parses a file, adds it to its own sketches (seeded
+ *    with the thread) and releases it. The sketches of the threads are
+ *    merged at the end.
+ */
+svcsigquantiles svcSigQuantilesBatch( const std::vector<std::string> &filenames, const std::vector<float> &grid = std::vector<float>(), const int &spectrum = SVCSIG_SPECTRUM_TARGET_REFLECTANCE, const unsigned int &threads = 0, const uint32_t &k = SVCSIG_SKETCH_K );
+
+/* Name: svcsigquantiles svcSigQuantilesBatch( const std::vector<svcsig> &sigs, const std::vector<float> &grid, const int &spectrum, const unsigned int &threads, const uint32_t &k )
+ *
+ * Description: Sketches a spectrum of many sig files that are already read
+ */
+svcsigquantiles svcSigQuantilesBatch( const std::vector<svcsig> &sigs, const std::vector<float> &grid = std::vector<float>(), const int &spectrum = SVCSIG_SPECTRUM_TARGET_REFLECTANCE, const unsigned int &threads = 0, const uint32_t &k = SVCSIG_SKETCH_K );
+
+
+// --- --- Implimentation --- --- //
+
+// -- -- Constructors -- -- //
+svcsigsketch::svcsigsketch( const uint32_t &k, const uint64_t &seed )
+: _k( std::max( k, uint32_t( 8 ) ) ), _n( 0 ), _random( svcSigSketchSeed( seed ) ), _levels( 1 )
+{
+  svcSigSketchCapacities();
+}
+
+// -- -- Accumulation -- -- //
+void svcsigsketch::add( const float &value )
+{
+  if ( std::isnan( value ) ) {
+    return;
+  }
+  _n++;
+  _levels[ 0 ].push_back( value );
+  if ( _levels[ 0 ].size() >= _capacity[ 0 ] ) {
+    svcSigSketchCompress();
+  }
+}
+
+void svcsigsketch::merge( const svcsigsketch &other )
+{
+  _k = std::max( _k, other._k );
+  _n += other._n;
+  if ( _levels.size() < other._levels.size() ) {
+    _levels.resize( other._levels.size() );
+    svcSigSketchCapacities();
+  }
+  for ( size_t h = 0; h < other._levels.size(); h++ ) {
+    _levels[ h ].insert( _levels[ h ].end(), other._levels[ h ].begin(), other._levels[ h ].end() );
+  }
+  svcSigSketchCompress();
+}
+
+// -- -- Getters -- -- //
+uint64_t svcsigsketch::count() const
+{
+  return _n;
+}
+
+size_t svcsigsketch::retained() const
+{
+  size_t total( 0 );
+  for ( size_t h = 0; h < _levels.size(); h++ ) {
+    total += _levels[ h ].size();
+  }
+  return total;
+}
+
+std::vector<float> svcsigsketch::quantiles( const std::vector<double> &q ) const
+{
+  std::vector<float> out( q.size(), NAN );
+  if ( _n == 0 ) {
+    return out;
+  }
+  
+  // the values and their weights, in order
+  std::vector< std::pair<float, uint64_t> > weighted;
+  weighted.reserve( retained() );
+  uint64_t total( 0 );
+  for ( size_t h = 0; h < _levels.size(); h++ ) {
+    for ( size_t i = 0; i < _levels[ h ].size(); i++ ) {
+      weighted.push_back( std::make_pair( _levels[ h ][ i ], uint64_t( 1 ) << h ) );
+    }
+    total += _levels[ h ].size() << h;
+  }
+  std::sort( weighted.begin(), weighted.end() );
+  for ( size_t i = 1; i < weighted.size(); i++ ) {
+    weighted[ i ].second += weighted[ i - 1 ].second;
+  }
+  
+  for ( size_t i = 0; i < q.size(); i++ ) {
+    double rank( std::max( 0.0, std::min( 1.0, q[ i ] ) ) * total );
+    size_t at( 0 );
+    while ( at + 1 < weighted.size() && weighted[ at ].second < rank ) {
+      at++;
+    }
+    out[ i ] = weighted[ at ].first;
+  }
+  return out;
+}
+
+float svcsigsketch::quantile( const double &q ) const
+{
+  return quantiles( std::vector<double>( 1, q ) )[ 0 ];
+}
+
+// -- -- Helper Functions -- -- //
+void svcsigsketch::svcSigSketchCapacities()
+{
+  _capacity.resize( _levels.size() );
+  double capacity( _k );
+  for ( size_t h = _levels.size(); h-- > 0; ) {
+    _capacity[ h ] = std::max( size_t( SVCSIG_SKETCH_MIN ), size_t( std::ceil( capacity ) ) );
+    capacity *= 2.0 / 3.0;
+  }
+}
+
+void svcsigsketch::svcSigSketchCompress()
+{
+  for ( size_t h = 0; h < _levels.size(); h++ ) {
+    if ( _levels[ h ].size() < _capacity[ h ] ) {
+      continue;
+    }
+    if ( h + 1 == _levels.size() ) {
+      _levels.push_back( std::vector<float>() );
+      svcSigSketchCapacities();
+    }
+    std::vector<float> &level( _levels[ h ] );
+    std::sort( level.begin(), level.end() );
+    
+    // an odd value out stays behind
+    float left( level.back() );
+    bool odd( level.size() % 2 == 1 );
+    if ( odd ) {
+      level.pop_back();
+    }
+    _random ^= _random << 13;
+    _random ^= _random >> 7;
+    _random ^= _random << 17;
+    for ( size_t i = _random & 1; i < level.size(); i += 2 ) {
+      _levels[ h + 1 ].push_back( level[ i ] );
+    }
+    level.clear();
+    if ( odd ) {
+      level.push_back( left );
+    }
+  }
+}
+
+uint64_t svcsigsketch::svcSigSketchSeed( const uint64_t &seed ) const
+{
+  uint64_t z( seed + 0x9e3779b97f4a7c15ULL );
+  z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+  z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+  z ^= z >> 31;
+  return z != 0 ? z : 0x9e3779b97f4a7c15ULL;
+}
+
+// -- -- Constructors -- -- //
+svcsigquantiles::svcsigquantiles( const std::vector<float> &grid, const uint32_t &k, const uint64_t &seed )
+: _grid( grid ), _k( k ), _seed( seed )
+{
+  _bands.reserve( grid.size() );
+  for ( size_t j = 0; j < grid.size(); j++ ) {
+    _bands.push_back( svcsigsketch( k, ( seed << 32 ) + j ) );
+  }
+}
+
+// -- -- Accumulation -- -- //
+void svcsigquantiles::add( const float *spectrum )
+{
+  for ( size_t j = 0; j < _grid.size(); j++ ) {
+    _bands[ j ].add( spectrum[ j ] );
+  }
+}
+
+void svcsigquantiles::add( const svcsig &sig, const int &spectrum )
+{
+  if ( spectrum != SVCSIG_SPECTRUM_REFERENCE_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_REFLECTANCE ) {
+    throw invalidSVCsigQuantile( "unknown spectrum" );
+  }
+  if ( sig.size() == 0 ) {
+    return;
+  }
+  if ( _grid.empty() ) {
+    *this = svcsigquantiles( sig.wavelength(), _k, _seed );
+  }
+  const float *data( spectrum == SVCSIG_SPECTRUM_REFERENCE_RADIANCE ? sig.referenceRadianceData() :
+    ( spectrum == SVCSIG_SPECTRUM_TARGET_RADIANCE ? sig.targetRadianceData() : sig.targetReflectanceData() ) );
+  if ( sig.size() == _grid.size() && std::equal( _grid.begin(), _grid.end(), sig.wavelengthData() ) ) {
+    add( data );
+  }
+  else {
+    if ( _resampler == NULL || _source.size() != sig.size() || memcmp( _source.data(), sig.wavelengthData(), sig.size() * sizeof( float ) ) != 0 ) {
+      _source = sig.wavelength();
+      _resampler = svcSigResampler( _source, _grid, SVCSIG_RESAMPLE_LINEAR );
+      _resampled.resize( _grid.size() );
+    }
+    _resampler->apply( data, _resampled.data() );
+    add( _resampled.data() );
+  }
+}
+
+void svcsigquantiles::merge( const svcsigquantiles &other )
+{
+  if ( other._grid.empty() ) {
+    return;
+  }
+  if ( _grid.empty() ) {
+    *this = other;
+    return;
+  }
+  if ( _grid != other._grid ) {
+    throw invalidSVCsigQuantile( "the grids differ" );
+  }
+  for ( size_t j = 0; j < _grid.size(); j++ ) {
+    _bands[ j ].merge( other._bands[ j ] );
+  }
+}
+
+// -- -- Getters -- -- //
+const std::vector<float> & svcsigquantiles::grid() const
+{
+  return _grid;
+}
+
+size_t svcsigquantiles::size() const
+{
+  return _grid.size();
+}
+
+const svcsigsketch & svcsigquantiles::band( const size_t &j ) const
+{
+  return _bands[ j ];
+}
+
+std::vector<float> svcsigquantiles::quantile( const double &q ) const
+{
+  std::vector<float> out( _grid.size() );
+  for ( size_t j = 0; j < _grid.size(); j++ ) {
+    out[ j ] = _bands[ j ].quantile( q );
+  }
+  return out;
+}
+
+std::vector<float> svcsigquantiles::median() const
+{
+  return quantile( 0.5 );
+}
+
+// -- -- Collections -- -- //
+svcsigquantiles svcSigQuantilesBatch( const std::vector<std::string> &filenames, const std::vector<float> &grid, const int &spectrum, const unsigned int &threads, const uint32_t &k )
+{
+  if ( spectrum != SVCSIG_SPECTRUM_REFERENCE_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_REFLECTANCE ) {
+    throw invalidSVCsigQuantile( "unknown spectrum" );
+  }
+  std::vector<float> wavelengths( grid );
+  if ( wavelengths.empty() && !filenames.empty() ) {
+    wavelengths = svcsig().read( filenames[ 0 ] ).wavelength();
+  }
+  std::vector<svcsigquantiles> partial;
+  unsigned int nThreads( svcSigThreads( threads ) );
+  for ( unsigned int t = 0; t < nThreads; t++ ) {
+    partial.push_back( svcsigquantiles( wavelengths, k, t ) );
+  }
+  svcSigParallelFor( filenames.size(), partial.size(), [&]( size_t i, unsigned int thread ) {
+    svcsig sig;
+    sig.read( filenames[ i ] );
+    partial[ thread ].add( sig, spectrum );
+  } );
+  for ( size_t t = 1; t < partial.size(); t++ ) {
+    partial[ 0 ].merge( partial[ t ] );
+  }
+  return partial[ 0 ];
+}
+
+svcsigquantiles svcSigQuantilesBatch( const std::vector<svcsig> &sigs, const std::vector<float> &grid, const int &spectrum, const unsigned int &threads, const uint32_t &k )
+{
+  if ( spectrum != SVCSIG_SPECTRUM_REFERENCE_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_REFLECTANCE ) {
+    throw invalidSVCsigQuantile( "unknown spectrum" );
+  }
+  std::vector<float> wavelengths( grid );
+  for ( size_t i = 0; i < sigs.size() && wavelengths.empty(); i++ ) {
+    wavelengths = sigs[ i ].wavelength();
+  }
+  std::vector<svcsigquantiles> partial;
+  unsigned int nThreads( svcSigThreads( threads ) );
+  for ( unsigned int t = 0; t < nThreads; t++ ) {
+    partial.push_back( svcsigquantiles( wavelengths, k, t ) );
+  }
+  size_t chunks( ( sigs.size() + SVCSIG_BATCH_CHUNK - 1 ) / SVCSIG_BATCH_CHUNK );
+  svcSigParallelFor( chunks, partial.size(), [&]( size_t chunk, unsigned int thread ) {
+    size_t end( std::min( sigs.size(), ( chunk + 1 ) * SVCSIG_BATCH_CHUNK ) );
+    for ( size_t i = chunk * SVCSIG_BATCH_CHUNK; i < end; i++ ) {
+      partial[ thread ].add( sigs[ i ], spectrum );
+    }
+  } );
+  for ( size_t t = 1; t < partial.size(); t++ ) {
+    partial[ 0 ].merge( partial[ t ] );
+  }
+  return partial[ 0 ];
+}
+
+#endif // __svcsigquantile_hpp_
@@ -0,0 +1,688 @@
+/*******************************************************************************
+ * svcsigquery.hpp
+ *
+ * DESCRIPTION:
+ *    Provides header and implimentation for the svcsigquery class, a filter
+ *    over the header fields of sig files that is compiled once from an
+ *    expression such as
+ *
+ *      instrumentCommonName == "HR-1024i" && targetBattery < 7.0 && targetError != 0
+ *
+ *    and the functions that run a query over many files (or a catalogue) on
+ *    all cores. Queries are tested as soon as a header is parsed, so the data
+ *    of a rejected file is never read.
+ *
+ *    Fields are named as the svcsig getters: the svcsigcommonheader fields
+ *    (e.g. instrumentCommonName, factorsReflectance) and the
+ *    svcsigspectraheader fields with a reference or target prefix (e.g.
+ *    targetBattery, referenceEpochTime, targetDecimalLatitude). A field is
+ *    compared (==, !=, <, <=, >, >=) with a number or a "string", and
+ *    comparisons are combined with &&, ||, ! and parentheses. Epoch time
+ *    fields may also be compared with a time string, e.g.
+ *    targetEpochTime >= "3/14/2014 10:00:00 AM".
+ *
+ *    Build with -pthread.
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *    2026-10-18: Positions come from the decoded header fields; added
+ *                decimalGpstime
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsigquery_hpp_
+#define __svcsigquery_hpp_
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "svcsighelper.hpp"
+#include "svcsig.hpp"
+#include "svcsigbatch.hpp"
+#include "svcsigcatalogue.hpp"
+
+// node types
+#define SVCSIG_QUERY_AND 0
+#define SVCSIG_QUERY_OR 1
+#define SVCSIG_QUERY_NOT 2
+#define SVCSIG_QUERY_NUMBER 3 // compare a numeric field
+#define SVCSIG_QUERY_STRING 4 // compare a string field
+
+// comparison operators
+#define SVCSIG_QUERY_EQ 0
+#define SVCSIG_QUERY_NE 1
+#define SVCSIG_QUERY_LT 2
+#define SVCSIG_QUERY_LE 3
+#define SVCSIG_QUERY_GT 4
+#define SVCSIG_QUERY_GE 5
+
+// which header a field is read from
+#define SVCSIG_QUERY_COMMON 0
+#define SVCSIG_QUERY_REFERENCE 1
+#define SVCSIG_QUERY_TARGET 2
+
+
+// a queryable header field. Common fields read the svcsigcommonheader,
+// spectra fields the reference or target svcsigspectraheader. Exactly one of
+// number and text is set.
+struct svcsigqueryfield {
+  const char *name;
+  bool spectra;
+  double ( *number )( const svcsigcommonheader &common, const svcsigspectraheader &spectra );
+  std::string ( *text )( const svcsigcommonheader &common, const svcsigspectraheader &spectra );
+};
+
+
+class svcsigquery : public svcsigfilter {
+private:
+  // one node of the compiled expression
+  struct node {
+    int type;
+    int op;
+    int left; // child nodes of AND, OR and NOT
+    int right;
+    int scope; // the header of a comparison
+    size_t field; // the field of a comparison
+    double number; // the value of a numeric comparison
+    std::string text; // the value of a string comparison
+  };
+  
+  std::string _expression;
+  std::vector<node> _nodes;
+  int _root;
+  
+  /* Name: const svcsigqueryfield * svcSigQueryFields( size_t &n ) const
+   *
+   * Description: Returns the table of queryable fields
+   * Arguments: size_t &n: the number of fields
+   * Modifies: n
+   * Returns: const svcsigqueryfield *
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  const svcsigqueryfield * svcSigQueryFields( size_t &n ) const;
+  
+  /* Name: int svcSigQueryOr( size_t &pos ), svcSigQueryAnd, svcSigQueryUnary,
+   *    svcSigQueryComparison
+   *
+   * Description: Recursive descent parser, one function per precedence level
+   * Arguments: size_t &pos: the position in _expression
+   * Modifies: pos, _nodes
+   * Returns: int, the index of the parsed node
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigQuery on syntax errors or unknown fields
+   * Notes:
+   */
+  int svcSigQueryOr( size_t &pos );
+  int svcSigQueryAnd( size_t &pos );
+  int svcSigQueryUnary( size_t &pos );
+  int svcSigQueryComparison( size_t &pos );
+  
+  /* Name: svcSigQuerySkip, svcSigQueryMatch, svcSigQueryOperand
+   *
+   * Description: Tokenizer helpers. svcSigQuerySkip skips white space,
+   *    svcSigQueryMatch consumes a token if it is next, and svcSigQueryOperand
+   *    reads an identifier, number or string.
+   * Notes: svcSigQueryOperand returns 'i', 'n' or 's' for the kind of operand
+   */
+  void svcSigQuerySkip( size_t &pos ) const;
+  bool svcSigQueryMatch( size_t &pos, const char *token ) const;
+  char svcSigQueryOperand( size_t &pos, std::string &text, double &number ) const;
+  
+  /* Name: void svcSigQueryError( const size_t &pos, const std::string &message ) const
+   *
+   * Description: Throws a syntax error
+   * Arguments: const size_t &pos: where in _expression
+   *            const std::string &message: what went wrong
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigQuery always
+   * Notes:
+   */
+  void svcSigQueryError( const size_t &pos, const std::string &message ) const;
+  
+  /* Name: bool svcSigQueryEvaluate( const int &n, ... ) const
+   *
+   * Description: Evaluates a node (short circuiting && and ||)
+   * Arguments: const int &n: the node
+   *            the headers of the file
+   * Modifies:
+   * Returns: bool
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  bool svcSigQueryEvaluate( const int &n, const svcsigcommonheader &common, const svcsigspectraheader &reference, const svcsigspectraheader &target ) const;
+
+public:
+  /* Name: svcsigquery( const std::string &expression )
+   *
+   * Description: Compiles a query
+   * Arguments: const std::string &expression: the query
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigQuery if expression is not a valid query
+   * Notes: An empty expression accepts everything
+   */
+  svcsigquery( const std::string &expression );
+  
+  /* Name: std::string expression() const
+   *
+   * Description: Returns the expression the query was compiled from
+   * Arguments:
+   * Modifies:
+   * Returns: std::string
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  std::string expression() const;
+  
+  /* Name: bool accept( const svcsig &sig ) const
+   *
+   * Description: Tests the header of a sig file
+   * Arguments: const svcsig &sig: the sig file (the data is not used)
+   * Modifies:
+   * Returns: bool
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Thread safe
+   */
+  bool accept( const svcsig &sig ) const;
+  
+  /* Name: bool accept( const svcsigcommonheader &common, const svcsigspectraheader &reference, const svcsigspectraheader &target ) const
+   *
+   * Description: Tests a header
+   * Arguments: the parts of the header
+   * Modifies:
+   * Returns: bool
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Thread safe
+   */
+  bool accept( const svcsigcommonheader &common, const svcsigspectraheader &reference, const svcsigspectraheader &target ) const;
+};
+
+
+/* Name: std::vector<std::string> svcSigQueryFiles( const svcsigquery &query, const std::vector<std::string> &filenames, const unsigned int &threads )
+ *
+ * Description: Finds the sig files that match a query
+ * Arguments: const svcsigquery &query: the query
+ *            const std::vector<std::string> &filenames: the sig files
+ *            const unsigned int &threads: the number of threads (0 for one per
+ *                core)
+ * Modifies:
+ * Returns: std::vector<std::string>, the matching files in the order given
+ * Pre:
+ * Post:
+ * Exceptions:
+ * Notes: Only the headers are read
+ */
+std::vector<std::string> svcSigQueryFiles( const svcsigquery &query, const std::vector<std::string> &filenames, const unsigned int &threads = 0 );
+
+/* Name: std::vector<svcsig> svcSigQueryRead( const svcsigquery &query, const std::vector<std::string> &filenames, const unsigned int &threads )
+ *
+ * Description: Reads the sig files that match a query
+ * Arguments: const svcsigquery &query: the query
+ *            const std::vector<std::string> &filenames: the sig files
+ *            const unsigned int &threads: the number of threads (0 for one per
+ *                core)
+ * Modifies:
+ * Returns: std::vector<svcsig>, the matching files in the order given
+ * Pre:
+ * Post:
+ * Exceptions:
+ * Notes: Each file is read once; the data of files that do not match is
+ *    skipped
+ */
+std::vector<svcsig> svcSigQueryRead( const svcsigquery &query, const std::vector<std::string> &filenames, const unsigned int &threads = 0 );
+
+/* Name: std::vector<size_t> svcSigQueryCatalogue( const svcsigquery &query, const svcsigcatalogue &catalogue, const unsigned int &threads )
+ *
+ * Description: Finds the catalogue entries that match a query
+ * Arguments: const svcsigquery &query: the query
+ *            const svcsigcatalogue &catalogue: the catalogue
+ *            const unsigned int &threads: the number of threads (0 for one per
+ *                core)
+ * Modifies:
+ * Returns: std::vector<size_t>, the matching entries in increasing order
+ * Pre:
+ * Post:
+ * Exceptions:
+ * Notes: No sig files are opened
+ */
+std::vector<size_t> svcSigQueryCatalogue( const svcsigquery &query, const svcsigcatalogue &catalogue, const unsigned int &threads = 0 );
+
+
+// --- --- Implimentation --- --- //
+
+// -- -- Constructors -- -- //
+svcsigquery::svcsigquery( const std::string &expression )
+: _expression( expression ), _root( -1 )
+{
+  size_t pos( 0 );
+  svcSigQuerySkip( pos );
+  if ( pos < _expression.size() ) {
+    _root = svcSigQueryOr( pos );
+    if ( pos < _expression.size() ) {
+      svcSigQueryError( pos, "unexpected '" + _expression.substr( pos, 1 ) + "'" );
+    }
+  }
+}
+
+// -- -- Getters -- -- //
+std::string svcsigquery::expression() const
+{
+  return _expression;
+}
+
+// -- -- Evaluation -- -- //
+bool svcsigquery::accept( const svcsig &sig ) const
+{
+  return accept( sig._commonHeader, sig._referenceHeader, sig._targetHeader );
+}
+
+bool svcsigquery::accept( const svcsigcommonheader &common, const svcsigspectraheader &reference, const svcsigspectraheader &target ) const
+{
+  if ( _root < 0 ) {
+    return true;
+  }
+  return svcSigQueryEvaluate( _root, common, reference, target );
+}
+
+bool svcsigquery::svcSigQueryEvaluate( const int &n, const svcsigcommonheader &common, const svcsigspectraheader &reference, const svcsigspectraheader &target ) const
+{
+  const node &current( _nodes[ n ] );
+  switch ( current.type ) {
+    case SVCSIG_QUERY_AND:
+      return svcSigQueryEvaluate( current.left, common, reference, target ) && svcSigQueryEvaluate( current.right, common, reference, target );
+    case SVCSIG_QUERY_OR:
+      return svcSigQueryEvaluate( current.left, common, reference, target ) || svcSigQueryEvaluate( current.right, common, reference, target );
+    case SVCSIG_QUERY_NOT:
+      return !svcSigQueryEvaluate( current.left, common, reference, target );
+    default:
+      break;
+  }
+  
+  size_t nFields;
+  const svcsigqueryfield &field( svcSigQueryFields( nFields )[ current.field ] );
+  const svcsigspectraheader &spectra( current.scope == SVCSIG_QUERY_REFERENCE ? reference : target );
+  int order;
+  if ( current.type == SVCSIG_QUERY_NUMBER ) {
+    double value( field.number( common, spectra ) );
+    if ( value != value ) {
+      // NaN (e.g. no GPS fix) only satisfies !=
+      return current.op == SVCSIG_QUERY_NE;
+    }
+    order = ( value < current.number ) ? -1 : ( value > current.number ? 1 : 0 );
+  }
+  else {
+    order = field.text( common, spectra ).compare( current.text );
+  }
+  
+  switch ( current.op ) {
+    case SVCSIG_QUERY_EQ: return order == 0;
+    case SVCSIG_QUERY_NE: return order != 0;
+    case SVCSIG_QUERY_LT: return order < 0;
+    case SVCSIG_QUERY_LE: return order <= 0;
+    case SVCSIG_QUERY_GT: return order > 0;
+    default: return order >= 0;
+  }
+}
+
+// -- -- Parser -- -- //
+int svcsigquery::svcSigQueryOr( size_t &pos )
+{
+  int left( svcSigQueryAnd( pos ) );
+  while ( svcSigQueryMatch( pos, "||" ) ) {
+    node n = { SVCSIG_QUERY_OR, 0, left, svcSigQueryAnd( pos ), 0, 0, 0.0, "" };
+    _nodes.push_back( n );
+    left = _nodes.size() - 1;
+  }
+  return left;
+}
+
+int svcsigquery::svcSigQueryAnd( size_t &pos )
+{
+  int left( svcSigQueryUnary( pos ) );
+  while ( svcSigQueryMatch( pos, "&&" ) ) {
+    node n = { SVCSIG_QUERY_AND, 0, left, svcSigQueryUnary( pos ), 0, 0, 0.0, "" };
+    _nodes.push_back( n );
+    left = _nodes.size() - 1;
+  }
+  return left;
+}
+
+int svcsigquery::svcSigQueryUnary( size_t &pos )
+{
+  if ( svcSigQueryMatch( pos, "!=" ) ) {
+    svcSigQueryError( pos - 2, "expected a comparison" );
+  }
+  if ( svcSigQueryMatch( pos, "!" ) ) {
+    node n = { SVCSIG_QUERY_NOT, 0, svcSigQueryUnary( pos ), -1, 0, 0, 0.0, "" };
+    _nodes.push_back( n );
+    return _nodes.size() - 1;
+  }
+  if ( svcSigQueryMatch( pos, "(" ) ) {
+    int inner( svcSigQueryOr( pos ) );
+    if ( !svcSigQueryMatch( pos, ")" ) ) {
+      svcSigQueryError( pos, "expected ')'" );
+    }
+    return inner;
+  }
+  return svcSigQueryComparison( pos );
+}
+
+int svcsigquery::svcSigQueryComparison( size_t &pos )
+{
+  std::string leftText, rightText;
+  double leftNumber, rightNumber;
+  size_t leftPos( pos );
+  char left( svcSigQueryOperand( pos, leftText, leftNumber ) );
+  
+  // the operator, longest first
+  static const char *operators[] = { "==", "!=", "<=", ">=", "<", ">" };
+  static const int codes[] = { SVCSIG_QUERY_EQ, SVCSIG_QUERY_NE, SVCSIG_QUERY_LE, SVCSIG_QUERY_GE, SVCSIG_QUERY_LT, SVCSIG_QUERY_GT };
+  int op( -1 );
+  for ( int i = 0; i < 6 && op < 0; i++ ) {
+    if ( svcSigQueryMatch( pos, operators[ i ] ) ) {
+      op = codes[ i ];
+    }
+  }
+  if ( op < 0 ) {
+    svcSigQueryError( pos, "expected a comparison operator" );
+  }
+  
+  size_t rightPos( pos );
+  char right( svcSigQueryOperand( pos, rightText, rightNumber ) );
+  
+  // put the field on the left
+  if ( left != 'i' && right == 'i' ) {
+    std::swap( left, right );
+    std::swap( leftText, rightText );
+    std::swap( leftNumber, rightNumber );
+    std::swap( leftPos, rightPos );
+    static const int mirror[] = { SVCSIG_QUERY_EQ, SVCSIG_QUERY_NE, SVCSIG_QUERY_GT, SVCSIG_QUERY_GE, SVCSIG_QUERY_LT, SVCSIG_QUERY_LE };
+    op = mirror[ op ];
+  }
+  if ( left != 'i' ) {
+    svcSigQueryError( leftPos, "expected a field" );
+  }
+  if ( right == 'i' ) {
+    svcSigQueryError( rightPos, "expected a number or a string" );
+  }
+  
+  // resolve the field
+  node n = { SVCSIG_QUERY_NUMBER, op, -1, -1, SVCSIG_QUERY_COMMON, 0, rightNumber, rightText };
+  std::string name( leftText );
+  if ( name.compare( 0, 9, "reference" ) == 0 && name.size() > 9 ) {
+    n.scope = SVCSIG_QUERY_REFERENCE;
+    name = name.substr( 9 );
+  }
+  else if ( name.compare( 0, 6, "target" ) == 0 && name.size() > 6 ) {
+    n.scope = SVCSIG_QUERY_TARGET;
+    name = name.substr( 6 );
+  }
+  if ( n.scope != SVCSIG_QUERY_COMMON ) {
+    name[ 0 ] = tolower( name[ 0 ] );
+  }
+  
+  size_t nFields;
+  const svcsigqueryfield *fields( svcSigQueryFields( nFields ) );
+  for ( n.field = 0; n.field < nFields; n.field++ ) {
+    if ( name.compare( fields[ n.field ].name ) == 0 && fields[ n.field ].spectra == ( n.scope != SVCSIG_QUERY_COMMON ) ) {
+      break;
+    }
+  }
+  if ( n.field == nFields ) {
+    svcSigQueryError( leftPos, "unknown field '" + leftText + "'" );
+  }
+  
+  // check the types
+  if ( fields[ n.field ].text != NULL ) {
+    n.type = SVCSIG_QUERY_STRING;
+    if ( right != 's' ) {
+      svcSigQueryError( rightPos, "'" + leftText + "' is compared with a string" );
+    }
+  }
+  else if ( name.compare( "epochTime" ) == 0 ) {
+    // epoch times are exact, and may be given as a time string
+    if ( right == 's' ) {
+      n.number = svcsigspectraheader().svcSigParseTime( rightText );
+      if ( n.number == double( SVCSIG_TIME_INVALID ) ) {
+        svcSigQueryError( rightPos, "invalid time \"" + rightText + "\"" );
+      }
+    }
+  }
+  else if ( right == 's' ) {
+    svcSigQueryError( rightPos, "'" + leftText + "' is compared with a number" );
+  }
+  else {
+    // the other numeric fields are stored as floats, so round the value the
+    // same way (e.g. targetBattery == 7.61 matches "7.61" in the file)
+    n.number = float( n.number );
+  }
+  
+  _nodes.push_back( n );
+  return _nodes.size() - 1;
+}
+
+// -- -- Tokenizer -- -- //
+void svcsigquery::svcSigQuerySkip( size_t &pos ) const
+{
+  while ( pos < _expression.size() && isspace( _expression[ pos ] ) ) {
+    pos++;
+  }
+}
+
+bool svcsigquery::svcSigQueryMatch( size_t &pos, const char *token ) const
+{
+  size_t length( strlen( token ) );
+  if ( _expression.compare( pos, length, token ) != 0 ) {
+    return false;
+  }
+  pos += length;
+  svcSigQuerySkip( pos );
+  return true;
+}
+
+char svcsigquery::svcSigQueryOperand( size_t &pos, std::string &text, double &number ) const
+{
+  text.clear();
+  number = 0.0;
+  if ( pos >= _expression.size() ) {
+    svcSigQueryError( pos, "unexpected end" );
+  }
+  
+  char c( _expression[ pos ] );
+  char kind;
+  if ( isalpha( c ) || c == '_' ) {
+    size_t start( pos );
+    while ( pos < _expression.size() && ( isalnum( _expression[ pos ] ) || _expression[ pos ] == '_' ) ) {
+      pos++;
+    }
+    text = _expression.substr( start, pos - start );
+    kind = 'i';
+  }
+  else if ( c == '"' ) {
+    for ( pos++; pos < _expression.size() && _expression[ pos ] != '"'; pos++ ) {
+      if ( _expression[ pos ] == '\\' && pos + 1 < _expression.size() ) {
+        pos++;
+      }
+      text += _expression[ pos ];
+    }
+    if ( pos >= _expression.size() ) {
+      svcSigQueryError( pos, "unterminated string" );
+    }
+    pos++;
+    kind = 's';
+  }
+  else {
+    const char *start( _expression.c_str() + pos );
+    char *end;
+    number = strtod( start, &end );
+    if ( end == start ) {
+      svcSigQueryError( pos, "unexpected '" + _expression.substr( pos, 1 ) + "'" );
+    }
+    pos += end - start;
+    kind = 'n';
+  }
+  svcSigQuerySkip( pos );
+  return kind;
+}
+
+void svcsigquery::svcSigQueryError( const size_t &pos, const std::string &message ) const
+{
+  std::ostringstream output;
+  output << message << " at " << pos << " in \"" << _expression << "\"";
+  throw invalidSVCsigQuery( output.str() );
+}
+
+// -- -- Fields -- -- //
+const svcsigqueryfield * svcsigquery::svcSigQueryFields( size_t &n ) const
+{
+  typedef const svcsigcommonheader & C;
+  typedef const svcsigspectraheader & S;
+  static const svcsigqueryfield fields[] = {
+    // svcsigcommonheader
+    { "name", false, NULL, []( C c, S ) { return c.name(); } },
+    { "instrument", false, NULL, []( C c, S ) { return c.instrument(); } },
+    { "instrumentModelNumber", false, NULL, []( C c, S ) { return c.instrumentModelNumber(); } },
+    { "instrumentExtendedSerialNumber", false, NULL, []( C c, S ) { return c.instrumentExtendedSerialNumber(); } },
+    { "instrumentCommonName", false, NULL, []( C c, S ) { return c.instrumentCommonName(); } },
+    { "comm", false, NULL, []( C c, S ) { return c.comm(); } },
+    { "factorsComment", false, NULL, []( C c, S ) { return c.factorsComment(); } },
+    { "externalDataMask", false, []( C c, S ) { return double( c.externalDataMask() ); }, NULL },
+    { "factorsReference", false, []( C c, S ) { return double( c.factorsReference() ); }, NULL },
+    { "factorsTarget", false, []( C c, S ) { return double( c.factorsTarget() ); }, NULL },
+    { "factorsReflectance", false, []( C c, S ) { return double( c.factorsReflectance() ); }, NULL },
+    // svcsigspectraheader
+    { "scanMethod", true, NULL, []( C, S s ) { return s.scanMethod(); } },
+    { "scanSettings", true, NULL, []( C, S s ) { return s.scanSettings(); } },
+    { "optic", true, NULL, []( C, S s ) { return s.optic(); } },
+    { "units", true, NULL, []( C, S s ) { return s.units(); } },
+    { "time", true, NULL, []( C, S s ) { return s.time(); } },
+    { "longitude", true, NULL, []( C, S s ) { return s.longitude(); } },
+    { "latitude", true, NULL, []( C, S s ) { return s.latitude(); } },
+    { "gpstime", true, NULL, []( C, S s ) { return s.gpstime(); } },
+    { "integrationSi", true, []( C, S s ) { return double( s.integrationSi() ); }, NULL },
+    { "integrationInGaAs1", true, []( C, S s ) { return double( s.integrationInGaAs1() ); }, NULL },
+    { "integrationInGaAs2", true, []( C, S s ) { return double( s.integrationInGaAs2() ); }, NULL },
+    { "scanCoaddsSi", true, []( C, S s ) { return double( s.scanCoaddsSi() ); }, NULL },
+    { "scanCoaddsInGaAs1", true, []( C, S s ) { return double( s.scanCoaddsInGaAs1() ); }, NULL },
+    { "scanCoaddsInGaAs2", true, []( C, S s ) { return double( s.scanCoaddsInGaAs2() ); }, NULL },
+    { "scanTime", true, []( C, S s ) { return double( s.scanTime() ); }, NULL },
+    { "tempSi", true, []( C, S s ) { return double( s.tempSi() ); }, NULL },
+    { "tempInGaAs1", true, []( C, S s ) { return double( s.tempInGaAs1() ); }, NULL },
+    { "tempInGaAs2", true, []( C, S s ) { return double( s.tempInGaAs2() ); }, NULL },
+    { "battery", true, []( C, S s ) { return double( s.battery() ); }, NULL },
+    { "error", true, []( C, S s ) { return double( s.error() ); }, NULL },
+    { "memorySlot", true, []( C, S s ) { return double( s.memorySlot() ); }, NULL },
+    { "epochTime", true, []( C, S s ) {
+      return s.epochTime() == SVCSIG_TIME_INVALID ? NAN : double( s.epochTime() );
+    }, NULL },
+    { "decimalLatitude", true, []( C, S s ) { return s.decodedLatitude(); }, NULL },
+    { "decimalLongitude", true, []( C, S s ) { return s.decodedLongitude(); }, NULL },
+    { "decimalGpstime", true, []( C, S s ) { return s.decodedGpstime(); }, NULL }
+  };
+  n = sizeof( fields ) / sizeof( fields[ 0 ] );
+  return fields;
+}
+
+
+// -- -- Running Queries -- -- //
+std::vector<std::string> svcSigQueryFiles( const svcsigquery &query, const std::vector<std::string> &filenames, const unsigned int &threads )
+{
+  std::vector<char> match( filenames.size(), 0 );
+  svcSigParallelFor( filenames.size(), threads, [&]( size_t i, unsigned int ) {
+    svcsig sig;
+    match[ i ] = sig.read( filenames[ i ], query, false );
+  } );
+  
+  std::vector<std::string> matches;
+  for ( size_t i = 0; i < filenames.size(); i++ ) {
+    if ( match[ i ] ) {
+      matches.push_back( filenames[ i ] );
+    }
+  }
+  return matches;
+}
+
+std::vector<svcsig> svcSigQueryRead( const svcsigquery &query, const std::vector<std::string> &filenames, const unsigned int &threads )
+{
+  std::vector<svcsig> sigs( filenames.size() );
+  std::vector<char> match( filenames.size(), 0 );
+  svcSigParallelFor( filenames.size(), threads, [&]( size_t i, unsigned int ) {
+    match[ i ] = sigs[ i ].read( filenames[ i ], query );
+  } );
+  
+  std::vector<svcsig> matches;
+  for ( size_t i = 0; i < filenames.size(); i++ ) {
+    if ( match[ i ] ) {
+      matches.push_back( sigs[ i ] );
+    }
+  }
+  return matches;
+}
+
+std::vector<size_t> svcSigQueryCatalogue( const svcsigquery &query, const svcsigcatalogue &catalogue, const unsigned int &threads )
+{
+  std::vector<char> match( catalogue.size(), 0 );
+  svcSigParallelFor( catalogue.size(), threads, [&]( size_t i, unsigned int ) {
+    match[ i ] = query.accept( catalogue.commonHeader( i ), catalogue.referenceHeader( i ), catalogue.targetHeader( i ) );
+  } );
+  
+  std::vector<size_t> matches;
+  for ( size_t i = 0; i < catalogue.size(); i++ ) {
+    if ( match[ i ] ) {
+      matches.push_back( i );
+    }
+  }
+  return matches;
+}
+
+#endif // __svcsigquery_hpp_
@@ -0,0 +1,163 @@
+/*******************************************************************************
+ * svcsigreflectance.hpp
+ *
+ * DESCRIPTION:
+ *    Recomputes the target reflectance of sig files from their radiances, e.g.
+ *    after a radiance has been corrected in place through
+ *    svcsig::targetRadianceData(). Reflectance is
+ *
+ *      100 * factorsReflectance * targetRadiance / referenceRadiance
+ *
+ *    (percent, as in the sig file), and 0 where the reference radiance is 0.
+ *
+ *    The kernel uses AVX-512, AVX or SSE when the compiler targets them (e.g.
+ *    -march=native or -mavx2) and plain C++ otherwise. A zero reference is
+ *    masked out of the result, so there are no branches in the loop.
+ *    Collections need -pthread.
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsigreflectance_hpp_
+#define __svcsigreflectance_hpp_
+
+#include <vector>
+
+#if defined( __SSE2__ ) || defined( __AVX__ ) || defined( __AVX512F__ )
+#include <immintrin.h>
+#endif
+
+#include "svcsig.hpp"
+#include "svcsigbatch.hpp"
+
+
+/* Name: void svcSigReflectance( const float *reference, const float *target, float *reflectance, const size_t &n, const float &factor )
+ *
+ * Description: Computes reflectance from reference and target radiances
+ * Arguments: const float *reference: the reference radiance
+ *            const float *target: the target radiance
+ *            float *reflectance: the reflectance (percent)
+ *            const size_t &n: the number of bands
+ *            const float &factor: the reflectance factor
+ *                (svcsig::factorsReflectance())
+ * Modifies: reflectance
+ * Returns:
+ * Pre: each array holds n values; reflectance may be one of the inputs
+ * Post:
+ * Exceptions:
+ * Notes: Bands with a reference of 0 are 0; a NaN reference stays NaN
+ */
+void svcSigReflectance( const float *reference, const float *target, float *reflectance, const size_t &n, const float &factor )
+{
+  const float scale( 100.0f * factor );
+  size_t i( 0 );
+#if defined( __AVX512F__ )
+  const __m512 scale16( _mm512_set1_ps( scale ) );
+  const __m512 zero16( _mm512_setzero_ps() );
+  for ( ; i + 16 <= n; i += 16 ) {
+    __m512 r( _mm512_loadu_ps( reference + i ) );
+    __mmask16 valid( _mm512_cmp_ps_mask( r, zero16, _CMP_NEQ_UQ ) );
+    __m512 t( _mm512_mul_ps( _mm512_loadu_ps( target + i ), scale16 ) );
+    _mm512_storeu_ps( reflectance + i, _mm512_maskz_div_ps( valid, t, r ) );
+  }
+#endif
+#if defined( __AVX__ )
+  const __m256 scale8( _mm256_set1_ps( scale ) );
+  const __m256 zero8( _mm256_setzero_ps() );
+  for ( ; i + 8 <= n; i += 8 ) {
+    __m256 r( _mm256_loadu_ps( reference + i ) );
+    __m256 valid( _mm256_cmp_ps( r, zero8, _CMP_NEQ_UQ ) );
+    __m256 t( _mm256_mul_ps( _mm256_loadu_ps( target + i ), scale8 ) );
+    _mm256_storeu_ps( reflectance + i, _mm256_and_ps( valid, _mm256_div_ps( t, r ) ) );
+  }
+#endif
+#if defined( __SSE2__ )
+  const __m128 scale4( _mm_set1_ps( scale ) );
+  const __m128 zero4( _mm_setzero_ps() );
+  for ( ; i + 4 <= n; i += 4 ) {
+    __m128 r( _mm_loadu_ps( reference + i ) );
+    __m128 valid( _mm_cmpneq_ps( r, zero4 ) );
+    __m128 t( _mm_mul_ps( _mm_loadu_ps( target + i ), scale4 ) );
+    _mm_storeu_ps( reflectance + i, _mm_and_ps( valid, _mm_div_ps( t, r ) ) );
+  }
+#endif
+  // the remainder (or everything, without SIMD); the select compiles to a
+  // blend, not a branch
+  for ( ; i < n; i++ ) {
+    float r( reference[ i ] );
+    float q( target[ i ] * scale / r );
+    reflectance[ i ] = ( r != 0.0f ) ? q : 0.0f;
+  }
+}
+
+/* Name: void svcSigReflectance( svcsig &sig )
+ *
+ * Description: Recomputes the target reflectance of a sig file in place
+ * Arguments: svcsig &sig: the sig file
+ * Modifies: sig (its target reflectance)
+ * Returns:
+ * Pre:
+ * Post:
+ * Exceptions:
+ * Notes:
+ */
+void svcSigReflectance( svcsig &sig )
+{
+  if ( sig.size() == 0 ) {
+    return;
+  }
+  svcSigReflectance( sig.referenceRadianceData(), sig.targetRadianceData(), sig.targetReflectanceData(), sig.size(), sig.factorsReflectance() );
+}
+
+/* Name: void svcSigReflectanceBatch( std::vector<svcsig> &sigs, const unsigned int &threads )
+ *
+ * Description: Recomputes the target reflectance of many sig files in place
+ *    across worker threads
+ * Arguments: std::vector<svcsig> &sigs: the sig files
+ *            const unsigned int &threads: the number of threads (0 for one per
+ *                core)
+ * Modifies: sigs (their target reflectances)
+ * Returns:
+ * Pre:
+ * Post:
+ * Exceptions:
+ * Notes:
+ */
+void svcSigReflectanceBatch( std::vector<svcsig> &sigs, const unsigned int &threads = 0 )
+{
+  svcSigParallelFor( sigs.size(), threads, [&]( size_t i, unsigned int ) {
+    svcSigReflectance( sigs[ i ] );
+  } );
+}
+
+#endif // __svcsigreflectance_hpp_
@@ -0,0 +1,657 @@
+/*******************************************************************************
+ * svcsigresample.hpp
+ *
+ * DESCRIPTION:
+ *    Provides header and implimentation for the svcsigresampler class, which
+ *    resamples spectra from one wavelength grid onto another (e.g. HR-1024i
+ *    and HR-768i files onto a common 1 nm grid), and a process wide cache of
+ *    resamplers so the weights for a pair of grids are computed once.
+ *
+ *    Modes:
+ *      SVCSIG_RESAMPLE_LINEAR: linear interpolation
+ *      SVCSIG_RESAMPLE_CUBIC: cubic Hermite interpolation with three point
+ *          slopes (a local cubic that is linear in the data)
+ *      SVCSIG_RESAMPLE_PCHIP: monotone piecewise cubic Hermite interpolation
+ *          (Fritsch and Carlson), which does not overshoot
+ *
+ *    Linear and cubic resampling are a sparse matrix (2 or 4 weights per
+ *    output band) applied to each spectrum. PCHIP slopes depend on the data,
+ *    so the interval and Hermite basis of each output band are precomputed
+ *    and the slopes are found per spectrum.
+ *
+ *    The source grid does not need to be sorted: sig files repeat wavelengths
+ *    where the detectors overlap. Source bands are sorted by wavelength and
+ *    bands with the same wavelength are averaged. Output bands outside the
+ *    source grid are NAN.
+ *
+ *    Build with -pthread.
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *    2026-10-18: svcSigResampleBatch() groups the files by grid
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *   F. N. Fritsch and R. E. Carlson, "Monotone Piecewise Cubic
+ *     Interpolation", SIAM J. Numer. Anal. 17(2), 1980
+ *   C. Moler, "Numerical Computing with MATLAB", ch. 3 (pchip)
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsigresample_hpp_
+#define __svcsigresample_hpp_
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
+
+#include "svcsighelper.hpp"
+#include "svcsig.hpp"
+#include "svcsigbatch.hpp"
+
+#define SVCSIG_RESAMPLE_LINEAR 0
+#define SVCSIG_RESAMPLE_CUBIC 1
+#define SVCSIG_RESAMPLE_PCHIP 2
+
+// the spectra of a sig file, for the functions that work on collections
+#define SVCSIG_SPECTRUM_REFERENCE_RADIANCE 0
+#define SVCSIG_SPECTRUM_TARGET_RADIANCE 1
+#define SVCSIG_SPECTRUM_TARGET_REFLECTANCE 2
+
+// the spectra gathered per svcsigresampler::apply() call by
+// svcSigResampleBatch()
+#define SVCSIG_RESAMPLE_CHUNK 1024
+
+
+class svcsigresampler {
+private:
+  int _mode;
+  size_t _sourceSize;
+  std::vector<float> _target;
+  
+  // a sparse matrix with a row per output band (linear and cubic), or per
+  // distinct source wavelength (pchip). _rows holds the start of each row in
+  // _index and _weight, plus the end.
+  std::vector<uint32_t> _rows;
+  std::vector<uint32_t> _index;
+  std::vector<float> _weight;
+  
+  // pchip only: the distinct source wavelengths, and for each output band
+  // the interval it is in (-1 outside) and its Hermite basis
+  std::vector<double> _x;
+  std::vector<int32_t> _interval;
+  std::vector<float> _basis;
+  
+  /* Name: void svcSigResampleNodes( const std::vector<float> &source, std::vector<double> &x, std::vector< std::vector<uint32_t> > &bands ) const
+   *
+   * Description: Sorts a grid, merging bands with the same wavelength
+   * Arguments: const std::vector<float> &source: the grid
+   *            std::vector<double> &x: the distinct wavelengths, ascending
+   *            std::vector< std::vector<uint32_t> > &bands: the source bands
+   *                of each distinct wavelength
+   * Modifies: x, bands
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: NaN wavelengths are dropped
+   */
+  void svcSigResampleNodes( const std::vector<float> &source, std::vector<double> &x, std::vector< std::vector<uint32_t> > &bands ) const;
+  
+  /* Name: int32_t svcSigResampleInterval( const std::vector<double> &x, const double &t ) const
+   *
+   * Description: Finds the interval [ x[ i ], x[ i + 1 ] ] holding t
+   * Returns: i, or -1 if t is outside x
+   */
+  int32_t svcSigResampleInterval( const std::vector<double> &x, const double &t ) const;
+  
+  /* Name: void svcSigResampleSlope( const std::vector<double> &x, const size_t &k, std::vector< std::pair<uint32_t, double> > &terms, const double &scale ) const
+   *
+   * Description: Adds the three point slope at x[ k ] as weights of the values
+   *    at the nodes
+   * Arguments: const std::vector<double> &x: the nodes (at least 3)
+   *            const size_t &k: the node
+   *            std::vector< std::pair<uint32_t, double> > &terms: ( node,
+   *                weight ) pairs
+   *            const double &scale: multiplies the weights
+   * Modifies: terms
+   */
+  void svcSigResampleSlope( const std::vector<double> &x, const size_t &k, std::vector< std::pair<uint32_t, double> > &terms, const double &scale ) const;
+  
+  /* Name: void svcSigResamplePchip( const float *in, std::vector<double> &y, std::vector<double> &d, float *out ) const
+   *
+   * Description: Resamples one spectrum by pchip
+   * Arguments: const float *in: the spectrum
+   *            std::vector<double> &y, &d: scratch for the node values and
+   *                slopes
+   *            float *out: the resampled spectrum
+   * Modifies: y, d, out
+   */
+  void svcSigResamplePchip( const float *in, std::vector<double> &y, std::vector<double> &d, float *out ) const;
+
+public:
+  /* Name: svcsigresampler( const std::vector<float> &source, const std::vector<float> &target, const int &mode )
+   *
+   * Description: Computes the weights that resample from one grid to another
+   * Arguments: const std::vector<float> &source: the wavelengths of the
+   *                spectra (e.g. svcsig::wavelength())
+   *            const std::vector<float> &target: the output wavelengths
+   *            const int &mode: SVCSIG_RESAMPLE_LINEAR, SVCSIG_RESAMPLE_CUBIC
+   *                or SVCSIG_RESAMPLE_PCHIP
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigResample if mode is unknown
+   * Notes: Cubic and pchip use linear interpolation if there are fewer than
+   *    3 distinct source wavelengths. Use svcSigResampler() to share
+   *    resamplers between callers.
+   */
+  svcsigresampler( const std::vector<float> &source, const std::vector<float> &target, const int &mode = SVCSIG_RESAMPLE_LINEAR );
+  
+  /* Name: getters
+   *
+   * Description: The mode, and the number of source and output bands
+   */
+  int mode() const;
+  size_t sourceSize() const;
+  size_t targetSize() const;
+  const std::vector<float> & target() const;
+  
+  /* Name: void apply( const float *in, float *out ) const
+   *
+   * Description: Resamples one spectrum
+   * Arguments: const float *in: sourceSize() values
+   *            float *out: targetSize() values
+   * Modifies: out
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  void apply( const float *in, float *out ) const;
+  
+  /* Name: void apply( const float *in, float *out, const size_t &count, const unsigned int &threads ) const
+   *
+   * Description: Resamples many spectra
+   * Arguments: const float *in: count spectra of sourceSize() values, one
+   *                after another
+   *            float *out: count spectra of targetSize() values
+   *            const size_t &count: the number of spectra
+   *            const unsigned int &threads: the number of threads (0 for one
+   *                per core)
+   * Modifies: out
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Spectra are resampled in blocks, so each block of output bands
+   *    stays in cache with its weights while the block's spectra pass
+   *    through it
+   */
+  void apply( const float *in, float *out, const size_t &count, const unsigned int &threads = 1 ) const;
+  
+  /* Name: std::vector<float> apply( const std::vector<float> &in ) const
+   *
+   * Description: Resamples one spectrum
+   */
+  std::vector<float> apply( const std::vector<float> &in ) const;
+};
+
+
+/* Name: std::shared_ptr<const svcsigresampler> svcSigResampler( const std::vector<float> &source, const std::vector<float> &target, const int &mode )
+ *
+ * Description: Returns the resampler for a pair of grids, computing it the
+ *    first time the pair is seen
+ * Arguments: see svcsigresampler()
+ * Modifies: the process wide cache
+ * Returns: std::shared_ptr<const svcsigresampler>
+ * Pre:
+ * Post:
+ * Exceptions: invalidSVCsigResample if mode is unknown
+ * Notes: Thread safe. Resamplers are kept for the life of the process (there
+ *    are only ever a few grids).
+ */
+std::shared_ptr<const svcsigresampler> svcSigResampler( const std::vector<float> &source, const std::vector<float> &target, const int &mode = SVCSIG_RESAMPLE_LINEAR );
+
+/* Name: std::vector<float> svcSigResampleGrid( const float &first, const float &last, const float &step )
+ *
+ * Description: Returns the grid first, first + step, ... up to last
+ *    (inclusive), e.g. svcSigResampleGrid( 350, 2500, 1 )
+ */
+std::vector<float> svcSigResampleGrid( const float &first, const float &last, const float &step );
+
+/* Name: std::vector<float> svcSigResampleBatch( const std::vector<svcsig> &sigs, const std::vector<float> &target, const int &mode, const int &spectrum, const unsigned int &threads )
+ *
+ * Description: Resamples a spectrum of many sig files onto one grid
+ * Arguments: const std::vector<svcsig> &sigs: the sig files, on any grids
+ *            const std::vector<float> &target: the output wavelengths
+ *            const int &mode: SVCSIG_RESAMPLE_LINEAR, SVCSIG_RESAMPLE_CUBIC
+ *                or SVCSIG_RESAMPLE_PCHIP
+ *            const int &spectrum: SVCSIG_SPECTRUM_REFERENCE_RADIANCE,
+ *                SVCSIG_SPECTRUM_TARGET_RADIANCE or
+ *                SVCSIG_SPECTRUM_TARGET_REFLECTANCE
+ *            const unsigned int &threads: the number of threads (0 for one per
+ *                core)
+ * Modifies:
+ * Returns: std::vector<float>, sigs.size() rows of target.size() values
+ * Pre:
+ * Post:
+ * Exceptions: invalidSVCsigResample if mode or spectrum is unknown
+ * Notes: The files are grouped by grid; each group looks up its resampler
+ *    once and is resampled in gathered chunks of SVCSIG_RESAMPLE_CHUNK
+ *    spectra. Empty files give rows of NAN.
+ */
+std::vector<float> svcSigResampleBatch( const std::vector<svcsig> &sigs, const std::vector<float> &target, const int &mode = SVCSIG_RESAMPLE_LINEAR, const int &spectrum = SVCSIG_SPECTRUM_TARGET_REFLECTANCE, const unsigned int &threads = 0 );
+
+
+// --- --- Implimentation --- --- //
+
+// -- -- Constructors -- -- //
+svcsigresampler::svcsigresampler( const std::vector<float> &source, const std::vector<float> &target, const int &mode )
+: _mode( mode ), _sourceSize( source.size() ), _target( target )
+{
+  if ( mode != SVCSIG_RESAMPLE_LINEAR && mode != SVCSIG_RESAMPLE_CUBIC && mode != SVCSIG_RESAMPLE_PCHIP ) {
+    throw invalidSVCsigResample( "unknown resampling mode" );
+  }
+  
+  std::vector<double> x;
+  std::vector< std::vector<uint32_t> > bands;
+  svcSigResampleNodes( source, x, bands );
+  int method( x.size() < 3 ? SVCSIG_RESAMPLE_LINEAR : mode );
+  
+  _rows.push_back( 0 );
+  if ( method == SVCSIG_RESAMPLE_PCHIP ) {
+    // a row per node, averaging its bands
+    _x = x;
+    for ( size_t k = 0; k < bands.size(); k++ ) {
+      for ( size_t b = 0; b < bands[ k ].size(); b++ ) {
+        _index.push_back( bands[ k ][ b ] );
+        _weight.push_back( 1.0 / bands[ k ].size() );
+      }
+      _rows.push_back( _index.size() );
+    }
+    _interval.resize( target.size() );
+    _basis.resize( 4 * target.size() );
+    for ( size_t j = 0; j < target.size(); j++ ) {
+      int32_t i( svcSigResampleInterval( x, target[ j ] ) );
+      _interval[ j ] = i;
+      if ( i < 0 ) {
+        continue;
+      }
+      double h( x[ i + 1 ] - x[ i ] );
+      double s( ( target[ j ] - x[ i ] ) / h );
+      _basis[ 4 * j ] = ( 2.0 * s - 3.0 ) * s * s + 1.0;
+      _basis[ 4 * j + 1 ] = h * ( ( s - 2.0 ) * s + 1.0 ) * s;
+      _basis[ 4 * j + 2 ] = ( 3.0 - 2.0 * s ) * s * s;
+      _basis[ 4 * j + 3 ] = h * ( s - 1.0 ) * s * s;
+    }
+    return;
+  }
+  
+  // linear and cubic: the weights of the nodes for each output band, then of
+  // the source bands
+  std::vector< std::pair<uint32_t, double> > terms;
+  std::vector< std::pair<uint32_t, double> > merged;
+  for ( size_t j = 0; j < target.size(); j++ ) {
+    terms.clear();
+    int32_t i( svcSigResampleInterval( x, target[ j ] ) );
+    if ( i >= 0 ) {
+      double h( x[ i + 1 ] - x[ i ] );
+      double s( ( target[ j ] - x[ i ] ) / h );
+      if ( method == SVCSIG_RESAMPLE_LINEAR ) {
+        terms.push_back( std::make_pair( uint32_t( i ), 1.0 - s ) );
+        terms.push_back( std::make_pair( uint32_t( i + 1 ), s ) );
+      }
+      else {
+        terms.push_back( std::make_pair( uint32_t( i ), ( 2.0 * s - 3.0 ) * s * s + 1.0 ) );
+        terms.push_back( std::make_pair( uint32_t( i + 1 ), ( 3.0 - 2.0 * s ) * s * s ) );
+        svcSigResampleSlope( x, i, terms, h * ( ( s - 2.0 ) * s + 1.0 ) * s );
+        svcSigResampleSlope( x, i + 1, terms, h * ( s - 1.0 ) * s * s );
+      }
+    }
+    
+    // nodes to source bands
+    merged.clear();
+    for ( size_t t = 0; t < terms.size(); t++ ) {
+      const std::vector<uint32_t> &b( bands[ terms[ t ].first ] );
+      for ( size_t k = 0; k < b.size(); k++ ) {
+        merged.push_back( std::make_pair( b[ k ], terms[ t ].second / b.size() ) );
+      }
+    }
+    std::sort( merged.begin(), merged.end() );
+    for ( size_t t = 0; t < merged.size(); t++ ) {
+      if ( t > 0 && merged[ t ].first == merged[ t - 1 ].first ) {
+        _weight.back() += merged[ t ].second;
+      }
+      else {
+        _index.push_back( merged[ t ].first );
+        _weight.push_back( merged[ t ].second );
+      }
+    }
+    _rows.push_back( _index.size() );
+  }
+  _mode = method == mode ? mode : SVCSIG_RESAMPLE_LINEAR;
+}
+
+// -- -- Getters -- -- //
+int svcsigresampler::mode() const
+{
+  return _mode;
+}
+
+size_t svcsigresampler::sourceSize() const
+{
+  return _sourceSize;
+}
+
+size_t svcsigresampler::targetSize() const
+{
+  return _target.size();
+}
+
+const std::vector<float> & svcsigresampler::target() const
+{
+  return _target;
+}
+
+// -- -- Resampling -- -- //
+void svcsigresampler::apply( const float *in, float *out ) const
+{
+  apply( in, out, 1, 1 );
+}
+
+std::vector<float> svcsigresampler::apply( const std::vector<float> &in ) const
+{
+  if ( in.size() != _sourceSize ) {
+    throw invalidSVCsigResample( "the spectrum is not on the source grid" );
+  }
+  std::vector<float> out( _target.size() );
+  if ( !out.empty() ) {
+    apply( in.data(), out.data(), 1, 1 );
+  }
+  return out;
+}
+
+void svcsigresampler::apply( const float *in, float *out, const size_t &count, const unsigned int &threads ) const
+{
+  // spectra per parallel item, and output bands per cache block
+  const size_t spectra( 64 );
+  const size_t block( 512 );
+  size_t n( _target.size() );
+  size_t items( ( count + spectra - 1 ) / spectra );
+  
+  svcSigParallelFor( items, threads, [&]( size_t item, unsigned int ) {
+    size_t first( item * spectra );
+    size_t last( std::min( count, first + spectra ) );
+    if ( _mode == SVCSIG_RESAMPLE_PCHIP ) {
+      std::vector<double> y, d;
+      for ( size_t s = first; s < last; s++ ) {
+        svcSigResamplePchip( in + s * _sourceSize, y, d, out + s * n );
+      }
+      return;
+    }
+    const uint32_t *rows( _rows.data() );
+    const uint32_t *index( _index.data() );
+    const float *weight( _weight.data() );
+    for ( size_t j0 = 0; j0 < n; j0 += block ) {
+      size_t j1( std::min( n, j0 + block ) );
+      for ( size_t s = first; s < last; s++ ) {
+        const float *x( in + s * _sourceSize );
+        float *y( out + s * n );
+        for ( size_t j = j0; j < j1; j++ ) {
+          float sum( 0.0f );
+          for ( uint32_t k = rows[ j ]; k < rows[ j + 1 ]; k++ ) {
+            sum += weight[ k ] * x[ index[ k ] ];
+          }
+          y[ j ] = rows[ j ] == rows[ j + 1 ] ? NAN : sum;
+        }
+      }
+    }
+  } );
+}
+
+// -- -- Helper Functions -- -- //
+void svcsigresampler::svcSigResampleNodes( const std::vector<float> &source, std::vector<double> &x, std::vector< std::vector<uint32_t> > &bands ) const
+{
+  std::vector< std::pair<float, uint32_t> > order;
+  for ( size_t i = 0; i < source.size(); i++ ) {
+    if ( !std::isnan( source[ i ] ) ) {
+      order.push_back( std::make_pair( source[ i ], uint32_t( i ) ) );
+    }
+  }
+  std::sort( order.begin(), order.end() );
+  x.clear();
+  bands.clear();
+  for ( size_t i = 0; i < order.size(); i++ ) {
+    if ( x.empty() || order[ i ].first != x.back() ) {
+      x.push_back( order[ i ].first );
+      bands.push_back( std::vector<uint32_t>() );
+    }
+    bands.back().push_back( order[ i ].second );
+  }
+}
+
+int32_t svcsigresampler::svcSigResampleInterval( const std::vector<double> &x, const double &t ) const
+{
+  if ( x.size() < 2 || !( t >= x.front() && t <= x.back() ) ) {
+    return -1;
+  }
+  size_t k( std::upper_bound( x.begin(), x.end(), t ) - x.begin() );
+  return k == x.size() ? int32_t( x.size() - 2 ) : int32_t( k - 1 );
+}
+
+void svcsigresampler::svcSigResampleSlope( const std::vector<double> &x, const size_t &k, std::vector< std::pair<uint32_t, double> > &terms, const double &scale ) const
+{
+  // the slope of the parabola through three nodes, at the middle node or
+  // (at the ends of the grid) at an end node
+  size_t n( x.size() );
+  size_t a( k == 0 ? 0 : ( k == n - 1 ? n - 3 : k - 1 ) );
+  double h0( x[ a + 1 ] - x[ a ] );
+  double h1( x[ a + 2 ] - x[ a + 1 ] );
+  double c0, c1, c2; // weights of the values at a, a + 1, a + 2
+  if ( k == a ) {
+    c0 = -( 2.0 * h0 + h1 ) / ( h0 * ( h0 + h1 ) );
+    c1 = ( h0 + h1 ) / ( h0 * h1 );
+    c2 = -h0 / ( h1 * ( h0 + h1 ) );
+  }
+  else if ( k == a + 1 ) {
+    c0 = -h1 / ( h0 * ( h0 + h1 ) );
+    c1 = ( h1 - h0 ) / ( h0 * h1 );
+    c2 = h0 / ( h1 * ( h0 + h1 ) );
+  }
+  else {
+    c0 = h1 / ( h0 * ( h0 + h1 ) );
+    c1 = -( h0 + h1 ) / ( h0 * h1 );
+    c2 = ( 2.0 * h1 + h0 ) / ( h1 * ( h0 + h1 ) );
+  }
+  terms.push_back( std::make_pair( uint32_t( a ), scale * c0 ) );
+  terms.push_back( std::make_pair( uint32_t( a + 1 ), scale * c1 ) );
+  terms.push_back( std::make_pair( uint32_t( a + 2 ), scale * c2 ) );
+}
+
+void svcsigresampler::svcSigResamplePchip( const float *in, std::vector<double> &y, std::vector<double> &d, float *out ) const
+{
+  size_t n( _x.size() );
+  y.resize( n );
+  d.resize( n );
+  for ( size_t k = 0; k < n; k++ ) {
+    double sum( 0.0 );
+    for ( uint32_t b = _rows[ k ]; b < _rows[ k + 1 ]; b++ ) {
+      sum += _weight[ b ] * in[ _index[ b ] ];
+    }
+    y[ k ] = sum;
+  }
+  
+  // Fritsch-Carlson slopes: a weighted harmonic mean of the secants inside,
+  // zero at extrema, and a shape preserving three point formula at the ends
+  double h0( _x[ 1 ] - _x[ 0 ] );
+  double delta0( ( y[ 1 ] - y[ 0 ] ) / h0 );
+  for ( size_t k = 1; k + 1 < n; k++ ) {
+    double h1( _x[ k + 1 ] - _x[ k ] );
+    double delta1( ( y[ k + 1 ] - y[ k ] ) / h1 );
+    if ( delta0 * delta1 <= 0.0 ) {
+      d[ k ] = 0.0;
+    }
+    else {
+      double w1( 2.0 * h1 + h0 );
+      double w2( h1 + 2.0 * h0 );
+      d[ k ] = ( w1 + w2 ) / ( w1 / delta0 + w2 / delta1 );
+    }
+    h0 = h1;
+    delta0 = delta1;
+  }
+  for ( int end = 0; end < 2; end++ ) {
+    size_t k( end == 0 ? 0 : n - 1 );
+    size_t a( end == 0 ? 0 : n - 2 ); // the end interval
+    size_t b( end == 0 ? 1 : n - 3 ); // the interval next to it
+    double ha( _x[ a + 1 ] - _x[ a ] );
+    double hb( _x[ b + 1 ] - _x[ b ] );
+    double da( ( y[ a + 1 ] - y[ a ] ) / ha );
+    double db( ( y[ b + 1 ] - y[ b ] ) / hb );
+    double slope( ( ( 2.0 * ha + hb ) * da - ha * db ) / ( ha + hb ) );
+    if ( slope * da <= 0.0 ) {
+      slope = 0.0;
+    }
+    else if ( da * db <= 0.0 && std::fabs( slope ) > std::fabs( 3.0 * da ) ) {
+      slope = 3.0 * da;
+    }
+    d[ k ] = slope;
+  }
+  
+  for ( size_t j = 0; j < _target.size(); j++ ) {
+    int32_t i( _interval[ j ] );
+    if ( i < 0 ) {
+      out[ j ] = NAN;
+      continue;
+    }
+    const float *basis( &_basis[ 4 * j ] );
+    out[ j ] = basis[ 0 ] * y[ i ] + basis[ 1 ] * d[ i ] + basis[ 2 ] * y[ i + 1 ] + basis[ 3 ] * d[ i + 1 ];
+  }
+}
+
+// -- -- The Cache -- -- //
+std::shared_ptr<const svcsigresampler> svcSigResampler( const std::vector<float> &source, const std::vector<float> &target, const int &mode )
+{
+  static std::mutex lock;
+  static std::map< std::string, std::shared_ptr<const svcsigresampler> > cache;
+  
+  // the key is the mode and both grids, byte for byte
+  std::string key( sizeof( int ) + sizeof( size_t ) + ( source.size() + target.size() ) * sizeof( float ), '\0' );
+  size_t sourceSize( source.size() );
+  memcpy( &key[ 0 ], &mode, sizeof( int ) );
+  memcpy( &key[ sizeof( int ) ], &sourceSize, sizeof( size_t ) );
+  if ( !source.empty() ) {
+    memcpy( &key[ sizeof( int ) + sizeof( size_t ) ], source.data(), source.size() * sizeof( float ) );
+  }
+  if ( !target.empty() ) {
+    memcpy( &key[ sizeof( int ) + sizeof( size_t ) + source.size() * sizeof( float ) ], target.data(), target.size() * sizeof( float ) );
+  }
+  
+  {
+    std::lock_guard<std::mutex> guard( lock );
+    std::map< std::string, std::shared_ptr<const svcsigresampler> >::const_iterator found( cache.find( key ) );
+    if ( found != cache.end() ) {
+      return found->second;
+    }
+  }
+  // build outside the lock; if two threads race, the first one in wins
+  std::shared_ptr<const svcsigresampler> resampler( new svcsigresampler( source, target, mode ) );
+  std::lock_guard<std::mutex> guard( lock );
+  return cache.insert( std::make_pair( key, resampler ) ).first->second;
+}
+
+std::vector<float> svcSigResampleGrid( const float &first, const float &last, const float &step )
+{
+  std::vector<float> grid;
+  if ( step <= 0.0 || last < first ) {
+    return grid;
+  }
+  size_t n( size_t( std::floor( ( double( last ) - first ) / step + 1e-6 ) ) + 1 );
+  grid.resize( n );
+  for ( size_t i = 0; i < n; i++ ) {
+    grid[ i ] = first + double( step ) * i;
+  }
+  return grid;
+}
+
+std::vector<float> svcSigResampleBatch( const std::vector<svcsig> &sigs, const std::vector<float> &target, const int &mode, const int &spectrum, const unsigned int &threads )
+{
+  if ( spectrum != SVCSIG_SPECTRUM_REFERENCE_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_REFLECTANCE ) {
+    throw invalidSVCsigResample( "unknown spectrum" );
+  }
+  std::vector<float> out( sigs.size() * target.size() );
+  
+  for ( size_t i = 0; i < sigs.size(); i++ ) {
+    if ( sigs[ i ].size() == 0 ) {
+      std::fill( out.begin() + i * target.size(), out.begin() + ( i + 1 ) * target.size(), float( NAN ) );
+    }
+  }
+  std::map< std::vector<float>, std::vector<size_t> > groups( svcSigGroupByGrid( sigs ) );
+  
+  // gather each group a chunk at a time, resample, and scatter the rows
+  std::vector<float> in, result;
+  for ( std::map< std::vector<float>, std::vector<size_t> >::const_iterator g = groups.begin(); g != groups.end(); ++g ) {
+    std::shared_ptr<const svcsigresampler> resampler( svcSigResampler( g->first, target, mode ) );
+    const std::vector<size_t> &group( g->second );
+    size_t n( g->first.size() );
+    for ( size_t first = 0; first < group.size(); first += SVCSIG_RESAMPLE_CHUNK ) {
+      size_t count( std::min( group.size() - first, size_t( SVCSIG_RESAMPLE_CHUNK ) ) );
+      // rows that are consecutive in out (the usual case) are written in place
+      bool consecutive( group[ first + count - 1 ] - group[ first ] == count - 1 );
+      in.resize( count * n );
+      result.resize( consecutive ? 0 : count * target.size() );
+      svcSigParallelFor( count, threads, [&]( size_t s, unsigned int ) {
+        const svcsig &sig( sigs[ group[ first + s ] ] );
+        const float *data( spectrum == SVCSIG_SPECTRUM_REFERENCE_RADIANCE ? sig.referenceRadianceData() :
+          ( spectrum == SVCSIG_SPECTRUM_TARGET_RADIANCE ? sig.targetRadianceData() : sig.targetReflectanceData() ) );
+        std::copy( data, data + n, in.begin() + s * n );
+      } );
+      if ( consecutive ) {
+        resampler->apply( in.data(), out.data() + group[ first ] * target.size(), count, threads );
+        continue;
+      }
+      resampler->apply( in.data(), result.data(), count, threads );
+      svcSigParallelFor( count, threads, [&]( size_t s, unsigned int ) {
+        std::copy( result.begin() + s * target.size(), result.begin() + ( s + 1 ) * target.size(), out.begin() + group[ first + s ] * target.size() );
+      } );
+    }
+  }
+  return out;
+}
+
+#endif // __svcsigresample_hpp_
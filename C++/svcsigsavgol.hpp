@@ -0,0 +1,481 @@
+/*******************************************************************************
+ * svcsigsavgol.hpp
+ *
+ * DESCRIPTION:
+ *    Provides header and implimentation for the svcsigsavgol class,
+ *    Savitzky-Golay smoothing and derivatives (e.g. of the red edge) of
+ *    spectra on a sig file's wavelength grid.
+ *
+ *    The bands of a sig file are not evenly spaced and its detector segments
+ *    overlap, so each band gets its own least squares polynomial over the
+ *    window of its actual wavelengths, kept within its detector segment
+ *    (shifted at the segment ends). The coefficients are found once per grid
+ *    and cached, and are applied across the bands with SIMD when the
+ *    compiler targets it (e.g. -march=native), to whole collections on all
+ *    cores.
+ *
+ *    Derivatives are per nm.
+ *
+ *    Build with -pthread.
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *    2026-10-18: svcSigSavgolBatch() looks up one filter per grid
+ *    2026-10-18: A window of one band is the identity, not NAN
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *   A. Savitzky, M. J. E. Golay, "Smoothing and Differentiation of Data by
+ *     Simplified Least Squares Procedures", Analytical Chemistry 36(8), 1964
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsigsavgol_hpp_
+#define __svcsigsavgol_hpp_
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
+
+#if defined( __SSE2__ ) || defined( __AVX__ ) || defined( __AVX512F__ )
+#include <immintrin.h>
+#endif
+
+#include "svcsighelper.hpp"
+#include "svcsig.hpp"
+#include "svcsigbatch.hpp"
+#include "svcsigresample.hpp"
+
+
+class svcsigsavgol {
+private:
+  size_t _size;
+  size_t _window;
+  size_t _order;
+  size_t _derivative;
+  
+  // band j is the sum over i < _length[ j ] of
+  // _coefficient[ i * _size + j ] * in[ _start[ j ] + i ]
+  std::vector<uint32_t> _start;
+  std::vector<uint32_t> _length;
+  std::vector<float> _coefficient;
+  
+  // runs [first, last) of bands with a full, centered window
+  std::vector< std::pair<size_t, size_t> > _centered;
+  
+  /* Name: void svcSigSavgolBand( const std::vector<float> &grid, const size_t &j )
+   *
+   * Description: Finds the coefficients of band j
+   */
+  void svcSigSavgolBand( const std::vector<float> &grid, const size_t &j );
+
+public:
+  /* Name: svcsigsavgol( const std::vector<float> &grid, const size_t &window, const size_t &order, const size_t &derivative )
+   *
+   * Description: Finds the coefficients of a filter for a grid
+   * Arguments: const std::vector<float> &grid: the wavelengths (nm), e.g.
+   *                svcsig::wavelength()
+   *            const size_t &window: the number of bands fitted (odd)
+   *            const size_t &order: the order of the polynomial
+   *            const size_t &derivative: 0 to smooth, 1 for the first
+   *                derivative, ...
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigSavgol if window is even or not larger than
+   *    order, or derivative is larger than order
+   * Notes: Detector segments end wherever the wavelength does not increase.
+   *    Bands of segments with no more than order bands are NAN. Use
+   *    svcSigSavgol() to share filters.
+   */
+  svcsigsavgol( const std::vector<float> &grid, const size_t &window, const size_t &order, const size_t &derivative = 0 );
+  
+  /* Name: getters
+   *
+   * Description: size() is the number of bands, and window(), order() and
+   *    derivative() the parameters of the filter
+   */
+  size_t size() const;
+  size_t window() const;
+  size_t order() const;
+  size_t derivative() const;
+  
+  /* Name: void apply( const float *in, float *out ) const
+   *
+   * Description: Filters a spectrum
+   * Arguments: const float *in: size() values on the grid
+   *            float *out: size() values
+   * Modifies: out
+   * Returns:
+   * Pre: in and out do not overlap
+   * Post:
+   * Exceptions:
+   * Notes: NAN input bands make the bands whose windows hold them NAN
+   */
+  void apply( const float *in, float *out ) const;
+  
+  /* Name: void apply( const float *in, float *out, const size_t &count, const unsigned int &threads ) const
+   *
+   * Description: Filters count spectra (rows of size() values)
+   * Arguments: const unsigned int &threads: the number of threads (0 for one
+   *                per core)
+   */
+  void apply( const float *in, float *out, const size_t &count, const unsigned int &threads = 1 ) const;
+  
+  /* Name: std::vector<float> apply( const svcsig &sig, const int &spectrum ) const
+   *
+   * Description: Filters a spectrum of a sig file on the filter's grid
+   * Arguments: const svcsig &sig: the sig file
+   *            const int &spectrum: SVCSIG_SPECTRUM_REFERENCE_RADIANCE,
+   *                SVCSIG_SPECTRUM_TARGET_RADIANCE or
+   *                SVCSIG_SPECTRUM_TARGET_REFLECTANCE
+   * Returns: std::vector<float>
+   * Exceptions: invalidSVCsigSavgol if the file has another number of bands,
+   *    or the spectrum is unknown
+   */
+  std::vector<float> apply( const svcsig &sig, const int &spectrum = SVCSIG_SPECTRUM_TARGET_REFLECTANCE ) const;
+};
+
+
+/* Name: std::shared_ptr<const svcsigsavgol> svcSigSavgol( const std::vector<float> &grid, const size_t &window, const size_t &order, const size_t &derivative )
+ *
+ * Description: Returns a filter for a grid, finding its coefficients the
+ *    first time the grid and parameters are seen
+ * Arguments: See svcsigsavgol
+ * Modifies:
+ * Returns: std::shared_ptr<const svcsigsavgol>
+ * Pre:
+ * Post:
+ * Exceptions: See svcsigsavgol
+ * Notes: Thread safe; filters are kept for the life of the process
+ */
+std::shared_ptr<const svcsigsavgol> svcSigSavgol( const std::vector<float> &grid, const size_t &window, const size_t &order, const size_t &derivative = 0 );
+
+/* Name: void svcSigSavgolBatch( const std::vector<svcsig> &sigs, float *out, const size_t &window, const size_t &order, const size_t &derivative, const int &spectrum, const unsigned int &threads )
+ *
+ * Description: Filters a spectrum of many sig files, each on its own grid
+ * Arguments: const std::vector<svcsig> &sigs: the sig files
+ *            float *out: the filtered spectra, one after another (file i
+ *                starts after the sigs[ 0 .. i - 1 ].size() values of the
+ *                files before it)
+ *            const size_t &window, &order, &derivative: see svcsigsavgol
+ *            const int &spectrum: SVCSIG_SPECTRUM_REFERENCE_RADIANCE,
+ *                SVCSIG_SPECTRUM_TARGET_RADIANCE or
+ *                SVCSIG_SPECTRUM_TARGET_REFLECTANCE
+ *            const unsigned int &threads: the number of threads (0 for one per
+ *                core)
+ * Modifies: out
+ * Returns:
+ * Pre: out holds the sum of sigs[ i ].size() values
+ * Post:
+ * Exceptions: invalidSVCsigSavgol, see svcsigsavgol
+ * Notes: Files are grouped by grid (svcSigGroupByGrid()) and the filter of
+ *    each grid is looked up once
+ */
+void svcSigSavgolBatch( const std::vector<svcsig> &sigs, float *out, const size_t &window, const size_t &order, const size_t &derivative = 0, const int &spectrum = SVCSIG_SPECTRUM_TARGET_REFLECTANCE, const unsigned int &threads = 0 );
+
+
+// --- --- Implimentation --- --- //
+
+// -- -- Constructors -- -- //
+svcsigsavgol::svcsigsavgol( const std::vector<float> &grid, const size_t &window, const size_t &order, const size_t &derivative )
+: _size( grid.size() ), _window( window ), _order( order ), _derivative( derivative )
+{
+  if ( window % 2 == 0 || window <= order ) {
+    throw invalidSVCsigSavgol( "the window must be odd and larger than the order" );
+  }
+  if ( derivative > order ) {
+    throw invalidSVCsigSavgol( "the derivative can not be larger than the order" );
+  }
+  _start.resize( _size );
+  _length.resize( _size );
+  _coefficient.assign( _window * _size, 0.0f );
+  
+  // the windows, within each segment
+  size_t half( _window / 2 );
+  size_t begin( 0 );
+  for ( size_t i = 1; i <= _size; i++ ) {
+    if ( i < _size && grid[ i ] > grid[ i - 1 ] ) {
+      continue;
+    }
+    size_t end( i );
+    size_t length( std::min( _window, end - begin ) );
+    for ( size_t j = begin; j < end; j++ ) {
+      size_t start( j < begin + half ? begin : j - half );
+      _start[ j ] = std::min( start, end - length );
+      _length[ j ] = length;
+      svcSigSavgolBand( grid, j );
+      
+      if ( length == _window && _start[ j ] + half == j ) {
+        if ( _centered.empty() || _centered.back().second != j ) {
+          _centered.push_back( std::make_pair( j, j ) );
+        }
+        _centered.back().second = j + 1;
+      }
+    }
+    begin = end;
+  }
+}
+
+// -- -- Getters -- -- //
+size_t svcsigsavgol::size() const
+{
+  return _size;
+}
+
+size_t svcsigsavgol::window() const
+{
+  return _window;
+}
+
+size_t svcsigsavgol::order() const
+{
+  return _order;
+}
+
+size_t svcsigsavgol::derivative() const
+{
+  return _derivative;
+}
+
+// -- -- Filtering -- -- //
+void svcsigsavgol::apply( const float *in, float *out ) const
+{
+  // every band, one coefficient at a time; centered runs read the input at a
+  // fixed offset, so they are one multiply-add across the bands
+  size_t half( _window / 2 );
+  std::fill( out, out + _size, 0.0f );
+  size_t next( 0 );
+  for ( size_t r = 0; r <= _centered.size(); r++ ) {
+    size_t first( r < _centered.size() ? _centered[ r ].first : _size );
+    for ( size_t j = next; j < first; j++ ) {
+      float sum( 0.0f );
+      for ( size_t i = 0; i < _length[ j ]; i++ ) {
+        sum += _coefficient[ i * _size + j ] * in[ _start[ j ] + i ];
+      }
+      out[ j ] = sum;
+    }
+    if ( r == _centered.size() ) {
+      break;
+    }
+    size_t last( _centered[ r ].second );
+    for ( size_t i = 0; i < _window; i++ ) {
+      const float *c( &_coefficient[ i * _size ] );
+      const float *x( in + i - half + first ); // x[ k ] is band first + k
+      size_t j( first );
+#if defined( __AVX512F__ )
+      for ( ; j + 16 <= last; j += 16 ) {
+        _mm512_storeu_ps( out + j, _mm512_fmadd_ps( _mm512_loadu_ps( c + j ), _mm512_loadu_ps( x + j - first ), _mm512_loadu_ps( out + j ) ) );
+      }
+#endif
+#if defined( __AVX__ )
+      for ( ; j + 8 <= last; j += 8 ) {
+        _mm256_storeu_ps( out + j, _mm256_add_ps( _mm256_loadu_ps( out + j ), _mm256_mul_ps( _mm256_loadu_ps( c + j ), _mm256_loadu_ps( x + j - first ) ) ) );
+      }
+#endif
+#if defined( __SSE2__ )
+      for ( ; j + 4 <= last; j += 4 ) {
+        _mm_storeu_ps( out + j, _mm_add_ps( _mm_loadu_ps( out + j ), _mm_mul_ps( _mm_loadu_ps( c + j ), _mm_loadu_ps( x + j - first ) ) ) );
+      }
+#endif
+      for ( ; j < last; j++ ) {
+        out[ j ] += c[ j ] * x[ j - first ];
+      }
+    }
+    next = last;
+  }
+}
+
+void svcsigsavgol::apply( const float *in, float *out, const size_t &count, const unsigned int &threads ) const
+{
+  svcSigParallelFor( count, threads, [&]( size_t s, unsigned int ) {
+    apply( in + s * _size, out + s * _size );
+  } );
+}
+
+std::vector<float> svcsigsavgol::apply( const svcsig &sig, const int &spectrum ) const
+{
+  if ( spectrum != SVCSIG_SPECTRUM_REFERENCE_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_REFLECTANCE ) {
+    throw invalidSVCsigSavgol( "unknown spectrum" );
+  }
+  if ( sig.size() != _size ) {
+    throw invalidSVCsigSavgol( "the file has " + std::to_string( sig.size() ) + " bands, not " + std::to_string( _size ) );
+  }
+  std::vector<float> out( _size );
+  if ( _size > 0 ) {
+    apply( spectrum == SVCSIG_SPECTRUM_REFERENCE_RADIANCE ? sig.referenceRadianceData() :
+      ( spectrum == SVCSIG_SPECTRUM_TARGET_RADIANCE ? sig.targetRadianceData() : sig.targetReflectanceData() ), out.data() );
+  }
+  return out;
+}
+
+// -- -- Helper Functions -- -- //
+void svcsigsavgol::svcSigSavgolBand( const std::vector<float> &grid, const size_t &j )
+{
+  size_t start( _start[ j ] );
+  size_t length( _length[ j ] );
+  size_t terms( _order + 1 );
+  if ( length < terms ) {
+    for ( size_t i = 0; i < length; i++ ) {
+      _coefficient[ i * _size + j ] = NAN;
+    }
+    return;
+  }
+  
+  // the fit is in t = ( x - x_j ) / scale, so the normal equations stay well
+  // conditioned whatever the spacing
+  double scale( 0.0 );
+  for ( size_t i = 0; i < length; i++ ) {
+    scale = std::max( scale, std::fabs( double( grid[ start + i ] ) - grid[ j ] ) );
+  }
+  if ( scale == 0.0 ) {
+    // a window of one band (window 1, or a segment of one band) has nothing
+    // to scale by: the value is itself, with no slope
+    _coefficient[ j ] = _derivative == 0 ? 1.0f : 0.0f;
+    return;
+  }
+  std::vector<double> t( length );
+  for ( size_t i = 0; i < length; i++ ) {
+    t[ i ] = ( double( grid[ start + i ] ) - grid[ j ] ) / scale;
+  }
+  
+  // solve ( A' A ) y = e_derivative, where A[ i ][ m ] = t_i^m, by Gaussian
+  // elimination with partial pivoting
+  std::vector<double> g( terms * ( terms + 1 ), 0.0 ); // augmented
+  for ( size_t i = 0; i < length; i++ ) {
+    std::vector<double> power( 2 * terms - 1, 1.0 );
+    for ( size_t m = 1; m < power.size(); m++ ) {
+      power[ m ] = power[ m - 1 ] * t[ i ];
+    }
+    for ( size_t a = 0; a < terms; a++ ) {
+      for ( size_t b = 0; b < terms; b++ ) {
+        g[ a * ( terms + 1 ) + b ] += power[ a + b ];
+      }
+    }
+  }
+  g[ _derivative * ( terms + 1 ) + terms ] = 1.0;
+  for ( size_t c = 0; c < terms; c++ ) {
+    size_t pivot( c );
+    for ( size_t r = c + 1; r < terms; r++ ) {
+      if ( std::fabs( g[ r * ( terms + 1 ) + c ] ) > std::fabs( g[ pivot * ( terms + 1 ) + c ] ) ) {
+        pivot = r;
+      }
+    }
+    for ( size_t k = 0; k <= terms; k++ ) {
+      std::swap( g[ c * ( terms + 1 ) + k ], g[ pivot * ( terms + 1 ) + k ] );
+    }
+    for ( size_t r = 0; r < terms; r++ ) {
+      if ( r == c ) {
+        continue;
+      }
+      double factor( g[ r * ( terms + 1 ) + c ] / g[ c * ( terms + 1 ) + c ] );
+      for ( size_t k = c; k <= terms; k++ ) {
+        g[ r * ( terms + 1 ) + k ] -= factor * g[ c * ( terms + 1 ) + k ];
+      }
+    }
+  }
+  
+  // coefficient i is derivative! sum_m y_m t_i^m / scale^derivative
+  double factor( 1.0 );
+  for ( size_t d = 2; d <= _derivative; d++ ) {
+    factor *= d;
+  }
+  factor /= std::pow( scale, double( _derivative ) );
+  for ( size_t i = 0; i < length; i++ ) {
+    double sum( 0.0 ), power( 1.0 );
+    for ( size_t m = 0; m < terms; m++ ) {
+      sum += g[ m * ( terms + 1 ) + terms ] / g[ m * ( terms + 1 ) + m ] * power;
+      power *= t[ i ];
+    }
+    _coefficient[ i * _size + j ] = factor * sum;
+  }
+}
+
+// -- -- Collections -- -- //
+std::shared_ptr<const svcsigsavgol> svcSigSavgol( const std::vector<float> &grid, const size_t &window, const size_t &order, const size_t &derivative )
+{
+  static std::mutex lock;
+  static std::map< std::string, std::shared_ptr<const svcsigsavgol> > cache;
+  
+  // the key is the parameters and the grid, byte for byte
+  size_t parameters[ 3 ] = { window, order, derivative };
+  std::string key( reinterpret_cast<const char *>( parameters ), sizeof( parameters ) );
+  if ( !grid.empty() ) {
+    key.append( reinterpret_cast<const char *>( grid.data() ), grid.size() * sizeof( float ) );
+  }
+  
+  {
+    std::lock_guard<std::mutex> guard( lock );
+    std::map< std::string, std::shared_ptr<const svcsigsavgol> >::const_iterator found( cache.find( key ) );
+    if ( found != cache.end() ) {
+      return found->second;
+    }
+  }
+  std::shared_ptr<const svcsigsavgol> filter( new svcsigsavgol( grid, window, order, derivative ) );
+  std::lock_guard<std::mutex> guard( lock );
+  return cache.insert( std::make_pair( key, filter ) ).first->second;
+}
+
+void svcSigSavgolBatch( const std::vector<svcsig> &sigs, float *out, const size_t &window, const size_t &order, const size_t &derivative, const int &spectrum, const unsigned int &threads )
+{
+  if ( spectrum != SVCSIG_SPECTRUM_REFERENCE_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_REFLECTANCE ) {
+    throw invalidSVCsigSavgol( "unknown spectrum" );
+  }
+  std::vector<size_t> offset( sigs.size() + 1, 0 );
+  for ( size_t i = 0; i < sigs.size(); i++ ) {
+    offset[ i + 1 ] = offset[ i ] + sigs[ i ].size();
+  }
+  std::vector< std::shared_ptr<const svcsigsavgol> > filters( sigs.size() );
+  std::map< std::vector<float>, std::vector<size_t> > groups( svcSigGroupByGrid( sigs ) );
+  for ( std::map< std::vector<float>, std::vector<size_t> >::const_iterator g = groups.begin(); g != groups.end(); ++g ) {
+    std::shared_ptr<const svcsigsavgol> filter( svcSigSavgol( g->first, window, order, derivative ) );
+    for ( size_t i = 0; i < g->second.size(); i++ ) {
+      filters[ g->second[ i ] ] = filter;
+    }
+  }
+  svcSigParallelFor( sigs.size(), threads, [&]( size_t i, unsigned int ) {
+    const svcsig &sig( sigs[ i ] );
+    if ( sig.size() == 0 ) {
+      return;
+    }
+    const float *data( spectrum == SVCSIG_SPECTRUM_REFERENCE_RADIANCE ? sig.referenceRadianceData() :
+      ( spectrum == SVCSIG_SPECTRUM_TARGET_RADIANCE ? sig.targetRadianceData() : sig.targetReflectanceData() ) );
+    filters[ i ]->apply( data, out + offset[ i ] );
+  } );
+}
+
+#endif // __svcsigsavgol_hpp_
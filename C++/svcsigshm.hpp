@@ -0,0 +1,664 @@
+/*******************************************************************************
+ * svcsigshm.hpp
+ *
+ * DESCRIPTION:
+ *    Provides header and implimentation for the svcsigshm class, a cache of
+ *    parsed sig files in a POSIX shared memory segment, so processes on one
+ *    machine parse each file once and share the result. Cached files are read
+ *    in place through svcsigshmview, without copying.
+ *
+ *    Any process may add files. Space is handed out by an atomic counter and a
+ *    file becomes visible when its slot is set with a compare and swap, so
+ *    neither readers nor writers take locks. Space is never reused; a file
+ *    that changes on disk gets a new record and the old one is left for
+ *    readers that still hold it. When the segment is full, publish() fails
+ *    and callers read the file themselves. Processes that only read can
+ *    attach() the segment, which maps it read only, so a stray write in them
+ *    faults instead of corrupting the other processes' view.
+ *
+ *    Build with -pthread (and -lrt with glibc older than 2.34).
+ *
+ * SEGMENT FORMAT:
+ *    svcsigshmheader
+ *    uint64_t slots[ slotCount ] (record offsets, 0 for empty; open
+ *        addressing on the hash of the path)
+ *    records: svcsigshmrecord, then float wavelength[ bands ],
+ *        referenceRadiance[ bands ], targetRadiance[ bands ],
+ *        targetReflectance[ bands ], then the string pool of the headers
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *    2026-10-18: Throws invalidSVCsigShm; files that do not parse are not
+ *        published
+ *    2026-10-18: Added attach(), which maps a segment read only
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *   shm_overview(7)
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsigshm_hpp_
+#define __svcsigshm_hpp_
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "svcsighelper.hpp"
+#include "svcsig.hpp"
+#include "svcsigcatalogue.hpp"
+
+#define SVCSIG_SHM_MAGIC "SVCSIGM"
+#define SVCSIG_SHM_VERSION 1
+
+// the default size of a new segment (bytes) and its number of slots
+#define SVCSIG_SHM_SIZE ( size_t( 1 ) << 30 )
+#define SVCSIG_SHM_SLOTS 65536
+
+
+// the segment header
+struct svcsigshmheader {
+  char magic[ 8 ];
+  uint32_t version;
+  std::atomic<uint32_t> ready; // set once the creator has filled the header
+  uint64_t size; // bytes in the segment
+  uint64_t slots;
+  std::atomic<uint64_t> used; // bytes handed out, from the segment start
+  std::atomic<uint64_t> count; // published records
+};
+
+// a cached file. The key is the path and the stat results it was read with
+// (entry.size, entry.mtime, device, inode).
+struct svcsigshmrecord {
+  uint64_t hash; // of the path
+  uint64_t device;
+  uint64_t inode;
+  uint64_t bands;
+  uint64_t poolSize;
+  svcsigcatalogueentry entry; // the headers, strings are offsets into the pool
+};
+
+
+/* Name: svcsigshmview
+ *
+ * Description: A read only view of a sig file in a svcsigshm segment
+ * Notes: Views stay valid while the svcsigshm they came from is open, even
+ *    if the file is replaced
+ */
+class svcsigshmview {
+private:
+  const svcsigshmrecord *_record;
+  
+  const float * svcSigShmData( const size_t &column ) const;
+  const char * svcSigShmPool() const;
+public:
+  svcsigshmview( const svcsigshmrecord *record = NULL );
+  
+  /* Name: bool valid() const
+   *
+   * Description: Returns false for the view of a file that was not found
+   */
+  bool valid() const;
+  
+  /* Name: size_t size() const
+   *
+   * Description: Returns the number of bands
+   */
+  size_t size() const;
+  
+  /* Name: spectra
+   *
+   * Description: The spectra, size() values each, read in place
+   */
+  const float * wavelength() const;
+  const float * referenceRadiance() const;
+  const float * targetRadiance() const;
+  const float * targetReflectance() const;
+  
+  /* Name: headers
+   *
+   * Description: path() is the file the record was read from; the headers
+   *    are built from the record (they are small, so they are copies)
+   */
+  std::string path() const;
+  svcsigcommonheader commonHeader() const;
+  svcsigspectraheader referenceHeader() const;
+  svcsigspectraheader targetHeader() const;
+};
+
+
+class svcsigshm {
+private:
+  std::string _name;
+  void *_map;
+  size_t _mapSize;
+  svcsigshmheader *_header;
+  std::atomic<uint64_t> *_slots;
+  bool _readOnly;
+  
+  svcsigshm( const svcsigshm &other );
+  svcsigshm& operator=( const svcsigshm &other );
+  
+  /* Name: uint64_t svcSigShmHash( const std::string &path ) const
+   *
+   * Description: 64 bit FNV-1a hash of a path
+   */
+  uint64_t svcSigShmHash( const std::string &path ) const;
+  
+  /* Name: const svcsigshmrecord * svcSigShmFind( const std::string &path, const uint64_t &hash, size_t &slot ) const
+   *
+   * Description: Finds the slot of a path
+   * Arguments: const std::string &path: the path
+   *            const uint64_t &hash: its hash
+   *            size_t &slot: the slot of the path, or the empty slot that ends
+   *                its probe sequence
+   * Modifies: slot
+   * Returns: the record, NULL if there is none
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: slot is the number of slots if the table is full
+   */
+  const svcsigshmrecord * svcSigShmFind( const std::string &path, const uint64_t &hash, size_t &slot ) const;
+  
+  /* Name: void svcSigShmMap( const std::string &name, const size_t &size, const size_t &slots, const bool &readOnly )
+   *
+   * Description: Maps a segment, creating it (if readOnly is false) if it
+   *    does not exist; see open() and attach()
+   */
+  void svcSigShmMap( const std::string &name, const size_t &size, const size_t &slots, const bool &readOnly );
+
+public:
+  /* Name: svcsigshm()
+   *
+   * Description: Constructs a closed segment
+   */
+  svcsigshm();
+  
+  /* Name: ~svcsigshm()
+   *
+   * Description: Unmaps the segment (it stays in the system)
+   */
+  ~svcsigshm();
+  
+  /* Name: svcsigshm& open( const std::string &name, const size_t &size, const size_t &slots )
+   *
+   * Description: Opens a segment, creating it if it does not exist
+   * Arguments: const std::string &name: the segment, e.g. "/svcsig"
+   *            const size_t &size: the size of a new segment (bytes)
+   *            const size_t &slots: the most files a new segment can hold
+   * Modifies: Everything
+   * Returns: *this
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigShm if the segment can not be opened, or
+   *     is not a valid segment
+   * Notes: size and slots are ignored if the segment exists. Memory is only
+   *    used as it is written.
+   */
+  svcsigshm& open( const std::string &name, const size_t &size = SVCSIG_SHM_SIZE, const size_t &slots = SVCSIG_SHM_SLOTS );
+  
+  /* Name: svcsigshm& attach( const std::string &name )
+   *
+   * Description: Opens an existing segment read only, for processes that
+   *    only find files
+   * Arguments: const std::string &name: the segment, e.g. "/svcsig"
+   * Modifies: Everything
+   * Returns: *this
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigShm if the segment does not exist, can not be
+   *     opened, or is not a valid segment
+   * Notes: The segment is mapped PROT_READ. publish() then returns false,
+   *    and read() does not add files, so it returns views only of files
+   *    that are already in the segment.
+   */
+  svcsigshm& attach( const std::string &name );
+  
+  /* Name: void close()
+   *
+   * Description: Unmaps the segment; views into it become invalid
+   */
+  void close();
+  
+  /* Name: static void remove( const std::string &name )
+   *
+   * Description: Removes a segment from the system. Processes that have it
+   *    open keep their mapping.
+   */
+  static void remove( const std::string &name );
+  
+  /* Name: bool publish( const std::string &filename, const svcsig &sig )
+   *
+   * Description: Adds a parsed file to the segment
+   * Arguments: const std::string &filename: the file sig was read from
+   *            const svcsig &sig: the parsed file
+   * Modifies: the segment
+   * Returns: bool, false if the file is missing, sig is empty (the file did
+   *     not parse), the segment is full or was attach()ed read only
+   * Pre: the segment is open
+   * Post:
+   * Exceptions:
+   * Notes: Lock free. If another process publishes the same file first, its
+   *    record is kept.
+   */
+  bool publish( const std::string &filename, const svcsig &sig );
+  
+  /* Name: svcsigshmview find( const std::string &filename ) const
+   *
+   * Description: Finds a file, if it has not changed since it was published
+   * Arguments: const std::string &filename: the file
+   * Modifies:
+   * Returns: svcsigshmview, not valid() if the file is not in the segment
+   * Pre: the segment is open
+   * Post:
+   * Exceptions:
+   * Notes: Lock free. The file is checked with stat().
+   */
+  svcsigshmview find( const std::string &filename ) const;
+  
+  /* Name: svcsigshmview read( const std::string &filename )
+   *
+   * Description: Finds a file, parsing and publishing it if it is not in the
+   *    segment
+   * Arguments: const std::string &filename: the file
+   * Modifies: the segment
+   * Returns: svcsigshmview, not valid() if the file can not be read (it is
+   *    then not published), the segment is full, or the file is not in a
+   *    segment that was attach()ed read only
+   * Pre: the segment is open
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  svcsigshmview read( const std::string &filename );
+  
+  /* Name: getters
+   *
+   * Description: size() is the number of published records, used() and
+   *    capacity() the bytes used and available in the segment
+   */
+  size_t size() const;
+  size_t used() const;
+  size_t capacity() const;
+};
+
+
+// --- --- Implimentation --- --- //
+
+// -- -- svcsigshmview -- -- //
+svcsigshmview::svcsigshmview( const svcsigshmrecord *record )
+: _record( record )
+{
+}
+
+bool svcsigshmview::valid() const
+{
+  return _record != NULL;
+}
+
+size_t svcsigshmview::size() const
+{
+  return _record->bands;
+}
+
+const float * svcsigshmview::wavelength() const
+{
+  return svcSigShmData( 0 );
+}
+
+const float * svcsigshmview::referenceRadiance() const
+{
+  return svcSigShmData( 1 );
+}
+
+const float * svcsigshmview::targetRadiance() const
+{
+  return svcSigShmData( 2 );
+}
+
+const float * svcsigshmview::targetReflectance() const
+{
+  return svcSigShmData( 3 );
+}
+
+std::string svcsigshmview::path() const
+{
+  return std::string( svcSigShmPool() + _record->entry.path );
+}
+
+svcsigcommonheader svcsigshmview::commonHeader() const
+{
+  svcsigcatalogue catalogue;
+  catalogue._records = &_record->entry;
+  catalogue._count = 1;
+  catalogue._strings = svcSigShmPool();
+  return catalogue.commonHeader( 0 );
+}
+
+svcsigspectraheader svcsigshmview::referenceHeader() const
+{
+  svcsigcatalogue catalogue;
+  catalogue._records = &_record->entry;
+  catalogue._count = 1;
+  catalogue._strings = svcSigShmPool();
+  return catalogue.referenceHeader( 0 );
+}
+
+svcsigspectraheader svcsigshmview::targetHeader() const
+{
+  svcsigcatalogue catalogue;
+  catalogue._records = &_record->entry;
+  catalogue._count = 1;
+  catalogue._strings = svcSigShmPool();
+  return catalogue.targetHeader( 0 );
+}
+
+const float * svcsigshmview::svcSigShmData( const size_t &column ) const
+{
+  const float *data( reinterpret_cast<const float *>( _record + 1 ) );
+  return data + column * _record->bands;
+}
+
+const char * svcsigshmview::svcSigShmPool() const
+{
+  return reinterpret_cast<const char *>( svcSigShmData( 4 ) );
+}
+
+// -- -- Constructors -- -- //
+svcsigshm::svcsigshm()
+: _map( NULL ), _mapSize( 0 ), _header( NULL ), _slots( NULL ), _readOnly( false )
+{
+}
+
+svcsigshm::~svcsigshm()
+{
+  close();
+}
+
+// -- -- Setup -- -- //
+svcsigshm& svcsigshm::open( const std::string &name, const size_t &size, const size_t &slots )
+{
+  svcSigShmMap( name, size, slots, false );
+  return *this;
+}
+
+svcsigshm& svcsigshm::attach( const std::string &name )
+{
+  svcSigShmMap( name, 0, 0, true );
+  return *this;
+}
+
+void svcsigshm::svcSigShmMap( const std::string &name, const size_t &size, const size_t &slots, const bool &readOnly )
+{
+  close();
+  std::atomic<uint64_t> test;
+  if ( !test.is_lock_free() ) {
+    throw invalidSVCsigShm( "shared memory needs lock free 64 bit atomics" );
+  }
+  
+  size_t headerSize( ( sizeof( svcsigshmheader ) + 7 ) / 8 * 8 );
+  bool created( !readOnly );
+  int fd( readOnly ? shm_open( name.c_str(), O_RDONLY, 0 ) : shm_open( name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644 ) );
+  if ( fd < 0 && !readOnly && errno == EEXIST ) {
+    created = false;
+    fd = shm_open( name.c_str(), O_RDWR, 0 );
+  }
+  if ( fd < 0 ) {
+    throw invalidSVCsigShm( "could not open shared memory '" + name + "'" );
+  }
+  
+  size_t mapSize( size );
+  if ( created ) {
+    if ( size < headerSize + slots * sizeof( uint64_t ) || ftruncate( fd, size ) != 0 ) {
+      ::close( fd );
+      shm_unlink( name.c_str() );
+      throw invalidSVCsigShm( "could not size shared memory '" + name + "'" );
+    }
+  }
+  else {
+    // wait (up to a second) for the creator to size the segment
+    struct stat st;
+    for ( int i = 0; fstat( fd, &st ) == 0 && size_t( st.st_size ) < headerSize && i < 1000; i++ ) {
+      usleep( 1000 );
+    }
+    mapSize = st.st_size;
+    if ( mapSize < headerSize ) {
+      ::close( fd );
+      throw invalidSVCsigShm( "'" + name + "' is not a sig cache" );
+    }
+  }
+  
+  void *map( mmap( NULL, mapSize, readOnly ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 ) );
+  ::close( fd );
+  if ( map == MAP_FAILED ) {
+    throw invalidSVCsigShm( "could not map shared memory '" + name + "'" );
+  }
+  svcsigshmheader *header( static_cast<svcsigshmheader *>( map ) );
+  
+  if ( created ) {
+    // the new segment is zero filled, so every slot is empty
+    memcpy( header->magic, SVCSIG_SHM_MAGIC, 8 );
+    header->version = SVCSIG_SHM_VERSION;
+    header->size = mapSize;
+    header->slots = slots;
+    header->used.store( headerSize + slots * sizeof( uint64_t ) );
+    header->count.store( 0 );
+    header->ready.store( 1, std::memory_order_release );
+  }
+  else {
+    for ( int i = 0; header->ready.load( std::memory_order_acquire ) == 0 && i < 1000; i++ ) {
+      usleep( 1000 );
+    }
+    if ( header->ready.load( std::memory_order_acquire ) == 0 || memcmp( header->magic, SVCSIG_SHM_MAGIC, 8 ) != 0 || header->version != SVCSIG_SHM_VERSION || header->size != mapSize ) {
+      munmap( map, mapSize );
+      throw invalidSVCsigShm( "'" + name + "' is not a compatible sig cache" );
+    }
+  }
+  
+  _name = name;
+  _map = map;
+  _mapSize = mapSize;
+  _header = header;
+  _slots = reinterpret_cast<std::atomic<uint64_t> *>( static_cast<char *>( map ) + headerSize );
+  _readOnly = readOnly;
+}
+
+void svcsigshm::close()
+{
+  if ( _map != NULL ) {
+    munmap( _map, _mapSize );
+  }
+  _map = NULL;
+  _mapSize = 0;
+  _header = NULL;
+  _slots = NULL;
+  _readOnly = false;
+}
+
+void svcsigshm::remove( const std::string &name )
+{
+  shm_unlink( name.c_str() );
+}
+
+// -- -- Publishing -- -- //
+bool svcsigshm::publish( const std::string &filename, const svcsig &sig )
+{
+  // an empty svcsig is a file that did not parse
+  struct stat st;
+  if ( _readOnly || sig.size() == 0 || stat( filename.c_str(), &st ) != 0 ) {
+    return false;
+  }
+  
+  // the headers, as a catalogue entry with its own string pool
+  svcsigcatalogue catalogue;
+  svcsigcatalogue::svcSigCatalogueIndex index;
+  std::vector<char> pool( 1, '\0' );
+  svcsigcatalogueentry entry;
+  memset( &entry, 0, sizeof( entry ) );
+  catalogue.svcSigCatalogueFill( sig, entry, pool, index );
+  entry.path = catalogue.svcSigCatalogueIntern( filename, pool, index );
+  entry.size = st.st_size;
+  entry.mtime = int64_t( st.st_mtim.tv_sec ) * 1000000000 + st.st_mtim.tv_nsec;
+  
+  // reserve the space
+  size_t bands( sig.size() );
+  size_t bytes( sizeof( svcsigshmrecord ) + 4 * bands * sizeof( float ) + pool.size() );
+  bytes = ( bytes + 7 ) / 8 * 8;
+  uint64_t offset( _header->used.fetch_add( bytes ) );
+  if ( offset + bytes > _header->size ) {
+    return false;
+  }
+  
+  // write the record
+  char *base( static_cast<char *>( _map ) + offset );
+  svcsigshmrecord *record( reinterpret_cast<svcsigshmrecord *>( base ) );
+  record->hash = svcSigShmHash( filename );
+  record->device = st.st_dev;
+  record->inode = st.st_ino;
+  record->bands = bands;
+  record->poolSize = pool.size();
+  record->entry = entry;
+  float *data( reinterpret_cast<float *>( record + 1 ) );
+  if ( bands > 0 ) {
+    memcpy( data, sig.wavelengthData(), bands * sizeof( float ) );
+    memcpy( data + bands, sig.referenceRadianceData(), bands * sizeof( float ) );
+    memcpy( data + 2 * bands, sig.targetRadianceData(), bands * sizeof( float ) );
+    memcpy( data + 3 * bands, sig.targetReflectanceData(), bands * sizeof( float ) );
+  }
+  memcpy( data + 4 * bands, &pool[ 0 ], pool.size() );
+  
+  // publish it: the release makes the record visible before the slot
+  size_t slot;
+  while ( true ) {
+    const svcsigshmrecord *current( svcSigShmFind( filename, record->hash, slot ) );
+    if ( slot == _header->slots ) {
+      return false;
+    }
+    uint64_t expected( current == NULL ? 0 : reinterpret_cast<const char *>( current ) - static_cast<char *>( _map ) );
+    if ( current != NULL && current->entry.size == entry.size && current->entry.mtime == entry.mtime && current->device == record->device && current->inode == record->inode ) {
+      return true; // someone else published it
+    }
+    if ( _slots[ slot ].compare_exchange_strong( expected, offset, std::memory_order_acq_rel ) ) {
+      if ( current == NULL ) {
+        _header->count++;
+      }
+      return true;
+    }
+    // lost a race for the slot, look again
+  }
+}
+
+// -- -- Lookup -- -- //
+svcsigshmview svcsigshm::find( const std::string &filename ) const
+{
+  struct stat st;
+  if ( stat( filename.c_str(), &st ) != 0 ) {
+    return svcsigshmview();
+  }
+  size_t slot;
+  const svcsigshmrecord *record( svcSigShmFind( filename, svcSigShmHash( filename ), slot ) );
+  if ( record == NULL || record->entry.size != st.st_size || record->entry.mtime != int64_t( st.st_mtim.tv_sec ) * 1000000000 + st.st_mtim.tv_nsec || record->device != uint64_t( st.st_dev ) || record->inode != uint64_t( st.st_ino ) ) {
+    return svcsigshmview();
+  }
+  return svcsigshmview( record );
+}
+
+svcsigshmview svcsigshm::read( const std::string &filename )
+{
+  svcsigshmview view( find( filename ) );
+  if ( !view.valid() && !_readOnly ) {
+    svcsig sig;
+    sig.read( filename );
+    if ( publish( filename, sig ) ) {
+      view = find( filename );
+    }
+  }
+  return view;
+}
+
+// -- -- Getters -- -- //
+size_t svcsigshm::size() const
+{
+  return _header->count.load();
+}
+
+size_t svcsigshm::used() const
+{
+  return std::min( uint64_t( _header->used.load() ), _header->size );
+}
+
+size_t svcsigshm::capacity() const
+{
+  return _header->size;
+}
+
+// -- -- Helper Functions -- -- //
+uint64_t svcsigshm::svcSigShmHash( const std::string &path ) const
+{
+  uint64_t hash( 14695981039346656037ULL );
+  for ( size_t i = 0; i < path.size(); i++ ) {
+    hash ^= static_cast<unsigned char>( path[ i ] );
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+const svcsigshmrecord * svcsigshm::svcSigShmFind( const std::string &path, const uint64_t &hash, size_t &slot ) const
+{
+  const char *base( static_cast<const char *>( _map ) );
+  size_t n( _header->slots );
+  slot = hash % n;
+  for ( size_t probe = 0; probe < n; probe++ ) {
+    uint64_t offset( _slots[ slot ].load( std::memory_order_acquire ) );
+    if ( offset == 0 ) {
+      return NULL;
+    }
+    const svcsigshmrecord *record( reinterpret_cast<const svcsigshmrecord *>( base + offset ) );
+    if ( record->hash == hash ) {
+      const char *pool( reinterpret_cast<const char *>( record + 1 ) + 4 * record->bands * sizeof( float ) );
+      if ( path.compare( pool + record->entry.path ) == 0 ) {
+        return record;
+      }
+    }
+    slot = ( slot + 1 ) % n;
+  }
+  slot = n;
+  return NULL;
+}
+
+#endif // __svcsigshm_hpp_
@@ -0,0 +1,795 @@
+/*******************************************************************************
+ * svcsigspatialindex.hpp
+ *
+ * DESCRIPTION:
+ *    Provides header and implimentation for the svcsigspatialindex class, a
+ *    static packed R-tree over the target positions of a collection of sig
+ *    files (or of a svcsigcatalogue). Positions are sorted along a Hilbert
+ *    curve and packed into nodes of SVCSIG_SPATIAL_NODE_SIZE, so the tree is
+ *    a few flat arrays that can be saved next to the data and loaded back.
+ *
+ *    Distances are great circle distances in meters on a spherical earth.
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *    2026-10-18: Positions come from the decoded header fields
+ *    2026-10-18: load() checks the counts against the file and the levels
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *   Kamel and Faloutsos, "Hilbert R-tree: An improved R-tree using fractals",
+ *     VLDB 1994
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsigspatialindex_hpp_
+#define __svcsigspatialindex_hpp_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <sys/stat.h>
+
+#include "svcsighelper.hpp"
+#include "svcsig.hpp"
+#include "svcsigcatalogue.hpp"
+
+#define SVCSIG_SPATIAL_MAGIC "SVCSIGS"
+#define SVCSIG_SPATIAL_VERSION 1
+#define SVCSIG_SPATIAL_NODE_SIZE 16
+
+// mean earth radius (IUGG), in meters
+#define SVCSIG_EARTH_RADIUS 6371008.8
+
+
+class svcsigspatialindex {
+private:
+  // the positions (degrees) and their ids, in Hilbert order
+  std::vector<double> _latitude;
+  std::vector<double> _longitude;
+  std::vector<uint64_t> _ids;
+  size_t _skipped; // positions with invalid quadrant data
+
+  // node bounding boxes (minLat, minLon, maxLat, maxLon), level by level from
+  // the leaves up. _levelCount[ 0 ] is the number of positions,
+  // _levelCount[ l ] the number of nodes on level l, which start at node
+  // _levelStart[ l ]. Node i of level l holds children
+  // [ i * SVCSIG_SPATIAL_NODE_SIZE, ( i + 1 ) * SVCSIG_SPATIAL_NODE_SIZE ) of
+  // level l - 1.
+  std::vector<double> _boxes;
+  std::vector<uint64_t> _levelCount;
+  std::vector<uint64_t> _levelStart;
+
+  /* Name: void svcSigSpatialBuild()
+   *
+   * Description: Sorts the positions and builds the nodes
+   * Arguments:
+   * Modifies: Everything
+   * Returns:
+   * Pre: _latitude, _longitude and _ids hold the positions
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  void svcSigSpatialBuild();
+
+  /* Name: uint64_t svcSigSpatialHilbert( uint32_t x, uint32_t y ) const
+   *
+   * Description: Position of a cell along a 2^16 x 2^16 Hilbert curve
+   * Arguments: uint32_t x, uint32_t y: the cell
+   * Modifies:
+   * Returns: uint64_t
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  uint64_t svcSigSpatialHilbert( uint32_t x, uint32_t y ) const;
+
+  /* Name: void svcSigSpatialSearch( ... ) const
+   *
+   * Description: Appends the indices (into _latitude) of all positions inside
+   *    a box that does not cross the antimeridian
+   * Arguments: const double &minLat, &minLon, &maxLat, &maxLon: the box
+   *            std::vector<size_t> &leaves: the output
+   * Modifies: leaves
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  void svcSigSpatialSearch( const double &minLat, const double &minLon, const double &maxLat, const double &maxLon, std::vector<size_t> &leaves ) const;
+
+  /* Name: double svcSigSpatialDistance( ... ) const
+   *
+   * Description: Great circle distance between two positions
+   * Arguments: latitudes and longitudes in degrees
+   * Modifies:
+   * Returns: the central angle in radians
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Multiply by SVCSIG_EARTH_RADIUS for meters
+   */
+  double svcSigSpatialDistance( const double &lat1, const double &lon1, const double &lat2, const double &lon2 ) const;
+
+  /* Name: double svcSigSpatialBoxDistance( const double &lat, const double &lon, const size_t &node ) const
+   *
+   * Description: Smallest great circle distance from a position to any point
+   *    of a node's box
+   * Arguments: const double &lat, &lon: the position (degrees)
+   *            const size_t &node: the node
+   * Modifies:
+   * Returns: the central angle in radians
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: This is exact, so it is a valid bound for the nearest search
+   */
+  double svcSigSpatialBoxDistance( const double &lat, const double &lon, const size_t &node ) const;
+
+public:
+  /* Name: svcsigspatialindex()
+   *
+   * Description: Constructs an empty index
+   * Arguments:
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  svcsigspatialindex();
+
+  /* Name: svcsigspatialindex& build( const std::vector<svcsig> &sigs )
+   *
+   * Description: Indexes the target positions of a collection
+   * Arguments: const std::vector<svcsig> &sigs: the collection
+   * Modifies: Everything
+   * Returns: *this
+   * Pre:
+   * Post: Query results are positions in sigs
+   * Exceptions:
+   * Notes: Spectra with invalid quadrant data (including no GPS fix) are
+   *    skipped and counted by skipped()
+   */
+  svcsigspatialindex& build( const std::vector<svcsig> &sigs );
+
+  /* Name: svcsigspatialindex& build( const svcsigcatalogue &catalogue )
+   *
+   * Description: Indexes the target positions of a catalogue
+   * Arguments: const svcsigcatalogue &catalogue: the catalogue
+   * Modifies: Everything
+   * Returns: *this
+   * Pre:
+   * Post: Query results are entries of catalogue
+   * Exceptions:
+   * Notes: No sig files are opened
+   */
+  svcsigspatialindex& build( const svcsigcatalogue &catalogue );
+
+  /* Name: svcsigspatialindex& build( const std::vector<double> &latitude, const std::vector<double> &longitude )
+   *
+   * Description: Indexes decimal degree positions
+   * Arguments: const std::vector<double> &latitude: the latitudes
+   *            const std::vector<double> &longitude: the longitudes
+   * Modifies: Everything
+   * Returns: *this
+   * Pre: latitude.size() == longitude.size()
+   * Post: Query results are positions in latitude
+   * Exceptions:
+   * Notes: NaN or out of range positions are skipped
+   */
+  svcsigspatialindex& build( const std::vector<double> &latitude, const std::vector<double> &longitude );
+
+  /* Name: void save( const std::string &filename ) const
+   *
+   * Description: Saves the index
+   * Arguments: const std::string &filename: the index file
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigIndex if the file cannot be written
+   * Notes:
+   */
+  void save( const std::string &filename ) const;
+
+  /* Name: svcsigspatialindex& load( const std::string &filename )
+   *
+   * Description: Loads an index saved with save()
+   * Arguments: const std::string &filename: the index file
+   * Modifies: Everything
+   * Returns: *this
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigIndex if the file cannot be read, or its counts
+   *    do not match its length or each other
+   * Notes:
+   */
+  svcsigspatialindex& load( const std::string &filename );
+
+  /* Name: size_t size() const
+   *
+   * Description: Returns the number of indexed positions
+   * Arguments:
+   * Modifies:
+   * Returns: size_t
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  size_t size() const;
+
+  /* Name: size_t skipped() const
+   *
+   * Description: Returns the number of spectra that were not indexed because
+   *    their position was invalid
+   * Arguments:
+   * Modifies:
+   * Returns: size_t
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  size_t skipped() const;
+
+  /* Name: std::vector<size_t> bbox( const double &minLat, const double &minLon, const double &maxLat, const double &maxLon ) const
+   *
+   * Description: Finds all positions inside a latitude/longitude box
+   * Arguments: const double &minLat, &minLon, &maxLat, &maxLon: the box in
+   *     decimal degrees
+   * Modifies:
+   * Returns: std::vector<size_t> of ids (unordered)
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: If minLon > maxLon the box crosses the antimeridian
+   */
+  std::vector<size_t> bbox( const double &minLat, const double &minLon, const double &maxLat, const double &maxLon ) const;
+
+  /* Name: std::vector<size_t> radius( const double &lat, const double &lon, const double &meters ) const
+   *
+   * Description: Finds all positions within a distance of a point
+   * Arguments: const double &lat, &lon: the point in decimal degrees
+   *            const double &meters: the distance
+   * Modifies:
+   * Returns: std::vector<size_t> of ids (unordered)
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  std::vector<size_t> radius( const double &lat, const double &lon, const double &meters ) const;
+
+  /* Name: std::vector<size_t> polygon( const std::vector<double> &latitude, const std::vector<double> &longitude ) const
+   *
+   * Description: Finds all positions inside a polygon
+   * Arguments: const std::vector<double> &latitude: the vertex latitudes
+   *            const std::vector<double> &longitude: the vertex longitudes
+   * Modifies:
+   * Returns: std::vector<size_t> of ids (unordered)
+   * Pre: latitude.size() == longitude.size() >= 3
+   * Post:
+   * Exceptions:
+   * Notes: The polygon is closed automatically. Edges are straight lines in
+   *    latitude/longitude, which is what field polygons are drawn in. The
+   *    polygon may not cross the antimeridian.
+   */
+  std::vector<size_t> polygon( const std::vector<double> &latitude, const std::vector<double> &longitude ) const;
+
+  /* Name: std::vector<size_t> nearest( const double &lat, const double &lon, const size_t &k, std::vector<double> &meters ) const
+   *
+   * Description: Finds the k nearest positions to a point
+   * Arguments: const double &lat, &lon: the point in decimal degrees
+   *            const size_t &k: the number of positions
+   *            std::vector<double> &meters: the output distances
+   * Modifies: meters
+   * Returns: std::vector<size_t> of ids, nearest first
+   * Pre:
+   * Post: meters has a distance for each id
+   * Exceptions:
+   * Notes:
+   */
+  std::vector<size_t> nearest( const double &lat, const double &lon, const size_t &k, std::vector<double> &meters ) const;
+  std::vector<size_t> nearest( const double &lat, const double &lon, const size_t &k ) const;
+};
+
+
+// --- --- Implimentation --- --- //
+
+// -- -- Constructors -- -- //
+svcsigspatialindex::svcsigspatialindex()
+{
+  _skipped = 0;
+}
+
+// -- -- Build -- -- //
+svcsigspatialindex& svcsigspatialindex::build( const std::vector<svcsig> &sigs )
+{
+  std::vector<double> latitude( sigs.size() );
+  std::vector<double> longitude( sigs.size() );
+  for ( size_t i = 0; i < sigs.size(); i++ ) {
+    latitude[ i ] = sigs[ i ].targetDecodedLatitude();
+    longitude[ i ] = sigs[ i ].targetDecodedLongitude();
+  }
+  return build( latitude, longitude );
+}
+
+svcsigspatialindex& svcsigspatialindex::build( const svcsigcatalogue &catalogue )
+{
+  std::vector<double> latitude( catalogue.size() );
+  std::vector<double> longitude( catalogue.size() );
+  for ( size_t i = 0; i < catalogue.size(); i++ ) {
+    latitude[ i ] = catalogue.entry( i ).target.decodedLatitude;
+    longitude[ i ] = catalogue.entry( i ).target.decodedLongitude;
+  }
+  return build( latitude, longitude );
+}
+
+svcsigspatialindex& svcsigspatialindex::build( const std::vector<double> &latitude, const std::vector<double> &longitude )
+{
+  _latitude.clear();
+  _longitude.clear();
+  _ids.clear();
+  _skipped = 0;
+  for ( size_t i = 0; i < latitude.size(); i++ ) {
+    // the comparisons are false for NaN
+    if ( latitude[ i ] >= -90.0 && latitude[ i ] <= 90.0 && longitude[ i ] >= -180.0 && longitude[ i ] <= 180.0 ) {
+      _latitude.push_back( latitude[ i ] );
+      _longitude.push_back( longitude[ i ] );
+      _ids.push_back( i );
+    }
+    else {
+      _skipped++;
+    }
+  }
+  svcSigSpatialBuild();
+  return *this;
+}
+
+void svcsigspatialindex::svcSigSpatialBuild()
+{
+  size_t n( _ids.size() );
+  size_t i, j, c;
+
+  // sort along the Hilbert curve
+  std::vector<std::pair<uint64_t, size_t> > order( n );
+  for ( i = 0; i < n; i++ ) {
+    uint32_t x( ( _longitude[ i ] + 180.0 ) / 360.0 * 65535.0 );
+    uint32_t y( ( _latitude[ i ] + 90.0 ) / 180.0 * 65535.0 );
+    order[ i ] = std::make_pair( svcSigSpatialHilbert( x, y ), i );
+  }
+  std::sort( order.begin(), order.end() );
+  std::vector<double> latitude( n ), longitude( n );
+  std::vector<uint64_t> ids( n );
+  for ( i = 0; i < n; i++ ) {
+    latitude[ i ] = _latitude[ order[ i ].second ];
+    longitude[ i ] = _longitude[ order[ i ].second ];
+    ids[ i ] = _ids[ order[ i ].second ];
+  }
+  _latitude.swap( latitude );
+  _longitude.swap( longitude );
+  _ids.swap( ids );
+
+  // pack the levels
+  _boxes.clear();
+  _levelCount.assign( 1, n );
+  _levelStart.assign( 1, 0 );
+  size_t count( n );
+  size_t nodes( 0 );
+  while ( count > 0 ) {
+    size_t level( _levelCount.size() );
+    size_t m( ( count + SVCSIG_SPATIAL_NODE_SIZE - 1 ) / SVCSIG_SPATIAL_NODE_SIZE );
+    _levelCount.push_back( m );
+    _levelStart.push_back( nodes );
+    for ( j = 0; j < m; j++ ) {
+      double box[ 4 ] = { 90.0, 180.0, -90.0, -180.0 };
+      size_t end( std::min( ( j + 1 ) * SVCSIG_SPATIAL_NODE_SIZE, count ) );
+      for ( c = j * SVCSIG_SPATIAL_NODE_SIZE; c < end; c++ ) {
+        if ( level == 1 ) {
+          box[ 0 ] = std::min( box[ 0 ], _latitude[ c ] );
+          box[ 1 ] = std::min( box[ 1 ], _longitude[ c ] );
+          box[ 2 ] = std::max( box[ 2 ], _latitude[ c ] );
+          box[ 3 ] = std::max( box[ 3 ], _longitude[ c ] );
+        }
+        else {
+          const double *child( &_boxes[ 4 * ( _levelStart[ level - 1 ] + c ) ] );
+          box[ 0 ] = std::min( box[ 0 ], child[ 0 ] );
+          box[ 1 ] = std::min( box[ 1 ], child[ 1 ] );
+          box[ 2 ] = std::max( box[ 2 ], child[ 2 ] );
+          box[ 3 ] = std::max( box[ 3 ], child[ 3 ] );
+        }
+      }
+      _boxes.insert( _boxes.end(), box, box + 4 );
+    }
+    nodes += m;
+    count = ( m > 1 ) ? m : 0;
+  }
+}
+
+// -- -- IO -- -- //
+void svcsigspatialindex::save( const std::string &filename ) const
+{
+  FILE *output( fopen( filename.c_str(), "wb" ) );
+  if ( output == NULL ) {
+    throw invalidSVCsigIndex( "could not write '" + filename + "'" );
+  }
+  char magic[ 8 ];
+  memcpy( magic, SVCSIG_SPATIAL_MAGIC, 8 );
+  uint32_t version( SVCSIG_SPATIAL_VERSION );
+  uint32_t nodeSize( SVCSIG_SPATIAL_NODE_SIZE );
+  uint64_t n( _ids.size() );
+  uint64_t skipped( _skipped );
+  uint64_t levels( _levelCount.size() );
+  uint64_t boxes( _boxes.size() );
+
+  bool good( fwrite( magic, 8, 1, output ) == 1 );
+  good = good && fwrite( &version, sizeof( version ), 1, output ) == 1;
+  good = good && fwrite( &nodeSize, sizeof( nodeSize ), 1, output ) == 1;
+  good = good && fwrite( &n, sizeof( n ), 1, output ) == 1;
+  good = good && fwrite( &skipped, sizeof( skipped ), 1, output ) == 1;
+  good = good && fwrite( &levels, sizeof( levels ), 1, output ) == 1;
+  good = good && fwrite( &boxes, sizeof( boxes ), 1, output ) == 1;
+  good = good && ( n == 0 || fwrite( _latitude.data(), sizeof( double ), n, output ) == n );
+  good = good && ( n == 0 || fwrite( _longitude.data(), sizeof( double ), n, output ) == n );
+  good = good && ( n == 0 || fwrite( _ids.data(), sizeof( uint64_t ), n, output ) == n );
+  good = good && ( levels == 0 || fwrite( _levelCount.data(), sizeof( uint64_t ), levels, output ) == levels );
+  good = good && ( levels == 0 || fwrite( _levelStart.data(), sizeof( uint64_t ), levels, output ) == levels );
+  good = good && ( boxes == 0 || fwrite( _boxes.data(), sizeof( double ), boxes, output ) == boxes );
+  good = ( fclose( output ) == 0 ) && good;
+  if ( !good ) {
+    throw invalidSVCsigIndex( "could not write '" + filename + "'" );
+  }
+}
+
+svcsigspatialindex& svcsigspatialindex::load( const std::string &filename )
+{
+  FILE *input( fopen( filename.c_str(), "rb" ) );
+  if ( input == NULL ) {
+    throw invalidSVCsigIndex( "could not read '" + filename + "'" );
+  }
+  char magic[ 8 ];
+  uint32_t version, nodeSize;
+  uint64_t n, skipped, levels, boxes;
+
+  bool good( fread( magic, 8, 1, input ) == 1 && memcmp( magic, SVCSIG_SPATIAL_MAGIC, 8 ) == 0 );
+  good = good && fread( &version, sizeof( version ), 1, input ) == 1 && version == SVCSIG_SPATIAL_VERSION;
+  good = good && fread( &nodeSize, sizeof( nodeSize ), 1, input ) == 1 && nodeSize == SVCSIG_SPATIAL_NODE_SIZE;
+  good = good && fread( &n, sizeof( n ), 1, input ) == 1;
+  good = good && fread( &skipped, sizeof( skipped ), 1, input ) == 1;
+  good = good && fread( &levels, sizeof( levels ), 1, input ) == 1 && levels >= 1;
+  good = good && fread( &boxes, sizeof( boxes ), 1, input ) == 1;
+  
+  // the arrays must fill the rest of the file exactly
+  struct stat st;
+  good = good && fstat( fileno( input ), &st ) == 0;
+  if ( good ) {
+    uint64_t header( 8 + 2 * sizeof( uint32_t ) + 4 * sizeof( uint64_t ) );
+    uint64_t words( uint64_t( st.st_size ) >= header ? ( uint64_t( st.st_size ) - header ) / 8 : 0 );
+    good = uint64_t( st.st_size ) == header + 8 * words && n <= words && levels <= words && boxes <= words
+      && 3 * n + 2 * levels + boxes == words;
+  }
+  if ( good ) {
+    _latitude.resize( n );
+    _longitude.resize( n );
+    _ids.resize( n );
+    _levelCount.resize( levels );
+    _levelStart.resize( levels );
+    _boxes.resize( boxes );
+    _skipped = skipped;
+    good = ( n == 0 || fread( _latitude.data(), sizeof( double ), n, input ) == n );
+    good = good && ( n == 0 || fread( _longitude.data(), sizeof( double ), n, input ) == n );
+    good = good && ( n == 0 || fread( _ids.data(), sizeof( uint64_t ), n, input ) == n );
+    good = good && ( levels == 0 || fread( _levelCount.data(), sizeof( uint64_t ), levels, input ) == levels );
+    good = good && ( levels == 0 || fread( _levelStart.data(), sizeof( uint64_t ), levels, input ) == levels );
+    good = good && ( boxes == 0 || fread( _boxes.data(), sizeof( double ), boxes, input ) == boxes );
+  }
+  
+  // the levels must be those svcSigSpatialBuild() packs for n positions
+  if ( good ) {
+    good = _levelCount[ 0 ] == n && _levelStart[ 0 ] == 0;
+    uint64_t count( n ), nodes( 0 );
+    for ( size_t l = 1; l < levels && good; l++ ) {
+      uint64_t m( ( count + SVCSIG_SPATIAL_NODE_SIZE - 1 ) / SVCSIG_SPATIAL_NODE_SIZE );
+      good = count > 0 && _levelCount[ l ] == m && _levelStart[ l ] == nodes;
+      nodes += m;
+      count = ( m > 1 ) ? m : 0;
+    }
+    good = good && count == 0 && boxes == 4 * nodes;
+  }
+  fclose( input );
+  if ( !good ) {
+    _latitude.clear();
+    _longitude.clear();
+    _ids.clear();
+    _boxes.clear();
+    _levelCount.assign( 1, 0 );
+    _levelStart.assign( 1, 0 );
+    throw invalidSVCsigIndex( "'" + filename + "' is not a spatial index" );
+  }
+  return *this;
+}
+
+// -- -- Getters -- -- //
+size_t svcsigspatialindex::size() const
+{
+  return _ids.size();
+}
+
+size_t svcsigspatialindex::skipped() const
+{
+  return _skipped;
+}
+
+// -- -- Queries -- -- //
+std::vector<size_t> svcsigspatialindex::bbox( const double &minLat, const double &minLon, const double &maxLat, const double &maxLon ) const
+{
+  std::vector<size_t> leaves;
+  if ( minLon <= maxLon ) {
+    svcSigSpatialSearch( minLat, minLon, maxLat, maxLon, leaves );
+  }
+  else {
+    svcSigSpatialSearch( minLat, minLon, maxLat, 180.0, leaves );
+    svcSigSpatialSearch( minLat, -180.0, maxLat, maxLon, leaves );
+  }
+  std::vector<size_t> ids( leaves.size() );
+  for ( size_t i = 0; i < leaves.size(); i++ ) {
+    ids[ i ] = _ids[ leaves[ i ] ];
+  }
+  return ids;
+}
+
+std::vector<size_t> svcsigspatialindex::radius( const double &lat, const double &lon, const double &meters ) const
+{
+  double angle( meters / SVCSIG_EARTH_RADIUS );
+  double dLat( angle * 180.0 / M_PI );
+  double minLat( lat - dLat ), maxLat( lat + dLat );
+  std::vector<size_t> leaves;
+
+  // bound the circle with a box; near the poles (or for huge circles) every
+  // longitude is in range
+  double s( ( minLat > -90.0 && maxLat < 90.0 ) ? sin( angle ) / cos( lat * M_PI / 180.0 ) : 1.0 );
+  if ( s < 1.0 ) {
+    double dLon( asin( s ) * 180.0 / M_PI );
+    double minLon( lon - dLon ), maxLon( lon + dLon );
+    if ( minLon < -180.0 ) {
+      svcSigSpatialSearch( minLat, minLon + 360.0, maxLat, 180.0, leaves );
+      minLon = -180.0;
+    }
+    if ( maxLon > 180.0 ) {
+      svcSigSpatialSearch( minLat, -180.0, maxLat, maxLon - 360.0, leaves );
+      maxLon = 180.0;
+    }
+    svcSigSpatialSearch( minLat, minLon, maxLat, maxLon, leaves );
+  }
+  else {
+    svcSigSpatialSearch( std::max( minLat, -90.0 ), -180.0, std::min( maxLat, 90.0 ), 180.0, leaves );
+  }
+
+  std::vector<size_t> ids;
+  for ( size_t i = 0; i < leaves.size(); i++ ) {
+    size_t j( leaves[ i ] );
+    if ( svcSigSpatialDistance( lat, lon, _latitude[ j ], _longitude[ j ] ) <= angle ) {
+      ids.push_back( _ids[ j ] );
+    }
+  }
+  return ids;
+}
+
+std::vector<size_t> svcsigspatialindex::polygon( const std::vector<double> &latitude, const std::vector<double> &longitude ) const
+{
+  std::vector<size_t> ids;
+  size_t n( std::min( latitude.size(), longitude.size() ) );
+  if ( n < 3 ) {
+    return ids;
+  }
+
+  double minLat( latitude[ 0 ] ), maxLat( latitude[ 0 ] );
+  double minLon( longitude[ 0 ] ), maxLon( longitude[ 0 ] );
+  for ( size_t i = 1; i < n; i++ ) {
+    minLat = std::min( minLat, latitude[ i ] );
+    maxLat = std::max( maxLat, latitude[ i ] );
+    minLon = std::min( minLon, longitude[ i ] );
+    maxLon = std::max( maxLon, longitude[ i ] );
+  }
+  std::vector<size_t> leaves;
+  svcSigSpatialSearch( minLat, minLon, maxLat, maxLon, leaves );
+
+  // ray casting (even-odd rule) along the latitude of each candidate
+  for ( size_t i = 0; i < leaves.size(); i++ ) {
+    double y( _latitude[ leaves[ i ] ] ), x( _longitude[ leaves[ i ] ] );
+    bool inside( false );
+    for ( size_t a = 0, b = n - 1; a < n; b = a++ ) {
+      if ( ( latitude[ a ] > y ) != ( latitude[ b ] > y ) &&
+           x < ( longitude[ b ] - longitude[ a ] ) * ( y - latitude[ a ] ) / ( latitude[ b ] - latitude[ a ] ) + longitude[ a ] ) {
+        inside = !inside;
+      }
+    }
+    if ( inside ) {
+      ids.push_back( _ids[ leaves[ i ] ] );
+    }
+  }
+  return ids;
+}
+
+std::vector<size_t> svcsigspatialindex::nearest( const double &lat, const double &lon, const size_t &k ) const
+{
+  std::vector<double> meters;
+  return nearest( lat, lon, k, meters );
+}
+
+std::vector<size_t> svcsigspatialindex::nearest( const double &lat, const double &lon, const size_t &k, std::vector<double> &meters ) const
+{
+  std::vector<size_t> ids;
+  meters.clear();
+  if ( k == 0 || _ids.empty() ) {
+    return ids;
+  }
+
+  // best first search: the queue holds nodes (keyed by the distance to their
+  // box) and positions (keyed by their distance), so a position popped off
+  // the queue is nearer than anything left
+  struct item {
+    double distance;
+    size_t level; // 0 for a position
+    size_t index;
+    bool operator<( const item &other ) const { return distance > other.distance; }
+  };
+  std::priority_queue<item> queue;
+  size_t top( _levelCount.size() - 1 );
+  item root = { 0.0, top, 0 };
+  queue.push( root );
+
+  while ( !queue.empty() && ids.size() < k ) {
+    item current( queue.top() );
+    queue.pop();
+    if ( current.level == 0 ) {
+      ids.push_back( _ids[ current.index ] );
+      meters.push_back( current.distance * SVCSIG_EARTH_RADIUS );
+      continue;
+    }
+    size_t begin( current.index * SVCSIG_SPATIAL_NODE_SIZE );
+    size_t end( std::min( begin + SVCSIG_SPATIAL_NODE_SIZE, size_t( _levelCount[ current.level - 1 ] ) ) );
+    for ( size_t c = begin; c < end; c++ ) {
+      item child = { 0.0, current.level - 1, c };
+      if ( child.level == 0 ) {
+        child.distance = svcSigSpatialDistance( lat, lon, _latitude[ c ], _longitude[ c ] );
+      }
+      else {
+        child.distance = svcSigSpatialBoxDistance( lat, lon, _levelStart[ child.level ] + c );
+      }
+      queue.push( child );
+    }
+  }
+  return ids;
+}
+
+// -- -- Helper Functions -- -- //
+void svcsigspatialindex::svcSigSpatialSearch( const double &minLat, const double &minLon, const double &maxLat, const double &maxLon, std::vector<size_t> &leaves ) const
+{
+  if ( _ids.empty() ) {
+    return;
+  }
+  // ( level, index ) pairs still to visit
+  std::vector<std::pair<size_t, size_t> > stack;
+  stack.push_back( std::make_pair( _levelCount.size() - 1, size_t( 0 ) ) );
+  while ( !stack.empty() ) {
+    size_t level( stack.back().first ), index( stack.back().second );
+    stack.pop_back();
+    const double *box( &_boxes[ 4 * ( _levelStart[ level ] + index ) ] );
+    if ( box[ 0 ] > maxLat || box[ 2 ] < minLat || box[ 1 ] > maxLon || box[ 3 ] < minLon ) {
+      continue;
+    }
+    size_t begin( index * SVCSIG_SPATIAL_NODE_SIZE );
+    size_t end( std::min( begin + SVCSIG_SPATIAL_NODE_SIZE, size_t( _levelCount[ level - 1 ] ) ) );
+    for ( size_t c = begin; c < end; c++ ) {
+      if ( level > 1 ) {
+        stack.push_back( std::make_pair( level - 1, c ) );
+      }
+      else if ( _latitude[ c ] >= minLat && _latitude[ c ] <= maxLat && _longitude[ c ] >= minLon && _longitude[ c ] <= maxLon ) {
+        leaves.push_back( c );
+      }
+    }
+  }
+}
+
+uint64_t svcsigspatialindex::svcSigSpatialHilbert( uint32_t x, uint32_t y ) const
+{
+  const uint32_t n( 65536 );
+  uint64_t d( 0 );
+  for ( uint32_t s = n / 2; s > 0; s /= 2 ) {
+    uint32_t rx( ( x & s ) > 0 );
+    uint32_t ry( ( y & s ) > 0 );
+    d += uint64_t( s ) * s * ( ( 3 * rx ) ^ ry );
+    // rotate the quadrant
+    if ( ry == 0 ) {
+      if ( rx == 1 ) {
+        x = n - 1 - x;
+        y = n - 1 - y;
+      }
+      std::swap( x, y );
+    }
+  }
+  return d;
+}
+
+double svcsigspatialindex::svcSigSpatialDistance( const double &lat1, const double &lon1, const double &lat2, const double &lon2 ) const
+{
+  const double d2r( M_PI / 180.0 );
+  double sinLat( sin( ( lat2 - lat1 ) * d2r / 2.0 ) );
+  double sinLon( sin( ( lon2 - lon1 ) * d2r / 2.0 ) );
+  double h( sinLat * sinLat + cos( lat1 * d2r ) * cos( lat2 * d2r ) * sinLon * sinLon );
+  return 2.0 * asin( sqrt( std::min( h, 1.0 ) ) );
+}
+
+double svcsigspatialindex::svcSigSpatialBoxDistance( const double &lat, const double &lon, const size_t &node ) const
+{
+  const double *box( &_boxes[ 4 * node ] );
+  if ( lon >= box[ 1 ] && lon <= box[ 3 ] ) {
+    // straight north or south
+    if ( lat < box[ 0 ] ) {
+      return ( box[ 0 ] - lat ) * M_PI / 180.0;
+    }
+    if ( lat > box[ 2 ] ) {
+      return ( lat - box[ 2 ] ) * M_PI / 180.0;
+    }
+    return 0.0;
+  }
+
+  // for any latitude the nearest point of the box is on the edge meridian
+  // nearest in longitude
+  double toMin( fmod( box[ 1 ] - lon + 540.0, 360.0 ) - 180.0 );
+  double toMax( fmod( box[ 3 ] - lon + 540.0, 360.0 ) - 180.0 );
+  double edge( fabs( toMin ) <= fabs( toMax ) ? box[ 1 ] : box[ 3 ] );
+  double dLon( std::min( fabs( toMin ), fabs( toMax ) ) );
+
+  // the nearest point along that meridian
+  double nearestLat;
+  if ( dLon >= 90.0 ) {
+    // the distance falls towards the pole on our side
+    nearestLat = ( lat >= 0.0 ) ? box[ 2 ] : box[ 0 ];
+  }
+  else {
+    nearestLat = atan( tan( lat * M_PI / 180.0 ) / cos( dLon * M_PI / 180.0 ) ) * 180.0 / M_PI;
+    nearestLat = std::min( std::max( nearestLat, box[ 0 ] ), box[ 2 ] );
+  }
+  return svcSigSpatialDistance( lat, lon, nearestLat, edge );
+}
+
+#endif // __svcsigspatialindex_hpp_
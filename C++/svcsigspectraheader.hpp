@@ -6,6 +6,11 @@
  *
  * HISTORY:
  *    2013-08-04: Written by Paul Romanczyk (RIT)
+ *    2026-10-18: svcsigcatalogue may rebuild headers
+ *    2026-10-18: Fixed the sign of S/W positions and invalid quadrant checks
+ *    2026-10-18: Decode the acquisition time once, when it is set
+ *    2026-10-18: Decode the position and gps time once, when they are set;
+ *                svcSigParseGpsTime() returns its result
  *
  * REFERENCES:
  *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
@@ -40,11 +45,21 @@
 #ifndef __svcsigspectraheader_hpp_
 #define __svcsigspectraheader_hpp_
 
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <string>
 #include <stdexcept>
 
+#include <stdint.h>
+
 #include "svcsighelper.hpp"
 
+// epochTime() of a header whose time could not be decoded
+#define SVCSIG_TIME_INVALID INT64_MIN
+
 class svcsig;
 
 class svcsigspectraheader {
@@ -62,9 +77,13 @@ private:
   unsigned int _error;
   std::string _units;
   std::string _time;
+  int64_t _epoch; // _time decoded by svcSigParseTime()
   std::string _longitude;
   std::string _latitude;
   std::string _gpstime;
+  double _decodedLongitude; // _longitude decoded by svcSigDecodeLatLon()
+  double _decodedLatitude; // _latitude decoded by svcSigDecodeLatLon()
+  double _decodedGpstime; // _gpstime decoded by svcSigDecodeGpsTime()
   unsigned int _memorySlot;
 protected:
   svcsigspectraheader& updateIntegration( float integration[ 3 ] );
@@ -192,6 +211,7 @@ public:
   unsigned int error() const;
   std::string units() const;
   std::string time() const;
+  int64_t epochTime() const;
   std::string longitude() const;
   float decimalLongitude() const;
   std::string latitude() const;
@@ -200,11 +220,69 @@ public:
   float decimalGpstime() const;
   unsigned int memorySlot() const;
   
+  /* Name: decoded position and gps time
+   *
+   * Description: decodedLongitude() and decodedLatitude() return the position
+   *    in degrees, decodedGpstime() the gps time in hours
+   * Returns: double, NAN if the field is missing or invalid (e.g. an unknown
+   *    quadrant)
+   * Exceptions:
+   * Notes: The fields are decoded once, when they are set. Unlike the decimal
+   *    versions, these do not throw.
+   */
+  double decodedLongitude() const;
+  double decodedLatitude() const;
+  double decodedGpstime() const;
+  
   void svcSigParseLatLon( const std::string &latlon, float &deg, float &minutes ) const;
   float svcSigParseLatLon( const std::string &latlon ) const;
   float svcSigParseGpsTime( const std::string &gpstime ) const;
   
+  /* Name: double svcSigDecodeLatLon( const std::string &latlon ) const
+   *
+   * Description: Decodes a position to degrees
+   * Arguments: const std::string &latlon: the position in dddmm.mmmmQ format,
+   *     where Q is the quadrant (N, S, E, or W)
+   * Modifies:
+   * Returns: double, negative for S and W, or NAN if latlon can not be decoded
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Does not allocate or throw
+   */
+  double svcSigDecodeLatLon( const std::string &latlon ) const;
+  
+  /* Name: double svcSigDecodeGpsTime( const std::string &gpstime ) const
+   *
+   * Description: Decodes a gps time to hours
+   * Arguments: const std::string &gpstime: the time in hhmmss.sss format
+   * Modifies:
+   * Returns: double, or NAN if gpstime can not be decoded
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Does not allocate or throw
+   */
+  double svcSigDecodeGpsTime( const std::string &gpstime ) const;
+  
+  /* Name: int64_t svcSigParseTime( const std::string &time ) const
+   *
+   * Description: Decodes an acquisition time to seconds since
+   *    1970-01-01 00:00:00
+   * Arguments: const std::string &time: the time in "m/d/yyyy h:mm:ss AM"
+   *     format (or 24 hour time without AM/PM)
+   * Modifies:
+   * Returns: int64_t, or SVCSIG_TIME_INVALID if time can not be decoded
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: The instrument clock has no time zone, so neither does the result;
+   *    it orders and differences times, and is UTC if the clock was
+   */
+  int64_t svcSigParseTime( const std::string &time ) const;
+  
   friend class svcsig;
+  friend class svcsigcatalogue;
 };
 
 // --- --- Implimentation --- --- //
@@ -230,9 +308,13 @@ svcsigspectraheader::svcsigspectraheader()
   _error = 0;
   _units = "";
   _time = "";
+  _epoch = SVCSIG_TIME_INVALID;
   _longitude = "";
   _latitude = "";
   _gpstime = "";
+  _decodedLongitude = NAN;
+  _decodedLatitude = NAN;
+  _decodedGpstime = NAN;
   _memorySlot = 0;
 }
 
@@ -256,9 +338,13 @@ svcsigspectraheader::svcsigspectraheader( const svcsigspectraheader &other )
   _error = other._error;
   _units = other._units;
   _time = other._time;
+  _epoch = other._epoch;
   _longitude = other._longitude;
   _latitude = other._latitude;
   _gpstime = other._gpstime;
+  _decodedLongitude = other._decodedLongitude;
+  _decodedLatitude = other._decodedLatitude;
+  _decodedGpstime = other._decodedGpstime;
   _memorySlot = other._memorySlot;
 }
 
@@ -533,7 +619,7 @@ float svcsigspectraheader::battery() const
 
 unsigned int svcsigspectraheader::error() const
 {
-  return _battery;
+  return _error;
 }
 
 std::string svcsigspectraheader::units() const
@@ -546,6 +632,11 @@ std::string svcsigspectraheader::time() const
   return _time;
 }
 
+int64_t svcsigspectraheader::epochTime() const
+{
+  return _epoch;
+}
+
 std::string svcsigspectraheader::longitude() const
 {
   return _longitude;
@@ -553,11 +644,10 @@ std::string svcsigspectraheader::longitude() const
 
 float svcsigspectraheader::decimalLongitude() const
 {
-  try {
-    return svcSigParseLatLon( _longitude );
-  } catch ( invalidSVCsigLatLonQuad &e ) {
-    throw; 
+  if ( std::isnan( _decodedLongitude ) ) {
+    throw invalidSVCsigLatLonQuad( _longitude );
   }
+  return _decodedLongitude;
 }
 
 std::string svcsigspectraheader::latitude() const
@@ -567,11 +657,10 @@ std::string svcsigspectraheader::latitude() const
 
 float svcsigspectraheader::decimalLatitude() const
 {
-  try {
-    return svcSigParseLatLon( _latitude );
-  } catch ( invalidSVCsigLatLonQuad &e ) {
-    throw;
+  if ( std::isnan( _decodedLatitude ) ) {
+    throw invalidSVCsigLatLonQuad( _latitude );
   }
+  return _decodedLatitude;
 }
 
 std::string svcsigspectraheader::gpstime() const
@@ -581,7 +670,7 @@ std::string svcsigspectraheader::gpstime() const
 
 float svcsigspectraheader::decimalGpstime() const
 {
-  return svcSigParseGpsTime( _gpstime );
+  return _decodedGpstime;
 }
 
 unsigned int svcsigspectraheader::memorySlot() const
@@ -589,6 +678,21 @@ unsigned int svcsigspectraheader::memorySlot() const
   return _memorySlot;
 }
 
+double svcsigspectraheader::decodedLongitude() const
+{
+  return _decodedLongitude;
+}
+
+double svcsigspectraheader::decodedLatitude() const
+{
+  return _decodedLatitude;
+}
+
+double svcsigspectraheader::decodedGpstime() const
+{
+  return _decodedGpstime;
+}
+
 // -- -- Updaters -- -- //
 svcsigspectraheader& svcsigspectraheader::updateIntegration( float integration[ 3 ] )
 {
@@ -825,24 +929,28 @@ svcsigspectraheader& svcsigspectraheader::updateUnits( const std::string &units
 svcsigspectraheader& svcsigspectraheader::updateTime( const std::string &time )
 {
   _time = time;
+  _epoch = svcSigParseTime( time );
   return *this;
 }
 
 svcsigspectraheader& svcsigspectraheader::updateLongitude( const std::string &longitude )
 {
   _longitude = longitude;
+  _decodedLongitude = svcSigDecodeLatLon( longitude );
   return *this;
 }
 
 svcsigspectraheader& svcsigspectraheader::updateLatitude( const std::string &latitude )
 {
   _latitude = latitude;
+  _decodedLatitude = svcSigDecodeLatLon( latitude );
   return *this;
 }
 
 svcsigspectraheader& svcsigspectraheader::updateGpsTime( const std::string &gpstime )
 {
   _gpstime = gpstime;
+  _decodedGpstime = svcSigDecodeGpsTime( gpstime );
   return *this;
 }
 
@@ -856,16 +964,21 @@ svcsigspectraheader& svcsigspectraheader::updateMemorySlot( const unsigned int &
 void svcsigspectraheader::svcSigParseLatLon( const std::string &latlon, float &deg, float &minutes ) const
 {
   try {
+    // latlon is dddmm.mmmmQ, where Q is the quadrant (N, S, E, or W)
     std::size_t loc( latlon.find( "." ) );
+    if ( latlon.size() < 2 || loc == std::string::npos || loc < 2 ) {
+      throw invalidSVCsigLatLonQuad( latlon );
+    }
     deg = atof( latlon.substr( 0, loc - 2 ).c_str() );
-    if ( latlon.substr( latlon.size() - 1, 1 ).compare( "E" ) || latlon.substr( latlon.size() - 1, 1 ).compare( "N" ) ) {
+    std::string quadrant( latlon.substr( latlon.size() - 1, 1 ) );
+    if ( quadrant.compare( "E" ) == 0 || quadrant.compare( "N" ) == 0 ) {
       // nothing to do, deg is positive
     }
-    else if ( latlon.substr( latlon.size() - 1, 1 ).compare( "W" ) || latlon.substr( latlon.size() - 1, 1 ).compare( "S" ) ) {
+    else if ( quadrant.compare( "W" ) == 0 || quadrant.compare( "S" ) == 0 ) {
       deg *= -1.0;
     }
     else {
-      throw invalidSVCsigLatLonQuad( ( latlon.substr( latlon.size() - 1, 1 ) ) );
+      throw invalidSVCsigLatLonQuad( quadrant );
     }
     minutes = atof( latlon.substr( loc - 2, latlon.size() - loc + 2 ).c_str() );
   } catch ( invalidSVCsigLatLonQuad &e ) {
@@ -878,12 +991,13 @@ float svcsigspectraheader::svcSigParseLatLon( const std::string &latlon ) const
   try {
     float deg, minutes;
     svcSigParseLatLon( latlon, deg, minutes );
-    if ( deg >= 0.0 ) {
-      deg += ( minutes / 60.0 );
+    // deg may be -0 (e.g. 0030.0000W), so use the quadrant for the sign
+    char quadrant( latlon[ latlon.size() - 1 ] );
+    if ( quadrant == 'W' || quadrant == 'S' ) {
+      deg -= ( minutes / 60.0 );
     }
     else {
-      // I need to check that this logic is correct!
-      deg -= ( minutes / 60.0 );
+      deg += ( minutes / 60.0 );
     }
     return deg;
   } catch ( invalidSVCsigLatLonQuad &e ) {
@@ -899,6 +1013,113 @@ float svcsigspectraheader::svcSigParseGpsTime( const std::string &gpstime ) cons
   
   minutes += ( seconds / 60.0 );
   hour += ( minutes / 60.0 );
+  return hour;
+}
+
+double svcsigspectraheader::svcSigDecodeLatLon( const std::string &latlon ) const
+{
+  // latlon is dddmm.mmmmQ, where Q is the quadrant (N, S, E, or W)
+  const char *s( latlon.c_str() );
+  size_t n( latlon.size() );
+  while ( n > 0 && isspace( static_cast<unsigned char>( s[ n - 1 ] ) ) ) {
+    n--;
+  }
+  if ( n < 2 ) {
+    return NAN;
+  }
+  double sign;
+  switch ( s[ n - 1 ] ) {
+    case 'N':
+    case 'E':
+      sign = 1.0;
+      break;
+    case 'S':
+    case 'W':
+      sign = -1.0;
+      break;
+    default:
+      return NAN;
+  }
   
+  const char *dot( static_cast<const char *>( memchr( s, '.', n ) ) );
+  if ( dot == NULL || dot - s < 2 ) {
+    return NAN;
+  }
+  
+  // the degrees are the digits before the two minute digits
+  const char *c( s );
+  while ( isspace( static_cast<unsigned char>( *c ) ) ) {
+    c++;
+  }
+  double degrees( 0.0 );
+  for ( ; c < dot - 2; c++ ) {
+    if ( *c < '0' || *c > '9' ) {
+      return NAN;
+    }
+    degrees = degrees * 10.0 + ( *c - '0' );
+  }
+  char *end;
+  double minutes( strtod( dot - 2, &end ) );
+  if ( end == dot - 2 || minutes < 0.0 ) {
+    return NAN;
+  }
+  return sign * ( degrees + minutes / 60.0 );
+}
+
+double svcsigspectraheader::svcSigDecodeGpsTime( const std::string &gpstime ) const
+{
+  // gpstime is hhmmss.sss
+  const char *s( gpstime.c_str() );
+  while ( isspace( static_cast<unsigned char>( *s ) ) ) {
+    s++;
+  }
+  for ( int i = 0; i < 4; i++ ) {
+    if ( s[ i ] < '0' || s[ i ] > '9' ) {
+      return NAN;
+    }
+  }
+  char *end;
+  double seconds( strtod( s + 4, &end ) );
+  if ( end == s + 4 || seconds < 0.0 ) {
+    return NAN;
+  }
+  double hours( ( s[ 0 ] - '0' ) * 10 + ( s[ 1 ] - '0' ) );
+  double minutes( ( s[ 2 ] - '0' ) * 10 + ( s[ 3 ] - '0' ) );
+  return hours + minutes / 60.0 + seconds / 3600.0;
+}
+
+int64_t svcsigspectraheader::svcSigParseTime( const std::string &time ) const
+{
+  int month, day, year, hour, minute, second;
+  char meridiem[ 3 ] = "";
+  int n( sscanf( time.c_str(), " %d/%d/%d %d:%d:%d %2s", &month, &day, &year, &hour, &minute, &second, meridiem ) );
+  if ( n < 6 || month < 1 || month > 12 || day < 1 || day > 31 || hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 60 ) {
+    return SVCSIG_TIME_INVALID;
+  }
+  if ( n == 7 ) {
+    if ( hour < 1 || hour > 12 ) {
+      return SVCSIG_TIME_INVALID;
+    }
+    if ( meridiem[ 0 ] == 'P' || meridiem[ 0 ] == 'p' ) {
+      hour = ( hour % 12 ) + 12;
+    }
+    else if ( meridiem[ 0 ] == 'A' || meridiem[ 0 ] == 'a' ) {
+      hour = hour % 12;
+    }
+    else {
+      return SVCSIG_TIME_INVALID;
+    }
+  }
+
+  // days since 1970-01-01 in the proleptic Gregorian calendar
+  // (H. Hinnant, "chrono-Compatible Low-Level Date Algorithms")
+  int64_t y( year - ( month <= 2 ) );
+  int64_t era( ( y >= 0 ? y : y - 399 ) / 400 );
+  int64_t yoe( y - era * 400 );
+  int64_t doy( ( 153 * ( month + ( month > 2 ? -3 : 9 ) ) + 2 ) / 5 + day - 1 );
+  int64_t doe( yoe * 365 + yoe / 4 - yoe / 100 + doy );
+  int64_t days( era * 146097 + doe - 719468 );
+
+  return days * 86400 + hour * 3600 + minute * 60 + second;
 }
 #endif // __svcsigspectraheader_h_
\ No newline at end of file
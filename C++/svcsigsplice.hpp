@@ -0,0 +1,472 @@
+/*******************************************************************************
+ * svcsigsplice.hpp
+ *
+ * DESCRIPTION:
+ *    Provides header and implimentation for the svcsigsplicer class, which
+ *    joins the detector segments of a sig file into one spectrum with
+ *    ascending wavelengths.
+ *
+ *    SVC instruments join three detectors (Si, InGaAs1 and InGaAs2; two on
+ *    some models) whose ranges overlap, and a sig file lists the bands of
+ *    each detector in turn, so wavelengths go back at each join. The splicer
+ *    finds the segments once per grid, cuts each overlap at a wavelength, and
+ *    optionally removes the step at each join by offsetting or scaling the
+ *    other detectors to match a reference detector. Applying it is one
+ *    scaled copy per segment.
+ *
+ *    Build with -pthread.
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *    2026-10-18: The corrections reuse one buffer per worker thread
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsigsplice_hpp_
+#define __svcsigsplice_hpp_
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "svcsighelper.hpp"
+#include "svcsig.hpp"
+#include "svcsigbatch.hpp"
+#include "svcsigresample.hpp"
+
+// where each overlap is cut
+#define SVCSIG_SPLICE_CUT_MIDPOINT 0 // the middle of the overlap
+#define SVCSIG_SPLICE_CUT_LOWER 1 // keep the lower detector through the overlap
+#define SVCSIG_SPLICE_CUT_UPPER 2 // keep the upper detector through the overlap
+#define SVCSIG_SPLICE_CUT_WAVELENGTH 3 // at svcsigspliceoptions::cuts
+
+// how the step at each join is removed
+#define SVCSIG_SPLICE_CORRECT_NONE 0
+#define SVCSIG_SPLICE_CORRECT_OFFSET 1 // add a constant to each other detector
+#define SVCSIG_SPLICE_CORRECT_SCALE 2 // multiply each other detector
+
+
+// the options of a svcsigsplicer
+struct svcsigspliceoptions {
+  int cut; // SVCSIG_SPLICE_CUT_*
+  std::vector<double> cuts; // nm, one per join, for SVCSIG_SPLICE_CUT_WAVELENGTH
+  int correct; // SVCSIG_SPLICE_CORRECT_*
+  size_t reference; // the detector the others are matched to (0 is Si)
+  
+  svcsigspliceoptions()
+  : cut( SVCSIG_SPLICE_CUT_MIDPOINT ), correct( SVCSIG_SPLICE_CORRECT_NONE ), reference( 0 )
+  {}
+};
+
+// a detector segment of a wavelength grid: bands [begin, end) of the file,
+// of which [first, last) are kept in the spliced spectrum
+struct svcsigsegment {
+  std::string name;
+  size_t begin;
+  size_t end;
+  size_t first;
+  size_t last;
+};
+
+
+class svcsigsplicer {
+private:
+  svcsigspliceoptions _options;
+  size_t _sourceSize;
+  std::vector<svcsigsegment> _segments;
+  std::vector<float> _wavelength; // of the spliced spectrum
+  std::vector<double> _cuts; // one per join
+  
+  // the value of the segments on either side of each join at its cut, as
+  // two bands and two weights each (lower, then upper)
+  std::vector<size_t> _joinBand;
+  std::vector<double> _joinWeight;
+  
+  /* Name: void svcSigSpliceAt( const std::vector<float> &grid, const svcsigsegment &segment, const double &wavelength, size_t *band, double *weight ) const
+   *
+   * Description: Finds two bands of a segment, and their weights, that
+   *    interpolate (or extrapolate) it at a wavelength
+   */
+  void svcSigSpliceAt( const std::vector<float> &grid, const svcsigsegment &segment, const double &wavelength, size_t *band, double *weight ) const;
+  
+  /* Name: void svcSigSpliceCorrection( const float *in, double *a, double *b, double *lower, double *upper ) const
+   *
+   * Description: The correction of each segment of a spectrum, as
+   *    a[ k ] * value + b[ k ]; lower and upper hold the values at each join
+   *    (one fewer than the segments)
+   */
+  void svcSigSpliceCorrection( const float *in, double *a, double *b, double *lower, double *upper ) const;
+
+public:
+  /* Name: svcsigsplicer( const std::vector<float> &grid, const svcsigspliceoptions &options )
+   *
+   * Description: Finds the detector segments of a grid and where to join them
+   * Arguments: const std::vector<float> &grid: the wavelengths of a sig file
+   *                (svcsig::wavelength())
+   *            const svcsigspliceoptions &options: the options
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigSplice if the options do not fit the grid
+   * Notes: A segment ends wherever the wavelength does not increase. Segments
+   *    are named Si, InGaAs1 and InGaAs2 (Si and InGaAs for two).
+   */
+  svcsigsplicer( const std::vector<float> &grid, const svcsigspliceoptions &options = svcsigspliceoptions() );
+  
+  /* Name: getters
+   *
+   * Description: sourceSize() is the number of bands of the grid, size() and
+   *    wavelength() the bands of the spliced spectrum, segments() the
+   *    detector segments and cuts() where each join was cut (nm)
+   */
+  size_t sourceSize() const;
+  size_t size() const;
+  const std::vector<float> & wavelength() const;
+  const std::vector<svcsigsegment> & segments() const;
+  const std::vector<double> & cuts() const;
+  
+  /* Name: const float * segment( const float *in, const size_t &k, size_t &size ) const
+   *
+   * Description: Returns the bands of detector segment k of a spectrum, in
+   *    place
+   * Arguments: const float *in: a spectrum on the grid
+   *            const size_t &k: the segment
+   *            size_t &size: the number of bands of the segment
+   * Modifies: size
+   * Returns: const float *, into in
+   */
+  const float * segment( const float *in, const size_t &k, size_t &size ) const;
+  
+  /* Name: void apply( const float *in, float *out, const size_t &count, const unsigned int &threads ) const
+   *
+   * Description: Splices spectra
+   * Arguments: const float *in: count spectra of sourceSize() values, one
+   *                after another
+   *            float *out: count spectra of size() values
+   *            const size_t &count: the number of spectra
+   *            const unsigned int &threads: the number of threads (0 for one
+   *                per core)
+   * Modifies: out
+   */
+  void apply( const float *in, float *out, const size_t &count = 1, const unsigned int &threads = 1 ) const;
+  
+  /* Name: std::vector<float> apply( const svcsig &sig, const int &spectrum ) const
+   *
+   * Description: Splices a spectrum of a sig file on this grid
+   * Arguments: const svcsig &sig: the sig file
+   *            const int &spectrum: SVCSIG_SPECTRUM_REFERENCE_RADIANCE,
+   *                SVCSIG_SPECTRUM_TARGET_RADIANCE or
+   *                SVCSIG_SPECTRUM_TARGET_REFLECTANCE
+   * Returns: std::vector<float>, size() values
+   * Exceptions: invalidSVCsigSplice if the file is not on this grid
+   */
+  std::vector<float> apply( const svcsig &sig, const int &spectrum = SVCSIG_SPECTRUM_TARGET_REFLECTANCE ) const;
+};
+
+
+/* Name: std::shared_ptr<const svcsigsplicer> svcSigSplicer( const std::vector<float> &grid, const svcsigspliceoptions &options )
+ *
+ * Description: Returns the splicer for a grid and options, building it the
+ *    first time they are seen
+ * Notes: Thread safe. Splicers are kept for the life of the process.
+ */
+std::shared_ptr<const svcsigsplicer> svcSigSplicer( const std::vector<float> &grid, const svcsigspliceoptions &options = svcsigspliceoptions() );
+
+
+// --- --- Implimentation --- --- //
+
+// -- -- Constructors -- -- //
+svcsigsplicer::svcsigsplicer( const std::vector<float> &grid, const svcsigspliceoptions &options )
+: _options( options ), _sourceSize( grid.size() )
+{
+  // the segments
+  size_t begin( 0 );
+  for ( size_t i = 1; i <= grid.size(); i++ ) {
+    if ( i == grid.size() || !( grid[ i ] > grid[ i - 1 ] ) ) {
+      svcsigsegment segment;
+      segment.begin = begin;
+      segment.end = i;
+      segment.first = begin;
+      segment.last = i;
+      _segments.push_back( segment );
+      begin = i;
+    }
+  }
+  const char *three[] = { "Si", "InGaAs1", "InGaAs2" };
+  const char *two[] = { "Si", "InGaAs" };
+  for ( size_t k = 0; k < _segments.size(); k++ ) {
+    if ( _segments.size() == 3 ) {
+      _segments[ k ].name = three[ k ];
+    }
+    else if ( _segments.size() == 2 ) {
+      _segments[ k ].name = two[ k ];
+    }
+    else {
+      _segments[ k ].name = "segment" + std::to_string( k + 1 );
+    }
+  }
+  size_t joins( _segments.empty() ? 0 : _segments.size() - 1 );
+  if ( options.cut == SVCSIG_SPLICE_CUT_WAVELENGTH && options.cuts.size() != joins ) {
+    throw invalidSVCsigSplice( "the grid needs a cut for each of its " + std::to_string( joins ) + " joins" );
+  }
+  if ( options.cut < SVCSIG_SPLICE_CUT_MIDPOINT || options.cut > SVCSIG_SPLICE_CUT_WAVELENGTH || options.correct < SVCSIG_SPLICE_CORRECT_NONE || options.correct > SVCSIG_SPLICE_CORRECT_SCALE ) {
+    throw invalidSVCsigSplice( "unknown option" );
+  }
+  if ( options.correct != SVCSIG_SPLICE_CORRECT_NONE && options.reference >= std::max( _segments.size(), size_t( 1 ) ) ) {
+    throw invalidSVCsigSplice( "the reference detector is not in the grid" );
+  }
+  
+  // the cuts: the lower segment keeps wavelengths <= cut, the upper > cut
+  for ( size_t j = 0; j < joins; j++ ) {
+    svcsigsegment &lower( _segments[ j ] );
+    svcsigsegment &upper( _segments[ j + 1 ] );
+    double lowerEnd( grid[ lower.end - 1 ] );
+    double upperStart( grid[ upper.begin ] );
+    double cut;
+    switch ( options.cut ) {
+      case SVCSIG_SPLICE_CUT_LOWER:
+        cut = lowerEnd;
+        break;
+      case SVCSIG_SPLICE_CUT_UPPER:
+        cut = std::nextafter( upperStart, -HUGE_VAL );
+        break;
+      case SVCSIG_SPLICE_CUT_WAVELENGTH:
+        cut = options.cuts[ j ];
+        break;
+      default:
+        cut = 0.5 * ( lowerEnd + upperStart );
+    }
+    _cuts.push_back( cut );
+    while ( lower.last > lower.first && grid[ lower.last - 1 ] > cut ) {
+      lower.last--;
+    }
+    while ( upper.first < upper.last && grid[ upper.first ] <= cut ) {
+      upper.first++;
+    }
+    
+    size_t band[ 2 ];
+    double weight[ 2 ];
+    svcSigSpliceAt( grid, lower, cut, band, weight );
+    _joinBand.insert( _joinBand.end(), band, band + 2 );
+    _joinWeight.insert( _joinWeight.end(), weight, weight + 2 );
+    svcSigSpliceAt( grid, upper, cut, band, weight );
+    _joinBand.insert( _joinBand.end(), band, band + 2 );
+    _joinWeight.insert( _joinWeight.end(), weight, weight + 2 );
+  }
+  
+  // the spliced grid; cuts that cross (e.g. a middle detector cut away
+  // entirely) leave the later segment to start after the earlier one ends
+  for ( size_t k = 0; k < _segments.size(); k++ ) {
+    svcsigsegment &segment( _segments[ k ] );
+    while ( segment.first < segment.last && !_wavelength.empty() && !( grid[ segment.first ] > _wavelength.back() ) ) {
+      segment.first++;
+    }
+    for ( size_t i = segment.first; i < segment.last; i++ ) {
+      _wavelength.push_back( grid[ i ] );
+    }
+  }
+}
+
+// -- -- Getters -- -- //
+size_t svcsigsplicer::sourceSize() const
+{
+  return _sourceSize;
+}
+
+size_t svcsigsplicer::size() const
+{
+  return _wavelength.size();
+}
+
+const std::vector<float> & svcsigsplicer::wavelength() const
+{
+  return _wavelength;
+}
+
+const std::vector<svcsigsegment> & svcsigsplicer::segments() const
+{
+  return _segments;
+}
+
+const std::vector<double> & svcsigsplicer::cuts() const
+{
+  return _cuts;
+}
+
+const float * svcsigsplicer::segment( const float *in, const size_t &k, size_t &size ) const
+{
+  const svcsigsegment &segment( _segments.at( k ) );
+  size = segment.end - segment.begin;
+  return in + segment.begin;
+}
+
+// -- -- Splicing -- -- //
+void svcsigsplicer::apply( const float *in, float *out, const size_t &count, const unsigned int &threads ) const
+{
+  size_t n( _wavelength.size() );
+  size_t segments( _segments.size() );
+  
+  // a, b, lower and upper for each worker, allocated once
+  std::vector< std::vector<double> > scratch( svcSigThreads( threads ), std::vector<double>( 4 * segments ) );
+  svcSigParallelFor( count, threads, [&]( size_t s, unsigned int thread ) {
+    const float *x( in + s * _sourceSize );
+    float *y( out + s * n );
+    double *a( scratch[ thread ].data() );
+    double *b( a + segments );
+    std::fill( a, a + segments, 1.0 );
+    std::fill( b, b + segments, 0.0 );
+    svcSigSpliceCorrection( x, a, b, b + segments, b + 2 * segments );
+    for ( size_t k = 0; k < _segments.size(); k++ ) {
+      const svcsigsegment &segment( _segments[ k ] );
+      const float scale( a[ k ] );
+      const float offset( b[ k ] );
+      const float *from( x + segment.first );
+      size_t length( segment.last - segment.first );
+      for ( size_t i = 0; i < length; i++ ) {
+        y[ i ] = scale * from[ i ] + offset;
+      }
+      y += length;
+    }
+  } );
+}
+
+std::vector<float> svcsigsplicer::apply( const svcsig &sig, const int &spectrum ) const
+{
+  if ( sig.size() != _sourceSize ) {
+    throw invalidSVCsigSplice( "the file is not on the splicer's grid" );
+  }
+  std::vector<float> out( _wavelength.size() );
+  if ( _sourceSize == 0 ) {
+    return out;
+  }
+  const float *data( spectrum == SVCSIG_SPECTRUM_REFERENCE_RADIANCE ? sig.referenceRadianceData() :
+    ( spectrum == SVCSIG_SPECTRUM_TARGET_RADIANCE ? sig.targetRadianceData() : sig.targetReflectanceData() ) );
+  apply( data, out.data(), 1, 1 );
+  return out;
+}
+
+// -- -- Helper Functions -- -- //
+void svcsigsplicer::svcSigSpliceAt( const std::vector<float> &grid, const svcsigsegment &segment, const double &wavelength, size_t *band, double *weight ) const
+{
+  size_t n( segment.end - segment.begin );
+  if ( n < 2 ) {
+    band[ 0 ] = band[ 1 ] = segment.begin;
+    weight[ 0 ] = 1.0;
+    weight[ 1 ] = 0.0;
+    return;
+  }
+  // the interval holding wavelength, or the end interval to extrapolate from
+  const float *first( &grid[ segment.begin ] );
+  size_t i( std::upper_bound( first, first + n, float( wavelength ) ) - first );
+  i = std::min( std::max( i, size_t( 1 ) ), n - 1 );
+  double x0( first[ i - 1 ] ), x1( first[ i ] );
+  double s( ( wavelength - x0 ) / ( x1 - x0 ) );
+  band[ 0 ] = segment.begin + i - 1;
+  band[ 1 ] = segment.begin + i;
+  weight[ 0 ] = 1.0 - s;
+  weight[ 1 ] = s;
+}
+
+void svcsigsplicer::svcSigSpliceCorrection( const float *in, double *a, double *b, double *lower, double *upper ) const
+{
+  if ( _options.correct == SVCSIG_SPLICE_CORRECT_NONE || _segments.size() < 2 ) {
+    return;
+  }
+  
+  // the lower and upper values at each join
+  size_t joins( _segments.size() - 1 );
+  for ( size_t j = 0; j < joins; j++ ) {
+    const size_t *band( &_joinBand[ 4 * j ] );
+    const double *weight( &_joinWeight[ 4 * j ] );
+    lower[ j ] = weight[ 0 ] * in[ band[ 0 ] ] + weight[ 1 ] * in[ band[ 1 ] ];
+    upper[ j ] = weight[ 2 ] * in[ band[ 2 ] ] + weight[ 3 ] * in[ band[ 3 ] ];
+  }
+  
+  // chain out from the reference; a ratio with a zero (or NaN) is left alone
+  bool scale( _options.correct == SVCSIG_SPLICE_CORRECT_SCALE );
+  for ( size_t k = _options.reference + 1; k < _segments.size(); k++ ) {
+    double l( lower[ k - 1 ] ), u( upper[ k - 1 ] );
+    if ( scale ) {
+      a[ k ] = a[ k - 1 ] * ( u != 0.0 && l != 0.0 && !std::isnan( l / u ) ? l / u : 1.0 );
+    }
+    else {
+      b[ k ] = b[ k - 1 ] + ( std::isnan( l - u ) ? 0.0 : l - u );
+    }
+  }
+  for ( size_t k = _options.reference; k > 0; k-- ) {
+    double l( lower[ k - 1 ] ), u( upper[ k - 1 ] );
+    if ( scale ) {
+      a[ k - 1 ] = a[ k ] * ( u != 0.0 && l != 0.0 && !std::isnan( u / l ) ? u / l : 1.0 );
+    }
+    else {
+      b[ k - 1 ] = b[ k ] + ( std::isnan( u - l ) ? 0.0 : u - l );
+    }
+  }
+}
+
+// -- -- The Cache -- -- //
+std::shared_ptr<const svcsigsplicer> svcSigSplicer( const std::vector<float> &grid, const svcsigspliceoptions &options )
+{
+  static std::mutex lock;
+  static std::map< std::string, std::shared_ptr<const svcsigsplicer> > cache;
+  
+  // the key is the options and the grid, byte for byte
+  int settings[ 2 ] = { options.cut, options.correct };
+  std::string key( reinterpret_cast<const char *>( settings ), sizeof( settings ) );
+  key.append( reinterpret_cast<const char *>( &options.reference ), sizeof( options.reference ) );
+  size_t cuts( options.cuts.size() );
+  key.append( reinterpret_cast<const char *>( &cuts ), sizeof( cuts ) );
+  if ( cuts > 0 ) {
+    key.append( reinterpret_cast<const char *>( options.cuts.data() ), cuts * sizeof( double ) );
+  }
+  if ( !grid.empty() ) {
+    key.append( reinterpret_cast<const char *>( grid.data() ), grid.size() * sizeof( float ) );
+  }
+  
+  {
+    std::lock_guard<std::mutex> guard( lock );
+    std::map< std::string, std::shared_ptr<const svcsigsplicer> >::const_iterator found( cache.find( key ) );
+    if ( found != cache.end() ) {
+      return found->second;
+    }
+  }
+  std::shared_ptr<const svcsigsplicer> splicer( new svcsigsplicer( grid, options ) );
+  std::lock_guard<std::mutex> guard( lock );
+  return cache.insert( std::make_pair( key, splicer ) ).first->second;
+}
+
+#endif // __svcsigsplice_hpp_
@@ -0,0 +1,660 @@
+/*******************************************************************************
+ * svcsigsrf.hpp
+ *
+ * DESCRIPTION:
+ *    Provides header and implimentation for the svcsigbandset and svcsigsrf
+ *    classes, which simulate the bands of other sensors (e.g. Landsat 8/9 OLI
+ *    or Sentinel-2 MSI) from field spectra by weighting them with each band's
+ *    spectral response function (SRF).
+ *
+ *    A svcsigbandset holds the SRFs of one sensor, loaded from a response
+ *    table or given as Gaussian bands (center and FWHM). A svcsigsrf holds
+ *    any number of band sets and, for each wavelength grid it sees, a sparse
+ *    matrix with a row per band, so every band set is simulated in one pass.
+ *
+ *    The weight of a source band is the integral of the SRF against the hat
+ *    function of that band (the spectrum is linear between bands), so narrow
+ *    SRFs are not undersampled. Weights are normalised to sum to 1. Bands
+ *    with less than SVCSIG_SRF_COVERAGE of their response inside the grid
+ *    are NAN.
+ *
+ *    Build with -pthread.
+ *
+ * RESPONSE TABLES:
+ *    Text, one row per wavelength (nm, or um if every wavelength is below
+ *    SVCSIG_SRF_MICRONS), then one response column per band. Columns are
+ *    separated by commas, tabs, semicolons or spaces. An optional first row
+ *    of column names names the bands. Lines starting with # are ignored.
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsigsrf_hpp_
+#define __svcsigsrf_hpp_
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
+
+#include "svcsighelper.hpp"
+#include "svcsig.hpp"
+#include "svcsigbatch.hpp"
+#include "svcsigresample.hpp"
+
+// the least fraction of a band's response that must be inside the grid
+#define SVCSIG_SRF_COVERAGE 0.99
+
+// the integration step (nm)
+#define SVCSIG_SRF_STEP 0.1
+
+// Gaussian SRFs are cut off this many FWHM from their center
+#define SVCSIG_SRF_GAUSSIAN_WIDTH 3.0
+
+// response tables with every wavelength below this are in um
+#define SVCSIG_SRF_MICRONS 30.0
+
+// spectra per block of the sparse-dense product
+#define SVCSIG_SRF_BLOCK 16
+
+
+// one spectral response function: a table, or a Gaussian if fwhm > 0
+struct svcsigband {
+  std::string name;
+  std::vector<double> wavelength; // nm, ascending
+  std::vector<double> response;
+  double center; // nm
+  double fwhm; // nm
+};
+
+
+class svcsigbandset {
+private:
+  std::string _name;
+  std::vector<svcsigband> _bands;
+
+public:
+  /* Name: svcsigbandset( const std::string &name )
+   *
+   * Description: Constructs an empty band set
+   * Arguments: const std::string &name: the sensor, e.g. "OLI"
+   */
+  svcsigbandset( const std::string &name = "" );
+  
+  /* Name: svcsigbandset& load( const std::string &filename )
+   *
+   * Description: Adds the bands of a response table (see RESPONSE TABLES)
+   * Arguments: const std::string &filename: the table
+   * Modifies: the bands
+   * Returns: *this
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigSrf if the table can not be read or has no bands
+   * Notes: Unnamed bands are called B1, B2, ...; negative responses are 0
+   */
+  svcsigbandset& load( const std::string &filename );
+  
+  /* Name: svcsigbandset& add( const std::string &name, const std::vector<double> &wavelength, const std::vector<double> &response )
+   *
+   * Description: Adds a band from its response at a list of wavelengths (nm)
+   * Exceptions: invalidSVCsigSrf if the lists differ in size or are empty
+   */
+  svcsigbandset& add( const std::string &name, const std::vector<double> &wavelength, const std::vector<double> &response );
+  
+  /* Name: svcsigbandset& gaussian( const std::string &name, const double &center, const double &fwhm )
+   *
+   * Description: Adds a Gaussian band
+   * Arguments: const std::string &name: the band
+   *            const double &center: its center (nm)
+   *            const double &fwhm: its full width at half maximum (nm)
+   * Exceptions: invalidSVCsigSrf if fwhm <= 0
+   */
+  svcsigbandset& gaussian( const std::string &name, const double &center, const double &fwhm );
+  
+  /* Name: getters
+   *
+   * Description: The name of the set, and its bands
+   */
+  std::string name() const;
+  size_t size() const;
+  const svcsigband & band( const size_t &i ) const;
+};
+
+
+// the weights of every band of a svcsigsrf for one wavelength grid: a sparse
+// matrix with a row per band. _rows holds the start of each row in index and
+// weight, plus the end. Empty rows are bands outside the grid.
+struct svcsigsrfmatrix {
+  size_t sourceSize;
+  std::vector<uint32_t> rows;
+  std::vector<uint32_t> index;
+  std::vector<float> weight;
+};
+
+
+class svcsigsrf {
+private:
+  std::vector<svcsigband> _bands;
+  std::vector<std::string> _sets; // the set of each band
+  
+  mutable std::mutex _lock;
+  mutable std::map< std::vector<float>, std::shared_ptr<const svcsigsrfmatrix> > _matrices;
+  
+  svcsigsrf( const svcsigsrf &other );
+  svcsigsrf& operator=( const svcsigsrf &other );
+  
+  /* Name: double svcSigSrfResponse( const svcsigband &band, const double &wavelength, size_t &hint ) const
+   *
+   * Description: The response of a band at a wavelength
+   * Arguments: const svcsigband &band: the band
+   *            const double &wavelength: the wavelength (nm)
+   *            size_t &hint: the table row to start looking from; keeps
+   *                increasing wavelengths linear time
+   * Modifies: hint
+   * Returns: double
+   */
+  double svcSigSrfResponse( const svcsigband &band, const double &wavelength, size_t &hint ) const;
+  
+  /* Name: void svcSigSrfSupport( const svcsigband &band, double &first, double &last, double &area ) const
+   *
+   * Description: The wavelength range and integral of a band's response
+   */
+  void svcSigSrfSupport( const svcsigband &band, double &first, double &last, double &area ) const;
+  
+  /* Name: std::shared_ptr<const svcsigsrfmatrix> svcSigSrfBuild( const std::vector<float> &grid ) const
+   *
+   * Description: Computes the weights of every band for a grid
+   */
+  std::shared_ptr<const svcsigsrfmatrix> svcSigSrfBuild( const std::vector<float> &grid ) const;
+  
+  /* Name: void svcSigSrfBlock( const svcsigsrfmatrix &matrix, const float * const *in, const size_t &count, float *out, float *tile ) const
+   *
+   * Description: Simulates the bands of up to SVCSIG_SRF_BLOCK spectra
+   * Arguments: const svcsigsrfmatrix &matrix: the weights
+   *            const float * const *in: the spectra
+   *            const size_t &count: the number of spectra
+   *            float *out: count rows of size() values
+   *            float *tile: scratch for sourceSize * SVCSIG_SRF_BLOCK values
+   * Modifies: out, tile
+   * Notes: The spectra are transposed into tile, so each weight multiplies a
+   *    contiguous run of SVCSIG_SRF_BLOCK values
+   */
+  void svcSigSrfBlock( const svcsigsrfmatrix &matrix, const float * const *in, const size_t &count, float *out, float *tile ) const;
+
+public:
+  /* Name: svcsigsrf()
+   *
+   * Description: Constructs an engine with no bands
+   */
+  svcsigsrf();
+  
+  /* Name: svcsigsrf& add( const svcsigbandset &set )
+   *
+   * Description: Adds the bands of a band set; they follow the bands already
+   *    added
+   * Modifies: the bands, and clears the cached weights
+   * Returns: *this
+   */
+  svcsigsrf& add( const svcsigbandset &set );
+  
+  /* Name: getters
+   *
+   * Description: size() is the number of bands over all of the band sets,
+   *    bandName( i ) and setName( i ) name band i
+   */
+  size_t size() const;
+  std::string bandName( const size_t &i ) const;
+  std::string setName( const size_t &i ) const;
+  
+  /* Name: std::shared_ptr<const svcsigsrfmatrix> matrix( const std::vector<float> &grid ) const
+   *
+   * Description: Returns the weights for a wavelength grid, computing them
+   *    the first time the grid is seen
+   * Arguments: const std::vector<float> &grid: the wavelengths (e.g.
+   *     svcsig::wavelength(); need not be sorted)
+   * Modifies: the cache
+   * Returns: std::shared_ptr<const svcsigsrfmatrix>
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Thread safe
+   */
+  std::shared_ptr<const svcsigsrfmatrix> matrix( const std::vector<float> &grid ) const;
+  
+  /* Name: void apply( const std::vector<float> &grid, const float *in, float *out, const size_t &count, const unsigned int &threads ) const
+   *
+   * Description: Simulates the bands of many spectra on one grid
+   * Arguments: const std::vector<float> &grid: the wavelengths of the spectra
+   *            const float *in: count spectra of grid.size() values, one after
+   *                another
+   *            float *out: count rows of size() values
+   *            const size_t &count: the number of spectra
+   *            const unsigned int &threads: the number of threads (0 for one
+   *                per core)
+   * Modifies: out
+   */
+  void apply( const std::vector<float> &grid, const float *in, float *out, const size_t &count, const unsigned int &threads = 0 ) const;
+  
+  /* Name: std::vector<float> apply( const std::vector<svcsig> &sigs, const int &spectrum, const unsigned int &threads ) const
+   *
+   * Description: Simulates the bands of a spectrum of many sig files
+   * Arguments: const std::vector<svcsig> &sigs: the sig files, on any grids
+   *            const int &spectrum: SVCSIG_SPECTRUM_REFERENCE_RADIANCE,
+   *                SVCSIG_SPECTRUM_TARGET_RADIANCE or
+   *                SVCSIG_SPECTRUM_TARGET_REFLECTANCE
+   *            const unsigned int &threads: the number of threads (0 for one
+   *                per core)
+   * Modifies:
+   * Returns: std::vector<float>, sigs.size() rows of size() values
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigSrf if spectrum is unknown
+   * Notes: Files are grouped by grid (svcSigGroupByGrid()), and each group is
+   *    multiplied in blocks
+   */
+  std::vector<float> apply( const std::vector<svcsig> &sigs, const int &spectrum = SVCSIG_SPECTRUM_TARGET_REFLECTANCE, const unsigned int &threads = 0 ) const;
+};
+
+
+// --- --- Implimentation --- --- //
+
+// -- -- svcsigbandset -- -- //
+svcsigbandset::svcsigbandset( const std::string &name )
+: _name( name )
+{
+}
+
+svcsigbandset& svcsigbandset::load( const std::string &filename )
+{
+  std::ifstream input( filename.c_str() );
+  if ( !input.is_open() ) {
+    throw invalidSVCsigSrf( "could not open '" + filename + "'" );
+  }
+  
+  std::vector<std::string> names;
+  std::vector<double> wavelength;
+  std::vector< std::vector<double> > response;
+  std::string line;
+  while ( std::getline( input, line ) ) {
+    for ( size_t i = 0; i < line.size(); i++ ) {
+      if ( line[ i ] == ',' || line[ i ] == '\t' || line[ i ] == ';' || line[ i ] == '\r' ) {
+        line[ i ] = ' ';
+      }
+    }
+    std::istringstream fields( line );
+    std::vector<std::string> columns;
+    std::string column;
+    while ( fields >> column ) {
+      columns.push_back( column );
+    }
+    if ( columns.empty() || columns[ 0 ][ 0 ] == '#' ) {
+      continue;
+    }
+    
+    char *end;
+    double w( strtod( columns[ 0 ].c_str(), &end ) );
+    if ( *end != '\0' ) {
+      // a row of names, before the data
+      if ( !wavelength.empty() ) {
+        throw invalidSVCsigSrf( "'" + filename + "' has text inside its data" );
+      }
+      names.assign( columns.begin() + 1, columns.end() );
+      continue;
+    }
+    if ( response.size() < columns.size() - 1 ) {
+      response.resize( columns.size() - 1, std::vector<double>( wavelength.size(), 0.0 ) );
+    }
+    wavelength.push_back( w );
+    for ( size_t b = 0; b < response.size(); b++ ) {
+      double r( b + 1 < columns.size() ? strtod( columns[ b + 1 ].c_str(), NULL ) : 0.0 );
+      response[ b ].push_back( std::isnan( r ) || r < 0.0 ? 0.0 : r );
+    }
+  }
+  if ( wavelength.empty() || response.empty() ) {
+    throw invalidSVCsigSrf( "'" + filename + "' has no bands" );
+  }
+  
+  double scale( *std::max_element( wavelength.begin(), wavelength.end() ) < SVCSIG_SRF_MICRONS ? 1000.0 : 1.0 );
+  for ( size_t i = 0; i < wavelength.size(); i++ ) {
+    wavelength[ i ] *= scale;
+  }
+  for ( size_t b = 0; b < response.size(); b++ ) {
+    std::ostringstream name;
+    if ( b < names.size() ) {
+      name << names[ b ];
+    }
+    else {
+      name << "B" << b + 1;
+    }
+    add( name.str(), wavelength, response[ b ] );
+  }
+  return *this;
+}
+
+svcsigbandset& svcsigbandset::add( const std::string &name, const std::vector<double> &wavelength, const std::vector<double> &response )
+{
+  if ( wavelength.empty() || wavelength.size() != response.size() ) {
+    throw invalidSVCsigSrf( "band '" + name + "' needs a response at each wavelength" );
+  }
+  std::vector< std::pair<double, double> > table;
+  for ( size_t i = 0; i < wavelength.size(); i++ ) {
+    table.push_back( std::make_pair( wavelength[ i ], response[ i ] ) );
+  }
+  std::sort( table.begin(), table.end() );
+  
+  svcsigband band;
+  band.name = name;
+  band.center = 0.0;
+  band.fwhm = 0.0;
+  for ( size_t i = 0; i < table.size(); i++ ) {
+    band.wavelength.push_back( table[ i ].first );
+    band.response.push_back( table[ i ].second );
+  }
+  _bands.push_back( band );
+  return *this;
+}
+
+svcsigbandset& svcsigbandset::gaussian( const std::string &name, const double &center, const double &fwhm )
+{
+  if ( !( fwhm > 0.0 ) ) {
+    throw invalidSVCsigSrf( "band '" + name + "' needs a positive FWHM" );
+  }
+  svcsigband band;
+  band.name = name;
+  band.center = center;
+  band.fwhm = fwhm;
+  _bands.push_back( band );
+  return *this;
+}
+
+std::string svcsigbandset::name() const
+{
+  return _name;
+}
+
+size_t svcsigbandset::size() const
+{
+  return _bands.size();
+}
+
+const svcsigband & svcsigbandset::band( const size_t &i ) const
+{
+  return _bands.at( i );
+}
+
+// -- -- svcsigsrf -- -- //
+svcsigsrf::svcsigsrf()
+{
+}
+
+svcsigsrf& svcsigsrf::add( const svcsigbandset &set )
+{
+  std::lock_guard<std::mutex> guard( _lock );
+  for ( size_t i = 0; i < set.size(); i++ ) {
+    _bands.push_back( set.band( i ) );
+    _sets.push_back( set.name() );
+  }
+  _matrices.clear();
+  return *this;
+}
+
+size_t svcsigsrf::size() const
+{
+  return _bands.size();
+}
+
+std::string svcsigsrf::bandName( const size_t &i ) const
+{
+  return _bands.at( i ).name;
+}
+
+std::string svcsigsrf::setName( const size_t &i ) const
+{
+  return _sets.at( i );
+}
+
+std::shared_ptr<const svcsigsrfmatrix> svcsigsrf::matrix( const std::vector<float> &grid ) const
+{
+  {
+    std::lock_guard<std::mutex> guard( _lock );
+    std::map< std::vector<float>, std::shared_ptr<const svcsigsrfmatrix> >::const_iterator found( _matrices.find( grid ) );
+    if ( found != _matrices.end() ) {
+      return found->second;
+    }
+  }
+  // build outside the lock; if two threads race, the first one in wins
+  std::shared_ptr<const svcsigsrfmatrix> built( svcSigSrfBuild( grid ) );
+  std::lock_guard<std::mutex> guard( _lock );
+  return _matrices.insert( std::make_pair( grid, built ) ).first->second;
+}
+
+void svcsigsrf::apply( const std::vector<float> &grid, const float *in, float *out, const size_t &count, const unsigned int &threads ) const
+{
+  std::shared_ptr<const svcsigsrfmatrix> weights( matrix( grid ) );
+  size_t blocks( ( count + SVCSIG_SRF_BLOCK - 1 ) / SVCSIG_SRF_BLOCK );
+  std::vector< std::vector<float> > tiles( svcSigThreads( threads ) );
+  svcSigParallelFor( blocks, threads, [&]( size_t block, unsigned int thread ) {
+    const float *spectra[ SVCSIG_SRF_BLOCK ];
+    size_t first( block * SVCSIG_SRF_BLOCK );
+    size_t n( std::min( count - first, size_t( SVCSIG_SRF_BLOCK ) ) );
+    for ( size_t s = 0; s < n; s++ ) {
+      spectra[ s ] = in + ( first + s ) * grid.size();
+    }
+    tiles[ thread ].resize( grid.size() * SVCSIG_SRF_BLOCK );
+    svcSigSrfBlock( *weights, spectra, n, out + first * _bands.size(), tiles[ thread ].data() );
+  } );
+}
+
+std::vector<float> svcsigsrf::apply( const std::vector<svcsig> &sigs, const int &spectrum, const unsigned int &threads ) const
+{
+  if ( spectrum != SVCSIG_SPECTRUM_REFERENCE_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_REFLECTANCE ) {
+    throw invalidSVCsigSrf( "unknown spectrum" );
+  }
+  std::vector<float> out( sigs.size() * _bands.size(), NAN );
+  
+  // group the files by grid, then cut each group into blocks
+  std::map< std::vector<float>, std::vector<size_t> > groups( svcSigGroupByGrid( sigs ) );
+  std::vector< std::shared_ptr<const svcsigsrfmatrix> > matrices;
+  std::vector< std::pair<size_t, size_t> > blocks; // ( group, first member )
+  std::vector< const std::vector<size_t> * > members;
+  for ( std::map< std::vector<float>, std::vector<size_t> >::const_iterator g = groups.begin(); g != groups.end(); ++g ) {
+    matrices.push_back( matrix( g->first ) );
+    members.push_back( &g->second );
+    for ( size_t first = 0; first < g->second.size(); first += SVCSIG_SRF_BLOCK ) {
+      blocks.push_back( std::make_pair( members.size() - 1, first ) );
+    }
+  }
+  
+  std::vector< std::vector<float> > tiles( svcSigThreads( threads ) );
+  std::vector< std::vector<float> > results( svcSigThreads( threads ) );
+  svcSigParallelFor( blocks.size(), threads, [&]( size_t b, unsigned int thread ) {
+    const svcsigsrfmatrix &weights( *matrices[ blocks[ b ].first ] );
+    const std::vector<size_t> &group( *members[ blocks[ b ].first ] );
+    size_t first( blocks[ b ].second );
+    size_t n( std::min( group.size() - first, size_t( SVCSIG_SRF_BLOCK ) ) );
+    const float *spectra[ SVCSIG_SRF_BLOCK ];
+    for ( size_t s = 0; s < n; s++ ) {
+      const svcsig &sig( sigs[ group[ first + s ] ] );
+      spectra[ s ] = spectrum == SVCSIG_SPECTRUM_REFERENCE_RADIANCE ? sig.referenceRadianceData() :
+        ( spectrum == SVCSIG_SPECTRUM_TARGET_RADIANCE ? sig.targetRadianceData() : sig.targetReflectanceData() );
+    }
+    tiles[ thread ].resize( weights.sourceSize * SVCSIG_SRF_BLOCK );
+    results[ thread ].resize( _bands.size() * SVCSIG_SRF_BLOCK );
+    svcSigSrfBlock( weights, spectra, n, results[ thread ].data(), tiles[ thread ].data() );
+    for ( size_t s = 0; s < n; s++ ) {
+      std::copy( results[ thread ].begin() + s * _bands.size(), results[ thread ].begin() + ( s + 1 ) * _bands.size(), out.begin() + group[ first + s ] * _bands.size() );
+    }
+  } );
+  return out;
+}
+
+// -- -- Helper Functions -- -- //
+double svcsigsrf::svcSigSrfResponse( const svcsigband &band, const double &wavelength, size_t &hint ) const
+{
+  if ( band.fwhm > 0.0 ) {
+    double x( ( wavelength - band.center ) / band.fwhm );
+    return std::exp( -4.0 * std::log( 2.0 ) * x * x );
+  }
+  const std::vector<double> &w( band.wavelength );
+  if ( wavelength < w.front() || wavelength > w.back() || w.size() < 2 ) {
+    return 0.0;
+  }
+  if ( hint >= w.size() - 1 || w[ hint ] > wavelength ) {
+    hint = 0;
+  }
+  while ( hint + 2 < w.size() && w[ hint + 1 ] < wavelength ) {
+    hint++;
+  }
+  double h( w[ hint + 1 ] - w[ hint ] );
+  double s( h > 0.0 ? ( wavelength - w[ hint ] ) / h : 0.0 );
+  return ( 1.0 - s ) * band.response[ hint ] + s * band.response[ hint + 1 ];
+}
+
+void svcsigsrf::svcSigSrfSupport( const svcsigband &band, double &first, double &last, double &area ) const
+{
+  if ( band.fwhm > 0.0 ) {
+    first = band.center - SVCSIG_SRF_GAUSSIAN_WIDTH * band.fwhm;
+    last = band.center + SVCSIG_SRF_GAUSSIAN_WIDTH * band.fwhm;
+    area = band.fwhm * std::sqrt( M_PI / ( 4.0 * std::log( 2.0 ) ) );
+    return;
+  }
+  first = band.wavelength.front();
+  last = band.wavelength.back();
+  area = 0.0;
+  for ( size_t i = 0; i + 1 < band.wavelength.size(); i++ ) {
+    area += 0.5 * ( band.response[ i ] + band.response[ i + 1 ] ) * ( band.wavelength[ i + 1 ] - band.wavelength[ i ] );
+  }
+}
+
+std::shared_ptr<const svcsigsrfmatrix> svcsigsrf::svcSigSrfBuild( const std::vector<float> &grid ) const
+{
+  // the distinct wavelengths, ascending, and the bands of each
+  std::vector< std::pair<float, uint32_t> > order;
+  for ( size_t i = 0; i < grid.size(); i++ ) {
+    if ( !std::isnan( grid[ i ] ) ) {
+      order.push_back( std::make_pair( grid[ i ], uint32_t( i ) ) );
+    }
+  }
+  std::sort( order.begin(), order.end() );
+  std::vector<double> x;
+  std::vector< std::vector<uint32_t> > nodes;
+  for ( size_t i = 0; i < order.size(); i++ ) {
+    if ( x.empty() || order[ i ].first != x.back() ) {
+      x.push_back( order[ i ].first );
+      nodes.push_back( std::vector<uint32_t>() );
+    }
+    nodes.back().push_back( order[ i ].second );
+  }
+  
+  std::shared_ptr<svcsigsrfmatrix> matrix( new svcsigsrfmatrix );
+  matrix->sourceSize = grid.size();
+  matrix->rows.push_back( 0 );
+  std::vector<double> weight( x.size() );
+  for ( size_t b = 0; b < _bands.size(); b++ ) {
+    const svcsigband &band( _bands[ b ] );
+    double first, last, area;
+    svcSigSrfSupport( band, first, last, area );
+    
+    // integrate the response against the hat function of each node
+    std::fill( weight.begin(), weight.end(), 0.0 );
+    double covered( 0.0 );
+    size_t hint( 0 );
+    size_t k( std::upper_bound( x.begin(), x.end(), first ) - x.begin() );
+    for ( k = k > 0 ? k - 1 : 0; k + 1 < x.size() && x[ k ] < last; k++ ) {
+      double h( x[ k + 1 ] - x[ k ] );
+      size_t steps( size_t( std::ceil( h / SVCSIG_SRF_STEP ) ) );
+      double dx( h / steps );
+      for ( size_t q = 0; q < steps; q++ ) {
+        double s( ( q + 0.5 ) / steps );
+        double r( svcSigSrfResponse( band, x[ k ] + s * h, hint ) * dx );
+        weight[ k ] += ( 1.0 - s ) * r;
+        weight[ k + 1 ] += s * r;
+        covered += r;
+      }
+    }
+    
+    if ( covered > 0.0 && covered >= SVCSIG_SRF_COVERAGE * area ) {
+      for ( size_t n = 0; n < x.size(); n++ ) {
+        if ( weight[ n ] <= 0.0 ) {
+          continue;
+        }
+        for ( size_t i = 0; i < nodes[ n ].size(); i++ ) {
+          matrix->index.push_back( nodes[ n ][ i ] );
+          matrix->weight.push_back( weight[ n ] / covered / nodes[ n ].size() );
+        }
+      }
+    }
+    matrix->rows.push_back( matrix->index.size() );
+  }
+  return matrix;
+}
+
+void svcsigsrf::svcSigSrfBlock( const svcsigsrfmatrix &matrix, const float * const *in, const size_t &count, float *out, float *tile ) const
+{
+  const size_t B( SVCSIG_SRF_BLOCK );
+  size_t n( matrix.sourceSize );
+  for ( size_t i = 0; i < n; i++ ) {
+    for ( size_t s = 0; s < B; s++ ) {
+      tile[ i * B + s ] = s < count ? in[ s ][ i ] : 0.0f;
+    }
+  }
+  
+  float sum[ SVCSIG_SRF_BLOCK ];
+  for ( size_t b = 0; b + 1 < matrix.rows.size(); b++ ) {
+    for ( size_t s = 0; s < B; s++ ) {
+      sum[ s ] = 0.0f;
+    }
+    for ( uint32_t k = matrix.rows[ b ]; k < matrix.rows[ b + 1 ]; k++ ) {
+      const float w( matrix.weight[ k ] );
+      const float *column( tile + matrix.index[ k ] * B );
+      for ( size_t s = 0; s < B; s++ ) {
+        sum[ s ] += w * column[ s ];
+      }
+    }
+    bool empty( matrix.rows[ b ] == matrix.rows[ b + 1 ] );
+    for ( size_t s = 0; s < count; s++ ) {
+      out[ s * _bands.size() + b ] = empty ? NAN : sum[ s ];
+    }
+  }
+}
+
+#endif // __svcsigsrf_hpp_
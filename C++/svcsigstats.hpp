@@ -0,0 +1,374 @@
+/*******************************************************************************
+ * svcsigstats.hpp
+ *
+ * DESCRIPTION:
+ *    Provides header and implimentation for the svcsigstats class, the
+ *    per-band count, mean, standard deviation, minimum and maximum of a
+ *    stream of spectra, and for reducing whole collections of sig files with
+ *    it on all cores.
+ *
+ *    Spectra are added one at a time with Welford's update, so nothing but
+ *    the O(bands) accumulators is kept, and accumulators are merged with
+ *    Chan et al.'s pairwise formula, so each thread can reduce its own files
+ *    and the results be combined at the end. Files are parsed, added and
+ *    released one at a time by the workers.
+ *
+ *    Build with -pthread.
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *    2026-10-18: The resampler is looked up once per grid, not per spectrum
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *   B. P. Welford, "Note on a Method for Calculating Corrected Sums of Squares
+ *     and Products", Technometrics 4(3), 1962
+ *   T. F. Chan, G. H. Golub, R. J. LeVeque, "Updating Formulae and a Pairwise
+ *     Algorithm for Computing Sample Variances", Stanford CS tech. report
+ *     STAN-CS-79-773, 1979
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsigstats_hpp_
+#define __svcsigstats_hpp_
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include "svcsighelper.hpp"
+#include "svcsig.hpp"
+#include "svcsigbatch.hpp"
+#include "svcsigresample.hpp"
+
+
+class svcsigstats {
+private:
+  std::vector<float> _grid;
+  std::vector<uint64_t> _count;
+  std::vector<double> _mean;
+  std::vector<double> _m2; // the sum of squared differences from the mean
+  std::vector<float> _min;
+  std::vector<float> _max;
+  std::vector<float> _source; // the grid of the last file resampled
+  std::shared_ptr<const svcsigresampler> _resampler; // from _source onto _grid
+  std::vector<float> _resampled;
+
+public:
+  /* Name: svcsigstats( const std::vector<float> &grid )
+   *
+   * Description: Constructs empty statistics
+   * Arguments: const std::vector<float> &grid: the wavelengths, or empty to
+   *                take those of the first sig file added
+   */
+  svcsigstats( const std::vector<float> &grid = std::vector<float>() );
+  
+  /* Name: void add( const float *spectrum )
+   *
+   * Description: Adds a spectrum on the grid
+   * Arguments: const float *spectrum: grid().size() values
+   * Modifies: The statistics
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: NAN values are skipped, so the counts can differ between bands
+   */
+  void add( const float *spectrum );
+  
+  /* Name: void add( const svcsig &sig, const int &spectrum )
+   *
+   * Description: Adds a spectrum of a sig file, in place if it is on the
+   *    grid, and resampled (linearly) onto it if not
+   * Arguments: const svcsig &sig: the sig file
+   *            const int &spectrum: SVCSIG_SPECTRUM_REFERENCE_RADIANCE,
+   *                SVCSIG_SPECTRUM_TARGET_RADIANCE or
+   *                SVCSIG_SPECTRUM_TARGET_REFLECTANCE
+   * Modifies: The statistics (and the grid if it was empty)
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigStats if the spectrum is unknown
+   * Notes: Bands outside the file's range are skipped. The resampler is kept
+   *    until a file on another grid is added, so a run of files on one grid
+   *    looks it up once.
+   */
+  void add( const svcsig &sig, const int &spectrum = SVCSIG_SPECTRUM_TARGET_REFLECTANCE );
+  
+  /* Name: void merge( const svcsigstats &other )
+   *
+   * Description: Adds the spectra of other statistics
+   * Arguments: const svcsigstats &other: statistics on the same grid
+   * Modifies: The statistics
+   * Returns:
+   * Pre:
+   * Post: The same (to rounding) as adding both streams to one
+   * Exceptions: invalidSVCsigStats if the grids differ
+   * Notes: Statistics with an empty grid merge with any
+   */
+  void merge( const svcsigstats &other );
+  
+  /* Name: getters
+   *
+   * Description: grid() is the wavelengths and size() the number of bands.
+   *    For each band, count() is the number of values, mean() their mean,
+   *    variance() and stddev() their sample (n - 1) variance and standard
+   *    deviation, and minimum() and maximum() their extrema. Bands without
+   *    values (or with one, for the variance) are NAN.
+   */
+  const std::vector<float> & grid() const;
+  size_t size() const;
+  std::vector<uint64_t> count() const;
+  std::vector<double> mean() const;
+  std::vector<double> variance() const;
+  std::vector<double> stddev() const;
+  std::vector<float> minimum() const;
+  std::vector<float> maximum() const;
+};
+
+
+/* Name: svcsigstats svcSigStatsBatch( const std::vector<std::string> &filenames, const std::vector<float> &grid, const int &spectrum, const unsigned int &threads )
+ *
+ * Description: Reduces a spectrum of many sig files without keeping them
+ * Arguments: const std::vector<std::string> &filenames: the sig files
+ *            const std::vector<float> &grid: the wavelengths, or empty for
+ *                those of the first file
+ *            const int &spectrum: SVCSIG_SPECTRUM_REFERENCE_RADIANCE,
+ *                SVCSIG_SPECTRUM_TARGET_RADIANCE or
+ *                SVCSIG_SPECTRUM_TARGET_REFLECTANCE
+ *            const unsigned int &threads: the number of threads (0 for one per
+ *                core)
+ * Modifies:
+ * Returns: svcsigstats
+ * Pre:
+ * Post:
+ * Exceptions: invalidSVCsigStats if the spectrum is unknown
+ * Notes: Each thread parses a file, adds it to its own statistics and
+ *    releases it, so memory is O(threads bands). The statistics of the
+ *    threads are merged at the end.
+ */
+svcsigstats svcSigStatsBatch( const std::vector<std::string> &filenames, const std::vector<float> &grid = std::vector<float>(), const int &spectrum = SVCSIG_SPECTRUM_TARGET_REFLECTANCE, const unsigned int &threads = 0 );
+
+/* Name: svcsigstats svcSigStatsBatch( const std::vector<svcsig> &sigs, const std::vector<float> &grid, const int &spectrum, const unsigned int &threads )
+ *
+ * Description: Reduces a spectrum of many sig files that are already read
+ */
+svcsigstats svcSigStatsBatch( const std::vector<svcsig> &sigs, const std::vector<float> &grid = std::vector<float>(), const int &spectrum = SVCSIG_SPECTRUM_TARGET_REFLECTANCE, const unsigned int &threads = 0 );
+
+
+// --- --- Implimentation --- --- //
+
+// -- -- Constructors -- -- //
+svcsigstats::svcsigstats( const std::vector<float> &grid )
+: _grid( grid ), _count( grid.size(), 0 ), _mean( grid.size(), 0.0 ), _m2( grid.size(), 0.0 ),
+  _min( grid.size(), INFINITY ), _max( grid.size(), -INFINITY )
+{
+}
+
+// -- -- Accumulation -- -- //
+void svcsigstats::add( const float *spectrum )
+{
+  for ( size_t j = 0; j < _grid.size(); j++ ) {
+    float value( spectrum[ j ] );
+    if ( std::isnan( value ) ) {
+      continue;
+    }
+    double delta( value - _mean[ j ] );
+    _count[ j ]++;
+    _mean[ j ] += delta / _count[ j ];
+    _m2[ j ] += delta * ( value - _mean[ j ] );
+    _min[ j ] = std::min( _min[ j ], value );
+    _max[ j ] = std::max( _max[ j ], value );
+  }
+}
+
+void svcsigstats::add( const svcsig &sig, const int &spectrum )
+{
+  if ( spectrum != SVCSIG_SPECTRUM_REFERENCE_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_REFLECTANCE ) {
+    throw invalidSVCsigStats( "unknown spectrum" );
+  }
+  if ( sig.size() == 0 ) {
+    return;
+  }
+  if ( _grid.empty() ) {
+    *this = svcsigstats( sig.wavelength() );
+  }
+  const float *data( spectrum == SVCSIG_SPECTRUM_REFERENCE_RADIANCE ? sig.referenceRadianceData() :
+    ( spectrum == SVCSIG_SPECTRUM_TARGET_RADIANCE ? sig.targetRadianceData() : sig.targetReflectanceData() ) );
+  if ( sig.size() == _grid.size() && std::equal( _grid.begin(), _grid.end(), sig.wavelengthData() ) ) {
+    add( data );
+  }
+  else {
+    if ( _resampler == NULL || _source.size() != sig.size() || memcmp( _source.data(), sig.wavelengthData(), sig.size() * sizeof( float ) ) != 0 ) {
+      _source = sig.wavelength();
+      _resampler = svcSigResampler( _source, _grid, SVCSIG_RESAMPLE_LINEAR );
+      _resampled.resize( _grid.size() );
+    }
+    _resampler->apply( data, _resampled.data() );
+    add( _resampled.data() );
+  }
+}
+
+void svcsigstats::merge( const svcsigstats &other )
+{
+  if ( other._grid.empty() ) {
+    return;
+  }
+  if ( _grid.empty() ) {
+    *this = other;
+    return;
+  }
+  if ( _grid != other._grid ) {
+    throw invalidSVCsigStats( "the grids differ" );
+  }
+  for ( size_t j = 0; j < _grid.size(); j++ ) {
+    if ( other._count[ j ] == 0 ) {
+      continue;
+    }
+    double count( double( _count[ j ] ) + other._count[ j ] );
+    double delta( other._mean[ j ] - _mean[ j ] );
+    _mean[ j ] += delta * other._count[ j ] / count;
+    _m2[ j ] += other._m2[ j ] + delta * delta * _count[ j ] / count * other._count[ j ];
+    _count[ j ] += other._count[ j ];
+    _min[ j ] = std::min( _min[ j ], other._min[ j ] );
+    _max[ j ] = std::max( _max[ j ], other._max[ j ] );
+  }
+}
+
+// -- -- Getters -- -- //
+const std::vector<float> & svcsigstats::grid() const
+{
+  return _grid;
+}
+
+size_t svcsigstats::size() const
+{
+  return _grid.size();
+}
+
+std::vector<uint64_t> svcsigstats::count() const
+{
+  return _count;
+}
+
+std::vector<double> svcsigstats::mean() const
+{
+  std::vector<double> out( _grid.size() );
+  for ( size_t j = 0; j < _grid.size(); j++ ) {
+    out[ j ] = _count[ j ] > 0 ? _mean[ j ] : NAN;
+  }
+  return out;
+}
+
+std::vector<double> svcsigstats::variance() const
+{
+  std::vector<double> out( _grid.size() );
+  for ( size_t j = 0; j < _grid.size(); j++ ) {
+    out[ j ] = _count[ j ] > 1 ? _m2[ j ] / ( _count[ j ] - 1 ) : NAN;
+  }
+  return out;
+}
+
+std::vector<double> svcsigstats::stddev() const
+{
+  std::vector<double> out( variance() );
+  for ( size_t j = 0; j < out.size(); j++ ) {
+    out[ j ] = std::sqrt( out[ j ] );
+  }
+  return out;
+}
+
+std::vector<float> svcsigstats::minimum() const
+{
+  std::vector<float> out( _min );
+  for ( size_t j = 0; j < _grid.size(); j++ ) {
+    out[ j ] = _count[ j ] > 0 ? out[ j ] : NAN;
+  }
+  return out;
+}
+
+std::vector<float> svcsigstats::maximum() const
+{
+  std::vector<float> out( _max );
+  for ( size_t j = 0; j < _grid.size(); j++ ) {
+    out[ j ] = _count[ j ] > 0 ? out[ j ] : NAN;
+  }
+  return out;
+}
+
+// -- -- Collections -- -- //
+svcsigstats svcSigStatsBatch( const std::vector<std::string> &filenames, const std::vector<float> &grid, const int &spectrum, const unsigned int &threads )
+{
+  if ( spectrum != SVCSIG_SPECTRUM_REFERENCE_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_REFLECTANCE ) {
+    throw invalidSVCsigStats( "unknown spectrum" );
+  }
+  std::vector<float> wavelengths( grid );
+  if ( wavelengths.empty() && !filenames.empty() ) {
+    wavelengths = svcsig().read( filenames[ 0 ] ).wavelength();
+  }
+  std::vector<svcsigstats> partial( svcSigThreads( threads ), svcsigstats( wavelengths ) );
+  svcSigParallelFor( filenames.size(), partial.size(), [&]( size_t i, unsigned int thread ) {
+    svcsig sig;
+    sig.read( filenames[ i ] );
+    partial[ thread ].add( sig, spectrum );
+  } );
+  for ( size_t t = 1; t < partial.size(); t++ ) {
+    partial[ 0 ].merge( partial[ t ] );
+  }
+  return partial[ 0 ];
+}
+
+svcsigstats svcSigStatsBatch( const std::vector<svcsig> &sigs, const std::vector<float> &grid, const int &spectrum, const unsigned int &threads )
+{
+  if ( spectrum != SVCSIG_SPECTRUM_REFERENCE_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_RADIANCE && spectrum != SVCSIG_SPECTRUM_TARGET_REFLECTANCE ) {
+    throw invalidSVCsigStats( "unknown spectrum" );
+  }
+  std::vector<float> wavelengths( grid );
+  for ( size_t i = 0; i < sigs.size() && wavelengths.empty(); i++ ) {
+    wavelengths = sigs[ i ].wavelength();
+  }
+  std::vector<svcsigstats> partial( svcSigThreads( threads ), svcsigstats( wavelengths ) );
+  size_t chunks( ( sigs.size() + SVCSIG_BATCH_CHUNK - 1 ) / SVCSIG_BATCH_CHUNK );
+  svcSigParallelFor( chunks, partial.size(), [&]( size_t chunk, unsigned int thread ) {
+    size_t end( std::min( sigs.size(), ( chunk + 1 ) * SVCSIG_BATCH_CHUNK ) );
+    for ( size_t i = chunk * SVCSIG_BATCH_CHUNK; i < end; i++ ) {
+      partial[ thread ].add( sigs[ i ], spectrum );
+    }
+  } );
+  for ( size_t t = 1; t < partial.size(); t++ ) {
+    partial[ 0 ].merge( partial[ t ] );
+  }
+  return partial[ 0 ];
+}
+
+#endif // __svcsigstats_hpp_
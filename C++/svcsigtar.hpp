@@ -0,0 +1,569 @@
+/*******************************************************************************
+ * svcsigtar.hpp
+ *
+ * DESCRIPTION:
+ *    Provides header and implimentation for the svcsigtar class, which reads
+ *    SVC sig files directly out of a (uncompressed) tar archive
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *   POSIX.1-2001 pax / ustar interchange format
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsigtar_hpp_
+#define __svcsigtar_hpp_
+
+#include <string>
+#include <vector>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "svcsighelper.hpp"
+#include "svcsig.hpp"
+
+
+class svcsigtar {
+private:
+  const char *_buffer; // the start of the archive
+  size_t _size; // the number of bytes in the archive
+  bool _mapped; // true if _buffer was mmap'ed by open( const std::string & )
+  size_t _offset; // the offset of the next header block
+  std::string _memberName; // the current member
+  const char *_memberData;
+  size_t _memberSize;
+
+  // tar archives are not copyable (they may own a mapping)
+  svcsigtar( const svcsigtar &other );
+  svcsigtar& operator=( const svcsigtar &other );
+
+  /* Name: size_t svcSigTarParseNumber( const char *field, const size_t &length ) const
+   *
+   * Description: Parses a numeric header field (octal, or GNU base-256 for
+   *    members larger than 8 GB)
+   * Arguments: const char *field: the start of the field
+   *            const size_t &length: the width of the field
+   * Modifies:
+   * Returns: size_t
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  size_t svcSigTarParseNumber( const char *field, const size_t &length ) const;
+
+  /* Name: bool svcSigTarCheckHeader( const char *header ) const
+   *
+   * Description: Validates the checksum of a 512 byte header block
+   * Arguments: const char *header: the header block
+   * Modifies:
+   * Returns: true if the checksum matches
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  bool svcSigTarCheckHeader( const char *header ) const;
+
+  /* Name: std::string svcSigTarParsePaxPath( const char *data, const size_t &size ) const
+   *
+   * Description: Finds the path record in a pax extended header
+   * Arguments: const char *data: the pax records
+   *            const size_t &size: the number of bytes of records
+   * Modifies:
+   * Returns: the path, or "" if there is no path record
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigTar if a record is malformed
+   * Notes:
+   */
+  std::string svcSigTarParsePaxPath( const char *data, const size_t &size ) const;
+
+  /* Name: bool svcSigTarIsSig( const std::string &name ) const
+   *
+   * Description: Checks if a member name ends in .sig (case insensitive)
+   * Arguments: const std::string &name: the member name
+   * Modifies:
+   * Returns: bool
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: name.sig.jpg is not a sig file
+   */
+  bool svcSigTarIsSig( const std::string &name ) const;
+
+public:
+  /* Name: svcsigtar()
+   *
+   * Description: Null constructor for svcsigtar
+   * Arguments:
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Use open() before calling next()
+   */
+  svcsigtar();
+
+  /* Name: svcsigtar( const std::string &filename )
+   *
+   * Description: Constructs a svcsigtar and opens a tar archive
+   * Arguments: const std::string &filename: the tar archive
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigTar if the archive cannot be opened
+   * Notes:
+   */
+  svcsigtar( const std::string &filename );
+
+  /* Name: ~svcsigtar()
+   *
+   * Description: Destructor for svcsigtar
+   * Arguments:
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Unmaps the archive if it was mapped
+   */
+  ~svcsigtar();
+
+  /* Name: svcsigtar& open( const std::string &filename )
+   *
+   * Description: Opens a tar archive by memory mapping it
+   * Arguments: const std::string &filename: the tar archive
+   * Modifies: Everything
+   * Returns: *this
+   * Pre:
+   * Post: The archive is positioned before the first member
+   * Exceptions: invalidSVCsigTar if the archive cannot be opened or mapped
+   * Notes: The mapping is advised as sequential, so the kernel reads ahead and
+   *    pages of skipped members are never touched
+   */
+  svcsigtar& open( const std::string &filename );
+
+  /* Name: svcsigtar& open( const char *buffer, const size_t &size )
+   *
+   * Description: Opens a tar archive that is already in memory
+   * Arguments: const char *buffer: the start of the archive
+   *            const size_t &size: the number of bytes in the archive
+   * Modifies: Everything
+   * Returns: *this
+   * Pre:
+   * Post: The archive is positioned before the first member
+   * Exceptions:
+   * Notes: The buffer is not copied, it must outlive this object
+   */
+  svcsigtar& open( const char *buffer, const size_t &size );
+
+  /* Name: void close()
+   *
+   * Description: Closes the archive
+   * Arguments:
+   * Modifies: Everything
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Pointers returned by memberData() are invalid after this
+   */
+  void close();
+
+  /* Name: void rewind()
+   *
+   * Description: Positions the archive before the first member
+   * Arguments:
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  void rewind();
+
+  /* Name: bool next()
+   *
+   * Description: Advances to the next .sig member of the archive
+   * Arguments:
+   * Modifies: the current member
+   * Returns: false at the end of the archive
+   * Pre:
+   * Post:
+   * Exceptions: invalidSVCsigTar if a header is corrupt or truncated
+   * Notes: Only the header blocks of other members are read, their payloads
+   *    are skipped
+   */
+  bool next();
+
+  /* Name: std::string memberName() const
+   *
+   * Description: Returns the path of the current member in the archive
+   * Arguments:
+   * Modifies:
+   * Returns: std::string
+   * Pre: next() returned true
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  std::string memberName() const;
+
+  /* Name: const char * memberData() const
+   *
+   * Description: Returns the contents of the current member
+   * Arguments:
+   * Modifies:
+   * Returns: const char *
+   * Pre: next() returned true
+   * Post:
+   * Exceptions:
+   * Notes: This points into the archive, it is not null terminated
+   */
+  const char * memberData() const;
+
+  /* Name: size_t memberSize() const
+   *
+   * Description: Returns the size in bytes of the current member
+   * Arguments:
+   * Modifies:
+   * Returns: size_t
+   * Pre: next() returned true
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  size_t memberSize() const;
+
+  /* Name: svcsig& read( svcsig &sig ) const
+   *
+   * Description: Parses the current member into sig
+   * Arguments: svcsig &sig: the output
+   * Modifies: svcsig &sig
+   * Returns: sig
+   * Pre: next() returned true
+   * Post:
+   * Exceptions:
+   * Notes: The member is parsed straight out of the archive buffer
+   */
+  svcsig& read( svcsig &sig ) const;
+
+  /* Name: std::vector<svcsig> readAll()
+   *
+   * Description: Parses every .sig member of the archive
+   * Arguments:
+   * Modifies: the current member
+   * Returns: std::vector<svcsig>, in archive order
+   * Pre:
+   * Post: The archive is at its end
+   * Exceptions: invalidSVCsigTar if a header is corrupt or truncated
+   * Notes:
+   */
+  std::vector<svcsig> readAll();
+};
+
+
+// --- --- Implimentation --- --- //
+
+// -- -- Constructors -- -- //
+svcsigtar::svcsigtar()
+{
+  _buffer = NULL;
+  _size = 0;
+  _mapped = false;
+  rewind();
+}
+
+svcsigtar::svcsigtar( const std::string &filename )
+{
+  _buffer = NULL;
+  _size = 0;
+  _mapped = false;
+  open( filename );
+}
+
+// -- -- Destructor -- -- //
+svcsigtar::~svcsigtar()
+{
+  close();
+}
+
+// -- -- IO -- -- //
+svcsigtar& svcsigtar::open( const std::string &filename )
+{
+  close();
+
+  int fd( ::open( filename.c_str(), O_RDONLY ) );
+  if ( fd < 0 ) {
+    throw invalidSVCsigTar( "could not open '" + filename + "'" );
+  }
+
+  struct stat st;
+  if ( fstat( fd, &st ) != 0 ) {
+    ::close( fd );
+    throw invalidSVCsigTar( "could not stat '" + filename + "'" );
+  }
+
+  if ( st.st_size > 0 ) {
+    void *map( mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 ) );
+    if ( map == MAP_FAILED ) {
+      ::close( fd );
+      throw invalidSVCsigTar( "could not map '" + filename + "'" );
+    }
+    madvise( map, st.st_size, MADV_SEQUENTIAL );
+    _buffer = static_cast<const char *>( map );
+    _size = st.st_size;
+    _mapped = true;
+  }
+  // the mapping stays valid after the descriptor is closed
+  ::close( fd );
+
+  rewind();
+  return *this;
+}
+
+svcsigtar& svcsigtar::open( const char *buffer, const size_t &size )
+{
+  close();
+  _buffer = buffer;
+  _size = size;
+  _mapped = false;
+  rewind();
+  return *this;
+}
+
+void svcsigtar::close()
+{
+  if ( _mapped ) {
+    munmap( const_cast<char *>( _buffer ), _size );
+  }
+  _buffer = NULL;
+  _size = 0;
+  _mapped = false;
+  rewind();
+}
+
+void svcsigtar::rewind()
+{
+  _offset = 0;
+  _memberName.clear();
+  _memberData = NULL;
+  _memberSize = 0;
+}
+
+bool svcsigtar::next()
+{
+  std::string longName; // from a GNU 'L' or pax 'x' member
+
+  while ( _offset + 512 <= _size ) {
+    const char *header( _buffer + _offset );
+
+    // the archive ends with zero blocks
+    if ( header[ 0 ] == '\0' ) {
+      size_t i( 0 );
+      while ( i < 512 && header[ i ] == '\0' ) {
+        i++;
+      }
+      if ( i == 512 ) {
+        break;
+      }
+    }
+
+    if ( !svcSigTarCheckHeader( header ) ) {
+      throw invalidSVCsigTar( "bad header checksum" );
+    }
+
+    size_t size( svcSigTarParseNumber( header + 124, 12 ) );
+    const char *data( header + 512 );
+    size_t blocks( ( size + 511 ) / 512 );
+    if ( size > _size - _offset - 512 ) {
+      throw invalidSVCsigTar( "truncated member" );
+    }
+    _offset += 512 * ( 1 + blocks );
+
+    char type( header[ 156 ] );
+    if ( type == 'L' ) {
+      // GNU long name for the next member
+      longName.assign( data, strnlen( data, size ) );
+      continue;
+    }
+    if ( type == 'x' ) {
+      // pax extended header for the next member
+      longName = svcSigTarParsePaxPath( data, size );
+      continue;
+    }
+    if ( type != '0' && type != '\0' && type != '7' ) {
+      // directories, links, global pax headers, ...
+      longName.clear();
+      continue;
+    }
+
+    std::string name;
+    if ( longName.size() > 0 ) {
+      name = longName;
+      longName.clear();
+    }
+    else {
+      name.assign( header, strnlen( header, 100 ) );
+      if ( memcmp( header + 257, "ustar\0", 6 ) == 0 && header[ 345 ] != '\0' ) {
+        // POSIX ustar prefix
+        name = std::string( header + 345, strnlen( header + 345, 155 ) ) + "/" + name;
+      }
+    }
+
+    if ( svcSigTarIsSig( name ) ) {
+      _memberName = name;
+      _memberData = data;
+      _memberSize = size;
+      return true;
+    }
+  }
+
+  _offset = _size;
+  _memberName.clear();
+  _memberData = NULL;
+  _memberSize = 0;
+  return false;
+}
+
+svcsig& svcsigtar::read( svcsig &sig ) const
+{
+  return sig.read( _memberData, _memberSize );
+}
+
+std::vector<svcsig> svcsigtar::readAll()
+{
+  std::vector<svcsig> sigs;
+  rewind();
+  while ( next() ) {
+    sigs.push_back( svcsig() );
+    read( sigs.back() );
+  }
+  return sigs;
+}
+
+// -- -- Getters -- -- //
+std::string svcsigtar::memberName() const
+{
+  return _memberName;
+}
+
+const char * svcsigtar::memberData() const
+{
+  return _memberData;
+}
+
+size_t svcsigtar::memberSize() const
+{
+  return _memberSize;
+}
+
+// -- -- Helper Functions -- -- //
+size_t svcsigtar::svcSigTarParseNumber( const char *field, const size_t &length ) const
+{
+  size_t value( 0 );
+  size_t i;
+  if ( static_cast<unsigned char>( field[ 0 ] ) & 0x80 ) {
+    // GNU base-256
+    value = static_cast<unsigned char>( field[ 0 ] ) & 0x7f;
+    for ( i = 1; i < length; i++ ) {
+      value = ( value << 8 ) | static_cast<unsigned char>( field[ i ] );
+    }
+    return value;
+  }
+  for ( i = 0; i < length && field[ i ] == ' '; i++ ) {
+    // skip leading spaces
+  }
+  for ( ; i < length && field[ i ] >= '0' && field[ i ] <= '7'; i++ ) {
+    value = ( value << 3 ) + ( field[ i ] - '0' );
+  }
+  return value;
+}
+
+bool svcsigtar::svcSigTarCheckHeader( const char *header ) const
+{
+  size_t sum( 0 );
+  for ( size_t i = 0; i < 512; i++ ) {
+    if ( i >= 148 && i < 156 ) {
+      sum += ' '; // the checksum field counts as spaces
+    }
+    else {
+      sum += static_cast<unsigned char>( header[ i ] );
+    }
+  }
+  return sum == svcSigTarParseNumber( header + 148, 8 );
+}
+
+std::string svcsigtar::svcSigTarParsePaxPath( const char *data, const size_t &size ) const
+{
+  // records are "<length> <key>=<value>\n"
+  std::string path;
+  size_t pos( 0 );
+  while ( pos < size && data[ pos ] != '\0' ) {
+    size_t length( 0 );
+    size_t i( pos );
+    while ( i < size && data[ i ] >= '0' && data[ i ] <= '9' ) {
+      length = 10 * length + ( data[ i ] - '0' );
+      i++;
+    }
+    if ( pos + length > size || i >= size || data[ i ] != ' ' || pos + length < i + 2 ) {
+      throw invalidSVCsigTar( "bad pax record" );
+    }
+    std::string record( data + i + 1, pos + length - i - 2 ); // drop the '\n'
+    if ( record.compare( 0, 5, "path=" ) == 0 ) {
+      path = record.substr( 5 );
+    }
+    pos += length;
+  }
+  return path;
+}
+
+bool svcsigtar::svcSigTarIsSig( const std::string &name ) const
+{
+  if ( name.size() < 4 ) {
+    return false;
+  }
+  const char *ext( name.c_str() + name.size() - 4 );
+  return ext[ 0 ] == '.'
+    && ( ext[ 1 ] == 's' || ext[ 1 ] == 'S' )
+    && ( ext[ 2 ] == 'i' || ext[ 2 ] == 'I' )
+    && ( ext[ 3 ] == 'g' || ext[ 3 ] == 'G' );
+}
+
+#endif // __svcsigtar_hpp_
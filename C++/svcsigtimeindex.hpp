@@ -0,0 +1,317 @@
+/*******************************************************************************
+ * svcsigtimeindex.hpp
+ *
+ * DESCRIPTION:
+ *    Provides header and implimentation for the svcsigtimeindex class, a sorted
+ *    index of the acquisition times of a collection of sig files (or of a
+ *    svcsigcatalogue) that answers time range and nearest time queries by
+ *    binary search.
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsigtimeindex_hpp_
+#define __svcsigtimeindex_hpp_
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <stdint.h>
+
+#include "svcsig.hpp"
+#include "svcsigcatalogue.hpp"
+
+// which spectrum of each file to index
+#define SVCSIG_TIME_REFERENCE 0
+#define SVCSIG_TIME_TARGET 1
+
+
+class svcsigtimeindex {
+private:
+  // the decoded times (seconds since the epoch, see
+  // svcsigspectraheader::epochTime()) in increasing order, and their ids
+  std::vector<int64_t> _times;
+  std::vector<size_t> _ids;
+  size_t _skipped; // spectra without a valid time
+
+public:
+  /* Name: svcsigtimeindex()
+   *
+   * Description: Constructs an empty index
+   * Arguments:
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  svcsigtimeindex();
+
+  /* Name: svcsigtimeindex& build( const std::vector<svcsig> &sigs, const int &spectrum )
+   *
+   * Description: Indexes the acquisition times of a collection
+   * Arguments: const std::vector<svcsig> &sigs: the collection
+   *            const int &spectrum: SVCSIG_TIME_TARGET (default) or
+   *                SVCSIG_TIME_REFERENCE
+   * Modifies: Everything
+   * Returns: *this
+   * Pre:
+   * Post: Query results are positions in sigs
+   * Exceptions:
+   * Notes: Spectra whose time could not be decoded are skipped and counted by
+   *    skipped()
+   */
+  svcsigtimeindex& build( const std::vector<svcsig> &sigs, const int &spectrum = SVCSIG_TIME_TARGET );
+
+  /* Name: svcsigtimeindex& build( const svcsigcatalogue &catalogue, const int &spectrum )
+   *
+   * Description: Indexes the acquisition times of a catalogue
+   * Arguments: const svcsigcatalogue &catalogue: the catalogue
+   *            const int &spectrum: SVCSIG_TIME_TARGET (default) or
+   *                SVCSIG_TIME_REFERENCE
+   * Modifies: Everything
+   * Returns: *this
+   * Pre:
+   * Post: Query results are entries of catalogue
+   * Exceptions:
+   * Notes: The catalogue stores decoded times, so nothing is parsed
+   */
+  svcsigtimeindex& build( const svcsigcatalogue &catalogue, const int &spectrum = SVCSIG_TIME_TARGET );
+
+  /* Name: svcsigtimeindex& build( const std::vector<int64_t> &times )
+   *
+   * Description: Indexes decoded times
+   * Arguments: const std::vector<int64_t> &times: the times
+   * Modifies: Everything
+   * Returns: *this
+   * Pre:
+   * Post: Query results are positions in times
+   * Exceptions:
+   * Notes: SVCSIG_TIME_INVALID times are skipped
+   */
+  svcsigtimeindex& build( const std::vector<int64_t> &times );
+
+  /* Name: size_t size() const
+   *
+   * Description: Returns the number of indexed times
+   * Arguments:
+   * Modifies:
+   * Returns: size_t
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  size_t size() const;
+
+  /* Name: size_t skipped() const
+   *
+   * Description: Returns the number of spectra that were not indexed because
+   *    their time could not be decoded
+   * Arguments:
+   * Modifies:
+   * Returns: size_t
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  size_t skipped() const;
+
+  /* Name: size_t count( const int64_t &begin, const int64_t &end ) const
+   *
+   * Description: Counts the spectra acquired in [begin, end]
+   * Arguments: const int64_t &begin, &end: the range (seconds since the epoch)
+   * Modifies:
+   * Returns: size_t
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: O( log n )
+   */
+  size_t count( const int64_t &begin, const int64_t &end ) const;
+
+  /* Name: std::vector<size_t> range( const int64_t &begin, const int64_t &end ) const
+   *
+   * Description: Finds the spectra acquired in [begin, end]
+   * Arguments: const int64_t &begin, &end: the range (seconds since the epoch)
+   * Modifies:
+   * Returns: std::vector<size_t> of ids, in time order
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  std::vector<size_t> range( const int64_t &begin, const int64_t &end ) const;
+
+  /* Name: std::vector<size_t> nearest( const int64_t &time, const size_t &k ) const
+   *
+   * Description: Finds the k spectra acquired nearest to a time
+   * Arguments: const int64_t &time: the time (seconds since the epoch)
+   *            const size_t &k: the number of spectra (default 1)
+   * Modifies:
+   * Returns: std::vector<size_t> of ids, nearest first (earlier first on ties)
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: e.g. the reference panel scans nearest to a target
+   */
+  std::vector<size_t> nearest( const int64_t &time, const size_t &k = 1 ) const;
+
+  /* Name: int64_t time( const size_t &id ) const
+   *
+   * Description: Returns the indexed time of an id
+   * Arguments: const size_t &id: the id
+   * Modifies:
+   * Returns: int64_t, SVCSIG_TIME_INVALID if id is not indexed
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: O( n ), this is for reporting, not for queries
+   */
+  int64_t time( const size_t &id ) const;
+};
+
+
+// --- --- Implimentation --- --- //
+
+// -- -- Constructors -- -- //
+svcsigtimeindex::svcsigtimeindex()
+{
+  _skipped = 0;
+}
+
+// -- -- Build -- -- //
+svcsigtimeindex& svcsigtimeindex::build( const std::vector<svcsig> &sigs, const int &spectrum )
+{
+  std::vector<int64_t> times( sigs.size() );
+  for ( size_t i = 0; i < sigs.size(); i++ ) {
+    times[ i ] = ( spectrum == SVCSIG_TIME_REFERENCE ) ? sigs[ i ].referenceEpochTime() : sigs[ i ].targetEpochTime();
+  }
+  return build( times );
+}
+
+svcsigtimeindex& svcsigtimeindex::build( const svcsigcatalogue &catalogue, const int &spectrum )
+{
+  std::vector<int64_t> times( catalogue.size() );
+  for ( size_t i = 0; i < catalogue.size(); i++ ) {
+    const svcsigcatalogueentry &e( catalogue.entry( i ) );
+    times[ i ] = ( spectrum == SVCSIG_TIME_REFERENCE ) ? e.reference.epoch : e.target.epoch;
+  }
+  return build( times );
+}
+
+svcsigtimeindex& svcsigtimeindex::build( const std::vector<int64_t> &times )
+{
+  std::vector<std::pair<int64_t, size_t> > order;
+  order.reserve( times.size() );
+  for ( size_t i = 0; i < times.size(); i++ ) {
+    if ( times[ i ] != SVCSIG_TIME_INVALID ) {
+      order.push_back( std::make_pair( times[ i ], i ) );
+    }
+  }
+  // pairs sort by time, then id, so equal times keep their input order
+  std::sort( order.begin(), order.end() );
+
+  _skipped = times.size() - order.size();
+  _times.resize( order.size() );
+  _ids.resize( order.size() );
+  for ( size_t i = 0; i < order.size(); i++ ) {
+    _times[ i ] = order[ i ].first;
+    _ids[ i ] = order[ i ].second;
+  }
+  return *this;
+}
+
+// -- -- Getters -- -- //
+size_t svcsigtimeindex::size() const
+{
+  return _times.size();
+}
+
+size_t svcsigtimeindex::skipped() const
+{
+  return _skipped;
+}
+
+int64_t svcsigtimeindex::time( const size_t &id ) const
+{
+  for ( size_t i = 0; i < _ids.size(); i++ ) {
+    if ( _ids[ i ] == id ) {
+      return _times[ i ];
+    }
+  }
+  return SVCSIG_TIME_INVALID;
+}
+
+// -- -- Queries -- -- //
+size_t svcsigtimeindex::count( const int64_t &begin, const int64_t &end ) const
+{
+  if ( end < begin ) {
+    return 0;
+  }
+  return std::upper_bound( _times.begin(), _times.end(), end ) - std::lower_bound( _times.begin(), _times.end(), begin );
+}
+
+std::vector<size_t> svcsigtimeindex::range( const int64_t &begin, const int64_t &end ) const
+{
+  if ( end < begin ) {
+    return std::vector<size_t>();
+  }
+  size_t first( std::lower_bound( _times.begin(), _times.end(), begin ) - _times.begin() );
+  size_t last( std::upper_bound( _times.begin() + first, _times.end(), end ) - _times.begin() );
+  return std::vector<size_t>( _ids.begin() + first, _ids.begin() + last );
+}
+
+std::vector<size_t> svcsigtimeindex::nearest( const int64_t &time, const size_t &k ) const
+{
+  std::vector<size_t> ids;
+  // grow a window out from the insertion point, taking the nearer side
+  size_t right( std::lower_bound( _times.begin(), _times.end(), time ) - _times.begin() );
+  size_t left( right );
+  while ( ids.size() < k && ( left > 0 || right < _times.size() ) ) {
+    if ( right == _times.size() || ( left > 0 && time - _times[ left - 1 ] <= _times[ right ] - time ) ) {
+      left--;
+      ids.push_back( _ids[ left ] );
+    }
+    else {
+      ids.push_back( _ids[ right ] );
+      right++;
+    }
+  }
+  return ids;
+}
+
+#endif // __svcsigtimeindex_hpp_
@@ -0,0 +1,579 @@
+/*******************************************************************************
+ * svcsigwatch.hpp
+ *
+ * DESCRIPTION:
+ *    Provides header and implimentation for the svcsigwatch class, which
+ *    watches directories with inotify (Linux) and parses each sig file as it
+ *    lands, handing it to a svcsigwatchhandler.
+ *
+ *    Files are picked up when they are closed after writing (IN_CLOSE_WRITE)
+ *    or moved in (IN_MOVED_TO), then held until they have been quiet for the
+ *    debounce time, so a file that is written in several passes is parsed
+ *    once, complete.
+ *
+ *    Each event carries the time the file was last written (its mtime), the
+ *    time it was seen and the time it was parsed, and the watch keeps the
+ *    latency from the file being seen to the handler call. (The mtime is
+ *    only informational: rsync -a and Syncthing keep the source's.)
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *    2026-10-18: Latency is measured from detection, not the mtime
+ *    2026-10-18: stop() before run() is no longer lost
+ *    2026-10-18: Latency stops before the handler, not after it
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *   inotify(7)
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#ifndef __svcsigwatch_hpp_
+#define __svcsigwatch_hpp_
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <dirent.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+
+#include "svcsighelper.hpp"
+#include "svcsig.hpp"
+
+// how long a file must be quiet before it is parsed, in ms
+#define SVCSIG_WATCH_DEBOUNCE 50
+
+
+/* Name: int64_t svcSigWatchNow()
+ *
+ * Description: Returns the wall clock time, in the units of the
+ *    svcsigwatchevent times
+ * Arguments:
+ * Modifies:
+ * Returns: int64_t ns since the epoch
+ * Pre:
+ * Post:
+ * Exceptions:
+ * Notes: Call it in a handler to measure the full latency of a file
+ */
+int64_t svcSigWatchNow()
+{
+  struct timespec now;
+  clock_gettime( CLOCK_REALTIME, &now );
+  return int64_t( now.tv_sec ) * 1000000000 + now.tv_nsec;
+}
+
+
+// a parsed sig file. Times are ns since the epoch (see svcSigWatchNow()).
+struct svcsigwatchevent {
+  std::string path;
+  svcsig sig;
+  int64_t written; // the mtime of the file (informational, a sync may keep the source's)
+  int64_t detected; // when inotify first reported the file
+  int64_t parsed; // when parsing finished, just before the handler is called
+};
+
+
+/* Name: svcsigwatchhandler
+ *
+ * Description: Receives the sig files found by a svcsigwatch
+ * Notes: arrived() is called from the thread running svcsigwatch::poll() or
+ *    run(). Exceptions thrown by it leave poll() or run().
+ */
+class svcsigwatchhandler {
+public:
+  virtual ~svcsigwatchhandler() {}
+  virtual void arrived( svcsigwatchevent &event ) = 0;
+};
+
+
+// the filter used when none is given: every valid sig file
+class svcsigwatchall : public svcsigfilter {
+public:
+  bool accept( const svcsig & ) const { return true; }
+};
+
+
+class svcsigwatch {
+private:
+  // a file waiting to be quiet
+  struct pending {
+    int64_t due; // when to look at it again (steady clock, ns)
+    int64_t detected;
+    off_t size;
+    int64_t mtime;
+  };
+  
+  svcsigwatchhandler &_handler;
+  const svcsigfilter *_filter;
+  int _debounce; // ms
+  int _inotify;
+  int _wake; // eventfd written by stop()
+  std::atomic<bool> _stopping;
+  std::map<int, std::string> _directories; // by watch descriptor
+  std::map<int, bool> _recursive;
+  std::map<std::string, pending> _pending;
+  
+  // latency counters (detection to the handler call), ns
+  size_t _count;
+  int64_t _totalLatency;
+  int64_t _maxLatency;
+  
+  svcsigwatch( const svcsigwatch &other );
+  svcsigwatch& operator=( const svcsigwatch &other );
+  
+  /* Name: void svcSigWatchQueue( const std::string &path, const int64_t &detected )
+   *
+   * Description: Starts (or restarts) the debounce of a file
+   * Arguments: const std::string &path: the file
+   *            const int64_t &detected: when it was seen
+   * Modifies: _pending
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Files that are not .sig, .sig.gz or .sig.zst are ignored
+   */
+  void svcSigWatchQueue( const std::string &path, const int64_t &detected );
+  
+  /* Name: void svcSigWatchScan( const std::string &directory )
+   *
+   * Description: Queues the sig files already in a new directory, which may
+   *    have been written before its watch was added
+   * Arguments: const std::string &directory: the directory
+   * Modifies: _pending
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  void svcSigWatchScan( const std::string &directory );
+  
+  /* Name: size_t svcSigWatchDue()
+   *
+   * Description: Parses the pending files that have been quiet for the debounce
+   *    time and calls the handler
+   * Arguments:
+   * Modifies: _pending, the latency counters
+   * Returns: size_t, the number of handler calls
+   * Pre:
+   * Post:
+   * Exceptions: Anything thrown by the handler
+   * Notes:
+   */
+  size_t svcSigWatchDue();
+  
+  /* Name: int64_t svcSigWatchSteady() const
+   *
+   * Description: Returns the monotonic clock in ns, for the debounce timers
+   */
+  int64_t svcSigWatchSteady() const;
+
+public:
+  /* Name: svcsigwatch( svcsigwatchhandler &handler, const int &debounce )
+   *
+   * Description: Creates a watch
+   * Arguments: svcsigwatchhandler &handler: receives the parsed files
+   *            const int &debounce: how long (ms) a file must be quiet
+   * Modifies:
+   * Returns:
+   * Pre: handler outlives the watch
+   * Post:
+   * Exceptions: std::runtime_error if inotify is not available
+   * Notes:
+   */
+  svcsigwatch( svcsigwatchhandler &handler, const int &debounce = SVCSIG_WATCH_DEBOUNCE );
+  
+  /* Name: ~svcsigwatch()
+   *
+   * Description: Removes the watches
+   */
+  ~svcsigwatch();
+  
+  /* Name: svcsigwatch& add( const std::string &directory, const bool &recursive )
+   *
+   * Description: Watches a directory
+   * Arguments: const std::string &directory: the directory
+   *            const bool &recursive: also watch its sub directories,
+   *                including ones created later
+   * Modifies:
+   * Returns: *this
+   * Pre:
+   * Post:
+   * Exceptions: std::runtime_error if the directory can not be watched
+   * Notes: Files already in directory are not reported
+   */
+  svcsigwatch& add( const std::string &directory, const bool &recursive = false );
+  
+  /* Name: svcsigwatch& filter( const svcsigfilter *filter )
+   *
+   * Description: Only reports files whose header passes a filter (e.g. a
+   *    svcsigquery); the data of other files is not read
+   * Arguments: const svcsigfilter *filter: the filter, or NULL for all files
+   * Modifies:
+   * Returns: *this
+   * Pre: filter outlives the watch
+   * Post:
+   * Exceptions:
+   * Notes:
+   */
+  svcsigwatch& filter( const svcsigfilter *filter );
+  
+  /* Name: size_t poll( const int &timeout )
+   *
+   * Description: Waits for files, and reports the ones that are ready
+   * Arguments: const int &timeout: the longest wait in ms, -1 for no limit
+   * Modifies:
+   * Returns: size_t, the number of files reported
+   * Pre:
+   * Post:
+   * Exceptions: Anything thrown by the handler
+   * Notes: Returns early once a file is reported or stop() is called, and at
+   *    once after stop()
+   */
+  size_t poll( const int &timeout );
+  
+  /* Name: void run()
+   *
+   * Description: Reports files until stop() is called
+   * Arguments:
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions: Anything thrown by the handler
+   * Notes: Returns at once if stop() was called before it, e.g. by another
+   *    thread before this one got here
+   */
+  void run();
+  
+  /* Name: void stop()
+   *
+   * Description: Makes run() return
+   * Arguments:
+   * Modifies:
+   * Returns:
+   * Pre:
+   * Post:
+   * Exceptions:
+   * Notes: Safe to call from another thread or from the handler, before or
+   *    during run(). A stopped watch stays stopped.
+   */
+  void stop();
+  
+  /* Name: size_t count() const
+   *
+   * Description: Returns the number of files reported
+   */
+  size_t count() const;
+  
+  /* Name: double meanLatency() const, double maxLatency() const
+   *
+   * Description: Return the mean and largest time, in seconds, from a file
+   *    being seen (its inotify event, or the scan of a new watch) to its
+   *    handler call
+   * Notes: This includes the debounce time and parsing, but not the time
+   *    spent in the handler
+   */
+  double meanLatency() const;
+  double maxLatency() const;
+};
+
+
+// --- --- Implimentation --- --- //
+
+// -- -- Constructors -- -- //
+svcsigwatch::svcsigwatch( svcsigwatchhandler &handler, const int &debounce )
+: _handler( handler ), _filter( NULL ), _debounce( debounce ), _stopping( false ), _count( 0 ), _totalLatency( 0 ), _maxLatency( 0 )
+{
+  _inotify = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+  _wake = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+  if ( _inotify < 0 || _wake < 0 ) {
+    if ( _inotify >= 0 ) {
+      close( _inotify );
+    }
+    if ( _wake >= 0 ) {
+      close( _wake );
+    }
+    throw std::runtime_error( "svcsigwatch: inotify is not available" );
+  }
+}
+
+svcsigwatch::~svcsigwatch()
+{
+  close( _inotify );
+  close( _wake );
+}
+
+// -- -- Setup -- -- //
+svcsigwatch& svcsigwatch::add( const std::string &directory, const bool &recursive )
+{
+  uint32_t mask( IN_CLOSE_WRITE | IN_MOVED_TO | IN_ONLYDIR );
+  if ( recursive ) {
+    mask |= IN_CREATE;
+  }
+  int wd( inotify_add_watch( _inotify, directory.c_str(), mask ) );
+  if ( wd < 0 ) {
+    throw std::runtime_error( "svcsigwatch: can not watch '" + directory + "'" );
+  }
+  _directories[ wd ] = directory;
+  _recursive[ wd ] = recursive;
+  
+  if ( recursive ) {
+    DIR *dir( opendir( directory.c_str() ) );
+    struct dirent *item;
+    while ( dir != NULL && ( item = readdir( dir ) ) != NULL ) {
+      std::string name( item->d_name );
+      struct stat st;
+      if ( name.compare( "." ) != 0 && name.compare( ".." ) != 0 && lstat( ( directory + "/" + name ).c_str(), &st ) == 0 && S_ISDIR( st.st_mode ) ) {
+        add( directory + "/" + name, true );
+      }
+    }
+    if ( dir != NULL ) {
+      closedir( dir );
+    }
+  }
+  return *this;
+}
+
+svcsigwatch& svcsigwatch::filter( const svcsigfilter *filter )
+{
+  _filter = filter;
+  return *this;
+}
+
+// -- -- Watching -- -- //
+size_t svcsigwatch::poll( const int &timeout )
+{
+  int64_t start( svcSigWatchSteady() );
+  while ( !_stopping ) {
+    // wait for an event, the next debounce, or the timeout
+    int64_t now( svcSigWatchSteady() );
+    int64_t wait( timeout < 0 ? -1 : std::max( int64_t( 0 ), start + int64_t( timeout ) * 1000000 - now ) );
+    for ( std::map<std::string, pending>::const_iterator it = _pending.begin(); it != _pending.end(); ++it ) {
+      int64_t until( std::max( int64_t( 0 ), it->second.due - now ) );
+      wait = ( wait < 0 ) ? until : std::min( wait, until );
+    }
+    
+    struct pollfd fds[ 2 ] = { { _inotify, POLLIN, 0 }, { _wake, POLLIN, 0 } };
+    // round up, so the debounce has passed when poll returns
+    int ms( wait < 0 ? -1 : int( ( wait + 999999 ) / 1000000 ) );
+    if ( ::poll( fds, 2, ms ) < 0 && errno != EINTR ) {
+      throw std::runtime_error( "svcsigwatch: poll failed" );
+    }
+    
+    if ( fds[ 0 ].revents & POLLIN ) {
+      int64_t detected( svcSigWatchNow() );
+      char buffer[ 65536 ] __attribute__ ( ( aligned( __alignof__( struct inotify_event ) ) ) );
+      ssize_t n;
+      while ( ( n = read( _inotify, buffer, sizeof( buffer ) ) ) > 0 ) {
+        for ( char *p = buffer; p < buffer + n; p += sizeof( struct inotify_event ) + reinterpret_cast<struct inotify_event *>( p )->len ) {
+          const struct inotify_event *event( reinterpret_cast<struct inotify_event *>( p ) );
+          if ( event->mask & IN_Q_OVERFLOW ) {
+            std::cerr << "svcsigwatch: inotify queue overflow, files may have been missed" << std::endl;
+            continue;
+          }
+          std::map<int, std::string>::const_iterator dir( _directories.find( event->wd ) );
+          if ( dir == _directories.end() || event->len == 0 ) {
+            continue;
+          }
+          std::string path( dir->second + "/" + event->name );
+          if ( event->mask & IN_ISDIR ) {
+            if ( _recursive[ event->wd ] && ( event->mask & ( IN_CREATE | IN_MOVED_TO ) ) ) {
+              try {
+                add( path, true );
+                svcSigWatchScan( path );
+              } catch ( std::runtime_error &e ) {
+                std::cerr << e.what() << std::endl;
+              }
+            }
+          }
+          else if ( event->mask & ( IN_CLOSE_WRITE | IN_MOVED_TO ) ) {
+            svcSigWatchQueue( path, detected );
+          }
+        }
+      }
+    }
+    if ( fds[ 1 ].revents & POLLIN ) {
+      uint64_t value;
+      if ( read( _wake, &value, sizeof( value ) ) < 0 ) {
+        // nothing to do, it only wakes poll()
+      }
+    }
+    
+    size_t reported( svcSigWatchDue() );
+    if ( reported > 0 || ( timeout >= 0 && svcSigWatchSteady() - start >= int64_t( timeout ) * 1000000 ) ) {
+      return reported;
+    }
+  }
+  return 0;
+}
+
+void svcsigwatch::run()
+{
+  while ( !_stopping ) {
+    poll( -1 );
+  }
+}
+
+void svcsigwatch::stop()
+{
+  _stopping = true;
+  uint64_t one( 1 );
+  if ( write( _wake, &one, sizeof( one ) ) < 0 ) {
+    // the eventfd is already signalled
+  }
+}
+
+// -- -- Getters -- -- //
+size_t svcsigwatch::count() const
+{
+  return _count;
+}
+
+double svcsigwatch::meanLatency() const
+{
+  return _count > 0 ? _totalLatency / double( _count ) / 1e9 : 0.0;
+}
+
+double svcsigwatch::maxLatency() const
+{
+  return _maxLatency / 1e9;
+}
+
+// -- -- Helper Functions -- -- //
+void svcsigwatch::svcSigWatchQueue( const std::string &path, const int64_t &detected )
+{
+  size_t loc( path.rfind( ".sig" ) );
+  if ( loc == std::string::npos ) {
+    return;
+  }
+  std::string extension( path.substr( loc ) );
+  if ( extension.compare( ".sig" ) != 0 && extension.compare( ".sig.gz" ) != 0 && extension.compare( ".sig.zst" ) != 0 ) {
+    return;
+  }
+  
+  std::map<std::string, pending>::iterator it( _pending.find( path ) );
+  if ( it == _pending.end() ) {
+    pending p = { 0, detected, -1, -1 };
+    it = _pending.insert( std::make_pair( path, p ) ).first;
+  }
+  it->second.due = svcSigWatchSteady() + int64_t( _debounce ) * 1000000;
+}
+
+void svcsigwatch::svcSigWatchScan( const std::string &directory )
+{
+  DIR *dir( opendir( directory.c_str() ) );
+  if ( dir == NULL ) {
+    return;
+  }
+  int64_t detected( svcSigWatchNow() );
+  struct dirent *item;
+  while ( ( item = readdir( dir ) ) != NULL ) {
+    std::string path( directory + "/" + item->d_name );
+    struct stat st;
+    if ( stat( path.c_str(), &st ) == 0 && S_ISREG( st.st_mode ) ) {
+      svcSigWatchQueue( path, detected );
+    }
+  }
+  closedir( dir );
+}
+
+size_t svcsigwatch::svcSigWatchDue()
+{
+  size_t reported( 0 );
+  int64_t now( svcSigWatchSteady() );
+  std::map<std::string, pending>::iterator it( _pending.begin() );
+  while ( it != _pending.end() ) {
+    if ( it->second.due > now ) {
+      ++it;
+      continue;
+    }
+    
+    // the file must not have changed since the last look
+    struct stat st;
+    if ( stat( it->first.c_str(), &st ) != 0 ) {
+      _pending.erase( it++ ); // removed again
+      continue;
+    }
+    int64_t mtime( int64_t( st.st_mtim.tv_sec ) * 1000000000 + st.st_mtim.tv_nsec );
+    if ( st.st_size != it->second.size || mtime != it->second.mtime ) {
+      it->second.size = st.st_size;
+      it->second.mtime = mtime;
+      if ( svcSigWatchNow() - mtime < int64_t( _debounce ) * 1000000 ) {
+        it->second.due = now + int64_t( _debounce ) * 1000000;
+        ++it;
+        continue;
+      }
+    }
+    
+    svcsigwatchevent event;
+    event.path = it->first;
+    event.written = mtime;
+    event.detected = it->second.detected;
+    _pending.erase( it++ );
+    
+    // (a file that is not a sig file is reported to std::cerr and skipped)
+    static const svcsigwatchall all;
+    if ( !event.sig.read( event.path, _filter != NULL ? *_filter : all ) ) {
+      continue;
+    }
+    event.parsed = svcSigWatchNow();
+    
+    // the time in the handler is the caller's, not the watch's
+    int64_t latency( event.parsed - event.detected );
+    _count++;
+    _totalLatency += latency;
+    _maxLatency = std::max( _maxLatency, latency );
+    reported++;
+    
+    _handler.arrived( event );
+  }
+  return reported;
+}
+
+int64_t svcsigwatch::svcSigWatchSteady() const
+{
+  struct timespec now;
+  clock_gettime( CLOCK_MONOTONIC, &now );
+  return int64_t( now.tv_sec ) * 1000000000 + now.tv_nsec;
+}
+
+#endif // __svcsigwatch_hpp_
@@ -0,0 +1,792 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "svcsig.hpp"
+#include "svcsigann.hpp"
+#include "svcsigbatch.hpp"
+#include "svcsigenvi.hpp"
+#include "svcsiglibrary.hpp"
+#include "svcsignumpy.hpp"
+#include "svcsigquantile.hpp"
+#include "svcsigresample.hpp"
+#include "svcsigsavgol.hpp"
+#include "svcsigsrf.hpp"
+
+void svctest_usage( void )
+{
+  std::cout << "svctest" << std::endl;
+  std::cout << "\tChecks the svcsig kernels against reference results" << std::endl;
+  std::cout << std::endl;
+  std::cout << "Usage: svctest [-t test] filename.sig ..." << std::endl;
+  std::cout << "\tt:\tThe test to run (default all): srf, ann, quantile, savgol, envi, numpy" << std::endl;
+  std::cout << "\tsrf:\tBand simulation against numerical integration of the" << std::endl;
+  std::cout << "\t\tresponse times the spectrum, linear between bands" << std::endl;
+  std::cout << "\tann:\tApproximate search against exact search of a library of" << std::endl;
+  std::cout << "\t\trandom mixtures of the files" << std::endl;
+  std::cout << "\tquantile:\tRank error of the quantile sketches, streamed and" << std::endl;
+  std::cout << "\t\tmerged, against the sorted columns of the mixtures" << std::endl;
+  std::cout << "\tsavgol:\tSavitzky-Golay filters against the tabulated convolutions" << std::endl;
+  std::cout << "\t\ton a uniform grid, and polynomials on the files' grids" << std::endl;
+  std::cout << "\tenvi:\tENVI spectral libraries of the files, read back against" << std::endl;
+  std::cout << "\t\tthe spliced and resampled spectra" << std::endl;
+  std::cout << "\tnumpy:\tNumPy libraries (.npy directory and .npz) of the files," << std::endl;
+  std::cout << "\t\tread back against the files and resampled spectra" << std::endl;
+  std::cout << "\tThe files should be on one HR-1024i grid, e.g. ../../data/*.sig" << std::endl;
+  return;
+};
+
+// prints a failure and returns 1, or returns 0
+size_t svctest_check( const bool &ok, const std::string &what )
+{
+  if ( ok ) {
+    return 0;
+  }
+  std::cout << "  FAIL: " << what << std::endl;
+  return 1;
+}
+
+// true if a is within tolerance of b, relative to b (or absolute below 1)
+bool svctest_same( const float &a, const float &b )
+{
+  return a == b || ( a != a && b != b );
+}
+
+bool svctest_close( const double &a, const double &b, const double &tolerance )
+{
+  return std::fabs( a - b ) <= tolerance * std::max( 1.0, std::fabs( b ) );
+}
+
+// a sig file with its wavelengths moved by shift, parsed from memory
+svcsig svctest_shifted( const std::string &filename, const double &shift )
+{
+  std::ifstream input( filename.c_str() );
+  std::ostringstream text;
+  std::string line;
+  bool data( false );
+  while ( std::getline( input, line ) ) {
+    if ( data ) {
+      std::istringstream values( line );
+      double wavelength;
+      values >> wavelength;
+      text.precision( 10 );
+      text << wavelength + shift << values.rdbuf() << "\n";
+    }
+    else {
+      text << line << "\n";
+      data = line.compare( 0, 5, "data=" ) == 0;
+    }
+  }
+  std::string buffer( text.str() );
+  svcsig sig;
+  sig.read( buffer.data(), buffer.size() );
+  return sig;
+}
+
+// size random mixtures of the files, with a little noise, on grid
+std::vector<float> svctest_library( const std::vector<svcsig> &sigs, const std::vector<float> &grid, const size_t &size )
+{
+  svcsiglibrary files;
+  files.build( sigs, grid );
+  std::mt19937 random( 1 );
+  std::exponential_distribution<float> abundance;
+  std::uniform_real_distribution<float> noise( -0.05f, 0.05f );
+  std::vector<float> library( size * grid.size(), 0.0f );
+  std::vector<float> mixture( sigs.size() );
+  for ( size_t s = 0; s < size; s++ ) {
+    float total( 0.0f );
+    for ( size_t f = 0; f < sigs.size(); f++ ) {
+      mixture[ f ] = abundance( random );
+      total += mixture[ f ];
+    }
+    float *spectrum( &library[ s * grid.size() ] );
+    for ( size_t f = 0; f < sigs.size(); f++ ) {
+      for ( size_t j = 0; j < grid.size(); j++ ) {
+        spectrum[ j ] += mixture[ f ] / total * files.row( f )[ j ];
+      }
+    }
+    for ( size_t j = 0; j < grid.size(); j++ ) {
+      spectrum[ j ] += noise( random );
+    }
+  }
+  return library;
+}
+
+// -- -- srf -- -- //
+// a band, by the integral of its response against the spectrum (linear
+// between the bands, which must not overlap within [first, last]) over the
+// part of [first, last] inside the grid
+double svctest_srf_reference( const svcsig &sig, const double &center, const double &fwhm, const std::vector<double> &table )
+{
+  std::vector< std::pair<double, double> > spectrum;
+  for ( size_t i = 0; i < sig.size(); i++ ) {
+    spectrum.push_back( std::make_pair( sig.wavelengthData()[ i ], sig.targetReflectanceData()[ i ] ) );
+  }
+  std::sort( spectrum.begin(), spectrum.end() );
+  double first( fwhm > 0.0 ? center - 3.0 * fwhm : table.front() );
+  double last( fwhm > 0.0 ? center + 3.0 * fwhm : table[ table.size() - 2 ] );
+  first = std::max( first, spectrum.front().first );
+  last = std::min( last, spectrum.back().first );
+  const double step( 0.001 );
+  double sum( 0.0 ), weights( 0.0 );
+  size_t k( 0 );
+  for ( double x = first + 0.5 * step; x < last; x += step ) {
+    double r;
+    if ( fwhm > 0.0 ) {
+      r = std::exp( -4.0 * std::log( 2.0 ) * ( x - center ) * ( x - center ) / ( fwhm * fwhm ) );
+    }
+    else {
+      // table is wavelength, response pairs
+      size_t j( 0 );
+      while ( j + 3 < table.size() && table[ j + 2 ] < x ) {
+        j += 2;
+      }
+      double s( ( x - table[ j ] ) / ( table[ j + 2 ] - table[ j ] ) );
+      r = ( 1.0 - s ) * table[ j + 1 ] + s * table[ j + 3 ];
+    }
+    while ( k + 2 < spectrum.size() && spectrum[ k + 1 ].first < x ) {
+      k++;
+    }
+    double s( ( x - spectrum[ k ].first ) / ( spectrum[ k + 1 ].first - spectrum[ k ].first ) );
+    sum += r * ( ( 1.0 - s ) * spectrum[ k ].second + s * spectrum[ k + 1 ].second );
+    weights += r;
+  }
+  return sum / weights;
+}
+
+size_t svctest_srf( const std::vector<std::string> &filenames )
+{
+  // bands clear of the detector overlaps (about 975-1010 and 1880-1905 nm):
+  // OLI 1-6 and MSI 5 and 9 as Gaussians, and a triangle from a table
+  const double gaussian[][ 2 ] = { { 443, 16 }, { 482, 60 }, { 561, 57 }, { 655, 38 }, { 865, 28 }, { 1609, 85 }, { 704, 15 }, { 945, 20 } };
+  const size_t gaussians( sizeof( gaussian ) / sizeof( gaussian[ 0 ] ) );
+  std::vector<double> triangle = { 600, 0, 650, 1, 700, 0 };
+  svcsigbandset set( "test" );
+  for ( size_t b = 0; b < gaussians; b++ ) {
+    set.gaussian( "G" + std::to_string( b + 1 ), gaussian[ b ][ 0 ], gaussian[ b ][ 1 ] );
+  }
+  set.add( "T", std::vector<double>( { 600, 650, 700 } ), std::vector<double>( { 0, 1, 0 } ) );
+  set.gaussian( "outside", 3000, 20 );
+  svcsigsrf srf;
+  srf.add( set );
+  size_t failures( 0 );
+
+  // the files, a copy of the first on another grid, and an empty file
+  std::vector<svcsig> sigs( svcSigReadBatch( filenames ) );
+  sigs.push_back( svctest_shifted( filenames[ 0 ], 0.37 ) );
+  sigs.push_back( svcsig() );
+  std::vector<float> out( srf.apply( sigs, SVCSIG_SPECTRUM_TARGET_REFLECTANCE, 2 ) );
+  failures += svctest_check( out.size() == sigs.size() * srf.size(), "apply( sigs ) has a row per file" );
+  for ( size_t i = 0; i + 1 < sigs.size(); i++ ) {
+    const float *row( &out[ i * srf.size() ] );
+    for ( size_t b = 0; b < gaussians; b++ ) {
+      double expected( svctest_srf_reference( sigs[ i ], gaussian[ b ][ 0 ], gaussian[ b ][ 1 ], triangle ) );
+      failures += svctest_check( svctest_close( row[ b ], expected, 1e-4 ),
+        "file " + std::to_string( i ) + " band " + srf.bandName( b ) + ": " + std::to_string( row[ b ] ) + ", expected " + std::to_string( expected ) );
+    }
+    double expected( svctest_srf_reference( sigs[ i ], 0.0, 0.0, triangle ) );
+    failures += svctest_check( svctest_close( row[ gaussians ], expected, 1e-4 ),
+      "file " + std::to_string( i ) + " table band: " + std::to_string( row[ gaussians ] ) + ", expected " + std::to_string( expected ) );
+    failures += svctest_check( std::isnan( row[ gaussians + 1 ] ), "file " + std::to_string( i ) + ": a band outside the grid is NAN" );
+
+    // the matrix path gives the same row
+    std::vector<float> single( srf.size() );
+    srf.apply( sigs[ i ].wavelength(), sigs[ i ].targetReflectanceData(), single.data(), 1, 1 );
+    for ( size_t b = 0; b < gaussians + 1; b++ ) {
+      failures += svctest_check( single[ b ] == row[ b ], "file " + std::to_string( i ) + " band " + srf.bandName( b ) + ": apply( grid ) differs from apply( sigs )" );
+    }
+  }
+  for ( size_t b = 0; b < srf.size(); b++ ) {
+    failures += svctest_check( std::isnan( out[ ( sigs.size() - 1 ) * srf.size() + b ] ), "an empty file is a row of NAN" );
+  }
+
+  // a linear spectrum is its value at the center of a symmetric band
+  std::vector<float> linear( sigs[ 0 ].size() );
+  for ( size_t i = 0; i < linear.size(); i++ ) {
+    linear[ i ] = 10.0f + 0.01f * sigs[ 0 ].wavelengthData()[ i ];
+  }
+  std::vector<float> simulated( srf.size() );
+  srf.apply( sigs[ 0 ].wavelength(), linear.data(), simulated.data(), 1, 1 );
+  for ( size_t b = 0; b < gaussians; b++ ) {
+    failures += svctest_check( svctest_close( simulated[ b ], 10.0 + 0.01 * gaussian[ b ][ 0 ], 1e-5 ), "linear spectrum, band " + srf.bandName( b ) );
+  }
+  failures += svctest_check( svctest_close( simulated[ gaussians ], 16.5, 1e-5 ), "linear spectrum, table band" );
+  return failures;
+}
+
+// -- -- ann -- -- //
+size_t svctest_ann( const std::vector<std::string> &filenames )
+{
+  const size_t size( 4000 ), queries( 100 ), k( 10 );
+  std::vector<float> grid( svcSigResampleGrid( 350, 2500, 5 ) );
+  std::vector<float> spectra( svctest_library( svcSigReadBatch( filenames ), grid, size + queries ) );
+  // every 97th library spectrum is zero (an unreadable file), and never
+  // matches, and so is the first query, which has no matches
+  for ( size_t i = 0; i < size; i += 97 ) {
+    std::fill( &spectra[ i * grid.size() ], &spectra[ ( i + 1 ) * grid.size() ], 0.0f );
+  }
+  std::fill( &spectra[ size * grid.size() ], &spectra[ ( size + 1 ) * grid.size() ], 0.0f );
+  svcsiglibrary library;
+  library.build( grid, spectra.data(), size );
+  const float *query( &spectra[ size * grid.size() ] );
+  const std::string filename( "svctest.ann" );
+  const char *names[] = { "angle", "euclidean", "pearson" };
+  size_t failures( 0 );
+
+  for ( int metric = SVCSIG_LIBRARY_ANGLE; metric <= SVCSIG_LIBRARY_PEARSON; metric++ ) {
+    std::string name( names[ metric ] );
+    std::vector< std::vector<svcsigmatch> > exact( library.search( query, queries, k, metric ) );
+    svcsigann built;
+    built.build( library, metric );
+    built.save( filename );
+    svcsigann ann;
+    ann.load( filename );
+
+    // the default probes find most of the exact matches, and nearly all once
+    // the best 50 are re-ranked (the reduced spectra lose the noise, which
+    // is most of what separates Pearson neighbours of these mixtures)
+    const size_t refines[] = { 0, 50 };
+    const double recalls[] = { 0.8, 0.99 };
+    for ( size_t r = 0; r < 2; r++ ) {
+      std::vector< std::vector<svcsigmatch> > found( ann.search( query, queries, k, SVCSIG_ANN_NPROBE, 1, refines[ r ] > 0 ? &library : NULL, refines[ r ] ) );
+      std::vector< std::vector<svcsigmatch> > again( built.search( query, queries, k, SVCSIG_ANN_NPROBE, 1, refines[ r ] > 0 ? &library : NULL, refines[ r ] ) );
+      size_t hits( 0 ), zero( found[ 0 ].size() ), differ( 0 ), total( 0 );
+      for ( size_t q = 0; q < queries; q++ ) {
+        total += exact[ q ].size();
+        for ( size_t i = 0; i < found[ q ].size(); i++ ) {
+          for ( size_t j = 0; j < exact[ q ].size(); j++ ) {
+            hits += found[ q ][ i ].id == exact[ q ][ j ].id ? 1 : 0;
+          }
+          zero += found[ q ][ i ].id % 97 == 0 ? 1 : 0;
+          differ += i >= again[ q ].size() || again[ q ][ i ].id != found[ q ][ i ].id ? 1 : 0;
+        }
+      }
+      double recall( hits / double( total ) );
+      std::string how( name + ", refine " + std::to_string( refines[ r ] ) + ": " );
+      failures += svctest_check( recall >= recalls[ r ], how + "recall@10 " + std::to_string( recall ) + ", expected at least " + std::to_string( recalls[ r ] ) );
+      failures += svctest_check( zero == 0, how + std::to_string( zero ) + " matches of zero spectra" );
+      failures += svctest_check( differ == 0, how + "the loaded index differs from the built one" );
+    }
+
+    // every list, re-ranked exactly, is exact search
+    std::vector< std::vector<svcsigmatch> > found( ann.search( query, queries, k, ann.lists(), 1, &library, size ) );
+    size_t differ( 0 );
+    for ( size_t q = 0; q < queries; q++ ) {
+      differ += found[ q ].size() != exact[ q ].size() ? 1 : 0;
+      for ( size_t i = 0; i < found[ q ].size() && i < exact[ q ].size(); i++ ) {
+        differ += svctest_close( found[ q ][ i ].distance, exact[ q ][ i ].distance, 1e-9 ) ? 0 : 1;
+      }
+    }
+    failures += svctest_check( differ == 0, name + ": " + std::to_string( differ ) + " distances differ from exact search with every list re-ranked" );
+  }
+
+  // an id past the end of the library is rejected
+  {
+    std::fstream file( filename.c_str(), std::ios::in | std::ios::out | std::ios::binary );
+    svcsigannheader header;
+    file.read( reinterpret_cast<char *>( &header ), sizeof( header ) );
+    size_t at( sizeof( header ) );
+    size_t sizes[ 6 ] = { header.bands * 4, header.bands * 4, header.dims * header.bands * 4, header.lists * header.dims * 4, ( header.lists + 1 ) * 8, 0 };
+    for ( size_t a = 0; a < 6; a++ ) {
+      at = ( at + SVCSIG_ANN_ALIGN - 1 ) / SVCSIG_ANN_ALIGN * SVCSIG_ANN_ALIGN + sizes[ a ];
+    }
+    uint32_t id( header.count );
+    file.seekp( at );
+    file.write( reinterpret_cast<const char *>( &id ), sizeof( id ) );
+  }
+  bool rejected( false );
+  try {
+    svcsigann().load( filename );
+  } catch ( const invalidSVCsigAnn & ) {
+    rejected = true;
+  }
+  failures += svctest_check( rejected, "an index with an id out of range loads" );
+  remove( filename.c_str() );
+  return failures;
+}
+
+// -- -- quantile -- -- //
+size_t svctest_quantile( const std::vector<std::string> &filenames )
+{
+  const size_t size( 20000 ), parts( 4 );
+  std::vector<float> grid( svcSigResampleGrid( 350, 2500, 10 ) );
+  std::vector<float> spectra( svctest_library( svcSigReadBatch( filenames ), grid, size ) );
+  size_t bands( grid.size() );
+  size_t failures( 0 );
+
+  // streamed into one set of sketches, and into parts that are merged (with
+  // a NAN in each spectrum of the parts, which is skipped)
+  svcsigquantiles streamed( grid );
+  std::vector<svcsigquantiles> part;
+  for ( size_t p = 0; p < parts; p++ ) {
+    part.push_back( svcsigquantiles( grid, SVCSIG_SKETCH_K, p ) );
+  }
+  std::vector<float> spectrum( bands );
+  for ( size_t s = 0; s < size; s++ ) {
+    streamed.add( &spectra[ s * bands ] );
+    std::copy( &spectra[ s * bands ], &spectra[ ( s + 1 ) * bands ], spectrum.begin() );
+    spectrum[ s % bands ] = NAN;
+    part[ s % parts ].add( spectrum.data() );
+  }
+  svcsigquantiles merged( part[ 0 ] );
+  for ( size_t p = 1; p < parts; p++ ) {
+    merged.merge( part[ p ] );
+  }
+  failures += svctest_check( streamed.band( 0 ).count() == size, "a sketch counts every value" );
+  failures += svctest_check( merged.band( 0 ).count() + ( size + bands - 1 ) / bands == size, "a merged sketch skips NAN" );
+
+  // the rank of each quantile in the sorted column: within 2% everywhere,
+  // and 0.6% on average (the header quotes about 1% and 0.3% for k = 200)
+  const double q[] = { 0.05, 0.5, 0.95 };
+  std::vector<float> column( size );
+  const svcsigquantiles *sketches[] = { &streamed, &merged };
+  const char *names[] = { "streamed", "merged" };
+  for ( size_t m = 0; m < 2; m++ ) {
+    for ( size_t i = 0; i < 3; i++ ) {
+      std::vector<float> approximate( sketches[ m ]->quantile( q[ i ] ) );
+      double worst( 0.0 ), mean( 0.0 );
+      size_t missing( 0 );
+      for ( size_t j = 0; j < bands; j++ ) {
+        column.clear();
+        for ( size_t s = 0; s < size; s++ ) {
+          if ( m == 0 || s % bands != j ) {
+            column.push_back( spectra[ s * bands + j ] );
+          }
+        }
+        std::sort( column.begin(), column.end() );
+        std::pair<std::vector<float>::iterator, std::vector<float>::iterator> at( std::equal_range( column.begin(), column.end(), approximate[ j ] ) );
+        missing += at.first == at.second ? 1 : 0;
+        double rank( 0.5 * ( ( at.first - column.begin() ) + ( at.second - column.begin() ) ) );
+        double error( std::fabs( rank - q[ i ] * ( column.size() - 1 ) ) / column.size() );
+        worst = std::max( worst, error );
+        mean += error / bands;
+      }
+      std::string how( std::string( names[ m ] ) + " q " + std::to_string( q[ i ] ) + ": " );
+      failures += svctest_check( missing == 0, how + std::to_string( missing ) + " values that were not in the stream" );
+      failures += svctest_check( worst <= 0.02, how + "worst rank error " + std::to_string( worst ) );
+      failures += svctest_check( mean <= 0.006, how + "mean rank error " + std::to_string( mean ) );
+    }
+  }
+
+  // bands that see the same stream make different choices, so their errors
+  // are not all the same
+  svcsigquantiles same( grid );
+  for ( size_t s = 0; s < size; s++ ) {
+    std::fill( spectrum.begin(), spectrum.end(), spectra[ s * bands ] );
+    same.add( spectrum.data() );
+  }
+  std::vector<float> median( same.median() );
+  size_t differ( 0 );
+  for ( size_t j = 1; j < bands; j++ ) {
+    differ += median[ j ] != median[ 0 ] ? 1 : 0;
+  }
+  failures += svctest_check( differ > bands / 2, "only " + std::to_string( differ ) + " of " + std::to_string( bands ) + " bands fed the same stream differ from the first" );
+  return failures;
+}
+
+// -- -- savgol -- -- //
+size_t svctest_savgol( const std::vector<std::string> &filenames )
+{
+  size_t failures( 0 );
+
+  // a uniform grid (2 nm) and a random spectrum: away from the ends the
+  // filters are the convolutions tabulated by Savitzky and Golay
+  const size_t n( 200 );
+  const double h( 2.0 );
+  std::vector<float> grid( n ), in( n ), out( n );
+  std::mt19937 random( 1 );
+  std::uniform_real_distribution<float> value( 0.0f, 100.0f );
+  for ( size_t i = 0; i < n; i++ ) {
+    grid[ i ] = 400.0 + h * i;
+    in[ i ] = value( random );
+  }
+  struct { size_t window, order, derivative; double norm; double c[ 7 ]; } tables[] = {
+    { 5, 2, 0, 35.0, { -3, 12, 17, 12, -3 } },
+    { 7, 2, 0, 21.0, { -2, 3, 6, 7, 6, 3, -2 } },
+    { 7, 4, 0, 231.0, { 5, -30, 75, 131, 75, -30, 5 } },
+    { 5, 2, 1, 10.0 * h, { -2, -1, 0, 1, 2 } },
+    { 7, 3, 1, 252.0 * h, { 22, -67, -58, 0, 58, 67, -22 } },
+    { 5, 2, 2, 7.0 * h * h, { 2, -1, -2, -1, 2 } },
+    { 1, 0, 0, 1.0, { 1 } }
+  };
+  for ( size_t t = 0; t < sizeof( tables ) / sizeof( tables[ 0 ] ); t++ ) {
+    svcsigsavgol filter( grid, tables[ t ].window, tables[ t ].order, tables[ t ].derivative );
+    filter.apply( in.data(), out.data() );
+    size_t half( tables[ t ].window / 2 ), wrong( 0 );
+    for ( size_t j = half; j + half < n; j++ ) {
+      double expected( 0.0 );
+      for ( size_t i = 0; i < tables[ t ].window; i++ ) {
+        expected += tables[ t ].c[ i ] * in[ j - half + i ] / tables[ t ].norm;
+      }
+      wrong += svctest_close( out[ j ], expected, 1e-5 ) ? 0 : 1;
+    }
+    failures += svctest_check( wrong == 0, "window " + std::to_string( tables[ t ].window ) + ", order " + std::to_string( tables[ t ].order ) +
+      ", derivative " + std::to_string( tables[ t ].derivative ) + ": " + std::to_string( wrong ) + " bands differ from the table" );
+  }
+
+  // on the files' uneven grids, with their detector overlaps, a quadratic is
+  // kept and differentiated exactly by an order 2 (or higher) filter,
+  // ends included
+  std::vector<svcsig> sigs( svcSigReadBatch( filenames ) );
+  sigs.push_back( svctest_shifted( filenames[ 0 ], 0.37 ) );
+  for ( size_t f = 0; f < sigs.size(); f += sigs.size() - 1 ) {
+    const float *x( sigs[ f ].wavelengthData() );
+    size_t bands( sigs[ f ].size() );
+    std::vector<float> quadratic( bands ), smoothed( bands );
+    for ( size_t j = 0; j < bands; j++ ) {
+      double u( ( x[ j ] - 1000.0 ) / 500.0 );
+      quadratic[ j ] = 1.0 + 0.5 * u * u;
+    }
+    for ( size_t derivative = 0; derivative <= 2; derivative++ ) {
+      std::shared_ptr<const svcsigsavgol> filter( svcSigSavgol( sigs[ f ].wavelength(), 11, 3, derivative ) );
+      filter->apply( quadratic.data(), smoothed.data() );
+      size_t wrong( 0 );
+      for ( size_t j = 0; j < bands; j++ ) {
+        double u( ( x[ j ] - 1000.0 ) / 500.0 );
+        double expected( derivative == 0 ? 1.0 + 0.5 * u * u : ( derivative == 1 ? u / 500.0 : 1.0 / 250000.0 ) );
+        wrong += svctest_close( smoothed[ j ], expected, derivative == 0 ? 1e-5 : 1e-6 ) ? 0 : 1;
+      }
+      failures += svctest_check( wrong == 0, "file " + std::to_string( f ) + ", derivative " + std::to_string( derivative ) + ": " +
+        std::to_string( wrong ) + " bands of a quadratic are wrong" );
+    }
+  }
+
+  // the batch is the filter of each file's grid
+  size_t total( 0 );
+  for ( size_t f = 0; f < sigs.size(); f++ ) {
+    total += sigs[ f ].size();
+  }
+  std::vector<float> batch( total );
+  svcSigSavgolBatch( sigs, batch.data(), 9, 2, 1, SVCSIG_SPECTRUM_TARGET_REFLECTANCE, 2 );
+  size_t at( 0 ), wrong( 0 );
+  for ( size_t f = 0; f < sigs.size(); f++ ) {
+    std::vector<float> single( svcsigsavgol( sigs[ f ].wavelength(), 9, 2, 1 ).apply( sigs[ f ] ) );
+    for ( size_t j = 0; j < single.size(); j++ ) {
+      wrong += batch[ at++ ] == single[ j ] ? 0 : 1;
+    }
+  }
+  failures += svctest_check( wrong == 0, std::to_string( wrong ) + " values of the batch differ from the filter of each file" );
+  return failures;
+}
+
+// -- -- envi -- -- //
+// the value of "key = value" in an ENVI header, without the braces of a list
+std::string svctest_envi_field( const std::string &header, const std::string &key )
+{
+  size_t start( header.find( "\n" + key + " = " ) );
+  if ( start == std::string::npos ) {
+    return "";
+  }
+  start += key.size() + 4;
+  if ( header[ start ] == '{' ) {
+    return header.substr( start + 1, header.find( '}', start ) - start - 1 );
+  }
+  return header.substr( start, header.find( '\n', start ) - start );
+}
+
+// the items of an ENVI list, trimmed
+std::vector<std::string> svctest_envi_list( const std::string &list )
+{
+  std::vector<std::string> items;
+  std::istringstream input( list );
+  std::string item;
+  while ( std::getline( input, item, ',' ) ) {
+    size_t first( item.find_first_not_of( " \n" ) ), last( item.find_last_not_of( " \n" ) );
+    items.push_back( first == std::string::npos ? "" : item.substr( first, last - first + 1 ) );
+  }
+  return items;
+}
+
+size_t svctest_envi( const std::vector<std::string> &filenames )
+{
+  size_t failures( 0 );
+  std::vector<svcsig> sigs( svcSigReadBatch( filenames ) );
+  const std::vector<float> &grid( svcSigSplicer( sigs[ 0 ].wavelength() )->wavelength() );
+  std::vector<std::string> names( filenames.size() );
+  for ( size_t i = 0; i < filenames.size(); i++ ) {
+    names[ i ] = filenames[ i ].substr( filenames[ i ].find_last_of( "/\\" ) + 1 );
+  }
+
+  // the files, a file on another grid, a name with the list delimiters and
+  // a spectrum already on the grid
+  svcsig shifted( svctest_shifted( filenames[ 0 ], 0.37 ) );
+  std::vector<float> ramp( grid.size() );
+  for ( size_t j = 0; j < ramp.size(); j++ ) {
+    ramp[ j ] = j * 0.25f;
+  }
+  std::vector< std::vector<float> > expected;
+  for ( size_t i = 0; i < sigs.size(); i++ ) {
+    expected.push_back( svcSigSplicer( sigs[ i ].wavelength() )->apply( sigs[ i ] ) );
+  }
+  std::shared_ptr<const svcsigsplicer> splicer( svcSigSplicer( shifted.wavelength() ) );
+  expected.push_back( svcSigResampler( splicer->wavelength(), grid )->apply( splicer->apply( shifted ) ) );
+  expected.push_back( ramp );
+  std::vector<std::string> expectedNames( names );
+  expectedNames.push_back( "shifted_ by _0.37_" );
+  expectedNames.push_back( "ramp" );
+
+  const std::string filename( "svctest.sli" ), header( "svctest.hdr" );
+  {
+    svcsigenvi library( filename );
+    library.add( sigs, 2, names ).add( shifted, "shifted, by {0.37}" ).add( "ramp", ramp.data() );
+    library.close();
+  }
+
+  std::ifstream hdr( header.c_str() );
+  std::string text( ( std::istreambuf_iterator<char>( hdr ) ), std::istreambuf_iterator<char>() );
+  const uint16_t one( 1 );
+  failures += svctest_check( text.compare( 0, 5, "ENVI\n" ) == 0, "the header does not start with ENVI" );
+  failures += svctest_check( svctest_envi_field( text, "samples" ) == std::to_string( grid.size() ), "samples is " + svctest_envi_field( text, "samples" ) );
+  failures += svctest_check( svctest_envi_field( text, "lines" ) == std::to_string( expected.size() ), "lines is " + svctest_envi_field( text, "lines" ) );
+  failures += svctest_check( svctest_envi_field( text, "data type" ) == "4", "data type is " + svctest_envi_field( text, "data type" ) );
+  failures += svctest_check( svctest_envi_field( text, "byte order" ) == ( *reinterpret_cast<const char *>( &one ) == 1 ? "0" : "1" ),
+    "byte order is " + svctest_envi_field( text, "byte order" ) );
+  failures += svctest_check( svctest_envi_list( svctest_envi_field( text, "spectra names" ) ) == expectedNames, "the spectra names differ" );
+  std::vector<std::string> wavelengths( svctest_envi_list( svctest_envi_field( text, "wavelength" ) ) );
+  size_t wrong( wavelengths.size() == grid.size() ? 0 : grid.size() );
+  for ( size_t j = 0; j < wavelengths.size() && wrong == 0; j++ ) {
+    wrong += svctest_close( atof( wavelengths[ j ].c_str() ), grid[ j ], 1e-6 ) ? 0 : 1;
+  }
+  failures += svctest_check( wrong == 0, std::to_string( wrong ) + " wavelengths differ from the spliced grid" );
+
+  std::ifstream sli( filename.c_str(), std::ios::binary );
+  std::vector<float> data( expected.size() * grid.size() + 1 );
+  sli.read( reinterpret_cast<char *>( data.data() ), data.size() * sizeof( float ) );
+  failures += svctest_check( size_t( sli.gcount() ) == expected.size() * grid.size() * sizeof( float ), "the library is " + std::to_string( sli.gcount() ) + " bytes" );
+  for ( size_t i = 0; i < expected.size(); i++ ) {
+    wrong = 0;
+    for ( size_t j = 0; j < grid.size(); j++ ) {
+      wrong += svctest_same( data[ i * grid.size() + j ], expected[ i ][ j ] ) ? 0 : 1;
+    }
+    failures += svctest_check( wrong == 0, expectedNames[ i ] + ": " + std::to_string( wrong ) + " values differ" );
+  }
+
+  // svcSigEnviWrite() streams the same library from the files
+  failures += svctest_check( svcSigEnviWrite( "svctest2.sli", filenames, std::vector<float>(), SVCSIG_SPECTRUM_TARGET_REFLECTANCE, SVCSIG_RESAMPLE_LINEAR, 2 ) == sigs.size(),
+    "svcSigEnviWrite() did not write every file" );
+  std::ifstream sli2( "svctest2.sli", std::ios::binary );
+  std::string bytes( ( std::istreambuf_iterator<char>( sli2 ) ), std::istreambuf_iterator<char>() );
+  failures += svctest_check( bytes.size() == sigs.size() * grid.size() * sizeof( float ) &&
+    std::equal( bytes.begin(), bytes.end(), reinterpret_cast<const char *>( data.data() ) ), "svcSigEnviWrite() differs from add()" );
+
+  // a library that is not closed leaves nothing behind
+  {
+    svcsigenvi library( "svctest3.sli" );
+    library.add( sigs[ 0 ] );
+  }
+  failures += svctest_check( !std::ifstream( "svctest3.sli" ) && !std::ifstream( "svctest3.sli.tmp" ) && !std::ifstream( "svctest3.hdr.names.tmp" ),
+    "an abandoned library left files" );
+
+  remove( filename.c_str() );
+  remove( header.c_str() );
+  remove( "svctest2.sli" );
+  remove( "svctest2.hdr" );
+  return failures;
+}
+
+// -- -- numpy -- -- //
+// the bytes of a file
+std::string svctest_bytes( const std::string &filename )
+{
+  std::ifstream input( filename.c_str(), std::ios::binary );
+  return std::string( ( std::istreambuf_iterator<char>( input ) ), std::istreambuf_iterator<char>() );
+}
+
+// a little endian integer of size bytes
+uint64_t svctest_get( const std::string &bytes, const size_t &at, const size_t &size )
+{
+  uint64_t value( 0 );
+  for ( size_t b = size; b > 0 && at + b <= bytes.size(); b-- ) {
+    value = ( value << 8 ) | static_cast<unsigned char>( bytes[ at + b - 1 ] );
+  }
+  return value;
+}
+
+// the payload of a .npy file, if its header has the descr and shape given
+std::string svctest_npy( const std::string &bytes, const std::string &descr, const std::string &shape )
+{
+  if ( bytes.size() < 10 || bytes.compare( 0, 8, std::string( "\x93NUMPY\x01\x00", 8 ) ) != 0 ) {
+    return "bad magic";
+  }
+  size_t length( 10 + svctest_get( bytes, 8, 2 ) );
+  std::string dict( bytes.substr( 10, length - 10 ) );
+  if ( length % 64 != 0 || length > bytes.size() || dict[ dict.size() - 1 ] != '\n' ) {
+    return "bad header";
+  }
+  if ( dict.find( "'descr': " + descr + "," ) == std::string::npos || dict.find( "'shape': " + shape + "," ) == std::string::npos ||
+    dict.find( "'fortran_order': False" ) == std::string::npos ) {
+    return "bad dict " + dict;
+  }
+  return bytes.substr( length );
+}
+
+size_t svctest_numpy( const std::vector<std::string> &filenames )
+{
+  size_t failures( 0 );
+  std::vector<svcsig> sigs( svcSigReadBatch( filenames ) );
+  sigs.push_back( svctest_shifted( filenames[ 0 ], 0.37 ) );
+  const std::vector<float> grid( sigs[ 0 ].wavelength() );
+
+  // the rows expected: the files on the grid as they are, the shifted file
+  // resampled onto it
+  std::string expected[ 3 ], records;
+  for ( size_t i = 0; i < sigs.size(); i++ ) {
+    const float *spectra[ 3 ] = { sigs[ i ].referenceRadianceData(), sigs[ i ].targetRadianceData(), sigs[ i ].targetReflectanceData() };
+    std::shared_ptr<const svcsigresampler> resampler( sigs[ i ].wavelength() == grid ? NULL : svcSigResampler( sigs[ i ].wavelength(), grid ) );
+    for ( size_t k = 0; k < 3; k++ ) {
+      std::vector<float> row( spectra[ k ], spectra[ k ] + grid.size() );
+      if ( resampler ) {
+        row = resampler->apply( std::vector<float>( spectra[ k ], spectra[ k ] + sigs[ i ].size() ) );
+      }
+      expected[ k ].append( reinterpret_cast<const char *>( row.data() ), row.size() * sizeof( float ) );
+    }
+  }
+  const std::string f4( std::string( "'" ) + svcSigNumpyOrder() + "f4'" );
+  const std::string shape( "(" + std::to_string( sigs.size() ) + ", " + std::to_string( grid.size() ) + ")" );
+
+  // a directory, then an .npz of the same library
+  const std::string directory( "svctest.npy" ), npz( "svctest.npz" );
+  const char *names[] = { "reference.npy", "target.npy", "reflectance.npy", "header.npy", "wavelength.npy" };
+  {
+    svcsignumpy library( directory );
+    library.add( sigs, 2 );
+    library.close();
+    svcsignumpy zipped( npz );
+    zipped.add( std::vector<svcsig>( sigs.begin(), sigs.end() - 1 ), 2 ).add( sigs.back() );
+    zipped.close();
+  }
+  std::string members[ 5 ];
+  for ( size_t k = 0; k < 5; k++ ) {
+    members[ k ] = svctest_bytes( directory + "/" + names[ k ] );
+  }
+  for ( size_t k = 0; k < 3; k++ ) {
+    std::string data( svctest_npy( members[ k ], f4, shape ) );
+    size_t wrong( data.size() == expected[ k ].size() ? 0 : grid.size() * sigs.size() );
+    for ( size_t j = 0; wrong < grid.size() * sigs.size() && j * sizeof( float ) < data.size(); j++ ) {
+      float a, b;
+      memcpy( &a, data.data() + j * sizeof( float ), sizeof( float ) );
+      memcpy( &b, expected[ k ].data() + j * sizeof( float ), sizeof( float ) );
+      wrong += svctest_same( a, b ) ? 0 : 1;
+    }
+    failures += svctest_check( wrong == 0, std::string( names[ k ] ) + ": " + std::to_string( wrong ) + " values differ" );
+  }
+  std::string wavelength( svctest_npy( members[ 4 ], f4, "(" + std::to_string( grid.size() ) + ",)" ) );
+  failures += svctest_check( wavelength.size() == grid.size() * sizeof( float ) &&
+    memcmp( wavelength.data(), grid.data(), wavelength.size() ) == 0, "wavelength.npy differs from the grid" );
+
+  // the header records: the names and the decoded positions
+  std::string header( svctest_npy( members[ 3 ], svcSigNumpyRecordDescr(), "(" + std::to_string( sigs.size() ) + ",)" ) );
+  size_t wrong( header.size() == sigs.size() * SVCSIG_NUMPY_RECORD ? 0 : sigs.size() );
+  for ( size_t i = 0; i < sigs.size() && wrong == 0; i++ ) {
+    const char *record( header.data() + i * SVCSIG_NUMPY_RECORD );
+    const double positions[ 6 ] = { sigs[ i ].referenceDecodedLatitude(), sigs[ i ].referenceDecodedLongitude(), sigs[ i ].referenceDecodedGpstime(),
+      sigs[ i ].targetDecodedLatitude(), sigs[ i ].targetDecodedLongitude(), sigs[ i ].targetDecodedGpstime() };
+    std::string name( sigs[ i ].name().substr( 0, SVCSIG_NUMPY_NAME ) );
+    name.resize( SVCSIG_NUMPY_NAME, '\0' );
+    wrong += name.compare( 0, SVCSIG_NUMPY_NAME, record, SVCSIG_NUMPY_NAME ) == 0 &&
+      memcmp( record + 2 * SVCSIG_NUMPY_NAME + 2 * SVCSIG_NUMPY_TIME, positions, sizeof( positions ) ) == 0 ? 0 : 1;
+  }
+  failures += svctest_check( wrong == 0, std::to_string( wrong ) + " header records differ" );
+
+  // the .npz: each member is stored, with its CRC, byte for byte as in the
+  // directory; the central directory points at them
+  std::string zip( svctest_bytes( npz ) );
+  size_t at( 0 ), found( 0 );
+  wrong = 0;
+  std::vector<uint64_t> offsets;
+  while ( svctest_get( zip, at, 4 ) == 0x04034b50 ) {
+    offsets.push_back( at );
+    size_t nameLength( svctest_get( zip, at + 26, 2 ) ), extraLength( svctest_get( zip, at + 28, 2 ) );
+    std::string name( zip.substr( at + 30, nameLength ) );
+    uint64_t size( svctest_get( zip, at + 30 + nameLength + 4, 8 ) );
+    std::string data( zip.substr( at + 30 + nameLength + extraLength, size ) );
+    for ( size_t k = 0; k < 5; k++ ) {
+      if ( name == names[ k ] ) {
+        found++;
+        wrong += data == members[ k ] && svctest_get( zip, at + 8, 2 ) == 0 &&
+          svctest_get( zip, at + 14, 4 ) == svcSigCrc32( 0, data.data(), data.size() ) ? 0 : 1;
+      }
+    }
+    at += 30 + nameLength + extraLength + size;
+  }
+  failures += svctest_check( found == 5 && wrong == 0, "the .npz has " + std::to_string( found ) + " members, " + std::to_string( wrong ) + " differ" );
+  size_t entries( 0 );
+  for ( size_t c = at; svctest_get( zip, c, 4 ) == 0x02014b50; entries++ ) {
+    size_t nameLength( svctest_get( zip, c + 28, 2 ) ), extraLength( svctest_get( zip, c + 30, 2 ) );
+    wrong += entries < offsets.size() && svctest_get( zip, c + 46 + nameLength + 20, 8 ) == offsets[ entries ] ? 0 : 1;
+    c += 46 + nameLength + extraLength;
+  }
+  failures += svctest_check( entries == 5 && wrong == 0, "the .npz central directory has " + std::to_string( entries ) + " entries, " + std::to_string( wrong ) + " wrong" );
+  failures += svctest_check( zip.size() >= 22 && svctest_get( zip, zip.size() - 22, 4 ) == 0x06054b50, "the .npz has no end of central directory" );
+
+  // the CRC of a known string
+  failures += svctest_check( svcSigCrc32( 0, "123456789", 9 ) == 0xcbf43926, "the CRC-32 of 123456789 is not cbf43926" );
+
+  for ( size_t k = 0; k < 5; k++ ) {
+    remove( ( directory + "/" + names[ k ] ).c_str() );
+  }
+  remove( directory.c_str() );
+  remove( npz.c_str() );
+  return failures;
+}
+
+int main( int argc, char* argv[] )
+{
+  std::string only;
+  std::vector<std::string> filenames;
+  for ( int i = 1; i < argc; i++ ) {
+    std::string arg( argv[ i ] );
+    if ( arg.compare( "-t" ) == 0 && i + 1 < argc ) {
+      only = argv[ ++i ];
+    }
+    else {
+      filenames.push_back( arg );
+    }
+  }
+  if ( filenames.empty() ) {
+    svctest_usage();
+    return argc == 1 ? 0 : 1;
+  }
+
+  typedef size_t ( *svctest )( const std::vector<std::string> & );
+  const std::pair<std::string, svctest> tests[] = {
+    std::make_pair( std::string( "srf" ), svctest_srf ),
+    std::make_pair( std::string( "ann" ), svctest_ann ),
+    std::make_pair( std::string( "quantile" ), svctest_quantile ),
+    std::make_pair( std::string( "savgol" ), svctest_savgol ),
+    std::make_pair( std::string( "envi" ), svctest_envi ),
+    std::make_pair( std::string( "numpy" ), svctest_numpy )
+  };
+  size_t failures( 0 );
+  bool found( false );
+  for ( size_t t = 0; t < sizeof( tests ) / sizeof( tests[ 0 ] ); t++ ) {
+    if ( !only.empty() && only.compare( tests[ t ].first ) != 0 ) {
+      continue;
+    }
+    found = true;
+    size_t failed( 0 );
+    try {
+      failed = tests[ t ].second( filenames );
+    } catch ( const std::exception &e ) {
+      std::cout << "  FAIL: " << e.what() << std::endl;
+      failed = 1;
+    }
+    std::cout << tests[ t ].first << ": " << ( failed == 0 ? "ok" : std::to_string( failed ) + " failed" ) << std::endl;
+    failures += failed;
+  }
+  if ( !found ) {
+    std::cerr << "unknown test '" << only << "'" << std::endl;
+    svctest_usage();
+    return 1;
+  }
+  return failures == 0 ? 0 : 1;
+}
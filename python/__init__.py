@@ -1,3 +1,5 @@
-from readSVCsig import readSVCdata
-from readSVCsig import readSVCheader
-from readSVCsig import readSVCsig
+from .readSVCsig import readSVCdata
+from .readSVCsig import readSVCheader
+from .readSVCsig import readSVCsig
+from .readSVCsig import readSVCsigBatch
+from .readSVCsig import readSVCsigPython
@@ -0,0 +1,100 @@
+#!/usr/bin/env python
+
+"""BENCHSVCSIG times the pure Python and C++ sig readers
+
+INPUTS:
+    files: the sig files to read
+
+OUTPUTS:
+    The files per second of readSVCsigPython, readSVCsig (the _svcsig
+    extension) and readSVCsigBatch, and whether the readers agree.
+
+    e.g. python benchSVCsig.py ../data/*.sig
+
+HISTORY:
+    2026-10-18: Initial version
+
+PUBLIC REPOSITORY:
+    https://github.com/pavdpr/svcread.git
+
+LICENSE:
+    The MIT License (MIT) Copyright
+    (c) 2013-2015 Rochester Institute of Technology
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the
+    "Software"), to deal in the Software without restriction, including
+    without limitation the rights to use, copy, modify, merge, publish,
+    distribute, sublicense, and/or sell copies of the Software, and to
+    permit persons to whom the Software is furnished to do so, subject to
+    the following conditions:
+
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+    OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+"""
+
+import sys
+import time
+import numpy
+
+import readSVCsig
+
+
+def timeReader(name, reader, filenames, minimum=1.0):
+    """runs reader( filenames ) for at least minimum seconds and prints the rate
+
+    Returns
+    the output of the last run
+    """
+
+    runs = 0
+    start = time.perf_counter()
+    while True:
+        output = reader(filenames)
+        runs += 1
+        elapsed = time.perf_counter() - start
+        if elapsed >= minimum:
+            break
+    rate = runs * len(filenames) / elapsed
+    print('%-20s %10.1f files/s' % (name, rate))
+    return output, rate
+
+
+if __name__ == '__main__':
+    filenames = sys.argv[1:]
+    if not filenames:
+        print('useage: benchSVCsig.py files')
+        sys.exit(1)
+
+    python, pythonRate = timeReader('readSVCsigPython',
+        lambda f: [readSVCsig.readSVCsigPython(x) for x in f], filenames)
+    if readSVCsig._svcsig is None:
+        print('_svcsig is not built; run make in this directory')
+        sys.exit(0)
+    native, nativeRate = timeReader('readSVCsig',
+        lambda f: [readSVCsig.readSVCsig(x) for x in f], filenames)
+    batch, batchRate = timeReader('readSVCsigBatch',
+        readSVCsig.readSVCsigBatch, filenames)
+    print('speed up: %.1fx (single), %.1fx (batch)' %
+          (nativeRate / pythonRate, batchRate / pythonRate))
+
+    # the C++ reader holds float32, so compare at that precision
+    worst = 0.0
+    for a, b in zip(python, batch):
+        for key in ('wavelength', 'referenceDC', 'targetDC', 'reflectance'):
+            if a[key].shape != b[key].shape:
+                worst = numpy.inf
+            else:
+                worst = max(worst, numpy.max(numpy.abs(
+                    a[key].astype(numpy.float32) - b[key]) /
+                    numpy.maximum(numpy.abs(a[key]), 1.0)))
+    print('largest relative difference: %g' % worst)
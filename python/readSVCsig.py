@@ -20,7 +20,20 @@ OUTPUTS:
     output['reflectance']: The reflectance spectrum of the target. The
             reflectance is percentage (0-100 range).
 
+    If the _svcsig extension is built (make in this directory), readSVCsig
+    and readSVCsigBatch parse with the C++ svcsig reader instead. Its spectra
+    are converted to writable float64 numpy arrays, as the pure Python reader
+    returns; readSVCsigPython is always the pure Python reader. For read only
+    float32 views of the parsed file (no copy), use numpy.asarray() on the
+    arrays of _svcsig.read() directly.
+
 HISTORY:
+    2026-10-18: Updated Code.
+      -- Uses the _svcsig C++ extension when it is available.
+      -- Added readSVCsigBatch and readSVCsigPython.
+      -- Runs under Python 3.
+      -- The C++ reader's spectra are writable float64 arrays, and
+         readSVCsigBatch gives None for unreadable files with either reader.
     2015-03-19: Updated Code.
       -- Fixed a bug when the gpstime was not set.
       -- Switched to regular expressions to parse data.
@@ -76,6 +89,14 @@ import re
 import sys
 import numpy
 
+try:
+    from . import _svcsig
+except (ImportError, SystemError, ValueError):
+    try:
+        import _svcsig
+    except ImportError:
+        _svcsig = None
+
 def readSVCheader(filename):
     """ Reads an SVC sig header
 
@@ -99,11 +120,11 @@ def readSVCheader(filename):
         Returns:
         tuple of two lists
         """
-        halfPoint = len(thelist) / 2
+        halfPoint = len(thelist) // 2
         return (thelist[:halfPoint], thelist[halfPoint:])
 
     try:
-        fid = open(filename, 'rU')
+        fid = open(filename, 'r')
 
         # make sure we are svc sig file
         line = fid.readline()
@@ -138,7 +159,7 @@ def readSVCheader(filename):
                     commonHeader[key] = value
                 elif key == 'integration':
                     tmp = commaregex.split(value)
-                    tmp = map(float, tmp)
+                    tmp = list(map(float, tmp))
                     (referenceHeader[key], targetHeader[key]) = \
                         splitListInHalf(tmp)
                 elif key == 'scan method':
@@ -146,13 +167,13 @@ def readSVCheader(filename):
                         splitListInHalf(value)
                 elif key == 'scan coadds':
                     tmp = commaregex.split(value)
-                    tmp = map(float, tmp)
+                    tmp = list(map(float, tmp))
                     (referenceHeader[key], targetHeader[key]) = \
                         splitListInHalf(tmp)
                 elif key == 'scan time':
                     tmp = commaregex.split(value)
                     # can this be an int?
-                    tmp = map(float, tmp)
+                    tmp = list(map(float, tmp))
                     (referenceHeader[key], targetHeader[key]) = \
                         splitListInHalf(tmp)
                 elif key == 'scan settings':
@@ -164,7 +185,7 @@ def readSVCheader(filename):
                     # I may want to switch to regualar expressions for this!
                     tmp = commaregex.split(value)
                     # i need to check that this is an int
-                    tmp = map(float, tmp)
+                    tmp = list(map(float, tmp))
                     (referenceHeader[key], targetHeader[key]) = \
                         splitListInHalf(tmp)
                 elif key == 'external data set2':
@@ -172,7 +193,7 @@ def readSVCheader(filename):
                     # I may want to switch to regualar expressions for this!
                     tmp = commaregex.split(value)
                     # i need to check that this is an int
-                    tmp = map(float, tmp)
+                    tmp = list(map(float, tmp))
                     (referenceHeader[key], targetHeader[key]) = \
                         splitListInHalf(tmp)
                 elif key == 'external data dark':
@@ -180,7 +201,7 @@ def readSVCheader(filename):
                     # I may want to switch to regualar expressions for this!
                     tmp = commaregex.split(value)
                     # i need to check that this is an int
-                    tmp = map(float, tmp)
+                    tmp = list(map(float, tmp))
                     (referenceHeader[key], targetHeader[key]) = \
                         splitListInHalf(tmp)
                 elif key == 'external data mask':
@@ -191,17 +212,17 @@ def readSVCheader(filename):
                 elif key == 'temp':
                     tmp = commaregex.split(value)
                     # i need to check that this is an int
-                    tmp = map(float, tmp)
+                    tmp = list(map(float, tmp))
                     (referenceHeader[key], targetHeader[key]) = \
                         splitListInHalf(tmp)
                 elif key == 'battery':
                     tmp = commaregex.split(value)
-                    tmp = map(float, tmp)
+                    tmp = list(map(float, tmp))
                     (referenceHeader[key], targetHeader[key]) = \
                         splitListInHalf(tmp)
                 elif key == 'error':
                     tmp = commaregex.split(value)
-                    tmp = map(int, tmp)
+                    tmp = list(map(int, tmp))
                     (referenceHeader[key], targetHeader[key]) = \
                         splitListInHalf(tmp)
                 elif key == 'units':
@@ -223,7 +244,7 @@ def readSVCheader(filename):
                         referenceHeader[key] = None
                         targetHeader[key] = None
                     elif tmp[0] and tmp[1]:
-                        tmp = map(float, tmp)
+                        tmp = list(map(float, tmp))
                         (referenceHeader[key], targetHeader[key]) = \
                             splitListInHalf(tmp)
                     else:
@@ -233,7 +254,7 @@ def readSVCheader(filename):
                     commonHeader[key] = value
                 elif key == 'memory slot':
                     tmp = commaregex.split(value)
-                    tmp = map(int, tmp)
+                    tmp = list(map(int, tmp))
                     (referenceHeader[key], targetHeader[key]) = \
                         splitListInHalf(tmp)
                 elif key == 'factors':
@@ -242,7 +263,7 @@ def readSVCheader(filename):
                         tmp = value[:idx]
                         tmp = tmp.strip()
                         tmp = commaregex.split(tmp)
-                        commonHeader[key] = map(float, tmp)
+                        commonHeader[key] = list(map(float, tmp))
                         tmp = value[idx+1:]
                         idx = tmp.find(']')
                         if idx > 0:
@@ -251,7 +272,7 @@ def readSVCheader(filename):
                     else:
                         # no comments
                         tmp = commaregex.split(value)
-                        commonHeader[key] = map(float, tmp)
+                        commonHeader[key] = list(map(float, tmp))
                 else:
                     # we are an unknown key, but we can add it since I can index
                     # dictionaries by strings
@@ -292,8 +313,8 @@ def readSVCdata(filename, skip=25):
         pass
 
 
-def readSVCsig(filename):
-    """reads a SVC sig file
+def readSVCsigPython(filename):
+    """reads a SVC sig file in pure Python
 
     Keyword arguments:
     filename -- (str) the filename
@@ -316,13 +337,66 @@ def readSVCsig(filename):
     return output
 
 
+def _nativeSVCsig(output):
+    """converts the spectra of an _svcsig dictionary to writable float64
+    numpy arrays, as readSVCsigPython returns them"""
+    for key in ('wavelength', 'referenceDC', 'targetDC', 'reflectance'):
+        output[key] = numpy.frombuffer(output[key], dtype=numpy.float32) \
+            .astype(numpy.float64)
+    return output
+
+
+def _readSVCsigPythonOrNone(filename):
+    """readSVCsigPython, or None if the file can not be read"""
+    try:
+        return readSVCsigPython(filename)
+    except Exception:
+        return None
+
+
+def readSVCsig(filename):
+    """reads a SVC sig file
+
+    Keyword arguments:
+    filename -- (str, bytes or os.PathLike) the filename
+
+    Returns
+    dict -- as readSVCsigPython, but from the C++ reader if it is built
+
+    Exceptions:
+    IOError -- if the C++ reader can not read the file
+    """
+
+    if _svcsig is None:
+        return readSVCsigPython(filename)
+    return _nativeSVCsig(_svcsig.read(filename))
+
+
+def readSVCsigBatch(filenames, threads=0):
+    """reads many SVC sig files
+
+    Keyword arguments:
+    filenames -- (list of str, bytes or os.PathLike) the filenames
+    threads   -- (int) the number of threads for the C++ reader, 0 for one
+                 per core (default=0)
+
+    Returns
+    list of dict -- as readSVCsig; None for files that could not be read
+    """
+
+    if _svcsig is None:
+        return [_readSVCsigPythonOrNone(filename) for filename in filenames]
+    return [None if output is None else _nativeSVCsig(output)
+            for output in _svcsig.readBatch(list(filenames), threads)]
+
+
 if __name__ == '__main__':
     # get the arguments
     args = sys.argv[1:]
 
     # make sure we have some inputs
     if not args:
-        print 'useage: readSVCsig.py file'
+        print('useage: readSVCsig.py file')
         sys.exit(1)
 
     # this may change in the future if there optional inputs
@@ -330,4 +404,4 @@ if __name__ == '__main__':
 
     data = readSVCsig(filename)
 
-    print data
\ No newline at end of file
+    print(data)
\ No newline at end of file
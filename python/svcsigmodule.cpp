@@ -0,0 +1,519 @@
+/*******************************************************************************
+ * svcsigmodule.cpp
+ *
+ * DESCRIPTION:
+ *    The _svcsig CPython extension: reads SVC sig files with the C++ svcsig
+ *    class, for readSVCsig.py. read( filename ) returns the same dictionary
+ *    as readSVCsig(); readBatch( filenames, threads ) reads many files across
+ *    worker threads.
+ *
+ *    The spectra are not copied: each is an _svcsig.array that exposes the
+ *    floats of the parsed file through the buffer protocol (format 'f'), so
+ *    numpy.asarray() and memoryview() view them in place. The file stays in
+ *    memory while any of its arrays do. The GIL is released while files are
+ *    read and parsed.
+ *
+ *    Python 3 only. Build with the Makefile in this directory.
+ *
+ * HISTORY:
+ *    2026-10-18: Initial version
+ *    2026-10-18: File names may be str, bytes or os.PathLike
+ *
+ * REFERENCES:
+ *   "SVC HR-1024i / SVC HR-768i User Manual" v1.6
+ *   http://spectravista.com/
+ *
+ * PUBLIC REPOSITORY:
+ *   https://github.com/pavdpr/svcread.git
+ *
+ * LICENSE:
+ *   The MIT License (MIT) Copyright (c) 2013 Paul Romanczyk
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *   AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ *   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ *   DEALINGS IN THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+#include "svcsig.hpp"
+#include "svcsigbatch.hpp"
+
+
+// a view of one spectrum of a parsed sig file; owner is the capsule that
+// holds the svcsig, shared by the file's four arrays
+struct svcsigarray {
+  PyObject_HEAD
+  PyObject *owner;
+  const float *data;
+  Py_ssize_t shape;
+  Py_ssize_t stride;
+};
+
+static void svcSigArrayDealloc( svcsigarray *self )
+{
+  Py_XDECREF( self->owner );
+  Py_TYPE( self )->tp_free( reinterpret_cast<PyObject *>( self ) );
+}
+
+static int svcSigArrayGetBuffer( svcsigarray *self, Py_buffer *view, int flags )
+{
+  if ( ( flags & PyBUF_WRITABLE ) == PyBUF_WRITABLE ) {
+    PyErr_SetString( PyExc_BufferError, "sig file arrays are read only" );
+    view->obj = NULL;
+    return -1;
+  }
+  view->obj = reinterpret_cast<PyObject *>( self );
+  Py_INCREF( self );
+  view->buf = const_cast<float *>( self->data );
+  view->len = self->shape * sizeof( float );
+  view->readonly = 1;
+  view->itemsize = sizeof( float );
+  view->format = ( flags & PyBUF_FORMAT ) ? const_cast<char *>( "f" ) : NULL;
+  view->ndim = 1;
+  view->shape = ( flags & PyBUF_ND ) ? &self->shape : NULL;
+  view->strides = ( flags & PyBUF_STRIDES ) == PyBUF_STRIDES ? &self->stride : NULL;
+  view->suboffsets = NULL;
+  view->internal = NULL;
+  return 0;
+}
+
+static Py_ssize_t svcSigArrayLength( svcsigarray *self )
+{
+  return self->shape;
+}
+
+static PyObject * svcSigArrayItem( svcsigarray *self, Py_ssize_t i )
+{
+  if ( i < 0 || i >= self->shape ) {
+    PyErr_SetString( PyExc_IndexError, "index out of range" );
+    return NULL;
+  }
+  return PyFloat_FromDouble( self->data[ i ] );
+}
+
+static PyBufferProcs svcSigArrayBuffer = {
+  reinterpret_cast<getbufferproc>( svcSigArrayGetBuffer ),
+  NULL
+};
+
+static PySequenceMethods svcSigArraySequence = {
+  reinterpret_cast<lenfunc>( svcSigArrayLength ),
+  NULL,
+  NULL,
+  reinterpret_cast<ssizeargfunc>( svcSigArrayItem ),
+};
+
+static PyTypeObject svcSigArrayType = {
+  PyVarObject_HEAD_INIT( NULL, 0 )
+  "_svcsig.array",
+};
+
+
+/* Name: PyObject * svcSigArray( PyObject *owner, const float *data, const size_t &size )
+ *
+ * Description: Makes an array that views the floats of a parsed sig file
+ * Arguments: PyObject *owner: the capsule that owns the file
+ *            const float *data, const size_t &size: the floats
+ * Returns: PyObject *, a new reference (NULL on error)
+ */
+static PyObject * svcSigArray( PyObject *owner, const float *data, const size_t &size )
+{
+  svcsigarray *array( PyObject_New( svcsigarray, &svcSigArrayType ) );
+  if ( array == NULL ) {
+    return NULL;
+  }
+  Py_INCREF( owner );
+  array->owner = owner;
+  array->data = data;
+  array->shape = size;
+  array->stride = sizeof( float );
+  return reinterpret_cast<PyObject *>( array );
+}
+
+static void svcSigCapsuleFree( PyObject *capsule )
+{
+  delete static_cast<svcsig *>( PyCapsule_GetPointer( capsule, "_svcsig.svcsig" ) );
+}
+
+// -- -- Headers -- -- //
+
+/* Name: bool svcSigSet( PyObject *dict, const char *key, PyObject *value )
+ *
+ * Description: dict[ key ] = value, stealing the reference to value
+ * Returns: bool, false on error
+ */
+static bool svcSigSet( PyObject *dict, const char *key, PyObject *value )
+{
+  if ( value == NULL ) {
+    return false;
+  }
+  int status( PyDict_SetItemString( dict, key, value ) );
+  Py_DECREF( value );
+  return status == 0;
+}
+
+// strip()ed, as readSVCheader() does
+static PyObject * svcSigString( const std::string &s )
+{
+  size_t begin( s.find_first_not_of( " \t\r\n" ) );
+  if ( begin == std::string::npos ) {
+    return PyUnicode_FromString( "" );
+  }
+  size_t end( s.find_last_not_of( " \t\r\n" ) + 1 );
+  return PyUnicode_DecodeLatin1( s.data() + begin, end - begin, NULL );
+}
+
+/* Name: double svcSigDecimal( const float &value )
+ *
+ * Description: The double of the shortest decimal that reads back as value,
+ *    i.e. the number in the file, as readSVCheader() gives it
+ */
+static double svcSigDecimal( const float &value )
+{
+  char text[ 32 ];
+  for ( int precision = 6; precision < 9; precision++ ) {
+    snprintf( text, sizeof( text ), "%.*g", precision, double( value ) );
+    if ( strtof( text, NULL ) == value ) {
+      return strtod( text, NULL );
+    }
+  }
+  return value;
+}
+
+static PyObject * svcSigFloats( const std::vector<double> &values )
+{
+  PyObject *list( PyList_New( values.size() ) );
+  for ( size_t i = 0; list != NULL && i < values.size(); i++ ) {
+    PyObject *value( PyFloat_FromDouble( values[ i ] ) );
+    if ( value == NULL ) {
+      Py_CLEAR( list );
+    }
+    else {
+      PyList_SET_ITEM( list, i, value );
+    }
+  }
+  return list;
+}
+
+static PyObject * svcSigFloats( const std::initializer_list<float> &values )
+{
+  std::vector<double> decimals;
+  for ( const float &value : values ) {
+    decimals.push_back( svcSigDecimal( value ) );
+  }
+  return svcSigFloats( decimals );
+}
+
+static PyObject * svcSigFloats( short *values, const size_t &begin, const size_t &end )
+{
+  std::vector<double> tmp( values + begin, values + end );
+  delete [] values;
+  return svcSigFloats( tmp );
+}
+
+static PyObject * svcSigInt( const unsigned int &value )
+{
+  return Py_BuildValue( "[I]", value );
+}
+
+static PyObject * svcSigGpstime( const std::string &gpstime )
+{
+  if ( gpstime.find_first_not_of( " \t" ) == std::string::npos ) {
+    Py_RETURN_NONE;
+  }
+  return svcSigFloats( std::vector<double>( 1, strtod( gpstime.c_str(), NULL ) ) );
+}
+
+/* Name: PyObject * svcSigSpectraHeader( const svcsig &sig, const bool &reference )
+ *
+ * Description: The referenceHeader or targetHeader dictionary of
+ *    readSVCheader(): the half of each two sided field that belongs to the
+ *    scan, numbers in lists
+ * Arguments: const svcsig &sig: the file
+ *            const bool &reference: true for the reference scan
+ * Returns: PyObject *, a new reference (NULL on error)
+ * Notes: readSVCheader() splits "external data dark" between the scans, so
+ *    the reference gets D1 - D4 and the target D5 - D8 here too.
+ */
+static PyObject * svcSigSpectraHeader( const svcsig &sig, const bool &reference )
+{
+  PyObject *dict( PyDict_New() );
+  if ( dict == NULL ) {
+    return NULL;
+  }
+  bool good;
+  if ( reference ) {
+    good = svcSigSet( dict, "integration", svcSigFloats( { sig.referenceIntegrationSi(), sig.referenceIntegrationInGaAs1(), sig.referenceIntegrationInGaAs2() } ) )
+      && svcSigSet( dict, "scan method", svcSigString( sig.referenceScanMethod() ) )
+      && svcSigSet( dict, "scan coadds", svcSigFloats( { sig.referenceScanCoaddsSi(), sig.referenceScanCoaddsInGaAs1(), sig.referenceScanCoaddsInGaAs2() } ) )
+      && svcSigSet( dict, "scan time", svcSigFloats( { sig.referenceScanTime() } ) )
+      && svcSigSet( dict, "scan settings", Py_BuildValue( "[N]", svcSigString( sig.referenceScanSettings() ) ) )
+      && svcSigSet( dict, "external data set1", svcSigFloats( sig.referenceExternalDataSet1(), 0, 8 ) )
+      && svcSigSet( dict, "external data set2", svcSigFloats( sig.referenceExternalDataSet2(), 0, 8 ) )
+      && svcSigSet( dict, "external data dark", svcSigFloats( sig.externalDataDark(), 0, 4 ) )
+      && svcSigSet( dict, "optic", svcSigString( sig.referenceOptic() ) )
+      && svcSigSet( dict, "temp", svcSigFloats( { sig.referenceTempSi(), sig.referenceTempInGaAs1(), sig.referenceTempInGaAs2() } ) )
+      && svcSigSet( dict, "battery", svcSigFloats( { sig.referenceBattery() } ) )
+      && svcSigSet( dict, "error", svcSigInt( sig.referenceError() ) )
+      && svcSigSet( dict, "units", svcSigString( sig.referenceUnits() ) )
+      && svcSigSet( dict, "time", svcSigString( sig.referenceTime() ) )
+      && svcSigSet( dict, "latitude", svcSigString( sig.referenceLatitude() ) )
+      && svcSigSet( dict, "longitude", svcSigString( sig.referenceLongitude() ) )
+      && svcSigSet( dict, "gpstime", svcSigGpstime( sig.referenceGpstime() ) )
+      && svcSigSet( dict, "memory slot", svcSigInt( sig.referenceMemorySlot() ) );
+  }
+  else {
+    good = svcSigSet( dict, "integration", svcSigFloats( { sig.targetIntegrationSi(), sig.targetIntegrationInGaAs1(), sig.targetIntegrationInGaAs2() } ) )
+      && svcSigSet( dict, "scan method", svcSigString( sig.targetScanMethod() ) )
+      && svcSigSet( dict, "scan coadds", svcSigFloats( { sig.targetScanCoaddsSi(), sig.targetScanCoaddsInGaAs1(), sig.targetScanCoaddsInGaAs2() } ) )
+      && svcSigSet( dict, "scan time", svcSigFloats( { sig.targetScanTime() } ) )
+      && svcSigSet( dict, "scan settings", Py_BuildValue( "[N]", svcSigString( sig.targetScanSettings() ) ) )
+      && svcSigSet( dict, "external data set1", svcSigFloats( sig.targetExternalDataSet1(), 0, 8 ) )
+      && svcSigSet( dict, "external data set2", svcSigFloats( sig.targetExternalDataSet2(), 0, 8 ) )
+      && svcSigSet( dict, "external data dark", svcSigFloats( sig.externalDataDark(), 4, 8 ) )
+      && svcSigSet( dict, "optic", svcSigString( sig.targetOptic() ) )
+      && svcSigSet( dict, "temp", svcSigFloats( { sig.targetTempSi(), sig.targetTempInGaAs1(), sig.targetTempInGaAs2() } ) )
+      && svcSigSet( dict, "battery", svcSigFloats( { sig.targetBattery() } ) )
+      && svcSigSet( dict, "error", svcSigInt( sig.targetError() ) )
+      && svcSigSet( dict, "units", svcSigString( sig.targetUnits() ) )
+      && svcSigSet( dict, "time", svcSigString( sig.targetTime() ) )
+      && svcSigSet( dict, "latitude", svcSigString( sig.targetLatitude() ) )
+      && svcSigSet( dict, "longitude", svcSigString( sig.targetLongitude() ) )
+      && svcSigSet( dict, "gpstime", svcSigGpstime( sig.targetGpstime() ) )
+      && svcSigSet( dict, "memory slot", svcSigInt( sig.targetMemorySlot() ) );
+  }
+  if ( !good ) {
+    Py_DECREF( dict );
+    return NULL;
+  }
+  return dict;
+}
+
+/* Name: PyObject * svcSigCommonHeader( const svcsig &sig )
+ *
+ * Description: The commonHeader dictionary of readSVCheader()
+ * Returns: PyObject *, a new reference (NULL on error)
+ */
+static PyObject * svcSigCommonHeader( const svcsig &sig )
+{
+  PyObject *dict( PyDict_New() );
+  if ( dict == NULL ) {
+    return NULL;
+  }
+  bool good( svcSigSet( dict, "name", svcSigString( sig.name() ) )
+    && svcSigSet( dict, "instrument", svcSigString( sig.instrument() ) )
+    && svcSigSet( dict, "external data mask", PyFloat_FromDouble( sig.externalDataMask() ) )
+    && svcSigSet( dict, "comm", svcSigString( sig.comm() ) )
+    && svcSigSet( dict, "factors", svcSigFloats( { sig.factorsReference(), sig.factorsTarget(), sig.factorsReflectance() } ) ) );
+  if ( good && !sig.factorsComment().empty() ) {
+    good = svcSigSet( dict, "factors comment", svcSigString( sig.factorsComment() ) );
+  }
+  if ( !good ) {
+    Py_DECREF( dict );
+    return NULL;
+  }
+  return dict;
+}
+
+/* Name: PyObject * svcSigDict( svcsig *sig )
+ *
+ * Description: The readSVCsig() dictionary of a parsed file
+ * Arguments: svcsig *sig: the file; owned by the dictionary's arrays from
+ *     now on (even on error)
+ * Returns: PyObject *, a new reference (NULL on error)
+ */
+static PyObject * svcSigDict( svcsig *sig )
+{
+  PyObject *owner( PyCapsule_New( sig, "_svcsig.svcsig", svcSigCapsuleFree ) );
+  if ( owner == NULL ) {
+    delete sig;
+    return NULL;
+  }
+  PyObject *dict( PyDict_New() );
+  PyObject *header( PyDict_New() );
+  bool good( dict != NULL && header != NULL
+    && svcSigSet( header, "commonHeader", svcSigCommonHeader( *sig ) )
+    && svcSigSet( header, "referenceHeader", svcSigSpectraHeader( *sig, true ) )
+    && svcSigSet( header, "targetHeader", svcSigSpectraHeader( *sig, false ) ) );
+  if ( good ) {
+    Py_INCREF( header );
+    good = svcSigSet( dict, "header", header )
+      && svcSigSet( dict, "wavelength", svcSigArray( owner, sig->wavelengthData(), sig->size() ) )
+      && svcSigSet( dict, "referenceDC", svcSigArray( owner, sig->referenceRadianceData(), sig->size() ) )
+      && svcSigSet( dict, "targetDC", svcSigArray( owner, sig->targetRadianceData(), sig->size() ) )
+      && svcSigSet( dict, "reflectance", svcSigArray( owner, sig->targetReflectanceData(), sig->size() ) );
+  }
+  Py_XDECREF( header );
+  Py_DECREF( owner );
+  if ( !good ) {
+    Py_XDECREF( dict );
+    return NULL;
+  }
+  return dict;
+}
+
+/* Name: static bool svcSigPath( PyObject *object, std::string &path )
+ *
+ * Description: Converts a str, bytes or os.PathLike file name to the bytes
+ *    of the file system encoding, as open() does
+ * Returns: false with a Python exception set if it is not a file name
+ */
+static bool svcSigPath( PyObject *object, std::string &path )
+{
+  PyObject *bytes( NULL );
+  if ( !PyUnicode_FSConverter( object, &bytes ) ) {
+    return false;
+  }
+  path.assign( PyBytes_AS_STRING( bytes ), PyBytes_GET_SIZE( bytes ) );
+  Py_DECREF( bytes );
+  return true;
+}
+
+// -- -- Module functions -- -- //
+
+static PyObject * svcSigRead( PyObject *, PyObject *args )
+{
+  PyObject *filename;
+  std::string name;
+  if ( !PyArg_ParseTuple( args, "O:read", &filename ) || !svcSigPath( filename, name ) ) {
+    return NULL;
+  }
+  svcsig *sig( new svcsig );
+  std::string error;
+  Py_BEGIN_ALLOW_THREADS
+  try {
+    sig->read( name );
+  } catch ( const std::exception &e ) {
+    error = e.what();
+  }
+  Py_END_ALLOW_THREADS
+  if ( !error.empty() || sig->size() == 0 ) {
+    delete sig;
+    PyErr_SetString( PyExc_IOError, ( "could not read '" + name + "'" + ( error.empty() ? "" : ": " + error ) ).c_str() );
+    return NULL;
+  }
+  return svcSigDict( sig );
+}
+
+static PyObject * svcSigReadBatchPy( PyObject *, PyObject *args )
+{
+  PyObject *sequence;
+  unsigned int threads( 0 );
+  if ( !PyArg_ParseTuple( args, "O|I:readBatch", &sequence, &threads ) ) {
+    return NULL;
+  }
+  PyObject *items( PySequence_Fast( sequence, "readBatch expects a sequence of file names" ) );
+  if ( items == NULL ) {
+    return NULL;
+  }
+  std::vector<std::string> filenames( PySequence_Fast_GET_SIZE( items ) );
+  for ( size_t i = 0; i < filenames.size(); i++ ) {
+    if ( !svcSigPath( PySequence_Fast_GET_ITEM( items, i ), filenames[ i ] ) ) {
+      Py_DECREF( items );
+      return NULL;
+    }
+  }
+  Py_DECREF( items );
+  
+  // parse into place, one heap svcsig per file, so nothing is copied
+  std::vector<svcsig *> sigs( filenames.size() );
+  for ( size_t i = 0; i < sigs.size(); i++ ) {
+    sigs[ i ] = new svcsig;
+  }
+  Py_BEGIN_ALLOW_THREADS
+  svcSigParallelFor( sigs.size(), threads, [&]( size_t i, unsigned int ) {
+    try {
+      sigs[ i ]->read( filenames[ i ] );
+    } catch ( const std::exception & ) {
+      delete sigs[ i ];
+      sigs[ i ] = new svcsig;
+    }
+  } );
+  Py_END_ALLOW_THREADS
+  
+  // None for the files that could not be read
+  PyObject *list( PyList_New( sigs.size() ) );
+  for ( size_t i = 0; i < sigs.size(); i++ ) {
+    PyObject *dict( NULL );
+    if ( list != NULL && sigs[ i ]->size() > 0 ) {
+      dict = svcSigDict( sigs[ i ] );
+      if ( dict == NULL ) {
+        Py_CLEAR( list );
+      }
+    }
+    else {
+      delete sigs[ i ];
+      if ( list != NULL ) {
+        Py_INCREF( Py_None );
+        dict = Py_None;
+      }
+    }
+    if ( list != NULL ) {
+      PyList_SET_ITEM( list, i, dict );
+    }
+  }
+  return list;
+}
+
+static PyMethodDef svcSigMethods[] = {
+  { "read", svcSigRead, METH_VARARGS,
+    "read(filename) -> dict\n\nReads a sig file (str, bytes or os.PathLike), as readSVCsig() does. Raises IOError if it can not be read." },
+  { "readBatch", svcSigReadBatchPy, METH_VARARGS,
+    "readBatch(filenames, threads=0) -> list\n\nReads many sig files across worker threads (0 for one per core).\nFiles that can not be read are None." },
+  { NULL, NULL, 0, NULL }
+};
+
+static struct PyModuleDef svcSigModule = {
+  PyModuleDef_HEAD_INIT,
+  "_svcsig",
+  "Reads SVC sig files with the C++ svcsig reader; spectra are exposed\nthrough the buffer protocol without copying.",
+  -1,
+  svcSigMethods
+};
+
+PyMODINIT_FUNC PyInit__svcsig( void )
+{
+  svcSigArrayType.tp_basicsize = sizeof( svcsigarray );
+  svcSigArrayType.tp_dealloc = reinterpret_cast<destructor>( svcSigArrayDealloc );
+  svcSigArrayType.tp_flags = Py_TPFLAGS_DEFAULT;
+  svcSigArrayType.tp_doc = "A read only array of floats of a sig file, for numpy.asarray() or memoryview()";
+  svcSigArrayType.tp_as_buffer = &svcSigArrayBuffer;
+  svcSigArrayType.tp_as_sequence = &svcSigArraySequence;
+  if ( PyType_Ready( &svcSigArrayType ) < 0 ) {
+    return NULL;
+  }
+  PyObject *module( PyModule_Create( &svcSigModule ) );
+  if ( module == NULL ) {
+    return NULL;
+  }
+  Py_INCREF( &svcSigArrayType );
+  if ( PyModule_AddObject( module, "array", reinterpret_cast<PyObject *>( &svcSigArrayType ) ) < 0 ) {
+    Py_DECREF( &svcSigArrayType );
+    Py_DECREF( module );
+    return NULL;
+  }
+  return module;
+}
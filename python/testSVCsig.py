@@ -0,0 +1,136 @@
+#!/usr/bin/env python
+
+"""TESTSVCSIG checks that the C++ and pure Python sig readers agree
+
+INPUTS:
+    files: the sig files to compare (default: ../data/*.sig)
+
+OUTPUTS:
+    unittest results. The native tests are skipped if _svcsig is not built.
+
+    e.g. python testSVCsig.py, or make test in this directory
+
+HISTORY:
+    2026-10-18: Initial version
+
+PUBLIC REPOSITORY:
+    https://github.com/pavdpr/svcread.git
+
+LICENSE:
+    The MIT License (MIT) Copyright
+    (c) 2013-2015 Rochester Institute of Technology
+
+    Permission is hereby granted, free of charge, to any person obtaining a
+    copy of this software and associated documentation files (the
+    "Software"), to deal in the Software without restriction, including
+    without limitation the rights to use, copy, modify, merge, publish,
+    distribute, sublicense, and/or sell copies of the Software, and to
+    permit persons to whom the Software is furnished to do so, subject to
+    the following conditions:
+
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+    OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+"""
+
+import glob
+import os
+import sys
+import unittest
+import numpy
+
+import readSVCsig
+
+SPECTRA = ('wavelength', 'referenceDC', 'targetDC', 'reflectance')
+FILENAMES = sorted(glob.glob(os.path.join(os.path.dirname(
+    os.path.abspath(__file__)), '..', 'data', '*.sig')))
+
+
+class testNative(unittest.TestCase):
+    """readSVCsig (C++) against readSVCsigPython"""
+
+    def setUp(self):
+        if readSVCsig._svcsig is None:
+            self.skipTest('_svcsig is not built')
+        self.assertTrue(FILENAMES, 'no sig files')
+
+    def testSpectra(self):
+        for filename in FILENAMES:
+            native = readSVCsig.readSVCsig(filename)
+            python = readSVCsig.readSVCsigPython(filename)
+            for key in SPECTRA:
+                self.assertEqual(native[key].dtype, python[key].dtype)
+                self.assertEqual(native[key].shape, python[key].shape)
+                # the C++ reader holds float32
+                numpy.testing.assert_allclose(native[key], python[key],
+                                              rtol=1e-6, err_msg=key)
+
+    def testWritable(self):
+        native = readSVCsig.readSVCsig(FILENAMES[0])
+        python = readSVCsig.readSVCsigPython(FILENAMES[0])
+        native['reflectance'] /= 100
+        python['reflectance'] /= 100
+        numpy.testing.assert_allclose(native['reflectance'],
+                                      python['reflectance'], rtol=1e-6)
+
+    def testHeaders(self):
+        for filename in FILENAMES:
+            native = readSVCsig.readSVCsig(filename)['header']
+            python = readSVCsig.readSVCsigPython(filename)['header']
+            for part in ('commonHeader', 'referenceHeader', 'targetHeader'):
+                self.assertEqual(sorted(native[part]), sorted(python[part]))
+                for key, value in native[part].items():
+                    other = python[part][key]
+                    if isinstance(value, str):
+                        # the pure reader splits text fields by character,
+                        # leaving the ', ' between the halves
+                        self.assertEqual(value, other.strip(' ,'), key)
+                    else:
+                        self.assertEqual(value, other, key)
+
+    def testBatch(self):
+        batch = readSVCsig.readSVCsigBatch(FILENAMES, 2)
+        for filename, native in zip(FILENAMES, batch):
+            single = readSVCsig.readSVCsig(filename)
+            for key in SPECTRA:
+                numpy.testing.assert_array_equal(native[key], single[key])
+
+
+class testBatchUnreadable(unittest.TestCase):
+    """readSVCsigBatch gives None for unreadable files with either reader"""
+
+    def check(self):
+        filenames = [FILENAMES[0], FILENAMES[0] + '.missing', __file__]
+        batch = readSVCsig.readSVCsigBatch(filenames)
+        self.assertEqual(len(batch), 3)
+        self.assertIsNotNone(batch[0])
+        self.assertIsNone(batch[1])
+        self.assertIsNone(batch[2])
+
+    def testNative(self):
+        if readSVCsig._svcsig is None:
+            self.skipTest('_svcsig is not built')
+        self.check()
+
+    def testPython(self):
+        native = readSVCsig._svcsig
+        readSVCsig._svcsig = None
+        try:
+            self.check()
+        finally:
+            readSVCsig._svcsig = native
+
+
+if __name__ == '__main__':
+    if len(sys.argv) > 1 and not sys.argv[1].startswith('-'):
+        FILENAMES = sys.argv[1:]
+        del sys.argv[1:]
+    unittest.main()